@@ -5,11 +5,12 @@
 use anyhow::{anyhow, bail, ensure, Context, Result};
 use code_gen_utils::{
     format_cc_ident, format_cc_includes, format_namespace_bound_cc_tokens, make_rs_ident,
-    CcInclude, NamespaceQualifier,
+    CcInclude, CcIncludeSet, NamespaceQualifier,
 };
 use itertools::Itertools;
 use proc_macro2::{Literal, TokenStream};
 use quote::{format_ident, quote};
+use rustc_data_structures::sync::{par_for_each_in, Lock};
 use rustc_hir::{AssocItemKind, ImplItemKind, ImplicitSelfKind, Item, ItemKind, Node, Unsafety};
 use rustc_middle::dep_graph::DepContext;
 use rustc_middle::mir::Mutability;
@@ -19,7 +20,7 @@ use rustc_span::symbol::Symbol;
 use rustc_target::spec::abi::Abi;
 use rustc_target::spec::PanicStrategy;
 use std::cmp::Ordering;
-use std::collections::{BTreeSet, HashMap, HashSet};
+use std::collections::{HashMap, HashSet};
 use std::iter::once;
 use std::ops::AddAssign;
 use std::rc::Rc;
@@ -111,7 +112,7 @@ struct CcPrerequisites {
     /// Set of `#include`s that a `CcSnippet` depends on.  For example if
     /// `CcSnippet::tokens` expands to `std::int32_t`, then `includes`
     /// need to cover the `#include <cstdint>`.
-    includes: BTreeSet<CcInclude>,
+    includes: CcIncludeSet,
 
     /// Set of local definitions that a `CcSnippet` depends on.  For example if
     /// `CcSnippet::tokens` expands to `void foo(S s)` then the definition
@@ -149,16 +150,12 @@ impl CcPrerequisites {
 
 impl AddAssign for CcPrerequisites {
     fn add_assign(&mut self, rhs: Self) {
-        let Self { mut includes, defs, fwd_decls } = rhs;
+        let Self { includes, defs, fwd_decls } = rhs;
 
-        // `BTreeSet::append` is used because it _seems_ to be more efficient than
-        // calling `extend`.  This is because `extend` takes an iterator
-        // (processing each `rhs` include one-at-a-time) while `append` steals
-        // the whole backing data store from `rhs.includes`. OTOH, this is a bit
-        // speculative, since the (expected / guessed) performance difference is
-        // not documented at
-        // https://doc.rust-lang.org/std/collections/struct.BTreeSet.html#method.append
-        self.includes.append(&mut includes);
+        // `CcIncludeSet` is a bitset over interned includes, so this merge is
+        // a word-level OR (`add_assign` runs once per snippet-within-snippet,
+        // which used to make `BTreeSet` merging show up on profiles).
+        self.includes |= includes;
 
         self.defs.extend(defs);
         self.fwd_decls.extend(fwd_decls);
@@ -1136,16 +1133,25 @@ fn format_unsupported_def(
 /// Formats all public items from the Rust crate being compiled.
 fn format_crate(input: &Input) -> Result<Output> {
     let tcx = input.tcx;
-    let mut bindings: HashMap<SnippetKey, MixedSnippet> = tcx
-        .hir()
-        .items()
-        .flat_map(|item_id| {
-            let def_id: LocalDefId = item_id.owner_id.def_id;
-            format_item(input, def_id)
-                .unwrap_or_else(|err| vec![format_unsupported_def(tcx, def_id, err)])
-                .into_iter()
-        })
-        .fold(HashMap::new(), |mut map, (key, value)| {
+
+    // Formatting is independent per item (`format_item` only queries `tcx`),
+    // so it is fanned out through the same infrastructure rustc's own queries
+    // use: with a non-parallel rustc `par_for_each_in` degrades to a plain
+    // sequential loop, with a parallel rustc the items are formatted on the
+    // query thread pool. The accumulation order under parallelism is
+    // nondeterministic, which is fine here: `bindings` is keyed by
+    // `SnippetKey` and the output order is fixed by the toposort below.
+    let formatted: Lock<Vec<(SnippetKey, MixedSnippet)>> = Lock::new(Vec::new());
+    par_for_each_in(tcx.hir().items().collect_vec(), |item_id| {
+        let def_id: LocalDefId = item_id.owner_id.def_id;
+        let snippets = format_item(input, def_id)
+            .unwrap_or_else(|err| vec![format_unsupported_def(tcx, def_id, err)]);
+        if !snippets.is_empty() {
+            formatted.lock().extend(snippets);
+        }
+    });
+    let mut bindings: HashMap<SnippetKey, MixedSnippet> =
+        formatted.into_inner().into_iter().fold(HashMap::new(), |mut map, (key, value)| {
             let old_item = map.insert(key, value);
             assert!(old_item.is_none(), "Duplicated key: {key:?}");
             map
@@ -1180,7 +1186,7 @@ fn format_crate(input: &Input) -> Result<Output> {
     let (includes, ordered_cc, rs_body) = {
         let mut already_declared = HashSet::new();
         let mut fwd_decls = HashSet::new();
-        let mut includes = BTreeSet::new();
+        let mut includes = CcIncludeSet::default();
         let mut ordered_cc = Vec::new();
         let mut rs_body = quote! {};
         for key in ordered_ids.into_iter() {
@@ -1190,7 +1196,7 @@ fn format_crate(input: &Input) -> Result<Output> {
                 cc: CcSnippet {
                     tokens: cc_tokens,
                     prereqs: CcPrerequisites {
-                        includes: mut inner_includes,
+                        includes: inner_includes,
                         fwd_decls: inner_fwd_decls,
                         .. // `defs` have already been utilized by `toposort` above
                     }
@@ -1201,7 +1207,7 @@ fn format_crate(input: &Input) -> Result<Output> {
             already_declared.insert(key.def_id);
             already_declared.extend(inner_fwd_decls.into_iter());
 
-            includes.append(&mut inner_includes);
+            includes |= inner_includes;
             ordered_cc.push((mod_path, cc_tokens));
             rs_body.extend(inner_rs);
         }
@@ -1227,7 +1233,9 @@ fn format_crate(input: &Input) -> Result<Output> {
         // unique + ergonomic).
         let crate_name = format_cc_ident(tcx.crate_name(LOCAL_CRATE).as_str())?;
 
-        let includes = format_cc_includes(&includes);
+        // The only place where the bitset is resolved back into `CcInclude`s
+        // (and sorted): once, for the whole header.
+        let includes = format_cc_includes(&includes.to_btree_set());
         let ordered_cc = format_namespace_bound_cc_tokens(ordered_cc);
         quote! {
             #includes
@@ -2216,11 +2224,11 @@ pub mod tests {
 
             // Main checks: `CcPrerequisites::includes`.
             assert_cc_matches!(
-                format_cc_includes(&main_api.prereqs.includes),
+                format_cc_includes(&main_api.prereqs.includes.to_btree_set()),
                 quote! { include <cstdint> }
             );
             assert_cc_matches!(
-                format_cc_includes(&impl_details.cc.prereqs.includes),
+                format_cc_includes(&impl_details.cc.prereqs.includes.to_btree_set()),
                 quote! { include <cstdint> }
             );
 
@@ -3774,7 +3782,7 @@ pub mod tests {
                 } else {
                     let expected_include: TokenStream = expected_include.parse().unwrap();
                     assert_cc_matches!(
-                        format_cc_includes(&actual_includes),
+                        format_cc_includes(&actual_includes.to_btree_set()),
                         quote! { __HASH_TOKEN__ include #expected_include }
                     );
                 }
@@ -4062,7 +4070,7 @@ pub mod tests {
             } else {
                 let expected_header = format_cc_ident(expected_include).unwrap();
                 assert_cc_matches!(
-                    format_cc_includes(&actual_includes),
+                    format_cc_includes(&actual_includes.to_btree_set()),
                     quote! { include <#expected_header> }
                 );
             }
@@ -6,6 +6,7 @@
 #![feature(rustc_private)]
 #![deny(rustc::internal)]
 
+extern crate rustc_data_structures;
 extern crate rustc_driver;
 extern crate rustc_error_codes;
 extern crate rustc_errors;
@@ -23,6 +24,7 @@ extern crate rustc_target;
 mod bindings;
 mod cmdline;
 mod run_compiler;
+mod worker;
 
 use anyhow::Context;
 use itertools::Itertools;
@@ -32,7 +34,8 @@ use std::path::Path;
 use cmdline::Cmdline;
 use run_compiler::run_compiler;
 use token_stream_printer::{
-    cc_tokens_to_formatted_string, rs_tokens_to_formatted_string, RustfmtConfig,
+    cc_format_string, rs_format_string, rs_tokens_to_string_chunks, tokens_to_string,
+    RustfmtConfig,
 };
 
 fn write_file(path: &Path, content: &str) -> anyhow::Result<()> {
@@ -40,24 +43,88 @@ fn write_file(path: &Path, content: &str) -> anyhow::Result<()> {
         .with_context(|| format!("Error when writing to {}", path.display()))
 }
 
+/// Computes the contents of the `--fingerprint-out` manifest: the stable
+/// crate hash of the compiled crate and of every dependency, plus the cmdline
+/// inputs that get stamped into the generated files.  The crate hashes cover
+/// the sources of each crate, so a matching manifest means that the outputs
+/// of the previous run are still valid.
+fn compute_fingerprint(cmdline: &Cmdline, tcx: TyCtxt) -> String {
+    use rustc_span::def_id::LOCAL_CRATE;
+    use std::fmt::Write as _;
+    let mut manifest = "cc_bindings_from_rs fingerprint v1\n".to_string();
+    writeln!(manifest, "crubit_support_path: {}", cmdline.crubit_support_path).unwrap();
+    writeln!(manifest, "{}: {}", tcx.crate_name(LOCAL_CRATE), tcx.crate_hash(LOCAL_CRATE)).unwrap();
+    for &cnum in tcx.crates(()) {
+        writeln!(manifest, "{}: {}", tcx.crate_name(cnum), tcx.crate_hash(cnum)).unwrap();
+    }
+    manifest
+}
+
 fn run_with_tcx(cmdline: &Cmdline, tcx: TyCtxt) -> anyhow::Result<()> {
     use bindings::*;
+
+    let fingerprint = cmdline.fingerprint_out.as_deref().map(|_| compute_fingerprint(cmdline, tcx));
+    if let (Some(fingerprint_path), Some(fingerprint)) =
+        (cmdline.fingerprint_out.as_deref(), fingerprint.as_deref())
+    {
+        let up_to_date = std::fs::read_to_string(fingerprint_path)
+            .map_or(false, |previous| previous == fingerprint);
+        if up_to_date && cmdline.h_out.exists() && cmdline.rs_out.exists() {
+            return Ok(());
+        }
+    }
+
     let Output { h_body, rs_body } = {
         let crubit_support_path = cmdline.crubit_support_path.as_str().into();
         let input = Input { tcx, crubit_support_path, _features: (), _crate_to_include_map: () };
         generate_bindings(&input)?
     };
 
+    // The two outputs are independent and the formatters dominate the output
+    // phase, so they are emitted concurrently.  Token streams are not `Send`,
+    // so both bodies are printed to strings first; then one thread pipes the
+    // C++ header through `clang-format` while the Rust glue is formatted as
+    // parallel `rustfmt` chunks that are streamed to disk, in order, as each
+    // chunk finishes.
+    let h_body = tokens_to_string(h_body)?;
+    let rs_chunks = rs_tokens_to_string_chunks(
+        rs_body,
+        std::thread::available_parallelism().map_or(1, std::num::NonZeroUsize::get),
+    )?;
+    let rustfmt_config =
+        RustfmtConfig::new(&cmdline.rustfmt_exe_path, cmdline.rustfmt_config_path.as_deref());
+    std::thread::scope(|scope| -> anyhow::Result<()> {
+        let h_thread = scope.spawn(move || -> anyhow::Result<()> {
+            let h_body = cc_format_string(h_body, &cmdline.clang_format_exe_path)?;
+            write_file(&cmdline.h_out, &h_body)
+        });
+        let rustfmt_config = &rustfmt_config;
+        let rs_threads: Vec<_> = rs_chunks
+            .into_iter()
+            .map(|chunk| scope.spawn(move || rs_format_string(chunk, rustfmt_config)))
+            .collect();
+        let rs_result = (|| -> anyhow::Result<()> {
+            use std::io::Write as _;
+            let rs_context = || format!("Error when writing to {}", cmdline.rs_out.display());
+            let mut writer = std::io::BufWriter::new(
+                std::fs::File::create(&cmdline.rs_out).with_context(rs_context)?,
+            );
+            for thread in rs_threads {
+                let chunk = thread.join().expect("rustfmt thread shouldn't panic")?;
+                writer.write_all(chunk.as_bytes()).with_context(rs_context)?;
+            }
+            writer.flush().with_context(rs_context)?;
+            Ok(())
+        })();
+        h_thread.join().expect("clang-format thread shouldn't panic").and(rs_result)
+    })?;
+
+    // The fingerprint is written last, so that a run that failed after writing
+    // only one of the outputs never claims to be up to date.
+    if let (Some(fingerprint_path), Some(fingerprint)) =
+        (cmdline.fingerprint_out.as_deref(), fingerprint.as_deref())
     {
-        let h_body = cc_tokens_to_formatted_string(h_body, &cmdline.clang_format_exe_path)?;
-        write_file(&cmdline.h_out, &h_body)?;
-    }
-
-    {
-        let rustfmt_config =
-            RustfmtConfig::new(&cmdline.rustfmt_exe_path, cmdline.rustfmt_config_path.as_deref());
-        let rs_body = rs_tokens_to_formatted_string(rs_body, &rustfmt_config)?;
-        write_file(&cmdline.rs_out, &rs_body)?;
+        write_file(fingerprint_path, fingerprint)?;
     }
 
     Ok(())
@@ -85,6 +152,18 @@ fn main() -> anyhow::Result<()> {
     // Unicode.  This seems okay.
     let args = std::env::args().collect_vec();
 
+    // `--persistent_worker` is part of the worker protocol rather than of any
+    // single action's cmdline (each `WorkRequest` carries the full per-action
+    // arguments), so it is handled here instead of in `Cmdline`.
+    if args.iter().any(|arg| arg == worker::PERSISTENT_WORKER_FLAG) {
+        return worker::run_worker_loop(
+            &args[0],
+            std::io::stdin().lock(),
+            std::io::stdout().lock(),
+            |request_args| run_with_cmdline_args(request_args),
+        );
+    }
+
     run_with_cmdline_args(&args)
         .map_err(|anyhow_err| match anyhow_err.downcast::<clap::Error>() {
             // Explicitly call `clap::Error::exit`, because 1) it results in *colored* output and
@@ -381,6 +460,27 @@ extern "C" fn __crubit_thunk__ANY_IDENTIFIER_CHARACTERS()
         Ok(())
     }
 
+    /// `test_fingerprint_out` tests that `--fingerprint-out` 1) writes the
+    /// manifest after a successful run and 2) still regenerates outputs that
+    /// went missing, even when the manifest matches.
+    #[test]
+    fn test_fingerprint_out() -> anyhow::Result<()> {
+        let test_args = TestArgs::default_args()?;
+        let fingerprint_path = test_args.tempdir.path().join("test_crate.fingerprint");
+        let test_args = test_args.with_extra_crubit_args(&[&format!(
+            "--fingerprint-out={}",
+            fingerprint_path.display()
+        )]);
+
+        let test_result = test_args.run().expect("First run should succeed");
+        assert!(fingerprint_path.exists());
+
+        std::fs::remove_file(&test_result.h_path)?;
+        test_args.run().expect("Second run should succeed");
+        assert!(test_result.h_path.exists());
+        Ok(())
+    }
+
     /// `test_invalid_h_out_path` tests not only the specific problem of an invalid
     /// `--h-out` argument, but also tests that errors from `run_with_tcx` are
     /// propagated.
@@ -42,6 +42,18 @@ pub struct Cmdline {
     #[clap(long, value_parser, value_name = "FILE")]
     pub rustfmt_config_path: Option<PathBuf>,
 
+    /// Directory for rustc's incremental compilation session; passed to rustc
+    /// as `-Cincremental=<DIR>` so that repeat invocations reuse the
+    /// dep-graph instead of redoing the full analysis.
+    #[clap(long, value_parser, value_name = "DIR")]
+    pub incremental_dir: Option<PathBuf>,
+
+    /// Output path for a fingerprint manifest of the inputs (stable crate
+    /// hashes plus stamped flags). When the file already matches and both
+    /// outputs exist, bindings generation and formatting are skipped.
+    #[clap(long, value_parser, value_name = "FILE")]
+    pub fingerprint_out: Option<PathBuf>,
+
     /// Command line arguments of the Rust compiler.
     #[clap(last = true, value_parser)]
     pub rustc_args: Vec<String>,
@@ -72,6 +84,12 @@ impl Cmdline {
         // element.
         cmdline.rustc_args.insert(0, exe_name);
 
+        // Translating `--incremental-dir` into a compiler flag here keeps the
+        // Bazel-side wrapper scripts oblivious to rustc's flag spelling.
+        if let Some(incremental_dir) = &cmdline.incremental_dir {
+            cmdline.rustc_args.push(format!("-Cincremental={}", incremental_dir.display()));
+        }
+
         Ok(cmdline)
     }
 }
@@ -141,6 +159,37 @@ mod tests {
         );
     }
 
+    #[test]
+    fn test_incremental_dir_happy_path() {
+        let cmdline = new_cmdline([
+            "--h-out=foo.h",
+            "--rs-out=foo_impl.rs",
+            "--crubit-support-path=crubit/support/for/tests",
+            "--clang-format-exe-path=clang-format.exe",
+            "--rustfmt-exe-path=rustfmt.exe",
+            "--incremental-dir=some/cache/dir",
+            "--",
+            "test.rs",
+            "--crate-type=lib",
+        ])
+        .unwrap();
+
+        let rustc_args = &cmdline.rustc_args;
+        assert!(
+            itertools::equal(
+                [
+                    "cc_bindings_from_rs_unittest_executable",
+                    "test.rs",
+                    "--crate-type=lib",
+                    "-Cincremental=some/cache/dir"
+                ],
+                rustc_args
+            ),
+            "rustc_args = {:?}",
+            rustc_args,
+        );
+    }
+
     /// The `test_help` unit test below has multiple purposes:
     /// - Direct/obvious purpose: testing that `--help` works
     /// - Double-checking the overall shape of our cmdline "API" (i.e.
@@ -181,12 +230,22 @@ OPTIONS:
             Path to the `crubit/support` directory in a format that should be used in the `#include`
             directives inside the generated C++ files. Example: "crubit/support"
 
+        --fingerprint-out <FILE>
+            Output path for a fingerprint manifest of the inputs (stable crate hashes plus stamped
+            flags). When the file already matches and both outputs exist, bindings generation and
+            formatting are skipped
+
         --h-out <FILE>
             Output path for C++ header file with bindings
 
     -h, --help
             Print help information
 
+        --incremental-dir <DIR>
+            Directory for rustc's incremental compilation session; passed to rustc as
+            `-Cincremental=<DIR>` so that repeat invocations reuse the dep-graph instead of redoing
+            the full analysis
+
         --rs-out <FILE>
             Output path for Rust implementation of the bindings
 
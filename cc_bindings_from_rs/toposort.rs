@@ -67,6 +67,13 @@ use std::hash::Hash;
 /// to the `BinaryHeap` via the `Ord` implementation of the private `HeapNode`
 /// struct below.
 ///
+/// Internally the graph is stored in a dense, index-based representation
+/// (adjacency lists of indices into a single `Vec` of nodes).  `NodeId`s are
+/// hashed only once per node and once per dependency edge - while the
+/// algorithm itself runs, every step is an array access.  This matters for
+/// the generated headers with thousands of items, where `NodeId` is a
+/// `SnippetKey` and hashing it on every edge relaxation dominated the sort.
+///
 /// # Why not use an existing Cargo crate?
 ///
 /// There are existing Cargo crate that provide an implementation of the
@@ -125,53 +132,70 @@ where
     NodeId: Clone + Eq + Hash,
     CmpFn: Fn(&NodeId, &NodeId) -> Ordering,
 {
-    // Translating `nodes` and `deps` into a `graph` that maps node ids into 1)
-    // `count_of_predecessors` and 2) a set of `successor` ids.
-    let mut graph: HashMap<NodeId, GraphNode<NodeId>> =
-        nodes.into_iter().map(|id| (id, GraphNode::default())).collect();
+    // Translating `nodes` into a dense, index-based representation.  This is
+    // the only place where `NodeId`s get hashed - the algorithm below works
+    // purely with indices into `ids`.
+    let mut ids: Vec<NodeId> = Vec::new();
+    let mut index_of_id: HashMap<NodeId, usize> = HashMap::new();
+    for id in nodes.into_iter() {
+        index_of_id.entry(id.clone()).or_insert_with(|| {
+            ids.push(id);
+            ids.len() - 1
+        });
+    }
+
+    // Translating `deps` into 1) `count_of_predecessors` and 2) adjacency
+    // lists of `successors` (both indexed by the node's position in `ids`).
+    let mut count_of_predecessors: Vec<usize> = vec![0; ids.len()];
+    let mut successors: Vec<Vec<usize>> = vec![Vec::new(); ids.len()];
     for Dependency { predecessor, successor } in deps.into_iter() {
-        graph
-            .get_mut(&successor)
-            .expect("`Dependency::successor` should refer to a NodeId in the `nodes` parameter")
-            .count_of_predecessors += 1;
-        graph
-            .get_mut(&predecessor)
-            .expect("`Dependency::predecessor` should refer to a NodeId in the `nodes` parameter")
-            .successors
-            .push(successor);
+        let succ_index = *index_of_id
+            .get(&successor)
+            .expect("`Dependency::successor` should refer to a NodeId in the `nodes` parameter");
+        let pred_index = *index_of_id
+            .get(&predecessor)
+            .expect("`Dependency::predecessor` should refer to a NodeId in the `nodes` parameter");
+        count_of_predecessors[succ_index] += 1;
+        successors[pred_index].push(succ_index);
     }
 
-    // `ready` contains ids of nodes which have no remaining predecessors (and which
-    // therefore are ready to be added to the `ordered` result of the
-    // topological sort).  Using a BinaryHeap to store the `ready` nodes helps
-    // to extract them in the `preferred_order`.  (This is the `S` data structure from
+    // `ready` contains indices of nodes which have no remaining predecessors
+    // (and which therefore are ready to be added to the `ordered` result of
+    // the topological sort).  Using a BinaryHeap to store the `ready` nodes
+    // helps to extract them in the `preferred_order`.  (This is the `S` data structure from
     // https://en.wikipedia.org/wiki/Topological_sorting#Kahn%27s_algorithm.)
-    let mut ready: BinaryHeap<HeapNode<'_, NodeId, CmpFn>> = graph
+    let mut ready: BinaryHeap<HeapNode<'_, NodeId, CmpFn>> = count_of_predecessors
         .iter()
-        .filter(|(_, graph_node)| graph_node.count_of_predecessors == 0)
-        .map(|(id, _)| HeapNode { id: id.clone(), cmp_fn: &preferred_order })
+        .enumerate()
+        .filter(|(_, &count)| count == 0)
+        .map(|(index, _)| HeapNode { index, ids: &ids, cmp_fn: &preferred_order })
         .collect();
 
     // `ordered` contains the topologically ordered results.  (This is the `L` list
     // from https://en.wikipedia.org/wiki/Topological_sorting#Kahn%27s_algorithm.)
-    let mut ordered: Vec<NodeId> = Vec::with_capacity(graph.len());
-    while let Some(HeapNode { id: removed_id, .. }) = ready.pop() {
-        let removed_graph_node = graph.remove(&removed_id).unwrap();
-        for succ_id in removed_graph_node.successors.into_iter() {
-            let succ = graph.get_mut(&succ_id).unwrap();
-            assert!(succ.count_of_predecessors > 0);
-            succ.count_of_predecessors -= 1;
-            if succ.count_of_predecessors == 0 {
-                ready.push(HeapNode { id: succ_id, cmp_fn: &preferred_order });
+    let mut is_ordered: Vec<bool> = vec![false; ids.len()];
+    let mut ordered: Vec<NodeId> = Vec::with_capacity(ids.len());
+    while let Some(HeapNode { index: removed_index, .. }) = ready.pop() {
+        is_ordered[removed_index] = true;
+        for &succ_index in successors[removed_index].iter() {
+            assert!(count_of_predecessors[succ_index] > 0);
+            count_of_predecessors[succ_index] -= 1;
+            if count_of_predecessors[succ_index] == 0 {
+                ready.push(HeapNode { index: succ_index, ids: &ids, cmp_fn: &preferred_order });
             }
         }
-        ordered.push(removed_id);
+        ordered.push(ids[removed_index].clone());
     }
 
     // `failed` contains the remaining nodes - ones that either formed a dependency
     // cycle or (possibly indirectly) depended on a node participating in a
     // cycle.
-    let mut failed: Vec<NodeId> = graph.into_keys().collect();
+    let mut failed: Vec<NodeId> = ids
+        .iter()
+        .enumerate()
+        .filter(|(index, _)| !is_ordered[*index])
+        .map(|(_, id)| id.clone())
+        .collect();
     failed.sort_by(preferred_order);
 
     TopoSortResult { ordered, failed }
@@ -196,26 +220,13 @@ pub struct TopoSortResult<NodeId> {
     pub failed: Vec<NodeId>,
 }
 
-struct GraphNode<NodeId> {
-    count_of_predecessors: usize,
-    successors: Vec<NodeId>,
-}
-
-// TODO(https://github.com/rust-lang/rust/issues/26925): It should be possible to
-// `#[derive(Default)]` here, but `derive` insists that `NodeId` has to
-// implement `Default` even though the default vector doesn't contain any
-// `NodeId`s.
-impl<NodeId> Default for GraphNode<NodeId> {
-    fn default() -> Self {
-        Self { count_of_predecessors: 0, successors: Vec::new() }
-    }
-}
-
 struct HeapNode<'a, NodeId, CmpFn>
 where
     CmpFn: Fn(&NodeId, &NodeId) -> Ordering,
 {
-    id: NodeId,
+    /// Index of the node in the `ids` vector of `toposort`.
+    index: usize,
+    ids: &'a [NodeId],
     cmp_fn: &'a CmpFn,
 }
 
@@ -228,7 +239,7 @@ where
         // "removes the greatest item from the binary heap" and therefore to pop items
         // in the `cmp_fn`-described preferred order we need to call `reverse()`
         // below.
-        (self.cmp_fn)(&self.id, &other.id).reverse()
+        (self.cmp_fn)(&self.ids[self.index], &other.ids[other.index]).reverse()
     }
 }
 
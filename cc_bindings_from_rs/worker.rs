@@ -0,0 +1,143 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! Support for running `cc_bindings_from_rs` as a Bazel persistent worker.
+//!
+//! Bazel launches a persistent worker once and then feeds it one action per
+//! `WorkRequest`, written to the worker's stdin as newline-delimited JSON.
+//! The worker answers each request with a `WorkResponse` on stdout.  Keeping
+//! the process alive across actions amortizes process startup and lets
+//! process-level caches (e.g. the incremental session behind
+//! `--incremental-dir`) persist across actions.  See
+//! https://bazel.build/remote/persistent for the protocol definition.
+
+use anyhow::{Context, Result};
+use serde::{Deserialize, Serialize};
+use std::io::{BufRead, Write};
+
+/// The flag Bazel appends to the cmdline when launching the tool as a
+/// persistent worker (this spelling - with an underscore - is fixed by Bazel).
+pub const PERSISTENT_WORKER_FLAG: &str = "--persistent_worker";
+
+/// One action, as sent by Bazel.  Fields we don't consult (e.g. `inputs` with
+/// their digests) are ignored by design - `serde` skips unknown fields.
+#[derive(Debug, Default, Deserialize)]
+#[serde(rename_all = "camelCase", default)]
+struct WorkRequest {
+    arguments: Vec<String>,
+    request_id: i32,
+}
+
+#[derive(Debug, Serialize)]
+#[serde(rename_all = "camelCase")]
+struct WorkResponse {
+    exit_code: i32,
+    output: String,
+    request_id: i32,
+}
+
+/// Runs the persistent-worker loop: parses `WorkRequest`s from `input`,
+/// invokes `run_one` on the arguments of each request (prefixed with
+/// `exe_name`, mirroring `argv[0]` of a one-shot invocation), and writes a
+/// `WorkResponse` to `output` as each action finishes.  An action failure is
+/// reported in the corresponding response; only protocol-level problems (e.g.
+/// a malformed request) abort the loop.  Returns cleanly when `input` reaches
+/// EOF, which is how Bazel asks a worker to shut down.
+pub fn run_worker_loop(
+    exe_name: &str,
+    input: impl BufRead,
+    mut output: impl Write,
+    mut run_one: impl FnMut(&[String]) -> Result<()>,
+) -> Result<()> {
+    for request in serde_json::Deserializer::from_reader(input).into_iter::<WorkRequest>() {
+        let request = request.context("Failed to parse a WorkRequest")?;
+        let mut args = Vec::with_capacity(request.arguments.len() + 1);
+        args.push(exe_name.to_string());
+        args.extend(request.arguments);
+        let response = match run_one(&args) {
+            Ok(()) => WorkResponse {
+                exit_code: 0,
+                output: String::new(),
+                request_id: request.request_id,
+            },
+            Err(err) => WorkResponse {
+                exit_code: 1,
+                output: format!("{err:#}"),
+                request_id: request.request_id,
+            },
+        };
+        serde_json::to_writer(&mut output, &response)
+            .context("Failed to serialize a WorkResponse")?;
+        output.write_all(b"\n")?;
+        // Bazel considers the action done when it reads the response, so the
+        // response must not linger in a buffer.
+        output.flush()?;
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_worker_loop_runs_each_request_and_reports_failures() {
+        let requests = concat!(
+            r#"{"arguments": ["--foo"], "requestId": 7}"#,
+            "\n",
+            r#"{"arguments": ["--bar"]}"#,
+            "\n",
+        );
+        let mut seen: Vec<Vec<String>> = vec![];
+        let mut responses = Vec::<u8>::new();
+        run_worker_loop("worker_exe", requests.as_bytes(), &mut responses, |args| {
+            seen.push(args.to_vec());
+            if args.iter().any(|arg| arg == "--bar") {
+                anyhow::bail!("no bar support")
+            }
+            Ok(())
+        })
+        .unwrap();
+
+        assert_eq!(
+            seen,
+            vec![
+                vec!["worker_exe".to_string(), "--foo".to_string()],
+                vec!["worker_exe".to_string(), "--bar".to_string()],
+            ],
+        );
+        let responses = String::from_utf8(responses).unwrap();
+        assert_eq!(
+            responses,
+            concat!(
+                r#"{"exitCode":0,"output":"","requestId":7}"#,
+                "\n",
+                r#"{"exitCode":1,"output":"no bar support","requestId":0}"#,
+                "\n",
+            ),
+        );
+    }
+
+    #[test]
+    fn test_worker_loop_empty_input_shuts_down_cleanly() {
+        let mut responses = Vec::<u8>::new();
+        run_worker_loop("worker_exe", "".as_bytes(), &mut responses, |_args| {
+            panic!("`run_one` shouldn't be invoked without a request")
+        })
+        .unwrap();
+        assert!(responses.is_empty());
+    }
+
+    #[test]
+    fn test_worker_loop_malformed_request_aborts() {
+        let mut responses = Vec::<u8>::new();
+        let err =
+            run_worker_loop("worker_exe", "this is not json\n".as_bytes(), &mut responses, |_| {
+                Ok(())
+            })
+            .expect_err("A malformed request should abort the loop");
+        let msg = format!("{err:#}");
+        assert!(msg.contains("Failed to parse a WorkRequest"), "msg = {msg}");
+    }
+}
@@ -0,0 +1,32 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "common/cfg_cache.h"
+
+#include <memory>
+#include <utility>
+
+#include "clang/AST/Decl.h"
+#include "clang/Analysis/FlowSensitive/ControlFlowContext.h"
+#include "llvm/Support/Error.h"
+
+namespace crubit {
+
+llvm::Expected<const clang::dataflow::ControlFlowContext*>
+FunctionCfgCache::Get(const clang::FunctionDecl* func) {
+  const clang::FunctionDecl* key = func->getCanonicalDecl();
+  if (auto iter = cache_.find(key); iter != cache_.end()) {
+    return iter->second.get();
+  }
+  llvm::Expected<clang::dataflow::ControlFlowContext> cfctx =
+      clang::dataflow::ControlFlowContext::build(func, *func->getBody(),
+                                                 func->getASTContext());
+  if (!cfctx) return cfctx.takeError();
+  auto [iter, inserted] = cache_.try_emplace(
+      key, std::make_unique<clang::dataflow::ControlFlowContext>(
+               std::move(*cfctx)));
+  return iter->second.get();
+}
+
+}  // namespace crubit
@@ -0,0 +1,52 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_COMMON_CFG_CACHE_H_
+#define CRUBIT_COMMON_CFG_CACHE_H_
+
+#include <memory>
+
+#include "clang/AST/Decl.h"
+#include "clang/Analysis/FlowSensitive/ControlFlowContext.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/Error.h"
+
+namespace crubit {
+
+// Caches the `ControlFlowContext` (CFG plus associated indices) that the
+// clang dataflow framework needs, one per function.
+//
+// Building a CFG is a fixed per-function cost, and the dataflow clients in
+// this repository pay it repeatedly for the same function: the lifetime
+// analysis re-runs a function once per fixpoint iteration of a recursive
+// cycle and again when virtual methods are revisited during the overrides
+// traversal. Keying the built context by canonical declaration makes every
+// re-analysis after the first start at the transfer functions.
+//
+// The cache holds `CFG`s that point into the AST, so it must not outlive the
+// `ASTContext` the analyzed functions belong to; scope it to one analysis
+// session over one context.
+class FunctionCfgCache {
+ public:
+  FunctionCfgCache() = default;
+
+  FunctionCfgCache(const FunctionCfgCache&) = delete;
+  FunctionCfgCache& operator=(const FunctionCfgCache&) = delete;
+
+  // Returns the control-flow context for `func`, building it on first use.
+  // `func` must have a body. The returned pointer remains valid for the
+  // lifetime of the cache. Build failures are not cached and are reported
+  // anew on every call.
+  llvm::Expected<const clang::dataflow::ControlFlowContext*> Get(
+      const clang::FunctionDecl* func);
+
+ private:
+  llvm::DenseMap<const clang::FunctionDecl*,
+                 std::unique_ptr<clang::dataflow::ControlFlowContext>>
+      cache_;
+};
+
+}  // namespace crubit
+
+#endif  // CRUBIT_COMMON_CFG_CACHE_H_
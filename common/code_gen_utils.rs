@@ -7,8 +7,10 @@ use itertools::Itertools;
 use once_cell::sync::Lazy;
 use proc_macro2::{Ident, TokenStream};
 use quote::{format_ident, quote, ToTokens};
-use std::collections::{BTreeSet, HashSet};
+use std::cell::RefCell;
+use std::collections::{BTreeSet, HashMap, HashSet};
 use std::rc::Rc;
+use std::sync::Mutex;
 
 /// Formats a C++ identifier. Returns an error when `ident` is a C++ reserved
 /// keyword or is an invalid identifier.
@@ -34,7 +36,26 @@ pub fn format_cc_ident(ident: &str) -> Result<TokenStream> {
 
 /// Makes an 'Ident' to be used in the Rust source code. Escapes Rust keywords.
 /// Panics if `ident` is empty or is otherwise an invalid identifier.
+///
+/// The result is interned per thread: names repeat enormously across a target
+/// (field names, method names, primitive types), and validating a candidate
+/// identifier means running it through `syn`'s parser, so repeat occurrences
+/// are served from a map lookup instead.
 pub fn make_rs_ident(ident: &str) -> Ident {
+    thread_local! {
+        static CACHE: RefCell<HashMap<String, Ident>> = RefCell::new(HashMap::new());
+    }
+    CACHE.with(|cache| {
+        if let Some(cached) = cache.borrow().get(ident) {
+            return cached.clone();
+        }
+        let made = make_rs_ident_uncached(ident);
+        cache.borrow_mut().insert(ident.to_string(), made.clone());
+        made
+    })
+}
+
+fn make_rs_ident_uncached(ident: &str) -> Ident {
     // TODO(https://github.com/dtolnay/syn/pull/1098): Remove the hardcoded list once syn recognizes
     // 2018 and 2021 keywords.
     if ["async", "await", "try", "dyn"].contains(&ident) {
@@ -211,6 +232,123 @@ impl ToTokens for CcInclude {
     }
 }
 
+/// `CcIncludeSet` is a set of `CcInclude`s, represented as a bitset over a
+/// process-wide interning table of includes.  Code generation accumulates and
+/// merges include sets once per generated snippet, and the number of distinct
+/// includes in a binding is tiny compared to the number of snippets, so each
+/// include is interned once and afterwards set membership is a single bit:
+/// inserts and merges don't allocate or hash, and merging two sets is a
+/// word-level OR.  The set only needs to be resolved back into `CcInclude`s
+/// (via `to_btree_set`) once, when the final header is emitted.
+#[derive(Clone, Debug, Default, Eq, PartialEq)]
+pub struct CcIncludeSet {
+    /// The i-th bit says whether the include with the interned index i (see
+    /// `IncludeInterner::table`) is an element of the set.
+    words: Vec<u64>,
+}
+
+impl CcIncludeSet {
+    pub fn insert(&mut self, include: CcInclude) {
+        let index = INCLUDE_INTERNER.lock().unwrap().intern(include);
+        let word_index = index / 64;
+        if self.words.len() <= word_index {
+            self.words.resize(word_index + 1, 0);
+        }
+        self.words[word_index] |= 1 << (index % 64);
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.words.iter().all(|&word| word == 0)
+    }
+
+    /// Resolves the set back into `CcInclude`s, sorted by `CcInclude`'s `Ord`
+    /// (system headers before user headers - the order that
+    /// `format_cc_includes` expects).
+    pub fn to_btree_set(&self) -> BTreeSet<CcInclude> {
+        let interner = INCLUDE_INTERNER.lock().unwrap();
+        let mut result = BTreeSet::new();
+        for (word_index, &word) in self.words.iter().enumerate() {
+            let mut word = word;
+            while word != 0 {
+                let bit = word.trailing_zeros() as usize;
+                word &= word - 1; // Clears the lowest set bit.
+                result.insert(interner.resolve(word_index * 64 + bit));
+            }
+        }
+        result
+    }
+}
+
+impl std::ops::BitOrAssign for CcIncludeSet {
+    fn bitor_assign(&mut self, rhs: Self) {
+        if self.words.len() < rhs.words.len() {
+            self.words.resize(rhs.words.len(), 0);
+        }
+        for (lhs_word, rhs_word) in self.words.iter_mut().zip(rhs.words.into_iter()) {
+            *lhs_word |= rhs_word;
+        }
+    }
+}
+
+impl FromIterator<CcInclude> for CcIncludeSet {
+    fn from_iter<T: IntoIterator<Item = CcInclude>>(iter: T) -> Self {
+        let mut set = Self::default();
+        for include in iter.into_iter() {
+            set.insert(include);
+        }
+        set
+    }
+}
+
+/// The interning table behind `CcIncludeSet`.  `CcInclude::UserHeader` holds
+/// an `Rc<str>` which is not `Send`, so the table stores a `Send`-safe
+/// equivalent of each include and reconstitutes `CcInclude`s in `resolve`.
+#[derive(Default)]
+struct IncludeInterner {
+    system_lookup: HashMap<&'static str, usize>,
+    user_lookup: HashMap<Box<str>, usize>,
+    table: Vec<InternedInclude>,
+}
+
+enum InternedInclude {
+    System(&'static str),
+    User(Box<str>),
+}
+
+impl IncludeInterner {
+    fn intern(&mut self, include: CcInclude) -> usize {
+        let next_index = self.table.len();
+        match include {
+            CcInclude::SystemHeader(path) => match self.system_lookup.entry(path) {
+                std::collections::hash_map::Entry::Occupied(entry) => *entry.get(),
+                std::collections::hash_map::Entry::Vacant(entry) => {
+                    entry.insert(next_index);
+                    self.table.push(InternedInclude::System(path));
+                    next_index
+                }
+            },
+            CcInclude::UserHeader(path) => match self.user_lookup.get(&*path) {
+                Some(&index) => index,
+                None => {
+                    self.user_lookup.insert(Box::from(&*path), next_index);
+                    self.table.push(InternedInclude::User(Box::from(&*path)));
+                    next_index
+                }
+            },
+        }
+    }
+
+    fn resolve(&self, index: usize) -> CcInclude {
+        match &self.table[index] {
+            InternedInclude::System(path) => CcInclude::SystemHeader(path),
+            InternedInclude::User(path) => CcInclude::UserHeader(Rc::from(&**path)),
+        }
+    }
+}
+
+static INCLUDE_INTERNER: Lazy<Mutex<IncludeInterner>> =
+    Lazy::new(|| Mutex::new(IncludeInterner::default()));
+
 /// Formats a set of `CcInclude`s, trying to follow the guidance from
 /// [the Google C++ Style Guide](https://google.github.io/styleguide/cppguide.html#Names_and_Order_of_Includes).
 pub fn format_cc_includes(set_of_includes: &BTreeSet<CcInclude>) -> TokenStream {
@@ -441,6 +579,14 @@ pub mod tests {
         assert_rs_matches!(quote! { #id }, quote! { r#impl });
     }
 
+    #[test]
+    fn test_make_rs_ident_interned() {
+        // Repeated calls hit the per-thread cache and must agree with the
+        // first, escaping included.
+        assert_eq!(make_rs_ident("impl"), make_rs_ident("impl"));
+        assert_eq!(make_rs_ident("foo"), make_rs_ident("foo"));
+    }
+
     #[test]
     #[should_panic]
     fn test_make_rs_ident_unfinished_group() {
@@ -489,6 +635,30 @@ pub mod tests {
         assert!(a < b);
     }
 
+    #[test]
+    fn test_cc_include_set_insert_and_merge() {
+        let mut set1 = CcIncludeSet::default();
+        assert!(set1.is_empty());
+        set1.insert(CcInclude::cstddef());
+        set1.insert(CcInclude::user_header("a.h".into()));
+        assert!(!set1.is_empty());
+
+        let mut set2 = CcIncludeSet::default();
+        set2.insert(CcInclude::cstddef()); // Duplicated in `set1`.
+        set2.insert(CcInclude::memory());
+
+        set1 |= set2;
+        let resolved = set1.to_btree_set();
+        assert_eq!(
+            resolved.into_iter().collect_vec(),
+            vec![
+                CcInclude::cstddef(),
+                CcInclude::memory(),
+                CcInclude::user_header("a.h".into()),
+            ],
+        );
+    }
+
     #[test]
     fn test_format_cc_includes() {
         let includes = [
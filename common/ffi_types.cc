@@ -4,10 +4,41 @@
 
 #include "common/ffi_types.h"
 
+#include <cstddef>
+#include <string>
+#include <vector>
+
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 
 namespace crubit {
 
+PackedFfiU8SliceTable::PackedFfiU8SliceTable(
+    absl::Span<const std::string> strings) {
+  size_t total_size = 0;
+  for (const std::string& s : strings) {
+    total_size += s.size();
+  }
+  buffer_.reserve(total_size);
+  ends_.reserve(strings.size());
+  for (const std::string& s : strings) {
+    buffer_.append(s);
+    ends_.push_back(buffer_.size());
+  }
+}
+
+std::vector<std::string> ConsumeFfiU8SliceTableBox(FfiU8SliceTableBox table) {
+  std::vector<std::string> result;
+  result.reserve(table.size);
+  size_t start = 0;
+  for (size_t i = 0; i < table.size; ++i) {
+    result.emplace_back(table.buffer + start, table.ends[i] - start);
+    start = table.ends[i];
+  }
+  FreeFfiU8SliceTableBox(table);
+  return result;
+}
+
 FfiU8Slice MakeFfiU8Slice(absl::string_view s) {
   FfiU8Slice result;
   result.ptr = s.data();
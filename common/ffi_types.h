@@ -6,8 +6,11 @@
 #define CRUBIT_COMMON_FFI_TYPES_H_
 
 #include <cstddef>
+#include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 
 namespace crubit {
 
@@ -24,6 +27,48 @@ struct FfiU8Slice {
   size_t size;
 };
 
+// Borrowed table of byte strings: `buffer` holds the entries concatenated,
+// and `ends[i]` is the offset one past the end of entry `i` (so entry `i`
+// spans `[ends[i - 1], ends[i])`, with `ends[-1]` taken as 0). A table of N
+// strings crosses the FFI boundary as one buffer and one offset array
+// instead of N separate slices.
+struct FfiU8SliceTable {
+  const char* buffer;
+  const size_t* ends;
+  size_t size;
+};
+
+// Owned, Rust-allocated variant of `FfiU8SliceTable`. Call
+// `FreeFfiU8SliceTableBox` to deallocate.
+struct FfiU8SliceTableBox {
+  const char* buffer;
+  const size_t* ends;
+  size_t size;
+};
+
+// Frees the memory associated with an `FfiU8SliceTableBox`.
+// Implemented in Rust.
+extern "C" void FreeFfiU8SliceTableBox(FfiU8SliceTableBox);
+
+// Packs `strings` into the single-buffer representation of
+// `FfiU8SliceTable`. The table returned by `table()` borrows from this
+// object and is valid for its lifetime.
+class PackedFfiU8SliceTable {
+ public:
+  explicit PackedFfiU8SliceTable(absl::Span<const std::string> strings);
+
+  FfiU8SliceTable table() const {
+    return FfiU8SliceTable{buffer_.data(), ends_.data(), ends_.size()};
+  }
+
+ private:
+  std::string buffer_;
+  std::vector<size_t> ends_;
+};
+
+// Copies the entries of `table` into a vector of strings and frees `table`.
+std::vector<std::string> ConsumeFfiU8SliceTableBox(FfiU8SliceTableBox table);
+
 // Returns an `FfiU8Slice` referencing the same data as `s`.
 FfiU8Slice MakeFfiU8Slice(absl::string_view s);
 
@@ -39,6 +84,51 @@ extern "C" FfiU8SliceBox AllocFfiU8SliceBox(FfiU8Slice ffi_u8_slice);
 // Implemented in Rust.
 extern "C" void FreeFfiU8SliceBox(FfiU8SliceBox);
 
+// Owns the Rust-allocated buffer of an `FfiU8SliceBox` and frees it via
+// `FreeFfiU8SliceBox` on destruction.  This lets C++ code adopt bytes that
+// were produced in Rust without copying them into a `std::string` first.
+// Move-only.
+class ScopedFfiU8SliceBox {
+ public:
+  ScopedFfiU8SliceBox() : box_{nullptr, 0} {}
+  explicit ScopedFfiU8SliceBox(FfiU8SliceBox box) : box_(box) {}
+  ScopedFfiU8SliceBox(const ScopedFfiU8SliceBox&) = delete;
+  ScopedFfiU8SliceBox& operator=(const ScopedFfiU8SliceBox&) = delete;
+  ScopedFfiU8SliceBox(ScopedFfiU8SliceBox&& other) noexcept
+      : box_(other.Release()) {}
+  ScopedFfiU8SliceBox& operator=(ScopedFfiU8SliceBox&& other) noexcept {
+    if (this != &other) {
+      Free();
+      box_ = other.Release();
+    }
+    return *this;
+  }
+  ~ScopedFfiU8SliceBox() { Free(); }
+
+  // Returns a view of the owned bytes.  Valid until this object is destroyed,
+  // moved from, or `Release`d.
+  absl::string_view value() const {
+    return absl::string_view(box_.ptr, box_.size);
+  }
+
+  // Relinquishes ownership of the underlying buffer and returns it.  The
+  // caller becomes responsible for calling `FreeFfiU8SliceBox`.
+  FfiU8SliceBox Release() {
+    FfiU8SliceBox result = box_;
+    box_ = {nullptr, 0};
+    return result;
+  }
+
+ private:
+  void Free() {
+    if (box_.ptr != nullptr) {
+      FreeFfiU8SliceBox(Release());
+    }
+  }
+
+  FfiU8SliceBox box_;
+};
+
 }  // namespace crubit
 
 #endif  // CRUBIT_COMMON_FFI_TYPES_H_
@@ -69,6 +69,115 @@ impl FfiU8Slice {
     }
 }
 
+/// Borrowed table of byte strings: `buffer` holds the entries concatenated,
+/// and `ends[i]` is the offset one past the end of entry `i`. A table of N
+/// strings crosses the FFI boundary as one buffer and one offset array
+/// instead of N separate slices.
+#[repr(C)]
+pub struct FfiU8SliceTable {
+    buffer: *const u8,
+    ends: *const usize,
+    size: usize,
+}
+
+impl FfiU8SliceTable {
+    /// Borrows the entries of this table as a vector of slices.
+    pub fn as_slices(&self) -> Vec<&[u8]> {
+        if self.size == 0 {
+            return Vec::new();
+        }
+        // Safety:
+        // Instances of `FfiU8SliceTable` are only created by FFI functions, which are
+        // unsafe themselves so it's their responsibility to maintain safety.
+        let ends = unsafe { slice::from_raw_parts(self.ends, self.size) };
+        let buffer = unsafe { slice::from_raw_parts(self.buffer, *ends.last().unwrap()) };
+        let mut result = Vec::with_capacity(self.size);
+        let mut start = 0;
+        for &end in ends {
+            result.push(&buffer[start..end]);
+            start = end;
+        }
+        result
+    }
+}
+
+/// Owned, Rust-allocated variant of `FfiU8SliceTable`. Must be freed by
+/// calling `FreeFfiU8SliceTableBox()` (or consumed by `into_strings`).
+#[repr(C)]
+pub struct FfiU8SliceTableBox {
+    buffer: *const u8,
+    ends: *const usize,
+    size: usize,
+}
+
+impl FfiU8SliceTableBox {
+    /// Packs `items` into a table: one buffer allocation and one offset
+    /// array, regardless of how many strings are passed.
+    pub fn from_strings<I: IntoIterator<Item = String>>(items: I) -> FfiU8SliceTableBox {
+        let mut buffer = Vec::<u8>::new();
+        let mut ends = Vec::<usize>::new();
+        for item in items {
+            buffer.extend_from_slice(item.as_bytes());
+            ends.push(buffer.len());
+        }
+        let size = ends.len();
+        let buffer = Box::leak(buffer.into_boxed_slice());
+        let ends = Box::leak(ends.into_boxed_slice());
+        FfiU8SliceTableBox { buffer: buffer.as_ptr(), ends: ends.as_ptr(), size }
+    }
+
+    /// Returns a borrowed view of this table.
+    pub fn as_table(&self) -> FfiU8SliceTable {
+        FfiU8SliceTable { buffer: self.buffer, ends: self.ends, size: self.size }
+    }
+
+    /// Consumes self, freeing the table and returning its entries as owned
+    /// strings.
+    pub fn into_strings(self) -> Vec<String> {
+        let result = self
+            .as_table()
+            .as_slices()
+            .into_iter()
+            .map(|s| String::from_utf8(s.to_vec()).unwrap())
+            .collect();
+        // Safety: pointers were created by `from_strings` via `Box::leak` (or
+        // by an FFI function with the same contract).
+        unsafe { free_table(&self) };
+        result
+    }
+}
+
+/// Reclaims the boxed slices behind `table`.
+///
+/// # Safety
+///
+/// `table` must have been created by `FfiU8SliceTableBox::from_strings` (on
+/// either side of the FFI boundary) and not freed yet.
+unsafe fn free_table(table: &FfiU8SliceTableBox) {
+    if table.size == 0 {
+        return;
+    }
+    let ends = Box::from_raw(slice::from_raw_parts_mut(table.ends as *mut usize, table.size));
+    let total = *ends.last().unwrap();
+    let _ = Box::from_raw(slice::from_raw_parts_mut(table.buffer as *mut u8, total));
+}
+
+/// Frees an `FfiU8SliceTableBox` allocated by Rust.
+///
+/// # Safety
+///
+/// Expectations:
+///    * function expects that param `table` is a valid FfiU8SliceTableBox
+///      that has been allocated earlier on the Rust side.
+///    * function expects that there are no remaining references to the table.
+///
+/// Ownership:
+///    * function takes ownership of the param `table` and frees its memory.
+#[no_mangle]
+pub unsafe extern "C" fn FreeFfiU8SliceTableBox(table: FfiU8SliceTableBox) {
+    catch_unwind(|| unsafe { free_table(&table) }).unwrap_or_else(|_| process::abort())
+}
+
 #[repr(C)]
 pub struct FfiU8SliceBox {
     ptr: *const u8,
@@ -101,4 +210,22 @@ mod tests {
         let ffi_slice = FfiU8SliceBox::from_boxed_slice(slice.clone());
         assert_eq!(ffi_slice.into_boxed_slice(), slice);
     }
+
+    #[test]
+    fn test_slice_table_roundtrip() {
+        let strings = vec!["hello".to_string(), "".to_string(), "world".to_string()];
+        let table = FfiU8SliceTableBox::from_strings(strings.clone());
+        assert_eq!(
+            table.as_table().as_slices(),
+            vec![&b"hello"[..], &b""[..], &b"world"[..]]
+        );
+        assert_eq!(table.into_strings(), strings);
+    }
+
+    #[test]
+    fn test_empty_slice_table() {
+        let table = FfiU8SliceTableBox::from_strings(vec![]);
+        assert!(table.as_table().as_slices().is_empty());
+        assert!(table.into_strings().is_empty());
+    }
 }
@@ -4,11 +4,33 @@
 
 #include "common/file_io.h"
 
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace crubit {
 
+absl::StatusOr<std::unique_ptr<llvm::MemoryBuffer>> GetFileBuffer(
+    absl::string_view path) {
+  // Not requiring a null terminator lets `MemoryBuffer` mmap the file
+  // regardless of how its size relates to the page size.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> err_or_buffer =
+      llvm::MemoryBuffer::getFileOrSTDIN(path.data(), /* IsText= */ true,
+                                         /* RequiresNullTerminator= */ false);
+  if (std::error_code err = err_or_buffer.getError()) {
+    return absl::Status(absl::StatusCode::kInternal, err.message());
+  }
+  return std::move(*err_or_buffer);
+}
+
 absl::StatusOr<std::string> GetFileContents(absl::string_view path) {
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> err_or_buffer =
       llvm::MemoryBuffer::getFileOrSTDIN(path.data(), /* IsText= */ true);
@@ -34,4 +56,55 @@ absl::Status SetFileContents(absl::string_view path,
   return absl::OkStatus();
 }
 
+absl::Status SetFileContentsAtomically(absl::string_view path,
+                                       absl::string_view contents) {
+  llvm::StringRef path_ref(path.data(), path.size());
+  llvm::SmallString<128> temp_path;
+  if (std::error_code error_code = llvm::sys::fs::createUniqueFile(
+          llvm::Twine(path_ref) + ".tmp.%%%%%%", temp_path)) {
+    return absl::Status(absl::StatusCode::kInternal, error_code.message());
+  }
+  absl::Status status = SetFileContents(
+      absl::string_view(temp_path.data(), temp_path.size()), contents);
+  if (status.ok()) {
+    if (std::error_code error_code = llvm::sys::fs::rename(temp_path,
+                                                           path_ref)) {
+      status = absl::Status(absl::StatusCode::kInternal, error_code.message());
+    }
+  }
+  if (!status.ok()) {
+    llvm::sys::fs::remove(temp_path);
+  }
+  return status;
+}
+
+AsyncFileWriter::~AsyncFileWriter() { Join().IgnoreError(); }
+
+void AsyncFileWriter::Write(std::string path, absl::string_view contents) {
+  threads_.push_back(std::thread([this, path = std::move(path), contents] {
+    absl::Status status = SetFileContentsAtomically(path, contents);
+    if (!status.ok()) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (first_error_.ok()) first_error_ = std::move(status);
+    }
+  }));
+}
+
+absl::Status AsyncFileWriter::Join() {
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::exchange(first_error_, absl::OkStatus());
+}
+
+absl::Status SetAllFileContents(absl::Span<const FileToWrite> files) {
+  AsyncFileWriter writer;
+  for (const FileToWrite& file : files) {
+    writer.Write(file.path, file.contents);
+  }
+  return writer.Join();
+}
+
 }  // namespace crubit
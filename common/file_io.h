@@ -5,17 +5,77 @@
 #ifndef CRUBIT_COMMON_FILE_IO_H_
 #define CRUBIT_COMMON_FILE_IO_H_
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 namespace crubit {
 
+// Returns the contents of the file at `path` as a (possibly memory-mapped)
+// buffer. Prefer this over `GetFileContents` when the contents are only
+// scanned, not mutated or stored: the data stays in the kernel page cache
+// instead of being duplicated into a heap string.
+absl::StatusOr<std::unique_ptr<llvm::MemoryBuffer>> GetFileBuffer(
+    absl::string_view path);
+
+// Returns a view of the contents of `buffer`.
+inline absl::string_view BufferContents(const llvm::MemoryBuffer& buffer) {
+  return absl::string_view(buffer.getBufferStart(), buffer.getBufferSize());
+}
+
 absl::StatusOr<std::string> GetFileContents(absl::string_view path);
 
 absl::Status SetFileContents(absl::string_view path,
                              absl::string_view contents);
 
+// Writes `contents` to a temporary file next to `path` and renames it into
+// place, so a crash mid-write never leaves a truncated file at `path`.
+absl::Status SetFileContentsAtomically(absl::string_view path,
+                                       absl::string_view contents);
+
+// A (path, contents) pair for the batch-write APIs below. `contents` is a
+// view; the referenced data must stay alive until the write completes.
+struct FileToWrite {
+  std::string path;
+  absl::string_view contents;
+};
+
+// Atomically writes every file in `files` concurrently; returns the first
+// error, if any.
+absl::Status SetAllFileContents(absl::Span<const FileToWrite> files);
+
+// Writes files on background threads so output I/O overlaps the caller's
+// remaining work. Every write is atomic in the sense of
+// `SetFileContentsAtomically`.
+class AsyncFileWriter {
+ public:
+  AsyncFileWriter() = default;
+  AsyncFileWriter(const AsyncFileWriter&) = delete;
+  AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+  // Joins any writes that are still outstanding, discarding their status.
+  ~AsyncFileWriter();
+
+  // Queues a write of `contents` to `path`. `contents` is not copied: the
+  // referenced data must stay alive until `Join` returns.
+  void Write(std::string path, absl::string_view contents);
+
+  // Blocks until every queued write has finished and returns the first
+  // error, if any. The writer is empty afterwards and can be reused.
+  absl::Status Join();
+
+ private:
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  absl::Status first_error_;  // Guarded by `mutex_`.
+};
+
 }  // namespace crubit
 
 #endif  // CRUBIT_COMMON_FILE_IO_H_
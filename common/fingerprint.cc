@@ -0,0 +1,31 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "common/fingerprint.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Endian.h"
+
+namespace crubit {
+
+Fingerprint& Fingerprint::Update(absl::string_view bytes) {
+  char size_prefix[sizeof(uint64_t)];
+  llvm::support::endian::write64le(size_prefix, bytes.size());
+  hasher_.update(llvm::StringRef(size_prefix, sizeof(size_prefix)));
+  hasher_.update(llvm::StringRef(bytes.data(), bytes.size()));
+  return *this;
+}
+
+std::string Fingerprint::HexDigest() && {
+  std::array<uint8_t, 32> digest = hasher_.final();
+  return llvm::toHex(llvm::ArrayRef<uint8_t>(digest), /*LowerCase=*/true);
+}
+
+}  // namespace crubit
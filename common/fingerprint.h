@@ -0,0 +1,40 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_COMMON_FINGERPRINT_H_
+#define CRUBIT_COMMON_FINGERPRINT_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "llvm/Support/SHA256.h"
+
+namespace crubit {
+
+// Computes a stable fingerprint over an ordered sequence of byte strings.
+//
+// This is used to key caches on tool inputs (header contents, clang
+// arguments, generated text) so that byte-identical inputs map to the same
+// cache entry across processes and machines.  Each `Update` is
+// length-delimited internally, so `Update("ab").Update("c")` and
+// `Update("a").Update("bc")` produce different digests.
+class Fingerprint {
+ public:
+  Fingerprint() = default;
+
+  // Mixes `bytes` into the fingerprint.  Returns `*this` so updates can be
+  // chained.
+  Fingerprint& Update(absl::string_view bytes);
+
+  // Returns the digest of everything passed to `Update` so far as a
+  // 64-character lowercase hex string.  May be called at most once.
+  std::string HexDigest() &&;
+
+ private:
+  llvm::SHA256 hasher_;
+};
+
+}  // namespace crubit
+
+#endif  // CRUBIT_COMMON_FINGERPRINT_H_
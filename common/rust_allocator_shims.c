@@ -2,38 +2,100 @@
 // Exceptions. See /LICENSE for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdlib.h>
 
 // Our temporary, local solution to
 //     https://github.com/rust-lang/rust/issues/73632.
+//
+// Since every Rust-side allocation in a mixed binary already funnels through
+// these shims, they double as the process's Rust allocation statistics:
+// relaxed atomic counters updated on every (de)allocation, queryable through
+// the crubit_rust_* getters below. common/timing.cc picks the getters up via
+// weak references and folds the numbers into the timing report, which lets us
+// attribute heap growth to pipeline phases without a malloc-interposing
+// allocator build.
 
 void *__rdl_alloc(size_t, size_t);
-void __rdl_dealloc(void *);
+void __rdl_dealloc(void *, size_t, size_t);
 void *__rdl_realloc(void *, size_t, size_t, size_t);
 void *__rdl_alloc_zeroed(size_t, size_t);
 
+static _Atomic size_t allocated_bytes;
+static _Atomic size_t allocation_count;
+static _Atomic size_t live_bytes;
+static _Atomic size_t peak_bytes;
+
+static void record_alloc(size_t size) {
+  atomic_fetch_add_explicit(&allocated_bytes, size, memory_order_relaxed);
+  atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+  size_t live =
+      atomic_fetch_add_explicit(&live_bytes, size, memory_order_relaxed) +
+      size;
+  size_t peak = atomic_load_explicit(&peak_bytes, memory_order_relaxed);
+  while (live > peak &&
+         !atomic_compare_exchange_weak_explicit(&peak_bytes, &peak, live,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) {
+  }
+}
+
+static void record_dealloc(size_t size) {
+  atomic_fetch_sub_explicit(&live_bytes, size, memory_order_relaxed);
+}
+
+size_t crubit_rust_allocated_bytes(void) {
+  return atomic_load_explicit(&allocated_bytes, memory_order_relaxed);
+}
+
+size_t crubit_rust_allocation_count(void) {
+  return atomic_load_explicit(&allocation_count, memory_order_relaxed);
+}
+
+size_t crubit_rust_live_bytes(void) {
+  return atomic_load_explicit(&live_bytes, memory_order_relaxed);
+}
+
+size_t crubit_rust_peak_bytes(void) {
+  return atomic_load_explicit(&peak_bytes, memory_order_relaxed);
+}
+
 // https://stdrs.dev/nightly/x86_64-unknown-linux-gnu/alloc/alloc/index.html
+//
+// rustc emits calls that pass (ptr, size, align) to __rust_dealloc, so the
+// shim declares the full signature; the size lets frees be subtracted from
+// the live-bytes counter.
 
 __attribute__((weak))
 void *__rust_alloc(size_t size, size_t align) {
-  return __rdl_alloc(size, align);
+  void *result = __rdl_alloc(size, align);
+  if (result != NULL) record_alloc(size);
+  return result;
 }
 
 __attribute__((weak))
-void __rust_dealloc(void *ptr) {
-  __rdl_dealloc(ptr);
+void __rust_dealloc(void *ptr, size_t size, size_t align) {
+  record_dealloc(size);
+  __rdl_dealloc(ptr, size, align);
 }
 
 __attribute__((weak))
 void *__rust_realloc(void *ptr, size_t old_size, size_t align,
     size_t new_size) {
-  return __rdl_realloc(ptr, old_size, align, new_size);
+  void *result = __rdl_realloc(ptr, old_size, align, new_size);
+  if (result != NULL) {
+    record_dealloc(old_size);
+    record_alloc(new_size);
+  }
+  return result;
 }
 
 __attribute__((weak))
 void *__rust_alloc_zeroed(size_t size, size_t align) {
-  return __rdl_alloc_zeroed(size, align);
+  void *result = __rdl_alloc_zeroed(size, align);
+  if (result != NULL) record_alloc(size);
+  return result;
 }
 
 __attribute__((weak))
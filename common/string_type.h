@@ -36,6 +36,7 @@
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/flags/marshalling.h"
+#include "absl/hash/hash.h"
 #include "absl/meta/type_traits.h"
 #include "absl/strings/string_view.h"
 
@@ -53,8 +54,34 @@
 #define CRUBIT_DEFINE_STRING_TYPE(string_type_name) \
   using string_type_name = ::crubit::StringType<class string_type_name##_tag_>;
 
+// Like CRUBIT_DEFINE_STRING_TYPE, but the StringType caches the hash of its
+// value at construction (at the cost of one extra word per instance). Opt in
+// for types that serve as hash-map keys on hot paths, so each value is hashed
+// when it is built rather than on every map probe.
+#define CRUBIT_DEFINE_STRING_TYPE_WITH_CACHED_HASH(string_type_name)       \
+  using string_type_name =                                                 \
+      ::crubit::StringType<class string_type_name##_tag_, /*kCacheHash=*/  \
+                           true>;
+
 namespace crubit {
 
+namespace string_type_internal {
+
+// Storage for the optional cached hash; the primary template is empty so
+// that types which do not opt in pay no size cost.
+template <bool kCacheHash>
+struct HashCache {
+  void Set(absl::string_view) {}
+};
+
+template <>
+struct HashCache<true> {
+  void Set(absl::string_view value) { hash = absl::HashOf(value); }
+  size_t hash = 0;
+};
+
+}  // namespace string_type_internal
+
 // StringType provides these operations:
 //   * relational operators (==, !=, <, <=, >, >=)
 //   * compare (future <=> operator)
@@ -62,11 +89,13 @@ namespace crubit {
 //   * streaming with operator<<
 //   * value(), which should return a string-like object (const string&,
 //     absl::string_view, ShortString<N>, etc.)
-template <typename Tag>
-class StringType {
+template <typename Tag, bool kCacheHash = false>
+class StringType : private string_type_internal::HashCache<kCacheHash> {
  public:
-  StringType() = default;
-  explicit StringType(std::string value) : s_(std::move(value)) {}
+  StringType() { this->Set(s_); }
+  explicit StringType(std::string value) : s_(std::move(value)) {
+    this->Set(s_);
+  }
 
   const std::string& value() const { return s_; }
 
@@ -100,7 +129,13 @@ class StringType {
 
   template <typename H>
   friend H AbslHashValue(H h, const StringType& s) {
-    return H::combine(std::move(h), s.value());
+    if constexpr (kCacheHash) {
+      return H::combine(
+          std::move(h),
+          static_cast<const string_type_internal::HashCache<true>&>(s).hash);
+    } else {
+      return H::combine(std::move(h), s.value());
+    }
   }
 
   friend std::ostream& operator<<(std::ostream& os, const StringType& s) {
@@ -114,15 +149,15 @@ class StringType {
 // Allows typed strings to be used as ABSL_FLAG values.
 //
 // This is equivalent in behavior to just using a raw std::string.
-template <typename Tag>
-bool AbslParseFlag(absl::string_view text, StringType<Tag>* out,
+template <typename Tag, bool kCacheHash>
+bool AbslParseFlag(absl::string_view text, StringType<Tag, kCacheHash>* out,
                    std::string* error) {
-  *out = StringType<Tag>(text);
+  *out = StringType<Tag, kCacheHash>(text);
   return true;
 }
 
-template <typename Tag>
-std::string AbslUnparseFlag(const StringType<Tag>& val) {
+template <typename Tag, bool kCacheHash>
+std::string AbslUnparseFlag(const StringType<Tag, kCacheHash>& val) {
   return absl::UnparseFlag(std::string(val.value()));
 }
 
@@ -61,6 +61,7 @@
 #ifndef CRUBIT_COMMON_STRONG_INT_H_
 #define CRUBIT_COMMON_STRONG_INT_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <iosfwd>
 #include <limits>
@@ -139,6 +140,48 @@ std::ostream &operator<<(std::ostream &os, StrongInt<TagType, uint8_t> arg) {
   return os << static_cast<unsigned int>(arg.value());
 }
 
+// Transparent hash / equality functors for hash containers keyed on a
+// StrongInt.
+//
+// `StrongIntValueHash` is an opt-in for StrongInt types whose raw values are
+// already well distributed — e.g. ids minted from pointers — where the
+// per-lookup cost of the seeded AbslHash pipeline is measurable: it hashes
+// with a single multiplication instead. (A pure identity hash would be
+// cheaper still, but pointer-derived values agree in their alignment bits,
+// and SwissTable control bytes come from just 7 bits of the hash, so one
+// multiplicative mix is required to avoid clustering.)
+//
+// Both functors are transparent, so containers parameterized with them can
+// be probed with the raw ValueType without constructing a StrongInt first.
+template <typename StrongIntType>
+struct StrongIntValueHash {
+  using is_transparent = void;
+
+  size_t operator()(StrongIntType id) const { return (*this)(id.value()); }
+  size_t operator()(typename StrongIntType::ValueType value) const {
+    // Fibonacci multiplier; spreads consecutive and aligned values across
+    // the whole output range.
+    return static_cast<size_t>(value) * size_t{0x9e3779b97f4a7c15};
+  }
+};
+
+template <typename StrongIntType>
+struct StrongIntValueEq {
+  using is_transparent = void;
+
+  bool operator()(StrongIntType lhs, StrongIntType rhs) const {
+    return lhs == rhs;
+  }
+  bool operator()(StrongIntType lhs,
+                  typename StrongIntType::ValueType rhs) const {
+    return lhs.value() == rhs;
+  }
+  bool operator()(typename StrongIntType::ValueType lhs,
+                  StrongIntType rhs) const {
+    return lhs == rhs.value();
+  }
+};
+
 // Define comparison operators.  We allow all comparison operators.
 #define CRUBIT_STRONG_INT_COMPARISON_OP(op)                       \
   template <typename TagType, typename ValueType>                 \
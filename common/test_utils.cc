@@ -4,26 +4,75 @@
 
 #include "common/test_utils.h"
 
+#include <cstdlib>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/synchronization/mutex.h"
 #include "common/file_io.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 
 namespace crubit {
+namespace {
+
+// The tmpfs-backed scratch root, when one was created; removed at process
+// exit, since nothing cleans /dev/shm up for us.
+const std::string* tmpfs_scratch_root = nullptr;
+
+void RemoveTmpfsScratchRoot() {
+  llvm::sys::fs::remove_directories(*tmpfs_scratch_root,
+                                    /*IgnoreErrors=*/true);
+}
+
+const std::string* CreateScratchRoot() {
+  std::string tmpfs_root = absl::StrCat(
+      "/dev/shm/crubit_test_scratch_", llvm::sys::Process::getProcessId());
+  if (!llvm::sys::fs::create_directories(tmpfs_root) &&
+      llvm::sys::fs::can_write(tmpfs_root)) {
+    tmpfs_scratch_root = new std::string(std::move(tmpfs_root));
+    std::atexit(RemoveTmpfsScratchRoot);
+    return tmpfs_scratch_root;
+  }
+  return new std::string(testing::TempDir());
+}
+
+// Returns the root under which per-test scratch directories live. Prefers a
+// tmpfs-backed, process-unique directory (/dev/shm on Linux) so that fixture
+// I/O runs at memory speed - the default test tmpdir may be disk-backed, and
+// then fixture setup dominates many small tests - falling back to the
+// default test tmpdir when tmpfs is unavailable. Chosen once per process.
+const std::string& TestScratchRoot() {
+  static const std::string* root = CreateScratchRoot();
+  return *root;
+}
+
+}  // namespace
 
 static std::string MakeTmpdirForCurrentTest() {
   absl::string_view current_test_name =
       testing::UnitTest::GetInstance()->current_test_info()->name();
-  std::string current_test_tmpdir_path =
-      absl::StrCat(testing::TempDir(), "/", current_test_name, "/");
-  llvm::StringRef parent_dir =
-      llvm::sys::path::parent_path(current_test_tmpdir_path);
-  CHECK(!llvm::sys::fs::create_directories(parent_dir));
-  return current_test_tmpdir_path;
+  // Per-test directories are pooled: repeated fixture writes within one test
+  // reuse the already-created directory instead of re-probing the filesystem.
+  static absl::Mutex mutex(absl::kConstInit);
+  static absl::flat_hash_map<std::string, std::string>* dirs =
+      new absl::flat_hash_map<std::string, std::string>();
+  absl::MutexLock lock(&mutex);
+  auto [it, inserted] = dirs->try_emplace(std::string(current_test_name));
+  if (inserted) {
+    std::string current_test_tmpdir_path =
+        absl::StrCat(TestScratchRoot(), "/", current_test_name, "/");
+    llvm::StringRef parent_dir =
+        llvm::sys::path::parent_path(current_test_tmpdir_path);
+    CHECK(!llvm::sys::fs::create_directories(parent_dir));
+    it->second = std::move(current_test_tmpdir_path);
+  }
+  return it->second;
 }
 
 std::string WriteFileForCurrentTest(absl::string_view filename,
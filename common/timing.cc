@@ -0,0 +1,202 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "common/timing.h"
+
+#include <time.h>
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/Support/JSON.h"
+
+// Defined in common/rust_allocator_shims.c. Declared weak so that binaries
+// which do not link the shims still report: the "rust_allocation" section is
+// then omitted and per-phase allocation deltas read 0.
+extern "C" {
+__attribute__((weak)) size_t crubit_rust_allocated_bytes(void);
+__attribute__((weak)) size_t crubit_rust_allocation_count(void);
+__attribute__((weak)) size_t crubit_rust_live_bytes(void);
+__attribute__((weak)) size_t crubit_rust_peak_bytes(void);
+}
+
+namespace crubit {
+
+namespace {
+
+bool RustAllocStatsLinked() { return crubit_rust_allocated_bytes != nullptr; }
+
+int64_t RustAllocatedBytesOrZero() {
+  return RustAllocStatsLinked()
+             ? static_cast<int64_t>(crubit_rust_allocated_bytes())
+             : 0;
+}
+
+struct PhaseStats {
+  int64_t calls = 0;
+  absl::Duration wall;
+  absl::Duration cpu;
+  int64_t rust_alloc_bytes = 0;
+};
+
+std::atomic<bool> collection_enabled{false};
+
+absl::Mutex& SamplesMutex() {
+  static absl::Mutex& mutex = *new absl::Mutex;
+  return mutex;
+}
+
+// Ordered maps so that the report (and its tests, if any) are deterministic
+// without a sort at emission time; both maps stay tiny.
+std::map<std::string, PhaseStats>& Phases() {
+  static auto& phases = *new std::map<std::string, PhaseStats>;
+  return phases;
+}
+
+std::map<std::string, int64_t>& Counters() {
+  static auto& counters = *new std::map<std::string, int64_t>;
+  return counters;
+}
+
+struct HistogramStats {
+  int64_t count = 0;
+  int64_t sum = 0;
+  int64_t max = 0;
+  // buckets[i] counts samples in (2^(i-1), 2^i]; buckets[0] counts samples
+  // <= 1 (including non-positive values, which are clamped).
+  std::array<int64_t, 64> buckets = {};
+};
+
+std::map<std::string, HistogramStats>& Histograms() {
+  static auto& histograms = *new std::map<std::string, HistogramStats>;
+  return histograms;
+}
+
+int BucketIndex(int64_t value) {
+  if (value <= 1) return 0;
+  // Index of the highest set bit of (value - 1), plus one: the smallest i
+  // with value <= 2^i.
+  int index = 0;
+  for (uint64_t v = static_cast<uint64_t>(value) - 1; v != 0; v >>= 1) {
+    ++index;
+  }
+  return index;
+}
+
+absl::Duration ThreadCpuTime() {
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+    return absl::ZeroDuration();
+  }
+  return absl::DurationFromTimespec(ts);
+}
+
+}  // namespace
+
+void EnableTimingCollection() {
+  collection_enabled.store(true, std::memory_order_relaxed);
+}
+
+bool IsTimingCollectionEnabled() {
+  return collection_enabled.load(std::memory_order_relaxed);
+}
+
+void RecordTimingSample(absl::string_view phase, absl::Duration wall,
+                        absl::Duration cpu, int64_t rust_alloc_bytes) {
+  if (!IsTimingCollectionEnabled()) return;
+  absl::MutexLock lock(&SamplesMutex());
+  PhaseStats& stats = Phases()[std::string(phase)];
+  ++stats.calls;
+  stats.wall += wall;
+  stats.cpu += cpu;
+  stats.rust_alloc_bytes += rust_alloc_bytes;
+}
+
+void RecordTimingCount(absl::string_view counter, int64_t delta) {
+  if (!IsTimingCollectionEnabled()) return;
+  absl::MutexLock lock(&SamplesMutex());
+  Counters()[std::string(counter)] += delta;
+}
+
+void RecordTimingHistogramSample(absl::string_view histogram, int64_t value) {
+  if (!IsTimingCollectionEnabled()) return;
+  absl::MutexLock lock(&SamplesMutex());
+  HistogramStats& stats = Histograms()[std::string(histogram)];
+  ++stats.count;
+  stats.sum += value;
+  if (value > stats.max) stats.max = value;
+  ++stats.buckets[BucketIndex(value)];
+}
+
+std::string TimingReportAsJson() {
+  llvm::json::Object phases;
+  llvm::json::Object counters;
+  llvm::json::Object histograms;
+  {
+    absl::MutexLock lock(&SamplesMutex());
+    for (const auto& [name, stats] : Phases()) {
+      phases[name] = llvm::json::Object{
+          {"calls", stats.calls},
+          {"wall_us", absl::ToInt64Microseconds(stats.wall)},
+          {"cpu_us", absl::ToInt64Microseconds(stats.cpu)},
+          {"rust_alloc_bytes", stats.rust_alloc_bytes},
+      };
+    }
+    for (const auto& [name, count] : Counters()) {
+      counters[name] = count;
+    }
+    for (const auto& [name, stats] : Histograms()) {
+      llvm::json::Object buckets;
+      for (size_t i = 0; i < stats.buckets.size(); ++i) {
+        if (stats.buckets[i] == 0) continue;
+        buckets[std::to_string(i == 0 ? uint64_t{1} : uint64_t{1} << i)] =
+            stats.buckets[i];
+      }
+      histograms[name] = llvm::json::Object{
+          {"count", stats.count},
+          {"sum", stats.sum},
+          {"max", stats.max},
+          {"buckets", std::move(buckets)},
+      };
+    }
+  }
+  llvm::json::Object report{{"phases", std::move(phases)},
+                            {"counters", std::move(counters)},
+                            {"histograms", std::move(histograms)}};
+  if (RustAllocStatsLinked()) {
+    report["rust_allocation"] = llvm::json::Object{
+        {"allocated_bytes",
+         static_cast<int64_t>(crubit_rust_allocated_bytes())},
+        {"allocations", static_cast<int64_t>(crubit_rust_allocation_count())},
+        {"live_bytes", static_cast<int64_t>(crubit_rust_live_bytes())},
+        {"peak_bytes", static_cast<int64_t>(crubit_rust_peak_bytes())},
+    };
+  }
+  return std::string(
+      llvm::formatv("{0:2}", llvm::json::Value(std::move(report))));
+}
+
+ScopedTimer::ScopedTimer(absl::string_view phase) : phase_(phase) {
+  if (!IsTimingCollectionEnabled()) return;
+  wall_start_ = absl::Now();
+  cpu_start_ = ThreadCpuTime();
+  rust_alloc_start_ = RustAllocatedBytesOrZero();
+}
+
+ScopedTimer::~ScopedTimer() {
+  if (!IsTimingCollectionEnabled()) return;
+  // The allocation delta is process-wide, so concurrent phases on other
+  // threads are attributed to whichever timers are open; with the tools'
+  // mostly sequential phase structure this is accurate enough to localize
+  // heap growth.
+  RecordTimingSample(phase_, absl::Now() - wall_start_,
+                     ThreadCpuTime() - cpu_start_,
+                     RustAllocatedBytesOrZero() - rust_alloc_start_);
+}
+
+}  // namespace crubit
@@ -0,0 +1,104 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_COMMON_TIMING_H_
+#define CRUBIT_COMMON_TIMING_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace crubit {
+
+// Lightweight instrumentation for answering "where does a slow invocation
+// spend its time?" without attaching a profiler.
+//
+// Collection is off by default, so the scoped timers sprinkled over hot
+// paths cost a single atomic load per construction. When enabled (the tools
+// enable it iff `--timing_report_out` is set), samples are aggregated
+// per phase name under a global mutex; the result is emitted once at the end
+// of an invocation via `TimingReportAsJson`.
+//
+// The phase name must outlive the sample (string literals in practice).
+
+// Turns on collection for the rest of the process lifetime.
+void EnableTimingCollection();
+bool IsTimingCollectionEnabled();
+
+// Adds one sample to the phase's aggregate: wall time, thread CPU time, an
+// implicit invocation count of 1, and (optionally) the Rust-side bytes
+// allocated during the phase. ScopedTimer fills in the last from the
+// allocation counters in rust_allocator_shims.c when those are linked in.
+void RecordTimingSample(absl::string_view phase, absl::Duration wall,
+                        absl::Duration cpu, int64_t rust_alloc_bytes = 0);
+
+// Adds `delta` to a free-standing counter (e.g. number of imported items).
+void RecordTimingCount(absl::string_view counter, int64_t delta);
+
+// Adds one sample to a power-of-two-bucketed histogram (e.g. per-function
+// analysis microseconds, CFG block counts). Buckets are implicit, so call
+// sites only supply the value.
+void RecordTimingHistogramSample(absl::string_view histogram, int64_t value);
+
+// Returns the aggregated report as a JSON object:
+//   {"phases": {"<phase>": {"calls": n, "wall_us": w, "cpu_us": c,
+//                           "rust_alloc_bytes": b}, ...},
+//    "counters": {"<counter>": n, ...},
+//    "histograms": {"<histogram>": {"count": n, "sum": s, "max": m,
+//                                   "buckets": {"<upper bound>": n, ...}},
+//                   ...}}
+// A histogram bucket keyed "<b>" counts samples in (b/2, b]; empty buckets
+// are omitted. Phases, counters, and histograms are sorted by name. When the
+// binary links common/rust_allocator_shims.c the report also carries a
+// process-wide "rust_allocation" object (allocated/live/peak bytes and
+// allocation count).
+std::string TimingReportAsJson();
+
+// Measures the wall and thread CPU time of a scope and records it under
+// `phase` on destruction. No-op (two atomic loads) when collection is off.
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(absl::string_view phase);
+  ~ScopedTimer();
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+  absl::string_view phase_;
+  absl::Time wall_start_;
+  absl::Duration cpu_start_;
+  int64_t rust_alloc_start_ = 0;
+};
+
+}  // namespace crubit
+
+// Convenience wrappers for instrumenting hot paths. These compile away
+// entirely when CRUBIT_DISABLE_TIMING is defined, for builds that must not
+// pay even the atomic load per sample; otherwise they defer to the functions
+// above (and remain runtime no-ops until EnableTimingCollection is called).
+#ifdef CRUBIT_DISABLE_TIMING
+
+#define CRUBIT_SCOPED_TIMER(phase)
+#define CRUBIT_RECORD_TIMING_COUNT(counter, delta)
+#define CRUBIT_RECORD_TIMING_HISTOGRAM(histogram, value)
+
+#else
+
+#define CRUBIT_TIMING_CONCAT_IMPL_(a, b) a##b
+#define CRUBIT_TIMING_CONCAT_(a, b) CRUBIT_TIMING_CONCAT_IMPL_(a, b)
+
+#define CRUBIT_SCOPED_TIMER(phase) \
+  ::crubit::ScopedTimer CRUBIT_TIMING_CONCAT_(crubit_scoped_timer_, \
+                                              __LINE__)(phase)
+#define CRUBIT_RECORD_TIMING_COUNT(counter, delta) \
+  ::crubit::RecordTimingCount(counter, delta)
+#define CRUBIT_RECORD_TIMING_HISTOGRAM(histogram, value) \
+  ::crubit::RecordTimingHistogramSample(histogram, value)
+
+#endif  // CRUBIT_DISABLE_TIMING
+
+#endif  // CRUBIT_COMMON_TIMING_H_
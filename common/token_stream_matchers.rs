@@ -95,7 +95,7 @@ pub mod internal {
 
     use anyhow::{anyhow, Result};
     pub use proc_macro2::TokenStream;
-    use proc_macro2::TokenTree;
+    use proc_macro2::{Delimiter, TokenTree};
     use std::iter;
     pub use token_stream_printer::{
         cc_tokens_to_formatted_string_for_tests, rs_tokens_to_formatted_string,
@@ -141,6 +141,44 @@ pub mod internal {
         }
     }
 
+    /// A cheap fingerprint of a single `TokenTree`, used by `match_tokens` to
+    /// rule out candidate match positions without running the full (and
+    /// string-formatting-heavy) `match_prefix` machinery.  Guarantee: if two
+    /// tokens can match each other in `match_tree`, their fingerprints are
+    /// equal.  The converse doesn't hold - e.g. two groups with the same
+    /// delimiter but different contents share a fingerprint; a collision only
+    /// costs a futile `match_prefix` call.
+    fn token_fingerprint(token: &TokenTree) -> u64 {
+        use std::collections::hash_map::DefaultHasher;
+        use std::hash::{Hash, Hasher};
+        let mut hasher = DefaultHasher::new();
+        match token {
+            // `match_tree` only requires matching groups to agree on the
+            // delimiter; their contents are matched recursively later.
+            TokenTree::Group(group) => ("group", format!("{:?}", group.delimiter())),
+            // All other token trees match iff their `Display` renderings are
+            // equal.
+            _ => ("leaf", format!("{}", token)),
+        }
+        .hash(&mut hasher);
+        hasher.finish()
+    }
+
+    /// Returns the fingerprint that the first non-whitespace token of the
+    /// input must have at a matching position, or `None` when no such filter
+    /// is sound: an empty pattern matches anywhere, a leading `.` may begin a
+    /// `...` wildcard, and a `Delimiter::None` group matches the rendering of
+    /// its contents rather than a single token.
+    fn pattern_prefilter_fingerprint(pattern: &TokenStream) -> Option<u64> {
+        let first = pattern.clone().into_iter().next()?;
+        match &first {
+            TokenTree::Punct(punct) if punct.as_char() == '.' => None,
+            TokenTree::Group(group) if group.delimiter() == Delimiter::None => None,
+            token if is_whitespace_token(token) => None,
+            token => Some(token_fingerprint(token)),
+        }
+    }
+
     pub fn match_tokens<ToStringFn>(
         input: &TokenStream,
         pattern: &TokenStream,
@@ -149,13 +187,38 @@ pub mod internal {
     where
         ToStringFn: Fn(TokenStream) -> Result<String>,
     {
-        let iter = input.clone().into_iter();
+        let pattern_fingerprint = pattern_prefilter_fingerprint(pattern);
         let mut best_mismatch = Mismatch::for_no_partial_match();
 
-        let mut stack = vec![iter];
-        while let Some(mut iter) = stack.pop() {
-            loop {
-                match match_prefix(iter.clone(), pattern.clone()) {
+        let mut stack: Vec<Vec<TokenTree>> = vec![input.clone().into_iter().collect()];
+        while let Some(tokens) = stack.pop() {
+            // `next_fingerprint[i]` is the fingerprint of the first
+            // non-whitespace token at or after position `i` (`None` when
+            // there is no such token, or when it is an opaque
+            // `Delimiter::None` group).  Precomputing the lookup keeps the
+            // scan linear even for whitespace-heavy streams.
+            let mut next_fingerprint: Vec<Option<u64>> = vec![None; tokens.len() + 1];
+            for (index, token) in tokens.iter().enumerate().rev() {
+                next_fingerprint[index] = match token {
+                    token if is_whitespace_token(token) => next_fingerprint[index + 1],
+                    TokenTree::Group(group) if group.delimiter() == Delimiter::None => None,
+                    token => Some(token_fingerprint(token)),
+                };
+            }
+            for start in 0..=tokens.len() {
+                if let Some(TokenTree::Group(group)) = tokens.get(start) {
+                    stack.push(group.stream().into_iter().collect());
+                }
+                if let (Some(wanted), Some(actual)) = (pattern_fingerprint, next_fingerprint[start])
+                {
+                    if wanted != actual {
+                        // The pattern mismatches at its very first token, so
+                        // this position can neither match nor improve
+                        // `best_mismatch` (its match length would be zero).
+                        continue;
+                    }
+                }
+                match match_prefix(tokens[start..].iter().cloned(), pattern.clone()) {
                     MatchInfo::Match { input_suffix: _ } => return Ok(()),
                     MatchInfo::Mismatch(mismatch) => {
                         if best_mismatch.match_length < mismatch.match_length {
@@ -163,13 +226,6 @@ pub mod internal {
                         }
                     }
                 };
-                if let Some(next) = iter.next() {
-                    if let TokenTree::Group(ref group) = next {
-                        stack.push(group.stream().into_iter());
-                    };
-                } else {
-                    break;
-                }
             }
         }
 
@@ -684,6 +740,34 @@ impl Drop {
         assert_rs_cc_matches!(quote! { [ a a b b c c ] }, quote! { [ ... c c ] });
     }
 
+    #[test]
+    fn test_wildcard_at_the_top_level() {
+        // A leading top-level wildcard disables the candidate-position
+        // prefilter - the first input token is unconstrained.
+        assert_rs_cc_matches!(quote! { a b c }, quote! { ... c });
+    }
+
+    #[test]
+    fn test_match_after_leading_whitespace() {
+        // The candidate-position prefilter must look through whitespace
+        // tokens, like the matcher itself does.
+        assert_rs_cc_matches!(quote! {__NEWLINE__ __NEWLINE__ fn foo() {}}, quote! {fn foo() {}});
+    }
+
+    #[test]
+    fn test_none_delimited_group_matches_its_contents() {
+        // A `Delimiter::None` group matches the rendering of its contents, so
+        // neither side of such a comparison may be filtered by fingerprint.
+        let group = proc_macro2::TokenTree::Group(proc_macro2::Group::new(
+            proc_macro2::Delimiter::None,
+            quote! {x},
+        ));
+        let input: TokenStream = std::iter::once(group.clone()).collect();
+        assert_rs_cc_matches!(input, quote! {x});
+        let pattern: TokenStream = std::iter::once(group).collect();
+        assert_rs_cc_matches!(quote! {x}, pattern);
+    }
+
     #[test]
     fn test_wildcard_not_consuming_anything_in_group() {
         assert_rs_cc_matches!(quote! { [ a b c ] }, quote! { [ ... a b c ] });
@@ -13,6 +13,7 @@ use std::process::{Command, Stdio};
 // TODO(b/231320237): The `RustfmtConfig` struct should be replaced with
 // `rustfmt_nightly::Config` once we switch to using rustfmt as a library
 // (instead of invoking the `rustfmt` executable).
+#[derive(Clone)]
 pub struct RustfmtConfig {
     /// Path to the `rustfmt` executable.
     exe_path: PathBuf,
@@ -88,6 +89,100 @@ pub fn rs_tokens_to_formatted_string_for_tests(input: TokenStream) -> Result<Str
     rs_tokens_to_formatted_string(input, &RustfmtConfig::for_testing())
 }
 
+/// Formats already-printed Rust source through `rustfmt`: the string-level
+/// counterpart of `rs_tokens_to_formatted_string`. Unlike token streams,
+/// strings are `Send`, so this can run on a worker thread to overlap the two
+/// formatter subprocesses of one invocation.
+pub fn rs_format_string(input: String, config: &RustfmtConfig) -> Result<String> {
+    rustfmt(input, config)
+}
+
+/// Formats already-printed C++ source through `clang-format`: the
+/// string-level counterpart of `cc_tokens_to_formatted_string`. See
+/// `rs_format_string` for the threading rationale.
+pub fn cc_format_string(input: String, clang_format_exe_path: &Path) -> Result<String> {
+    clang_format(input, clang_format_exe_path)
+}
+
+/// A chunk never cuts below this many top-level token trees (roughly a few
+/// dozen items), so small outputs stay a single chunk and a large one is not
+/// shredded into per-item formatter spawns.
+const MIN_CHUNK_TREES: usize = 1024;
+
+/// Prints `tokens` as up to `max_chunks` string chunks, cutting only after a
+/// top-level `;` or brace-delimited group — i.e. between complete top-level
+/// items — so each chunk is valid Rust on its own and the concatenation of
+/// the chunks is byte-identical to `tokens_to_string` of the whole stream.
+/// Intended for feeding `rs_format_string_chunks`.
+pub fn rs_tokens_to_string_chunks(
+    tokens: TokenStream,
+    max_chunks: usize,
+) -> Result<Vec<String>> {
+    let trees: Vec<TokenTree> = tokens.into_iter().collect();
+    if trees.is_empty() {
+        return Ok(Vec::new());
+    }
+    let target_len =
+        std::cmp::max((trees.len() + max_chunks.max(1) - 1) / max_chunks.max(1), MIN_CHUNK_TREES);
+    let mut chunks = Vec::new();
+    let mut current: Vec<TokenTree> = Vec::new();
+    for tree in trees {
+        // Top-level items end with either a `;` (use, static, const, type)
+        // or a braced body (fn, impl, struct, mod, ...). Attributes and doc
+        // comments always follow such a boundary, so they stay with the item
+        // they annotate.
+        let at_item_end = match &tree {
+            TokenTree::Punct(p) => p.as_char() == ';',
+            TokenTree::Group(g) => g.delimiter() == Delimiter::Brace,
+            _ => false,
+        };
+        current.push(tree);
+        if at_item_end && current.len() >= target_len {
+            chunks.push(tokens_to_string(current.drain(..).collect())?);
+        }
+    }
+    if !current.is_empty() {
+        chunks.push(tokens_to_string(current.into_iter().collect())?);
+    }
+    Ok(chunks)
+}
+
+/// Formats the chunks from `rs_tokens_to_string_chunks` through `rustfmt`
+/// concurrently (one subprocess per chunk) and concatenates the results in
+/// order. `rustfmt` is single-threaded and formats top-level items
+/// independently, so chunking turns the formatting of a multi-megabyte
+/// buffer from the longest serial phase into a parallel one with unchanged
+/// output.
+pub fn rs_format_string_chunks(chunks: Vec<String>, config: &RustfmtConfig) -> Result<String> {
+    let formatted: Vec<String> = std::thread::scope(|scope| {
+        let handles: Vec<_> =
+            chunks.into_iter().map(|chunk| scope.spawn(move || rustfmt(chunk, config))).collect();
+        handles
+            .into_iter()
+            .map(|handle| handle.join().expect("rustfmt thread panicked"))
+            .collect()
+    })
+    .into_iter()
+    .collect::<Result<_>>()?;
+    let mut result = String::with_capacity(formatted.iter().map(String::len).sum());
+    for piece in &formatted {
+        result.push_str(piece);
+    }
+    Ok(result)
+}
+
+/// Like `rs_tokens_to_formatted_string`, but formats in-process instead of
+/// piping through a `rustfmt` subprocess: a newline is inserted after each
+/// `;`, and after opening and closing braces. Callers select this backend by
+/// not configuring a `rustfmt` executable; the output is valid Rust with a
+/// stable line structure, just not rustfmt-pretty (in particular, doc
+/// comments stay in their `#[doc = "..."]` attribute form).
+pub fn rs_tokens_to_string_with_line_breaks(tokens: TokenStream) -> Result<String> {
+    let mut result = String::with_capacity(OUTPUT_CAPACITY_GUESS);
+    tokens_to_string_with(&mut result, tokens, /* line_breaks= */ true)?;
+    Ok(result)
+}
+
 /// Like `tokens_to_string` but also runs the result through `clang-format`.
 pub fn cc_tokens_to_formatted_string(
     tokens: TokenStream,
@@ -105,6 +200,119 @@ pub fn cc_tokens_to_formatted_string_for_tests(tokens: TokenStream) -> Result<St
 }
 
 
+/// Like `cc_tokens_to_formatted_string`, but formats in-process instead of
+/// piping through a `clang-format` subprocess. The generated C++ follows a
+/// small fixed grammar (includes, `extern "C"` blocks, thunks,
+/// `static_assert`s, namespaces), so an indentation-aware printer that breaks
+/// lines after `;` and around braces is sufficient for readable output.
+/// Callers select this backend by not configuring a `clang-format`
+/// executable.
+pub fn cc_tokens_to_string_with_indentation(tokens: TokenStream) -> Result<String> {
+    let mut result = String::with_capacity(OUTPUT_CAPACITY_GUESS);
+    let mut at_line_start = false;
+    cc_tokens_to_string_indented(&mut result, tokens, 0, &mut at_line_start)?;
+    Ok(result)
+}
+
+fn cc_tokens_to_string_indented(
+    result: &mut String,
+    tokens: TokenStream,
+    indent: usize,
+    at_line_start: &mut bool,
+) -> Result<()> {
+    const INDENT: &str = "  ";
+    // Writes the pending indentation when `tt` is the first visible token on
+    // its line.
+    fn maybe_indent(result: &mut String, indent: usize, at_line_start: &mut bool) {
+        if *at_line_start {
+            for _ in 0..indent {
+                result.push_str(INDENT);
+            }
+            *at_line_start = false;
+        }
+    }
+
+    let mut it = tokens.into_iter().peekable();
+    while let Some(tt) = it.next() {
+        match tt {
+            TokenTree::Ident(ref tt) if tt == "__NEWLINE__" => {
+                writeln!(result)?;
+                *at_line_start = true;
+            }
+            TokenTree::Ident(ref tt) if tt == "__SPACE__" => write!(result, " ")?,
+            TokenTree::Ident(ref tt) if tt == "__HASH_TOKEN__" => {
+                maybe_indent(result, indent, at_line_start);
+                write!(result, "#")?;
+            }
+            TokenTree::Ident(ref tt) if tt == "__COMMENT__" => {
+                if let Some(TokenTree::Literal(lit)) = it.next() {
+                    maybe_indent(result, indent, at_line_start);
+                    let line_prefix = format!("\n{}// ", INDENT.repeat(indent));
+                    writeln!(
+                        result,
+                        "// {}",
+                        lit.to_string().trim_matches('"').replace("\\n", &line_prefix)
+                    )?;
+                    *at_line_start = true;
+                } else {
+                    bail!("__COMMENT__ must be followed by a literal")
+                }
+            }
+            TokenTree::Group(ref tt) => {
+                maybe_indent(result, indent, at_line_start);
+                match tt.delimiter() {
+                    Delimiter::Brace => {
+                        writeln!(result, "{{")?;
+                        *at_line_start = true;
+                        cc_tokens_to_string_indented(
+                            result,
+                            tt.stream(),
+                            indent + 1,
+                            at_line_start,
+                        )?;
+                        if !*at_line_start {
+                            writeln!(result)?;
+                        }
+                        *at_line_start = true;
+                        maybe_indent(result, indent, at_line_start);
+                        writeln!(result, "}}")?;
+                        *at_line_start = true;
+                    }
+                    delimiter => {
+                        let (open_delimiter, closed_delimiter) = match delimiter {
+                            Delimiter::Parenthesis => ("(", ")"),
+                            Delimiter::Bracket => ("[", "]"),
+                            Delimiter::Brace | Delimiter::None => ("", ""),
+                        };
+                        write!(result, "{}", open_delimiter)?;
+                        cc_tokens_to_string_indented(result, tt.stream(), indent, at_line_start)?;
+                        write!(result, "{}", closed_delimiter)?;
+                    }
+                }
+            }
+            _ => {
+                maybe_indent(result, indent, at_line_start);
+                write!(result, "{}", tt)?;
+
+                if let TokenTree::Punct(ref p) = tt {
+                    if p.as_char() == ';' {
+                        writeln!(result)?;
+                        *at_line_start = true;
+                        continue;
+                    }
+                }
+
+                if let Some(tt_next) = it.peek() {
+                    if tokens_require_whitespace(&tt, tt_next) {
+                        write!(result, " ")?;
+                    }
+                }
+            }
+        }
+    }
+    Ok(())
+}
+
 /// Produces source code out of the token stream.
 ///
 /// Notable features:
@@ -121,13 +329,23 @@ pub fn cc_tokens_to_formatted_string_for_tests(tokens: TokenStream) -> Result<St
 ///   placeholder `__SPACE__`.
 /// * `TokenStream` cannot encode comments, so we use the placeholder
 ///   `__COMMENT__`, followed by a string literal.
-fn tokens_to_string(tokens: TokenStream) -> Result<String> {
-    let mut result = String::new();
-    tokens_to_string_impl(&mut result, tokens)?;
+pub fn tokens_to_string(tokens: TokenStream) -> Result<String> {
+    let mut result = String::with_capacity(OUTPUT_CAPACITY_GUESS);
+    tokens_to_string_with(&mut result, tokens, /* line_breaks= */ false)?;
     Ok(result)
 }
 
-fn tokens_to_string_impl(result: &mut String, tokens: TokenStream) -> Result<()> {
+/// Initial capacity of printer output buffers. Generated files are typically
+/// tens of kilobytes to megabytes; starting here skips the reallocation and
+/// copy churn of growing a `String` up from empty, while over-reserving only
+/// costs address space for tiny outputs.
+const OUTPUT_CAPACITY_GUESS: usize = 64 * 1024;
+
+fn tokens_to_string_with(
+    result: &mut String,
+    tokens: TokenStream,
+    line_breaks: bool,
+) -> Result<()> {
     let mut it = tokens.into_iter().peekable();
     while let Some(tt) = it.next() {
         match tt {
@@ -153,13 +371,28 @@ fn tokens_to_string_impl(result: &mut String, tokens: TokenStream) -> Result<()>
                     Delimiter::Brace => ("{ ", " }"),
                     Delimiter::None => ("", ""),
                 };
+                let is_brace = tt.delimiter() == Delimiter::Brace;
                 write!(result, "{}", open_delimiter)?;
-                tokens_to_string_impl(result, tt.stream())?;
+                if line_breaks && is_brace {
+                    writeln!(result)?;
+                }
+                tokens_to_string_with(result, tt.stream(), line_breaks)?;
                 write!(result, "{}", closed_delimiter)?;
+                if line_breaks && is_brace {
+                    writeln!(result)?;
+                }
             }
             _ => {
                 write!(result, "{}", tt)?;
 
+                if line_breaks {
+                    if let TokenTree::Punct(ref p) = tt {
+                        if p.as_char() == ';' {
+                            writeln!(result)?;
+                        }
+                    }
+                }
+
                 // Insert spaces between tokens when they are needed to separate tokens.
                 // In particular, `a b` is different than `ab`, and `: ::` is different from
                 // `:::`.
@@ -201,6 +434,106 @@ fn is_ident_or_literal(tt: &TokenTree) -> bool {
     }
 }
 
+/// Environment variable naming a directory for the persistent format cache.
+/// When set, formatter results are cached there keyed on a hash of the
+/// unformatted text, the formatter executable (path plus size and mtime, as a
+/// version proxy), and the cmdline arguments; a hit skips spawning the
+/// formatter entirely. Unset means no caching. Generated sources are highly
+/// repetitive across incremental builds - most targets regenerate
+/// byte-identical text - so a warm cache removes the formatter subprocess
+/// from the critical path of unchanged targets.
+pub const FORMAT_CACHE_DIR_ENV_VAR: &str = "CRUBIT_FORMAT_CACHE_DIR";
+
+/// 128-bit FNV-1a. Not cryptographic - the cache key only needs to make
+/// accidental collisions implausible, and a local implementation avoids a
+/// hash-crate dependency for this one call site.
+struct Fnv128 {
+    hash: u128,
+}
+
+impl Fnv128 {
+    const OFFSET_BASIS: u128 = 0x6c62272e07bb014262b821756295c58d;
+    const PRIME: u128 = 0x0000000001000000000000000000013b;
+
+    fn new() -> Self {
+        Self { hash: Self::OFFSET_BASIS }
+    }
+
+    /// Hashes `bytes` with a length prefix, so that adjacent fields of
+    /// different lengths cannot alias each other in the digest.
+    fn update_field(&mut self, bytes: &[u8]) {
+        self.update(&(bytes.len() as u64).to_le_bytes());
+        self.update(bytes);
+    }
+
+    fn update(&mut self, bytes: &[u8]) {
+        for &byte in bytes {
+            self.hash ^= u128::from(byte);
+            self.hash = self.hash.wrapping_mul(Self::PRIME);
+        }
+    }
+}
+
+/// Computes the cache entry file name for formatting `input` with the
+/// formatter at `exe_path` invoked with `args`. Returns `None` when the
+/// executable cannot be stat'ed: without its size and mtime there is no way
+/// to notice a formatter upgrade, so such inputs are not cached.
+fn format_cache_entry_name(input: &str, exe_path: &Path, args: &[&OsStr]) -> Option<String> {
+    let metadata = std::fs::metadata(exe_path).ok()?;
+    let mtime =
+        metadata.modified().ok()?.duration_since(std::time::UNIX_EPOCH).ok()?.as_nanos();
+    let mut fnv = Fnv128::new();
+    fnv.update_field(exe_path.as_os_str().as_encoded_bytes());
+    fnv.update_field(&metadata.len().to_le_bytes());
+    fnv.update_field(&mtime.to_le_bytes());
+    for arg in args {
+        fnv.update_field(arg.as_encoded_bytes());
+    }
+    fnv.update_field(input.as_bytes());
+    Some(format!("{:032x}.formatted", fnv.hash))
+}
+
+/// Runs `input` through the formatter at `exe_path`, consulting and filling
+/// the cache in `cache_dir` (when one is configured). Cache I/O is
+/// best-effort: any failure to read or write an entry just falls back to (or
+/// proceeds after) the formatter subprocess.
+fn format_with_cache(
+    input: String,
+    exe_name: &str,
+    exe_path: &Path,
+    args: &[&OsStr],
+    cache_dir: Option<&Path>,
+) -> Result<String> {
+    let entry_path = cache_dir
+        .zip(format_cache_entry_name(&input, exe_path, args))
+        .map(|(dir, name)| dir.join(name));
+    if let Some(entry_path) = &entry_path {
+        if let Ok(cached) = std::fs::read_to_string(entry_path) {
+            return Ok(cached);
+        }
+    }
+    let formatted = pipe_string_through_process(input, exe_name, exe_path, args.iter().copied())?;
+    if let Some(entry_path) = &entry_path {
+        // Write via a process-unique temp file and rename, so that concurrent
+        // invocations never observe a partially written entry.
+        let tmp_path = entry_path.with_extension(format!("tmp.{}", std::process::id()));
+        if std::fs::write(&tmp_path, &formatted).is_ok()
+            && std::fs::rename(&tmp_path, entry_path).is_err()
+        {
+            let _ = std::fs::remove_file(&tmp_path);
+        }
+    }
+    Ok(formatted)
+}
+
+fn format_cache_dir_from_env() -> Option<PathBuf> {
+    let dir = PathBuf::from(std::env::var_os(FORMAT_CACHE_DIR_ENV_VAR)?);
+    // Creating the directory here lets callers point the variable at a
+    // not-yet-existing location (e.g. under a build output dir).
+    std::fs::create_dir_all(&dir).ok()?;
+    Some(dir)
+}
+
 fn pipe_string_through_process<'a>(
     input: String,
     exe_name: &str,
@@ -229,20 +562,23 @@ fn pipe_string_through_process<'a>(
 }
 
 fn rustfmt(input: String, config: &RustfmtConfig) -> Result<String> {
-    pipe_string_through_process(
+    let args: Vec<&OsStr> = config.cmdline_args.iter().map(OsString::as_os_str).collect();
+    format_with_cache(
         input,
         "rustfmt",
         &config.exe_path,
-        config.cmdline_args.iter().map(OsString::as_os_str),
+        &args,
+        format_cache_dir_from_env().as_deref(),
     )
 }
 
 fn clang_format(input: String, clang_format_exe_path: &Path) -> Result<String> {
-    pipe_string_through_process(
+    format_with_cache(
         input,
         "clang-format",
         clang_format_exe_path,
-        [OsStr::new("--style=google")],
+        &[OsStr::new("--style=google")],
+        format_cache_dir_from_env().as_deref(),
     )
 }
 
@@ -381,6 +717,19 @@ mod tests {
         Ok(())
     }
 
+    #[test]
+    fn test_rs_tokens_to_string_with_line_breaks() -> Result<()> {
+        let input = quote! {
+            fn foo() { bar(); baz(); }
+            static X: i32 = 42;
+        };
+        assert_eq!(
+            rs_tokens_to_string_with_line_breaks(input)?,
+            "fn foo(){ \nbar();\nbaz();\n }\nstatic X:i32=42;\n"
+        );
+        Ok(())
+    }
+
     #[test]
     fn test_rs_tokens_to_formatted_string_for_tests() {
         let input = quote! {
@@ -446,6 +795,134 @@ fn foo(
         Ok(())
     }
 
+    #[test]
+    fn test_cc_tokens_to_string_with_indentation() -> Result<()> {
+        let input = quote! {
+            __HASH_TOKEN__ include "foo/bar.h" __NEWLINE__
+            namespace ns {
+                void foo() { bar(); }
+            }
+        };
+        assert_eq!(
+            cc_tokens_to_string_with_indentation(input)?,
+            "#include \"foo/bar.h\"\nnamespace ns{\n  void foo(){\n    bar();\n  }\n}\n"
+        );
+        Ok(())
+    }
+
+    #[test]
+    fn test_rs_tokens_to_string_chunks_concatenates_to_whole() -> Result<()> {
+        // Enough top-level items to exceed the minimum chunk size several
+        // times over, so the stream actually splits.
+        let mut tokens = TokenStream::new();
+        for i in 0..1000 {
+            let name = quote::format_ident!("f{}", i);
+            tokens.extend(quote! { fn #name() {} });
+        }
+        let whole = tokens_to_string(tokens.clone())?;
+        let chunks = rs_tokens_to_string_chunks(tokens, 4)?;
+        assert!(chunks.len() > 1);
+        // Cuts happen only between items, and concatenation reproduces the
+        // single-buffer output byte for byte.
+        for chunk in &chunks {
+            assert!(chunk.ends_with('}'), "unexpected chunk end: {chunk:?}");
+        }
+        assert_eq!(chunks.concat(), whole);
+        Ok(())
+    }
+
+    #[test]
+    fn test_rs_tokens_to_string_chunks_small_stream_single_chunk() -> Result<()> {
+        let tokens = quote! { fn a() {} fn b() {} };
+        let chunks = rs_tokens_to_string_chunks(tokens.clone(), 8)?;
+        assert_eq!(chunks, vec![tokens_to_string(tokens)?]);
+        assert_eq!(rs_tokens_to_string_chunks(TokenStream::new(), 8)?, Vec::<String>::new());
+        Ok(())
+    }
+
+    #[test]
+    fn test_rs_format_string_chunks() {
+        let config = RustfmtConfig::new(Path::new(RUSTFMT_EXE_PATH_FOR_TESTING), None);
+        let chunks = vec!["fn a(){}".to_string(), "fn b(){}".to_string()];
+        let output = rs_format_string_chunks(chunks, &config).unwrap();
+        assert_eq!(output, "fn a() {}\nfn b() {}\n");
+    }
+
+    #[test]
+    fn test_format_cache_hit_skips_formatter() -> Result<()> {
+        let tmpdir = tempdir()?;
+        let cache_dir = tmpdir.path().join("cache");
+        std::fs::create_dir(&cache_dir)?;
+        // A plain file, not an executable: spawning it would fail, so getting
+        // the sentinel back proves the cache was consulted before any spawn.
+        let exe_path = tmpdir.path().join("not-a-formatter");
+        std::fs::write(&exe_path, "")?;
+        let args = [OsStr::new("--some-arg")];
+        let entry_name = format_cache_entry_name("fn f(){}", &exe_path, &args).unwrap();
+        std::fs::write(cache_dir.join(entry_name), "fn f() {}\n")?;
+
+        let output = format_with_cache(
+            "fn f(){}".to_string(),
+            "not-a-formatter",
+            &exe_path,
+            &args,
+            Some(&cache_dir),
+        )?;
+        assert_eq!(output, "fn f() {}\n");
+        Ok(())
+    }
+
+    #[test]
+    fn test_format_cache_write_through() -> Result<()> {
+        let tmpdir = tempdir()?;
+        let cache_dir = tmpdir.path().to_path_buf();
+        // `cat` stands in for a formatter; as the identity function it makes
+        // the expected cache contents obvious.
+        let exe_path = Path::new("/bin/cat");
+        let output =
+            format_with_cache("fn f(){}".to_string(), "cat", exe_path, &[], Some(&cache_dir))?;
+        assert_eq!(output, "fn f(){}");
+
+        // Exactly one entry, holding the formatted bytes.
+        let entries: Vec<_> = std::fs::read_dir(&cache_dir)?.collect::<std::io::Result<_>>()?;
+        assert_eq!(entries.len(), 1);
+        assert_eq!(std::fs::read_to_string(entries[0].path())?, "fn f(){}");
+
+        // Replace the entry with a sentinel to prove the second call is
+        // served from the cache rather than re-running the formatter.
+        std::fs::write(entries[0].path(), "sentinel")?;
+        let output =
+            format_with_cache("fn f(){}".to_string(), "cat", exe_path, &[], Some(&cache_dir))?;
+        assert_eq!(output, "sentinel");
+        Ok(())
+    }
+
+    #[test]
+    fn test_format_cache_entry_name_keying() -> Result<()> {
+        let tmpdir = tempdir()?;
+        let exe_path = tmpdir.path().join("formatter");
+        std::fs::write(&exe_path, "v1")?;
+        let name = |input: &str, args: &[&OsStr]| {
+            format_cache_entry_name(input, &exe_path, args).unwrap()
+        };
+
+        assert_eq!(name("fn f(){}", &[]), name("fn f(){}", &[]));
+        assert_ne!(name("fn f(){}", &[]), name("fn g(){}", &[]));
+        assert_ne!(name("fn f(){}", &[]), name("fn f(){}", &[OsStr::new("--edition=2021")]));
+
+        // A changed executable (here: a different size) invalidates entries.
+        let old_name = name("fn f(){}", &[]);
+        std::fs::write(&exe_path, "v2, but longer")?;
+        assert_ne!(old_name, name("fn f(){}", &[]));
+
+        // A missing executable disables caching instead of mis-keying.
+        assert_eq!(
+            format_cache_entry_name("fn f(){}", &tmpdir.path().join("gone"), &[]),
+            None
+        );
+        Ok(())
+    }
+
     #[test]
     fn test_cc_tokens_to_formatted_string_for_tests() {
         let input = quote! {
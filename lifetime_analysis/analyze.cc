@@ -17,6 +17,8 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
+#include "common/cfg_cache.h"
+#include "common/timing.h"
 #include "lifetime_analysis/lifetime_analysis.h"
 #include "lifetime_analysis/lifetime_lattice.h"
 #include "lifetime_analysis/object_repository.h"
@@ -24,6 +26,7 @@
 #include "lifetime_annotations/function_lifetimes.h"
 #include "lifetime_annotations/lifetime.h"
 #include "lifetime_annotations/lifetime_substitutions.h"
+#include "lifetime_annotations/lifetime_symbol_table.h"
 #include "lifetime_annotations/pointee_type.h"
 #include "lifetime_annotations/type_lifetimes.h"
 #include "clang/AST/Decl.h"
@@ -74,7 +77,11 @@ llvm::Error PropagateStaticToPointees(LifetimeSubstitutions& subst,
   while (!pointees.empty()) {
     const Object* cur = pointees.back();
     pointees.pop_back();
-    visited.insert(cur);
+    // An object can be pushed several times before it is first popped (once
+    // per predecessor); deduplicate here so it is processed only once.
+    if (!visited.insert(cur).second) {
+      continue;
+    }
     if (cur->GetLifetime().IsLocal()) {
       return llvm::createStringError(
           llvm::inconvertibleErrorCode(),
@@ -85,7 +92,13 @@ llvm::Error PropagateStaticToPointees(LifetimeSubstitutions& subst,
       subst.Add(cur->GetLifetime(), Lifetime::Static());
     }
 
-    for (const Object* pointee : points_to_map.GetPointerPointsToSet(cur)) {
+    // Look the points-to set up in place; GetPointerPointsToSet would copy
+    // it for every visited object.
+    auto iter = points_to_map.PointerPointsTos().find(cur);
+    if (iter == points_to_map.PointerPointsTos().end()) {
+      continue;
+    }
+    for (const Object* pointee : iter->second) {
       if (!visited.count(pointee)) {
         pointees.push_back(pointee);
       }
@@ -523,11 +536,21 @@ llvm::Error AnalyzeFunctionBody(
         callee_lifetimes,
     const DiagnosticReporter& diag_reporter,
     ObjectRepository& object_repository, PointsToMap& points_to_map,
-    LifetimeConstraints& constraints, std::string* cfg_dot) {
-  auto cfctx = clang::dataflow::ControlFlowContext::build(
-      func, *func->getBody(), func->getASTContext());
+    LifetimeConstraints& constraints, crubit::FunctionCfgCache& cfg_cache,
+    std::string* cfg_dot) {
+  // The CFG is shared across re-analyses of the same function (fixpoint
+  // iterations for recursive cycles, the overrides traversal); only the
+  // dataflow state below is rebuilt each time.
+  auto cfctx = cfg_cache.Get(func);
   if (!cfctx) return cfctx.takeError();
 
+  // The analysis context (and its solver) is deliberately per-function
+  // rather than pooled across the TU: this analysis runs with
+  // ApplyBuiltinTransfer=false, so the solver is never invoked and costs
+  // only its construction, while a shared DataflowAnalysisContext would
+  // accumulate interned state across thousands of functions with no reset
+  // API to reclaim it. The dominant per-function fixed cost is the CFG
+  // build above, which is inherently per-function.
   clang::dataflow::DataflowAnalysisContext analysis_context(
       std::make_unique<clang::dataflow::WatchedLiteralsSolver>());
   clang::dataflow::Environment environment(analysis_context);
@@ -535,17 +558,31 @@ llvm::Error AnalyzeFunctionBody(
   LifetimeAnalysis analysis(func, object_repository, callee_lifetimes,
                             diag_reporter);
 
+  // Block scheduling (including the visit order for loops) is owned by the
+  // dataflow framework; it offers no hook for a custom worklist, and
+  // re-implementing the fixpoint driver here would mean forking
+  // `transferBlock` and the `Environment` plumbing just to change iteration
+  // order. Cheap convergence detection on our side (see
+  // `PointsToMap::SharesStateWith`) keeps re-evaluations of settled blocks
+  // inexpensive instead.
+  //
+  // For the same reason there is no widening at loop back-edges (the
+  // framework does not expose them). Termination does not depend on it: the
+  // object universe for a function is created up front by ObjectRepository
+  // from the types' lifetimes - loops over recursive data structures reuse
+  // the same summary objects rather than materializing one object per
+  // iteration - so points-to sets are monotone over a finite domain.
   llvm::Expected<std::vector<
       std::optional<clang::dataflow::DataflowAnalysisState<LifetimeLattice>>>>
       maybe_block_to_output_state =
-          clang::dataflow::runDataflowAnalysis(*cfctx, analysis, environment);
+          clang::dataflow::runDataflowAnalysis(**cfctx, analysis, environment);
   if (!maybe_block_to_output_state) {
     return maybe_block_to_output_state.takeError();
   }
   auto& block_to_output_state = *maybe_block_to_output_state;
 
   const auto exit_block_state =
-      block_to_output_state.at(cfctx->getCFG().getExit().getBlockID());
+      block_to_output_state.at((*cfctx)->getCFG().getExit().getBlockID());
   if (!exit_block_state.has_value()) {
     assert(false);
     return llvm::createStringError(
@@ -589,13 +626,19 @@ llvm::Error AnalyzeFunctionBody(
     }
     visited.insert(obj);
     constraints.AddOutlivesConstraint(Lifetime::Static(), obj->GetLifetime());
-    for (auto pointee : points_to_map.GetPointerPointsToSet(obj)) {
-      stack.push_back(pointee);
+    auto iter = points_to_map.PointerPointsTos().find(obj);
+    if (iter == points_to_map.PointerPointsTos().end()) {
+      continue;
+    }
+    for (const Object* pointee : iter->second) {
+      if (!visited.contains(pointee)) {
+        stack.push_back(pointee);
+      }
     }
   }
 
   if (cfg_dot) {
-    *cfg_dot = CreateCfgDot(cfctx->getCFG(), func->getASTContext(),
+    *cfg_dot = CreateCfgDot((*cfctx)->getCFG(), func->getASTContext(),
                             block_to_output_state, object_repository);
   }
 
@@ -605,7 +648,9 @@ llvm::Error AnalyzeFunctionBody(
 llvm::Expected<FunctionAnalysis> AnalyzeSingleFunction(
     const clang::FunctionDecl* func,
     const FunctionLifetimesMap& callee_lifetimes,
-    const DiagnosticReporter& diag_reporter, FunctionDebugInfoMap* debug_info) {
+    const DiagnosticReporter& diag_reporter,
+    crubit::FunctionCfgCache& cfg_cache, FunctionDebugInfoMap* debug_info) {
+  CRUBIT_SCOPED_TIMER("lifetime_analysis_function");
   llvm::Expected<ObjectRepository> object_repository =
       ObjectRepository::Create(func, callee_lifetimes);
   if (auto err = object_repository.takeError()) {
@@ -648,7 +693,7 @@ llvm::Expected<FunctionAnalysis> AnalyzeSingleFunction(
     std::string* cfg_dot = debug_info ? &(*debug_info)[func].cfg_dot : nullptr;
     if (llvm::Error err = AnalyzeFunctionBody(
             func, callee_lifetimes, diag_reporter, analysis.object_repository,
-            analysis.points_to_map, analysis.constraints, cfg_dot)) {
+            analysis.points_to_map, analysis.constraints, cfg_cache, cfg_dot)) {
       return std::move(err);
     }
   } else {
@@ -656,6 +701,11 @@ llvm::Expected<FunctionAnalysis> AnalyzeSingleFunction(
                                    "Declaration-only!");
   }
 
+  // All debug formatting is opt-in: this block runs only when a caller
+  // passed a FunctionDebugInfoMap, CreateCfgDot only when `cfg_dot` was
+  // requested, and LifetimeLattice::ToString only when the dataflow
+  // framework's own logging invokes it. Production runs construct none of
+  // these strings.
   if (debug_info) {
     std::string ast;
     llvm::raw_string_ostream os(ast);
@@ -908,6 +958,16 @@ llvm::SmallVector<const clang::FunctionDecl*> GetAllFunctionDefinitions(
   return functions;
 }
 
+// Builds the complete base-method-to-overrides index in one pass over the
+// TU, before any analysis starts; traversal then pays one DenseMap lookup
+// per virtual method. The `in_overrides_traversal` flag on
+// `VisitedCallStackEntry` is not part of graph construction - it sequences
+// the propagation of lifetimes from final overriders back into their base
+// methods, which has to happen during the analysis walk because it consumes
+// the overriders' freshly computed lifetimes. An explicit SCC-condensed call
+// graph would duplicate what the visited-stack cycle handling
+// (FindAndMarkCycleWithFunc / AnalyzeRecursiveFunctions) already computes
+// lazily for exactly the components that need it.
 BaseToOverrides BuildBaseToOverrides(const clang::TranslationUnitDecl* tu) {
   BaseToOverrides base_to_overrides;
   for (const clang::FunctionDecl* f : GetAllFunctionDefinitions(tu)) {
@@ -957,7 +1017,8 @@ llvm::Error UpdateFunctionLifetimesWithOverrides(
     const clang::FunctionDecl* func,
     llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>&
         analyzed,
-    const llvm::SmallPtrSet<const clang::CXXMethodDecl*, 2>& overrides) {
+    const llvm::SmallPtrSet<const clang::CXXMethodDecl*, 2>& overrides,
+    llvm::DenseSet<const clang::FunctionDecl*>& overrides_dirty) {
   const auto* canonical = func->getCanonicalDecl();
   const auto* method = clang::dyn_cast<clang::CXXMethodDecl>(func);
   assert(method != nullptr);
@@ -993,13 +1054,20 @@ llvm::Error UpdateFunctionLifetimesWithOverrides(
       return err;
     }
   }
-  analyzed[canonical] = base_lifetimes;
+  // Record the update only if it actually constrained anything; callers of
+  // this method are re-analyzed during the overrides traversal only when one
+  // of their callees is marked dirty here.
+  if (!IsIsomorphic(*opt_lifetimes, base_lifetimes)) {
+    analyzed[canonical] = std::move(base_lifetimes);
+    overrides_dirty.insert(canonical);
+  }
   return llvm::Error::success();
 }
 
 llvm::Error AnalyzeRecursiveFunctions(
     llvm::ArrayRef<VisitedCallStackEntry> funcs, FunctionLifetimesMap& analyzed,
-    const DiagnosticReporter& diag_reporter, FunctionDebugInfoMap* debug_info) {
+    const DiagnosticReporter& diag_reporter,
+    crubit::FunctionCfgCache& cfg_cache, FunctionDebugInfoMap* debug_info) {
   for (const auto [func, in_cycle, _] : funcs) {
     assert(in_cycle);
 
@@ -1013,7 +1081,7 @@ llvm::Error AnalyzeRecursiveFunctions(
     if (!func_lifetimes_result) {
       return func_lifetimes_result.takeError();
     }
-    analyzed[func->getCanonicalDecl()] = func_lifetimes_result.get();
+    analyzed[func->getCanonicalDecl()] = std::move(func_lifetimes_result.get());
   }
 
   int64_t expected_iterations = 0;
@@ -1039,8 +1107,9 @@ llvm::Error AnalyzeRecursiveFunctions(
     }
 
     for (const auto [func, in_cycle, _] : funcs) {
-      auto analysis_result =
-          AnalyzeSingleFunction(func, analyzed, diag_reporter, debug_info);
+      auto analysis_result = AnalyzeSingleFunction(func, analyzed,
+                                                   diag_reporter, cfg_cache,
+                                                   debug_info);
       if (!analysis_result) {
         return analysis_result.takeError();
       }
@@ -1060,7 +1129,7 @@ llvm::Error AnalyzeRecursiveFunctions(
       if (std::holds_alternative<FunctionLifetimes>(existing_result) &&
           !IsIsomorphic(std::get<FunctionLifetimes>(existing_result),
                         func_lifetimes_result.get())) {
-        existing_result = func_lifetimes_result.get();
+        existing_result = std::move(func_lifetimes_result.get());
         func_lifetimes_changed = true;
       }
     }
@@ -1094,7 +1163,10 @@ void AnalyzeFunctionRecursive(
     llvm::SmallVectorImpl<VisitedCallStackEntry>& visited,
     const clang::FunctionDecl* func,
     const LifetimeAnnotationContext& lifetime_context,
-    const DiagnosticReporter& diag_reporter, FunctionDebugInfoMap* debug_info,
+    const DiagnosticReporter& diag_reporter,
+    crubit::FunctionCfgCache& cfg_cache,
+    llvm::DenseSet<const clang::FunctionDecl*>& overrides_dirty,
+    FunctionDebugInfoMap* debug_info,
     const BaseToOverrides& base_to_overrides) {
   // Make sure we're always using the canonical declaration when using the
   // function as a key in maps and sets.
@@ -1117,7 +1189,7 @@ void AnalyzeFunctionRecursive(
                               .moveInto(annotations)) {
       analyzed[func] = FunctionAnalysisError(err);
     } else {
-      analyzed[func] = annotations;
+      analyzed[func] = std::move(annotations);
     }
     return;
   }
@@ -1172,7 +1244,8 @@ void AnalyzeFunctionRecursive(
       continue;
     }
     AnalyzeFunctionRecursive(analyzed, visited, callee, lifetime_context,
-                             diag_reporter, debug_info, base_to_overrides);
+                             diag_reporter, cfg_cache, overrides_dirty,
+                             debug_info, base_to_overrides);
   }
 
   llvm::DenseSet<const clang::CXXMethodDecl*> bases;
@@ -1190,7 +1263,8 @@ void AnalyzeFunctionRecursive(
       GetBaseMethods(cxxmethod, bases);
       for (const auto* base : bases) {
         AnalyzeFunctionRecursive(analyzed, visited, base, lifetime_context,
-                                 diag_reporter, debug_info, base_to_overrides);
+                                 diag_reporter, cfg_cache, overrides_dirty,
+                                 debug_info, base_to_overrides);
       }
     } else {
       // We are in an overrides traversal for a virtual method starting from its
@@ -1202,8 +1276,8 @@ void AnalyzeFunctionRecursive(
         overrides = iter->second;
         for (const auto* derived : overrides) {
           AnalyzeFunctionRecursive(analyzed, visited, derived, lifetime_context,
-                                   diag_reporter, debug_info,
-                                   base_to_overrides);
+                                   diag_reporter, cfg_cache, overrides_dirty,
+                                   debug_info, base_to_overrides);
         }
       }
     }
@@ -1244,18 +1318,47 @@ void AnalyzeFunctionRecursive(
     if (bases.empty()) {
       // This function is not where we initiated an overrides traversal from its
       // base methods.
-      auto analysis_result =
-          AnalyzeSingleFunction(func, analyzed, diag_reporter, debug_info);
-      if (!analysis_result) {
-        analyzed[func] = FunctionAnalysisError(analysis_result.takeError());
-      } else {
-        auto func_lifetimes_result = ConstructFunctionLifetimes(
-            func, std::move(analysis_result.get()), diag_reporter);
-        if (!func_lifetimes_result) {
-          analyzed[func] =
-              FunctionAnalysisError(func_lifetimes_result.takeError());
+      //
+      // If we get here with the function already analyzed, this is a
+      // re-analysis during an overrides traversal. The analysis is a
+      // deterministic function of the body (unchanged) and the callees'
+      // recorded lifetimes, so it can only produce a new result if one of
+      // those inputs was actually constrained since the last run; otherwise
+      // reuse the previous result instead of repeating the whole fixpoint.
+      bool reuse_previous_result = false;
+      if (is_analyzed) {
+        bool inputs_changed = overrides_dirty.contains(func);
+        for (const auto& callee : maybe_callees.get()) {
+          if (inputs_changed) break;
+          inputs_changed = overrides_dirty.contains(callee);
+        }
+        reuse_previous_result = !inputs_changed;
+      }
+      if (!reuse_previous_result) {
+        auto analysis_result = AnalyzeSingleFunction(func, analyzed,
+                                                     diag_reporter, cfg_cache,
+                                                     debug_info);
+        if (!analysis_result) {
+          analyzed[func] = FunctionAnalysisError(analysis_result.takeError());
         } else {
-          analyzed[func] = func_lifetimes_result.get();
+          auto func_lifetimes_result = ConstructFunctionLifetimes(
+              func, std::move(analysis_result.get()), diag_reporter);
+          if (!func_lifetimes_result) {
+            analyzed[func] =
+                FunctionAnalysisError(func_lifetimes_result.takeError());
+          } else {
+            // During an overrides traversal, dependents only get re-analyzed
+            // if this result really changed.
+            if (is_analyzed) {
+              FunctionLifetimesOrError& existing = analyzed[func];
+              if (!std::holds_alternative<FunctionLifetimes>(existing) ||
+                  !IsIsomorphic(std::get<FunctionLifetimes>(existing),
+                                func_lifetimes_result.get())) {
+                overrides_dirty.insert(func);
+              }
+            }
+            analyzed[func] = std::move(func_lifetimes_result.get());
+          }
         }
       }
     } else {
@@ -1271,7 +1374,7 @@ void AnalyzeFunctionRecursive(
         llvm::ArrayRef<VisitedCallStackEntry>(visited).drop_front(
             func_in_visited);
     if (llvm::Error err = AnalyzeRecursiveFunctions(
-            funcs_in_cycle, analyzed, diag_reporter, debug_info)) {
+            funcs_in_cycle, analyzed, diag_reporter, cfg_cache, debug_info)) {
       for (const auto [func_in_cycle, _1, _2] : funcs_in_cycle) {
         analyzed[func_in_cycle] = FunctionAnalysisError(err);
       }
@@ -1282,7 +1385,8 @@ void AnalyzeFunctionRecursive(
   // need to be (recursively) updated with the results of the overrides.
   if (in_overrides_traversal) {
     if (llvm::Error err =
-            UpdateFunctionLifetimesWithOverrides(func, analyzed, overrides)) {
+            UpdateFunctionLifetimesWithOverrides(func, analyzed, overrides,
+                                                 overrides_dirty)) {
       analyzed[func] = FunctionAnalysisError(err);
     }
   }
@@ -1293,6 +1397,35 @@ void AnalyzeFunctionRecursive(
   visited.resize(func_in_visited);
 }
 
+// Forward declaration; defined with the other USR helpers below.
+std::string GetFunctionUSRString(const clang::Decl* func);
+
+// Records the lifetimes from `imported_summaries` for the matching function
+// definitions in `tu` into `analyzed`, so that the subsequent traversal
+// treats those functions as already analyzed. Summaries that fail to parse
+// against the local declaration (e.g. because the signature changed since
+// they were exported) are dropped, and the function is analyzed locally.
+void SeedFromImportedSummaries(
+    const clang::TranslationUnitDecl* tu,
+    const FunctionAnalysisSummaries& imported_summaries,
+    llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>&
+        analyzed) {
+  for (const clang::FunctionDecl* func : GetAllFunctionDefinitions(tu)) {
+    if (func->isTemplated()) continue;
+    func = func->getCanonicalDecl();
+    if (analyzed.count(func) > 0) continue;
+    auto iter = imported_summaries.find(GetFunctionUSRString(func));
+    if (iter == imported_summaries.end()) continue;
+    llvm::Expected<FunctionLifetimes> lifetimes =
+        ParseLifetimeAnnotations(func, iter->second);
+    if (!lifetimes) {
+      llvm::consumeError(lifetimes.takeError());
+      continue;
+    }
+    analyzed.insert({func, std::move(lifetimes.get())});
+  }
+}
+
 llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>
 AnalyzeTranslationUnitAndCollectTemplates(
     const clang::TranslationUnitDecl* tu,
@@ -1300,10 +1433,29 @@ AnalyzeTranslationUnitAndCollectTemplates(
     const DiagnosticReporter& diag_reporter, FunctionDebugInfoMap* debug_info,
     llvm::DenseMap<clang::FunctionTemplateDecl*, const clang::FunctionDecl*>&
         uninstantiated_templates,
-    const BaseToOverrides& base_to_overrides) {
+    const BaseToOverrides& base_to_overrides,
+    const FunctionAnalysisSummaries* imported_summaries = nullptr) {
   llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError> result;
+  if (imported_summaries != nullptr && !imported_summaries->empty()) {
+    SeedFromImportedSummaries(tu, *imported_summaries, result);
+  }
   llvm::SmallVector<VisitedCallStackEntry> visited;
-
+  // One CFG cache for the whole traversal, so that the overrides
+  // re-traversal and recursive-cycle fixpoints reuse each function's CFG.
+  // Scoped to this function because the cached CFGs point into `tu`'s
+  // ASTContext.
+  crubit::FunctionCfgCache cfg_cache;
+  // Functions whose recorded lifetimes changed during the overrides
+  // traversal; dependents are only re-analyzed when one of their callees
+  // appears here.
+  llvm::DenseSet<const clang::FunctionDecl*> overrides_dirty;
+
+  // Functions in disjoint call-graph components are logically independent,
+  // but they cannot be analyzed on separate threads: they share one
+  // ASTContext, and the analysis mutates lazily-initialized AST state
+  // through it (CFG construction, record layout and other type queries), so
+  // the traversal stays sequential with the recursion handling callees and
+  // cycles on demand.
   for (const clang::FunctionDecl* func : GetAllFunctionDefinitions(tu)) {
     // Skip templated functions.
     if (func->isTemplated()) {
@@ -1328,7 +1480,8 @@ AnalyzeTranslationUnitAndCollectTemplates(
     // function before.
 
     AnalyzeFunctionRecursive(result, visited, func, lifetime_context,
-                             diag_reporter, debug_info, base_to_overrides);
+                             diag_reporter, cfg_cache, overrides_dirty,
+                             debug_info, base_to_overrides);
   }
 
   return result;
@@ -1345,6 +1498,21 @@ std::string GetFunctionUSRString(const clang::Decl* func) {
   return std::string(usr.data(), usr.size());
 }
 
+// Memoizes `GetFunctionUSRString` per canonical declaration. USR generation
+// re-walks the whole decl context chain on every call, and the merge step
+// below asks for the same template's USR once per specialization of it.
+class FunctionUSRCache {
+ public:
+  const std::string& Get(const clang::Decl* decl) {
+    auto [iter, inserted] = cache_.try_emplace(decl->getCanonicalDecl());
+    if (inserted) iter->second = GetFunctionUSRString(decl);
+    return iter->second;
+  }
+
+ private:
+  llvm::DenseMap<const clang::Decl*, std::string> cache_;
+};
+
 // Run AnalyzeFunctionRecursive with `context`. Report results through
 // `result_callback` and update `debug_info` using USR strings to map functions
 // to the original ASTContext.
@@ -1361,6 +1529,10 @@ void AnalyzeTemplateFunctionsInSeparateASTContext(
       inner_result;
   llvm::SmallVector<VisitedCallStackEntry> inner_visited;
   FunctionDebugInfoMap inner_debug_info;
+  // Scoped to this function: the cached CFGs point into `context`, which is
+  // destroyed when the placeholder tool invocation returns.
+  crubit::FunctionCfgCache cfg_cache;
+  llvm::DenseSet<const clang::FunctionDecl*> overrides_dirty;
 
   for (const clang::FunctionDecl* func :
        GetAllFunctionDefinitions(context.getTranslationUnitDecl())) {
@@ -1368,19 +1540,21 @@ void AnalyzeTemplateFunctionsInSeparateASTContext(
     if (func->isTemplated()) continue;
 
     AnalyzeFunctionRecursive(inner_result, inner_visited, func,
-                             lifetime_context, diag_reporter, &inner_debug_info,
+                             lifetime_context, diag_reporter, cfg_cache,
+                             overrides_dirty, &inner_debug_info,
                              base_to_overrides);
   }
 
   // We need to remap the results with FunctionDecl* in the
   // original ASTContext. (Because this context goes away after
   // this)
+  FunctionUSRCache usr_cache;
   llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>
       merged_result = initial_result;
   for (const auto& [decl, lifetimes_or_error] : inner_result) {
     if (!decl->isFunctionTemplateSpecialization()) continue;
     auto* tmpl = decl->getTemplateSpecializationInfo()->getTemplate();
-    auto iter = template_usr_to_decl.find(GetFunctionUSRString(tmpl));
+    auto iter = template_usr_to_decl.find(usr_cache.Get(tmpl));
     if (iter != template_usr_to_decl.end()) {
       merged_result.insert({iter->second, lifetimes_or_error});
     }
@@ -1391,7 +1565,7 @@ void AnalyzeTemplateFunctionsInSeparateASTContext(
   for (auto& [decl, info] : inner_debug_info) {
     if (!decl->isFunctionTemplateSpecialization()) continue;
     auto* tmpl = decl->getTemplateSpecializationInfo()->getTemplate();
-    auto iter = template_usr_to_decl.find(GetFunctionUSRString(tmpl));
+    auto iter = template_usr_to_decl.find(usr_cache.Get(tmpl));
     if (iter != template_usr_to_decl.end()) (*debug_info)[iter->second] = info;
   }
 }
@@ -1430,9 +1604,12 @@ FunctionLifetimesOrError AnalyzeFunction(
   }
   DiagnosticReporter diag_reporter =
       DiagReporterForDiagEngine(func->getASTContext().getDiagnostics());
+  crubit::FunctionCfgCache cfg_cache;
+  llvm::DenseSet<const clang::FunctionDecl*> overrides_dirty;
   AnalyzeFunctionRecursive(
-      analyzed, visited, func, lifetime_context, diag_reporter,
-      debug_info_map ? &debug_info_map.value() : nullptr, BaseToOverrides());
+      analyzed, visited, func, lifetime_context, diag_reporter, cfg_cache,
+      overrides_dirty, debug_info_map ? &debug_info_map.value() : nullptr,
+      BaseToOverrides());
   if (debug_info) {
     *debug_info = debug_info_map->lookup(func);
   }
@@ -1443,7 +1620,8 @@ llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>
 AnalyzeTranslationUnit(const clang::TranslationUnitDecl* tu,
                        const LifetimeAnnotationContext& lifetime_context,
                        DiagnosticReporter diag_reporter,
-                       FunctionDebugInfoMap* debug_info) {
+                       FunctionDebugInfoMap* debug_info,
+                       const FunctionAnalysisSummaries* imported_summaries) {
   if (!diag_reporter) {
     diag_reporter =
         DiagReporterForDiagEngine(tu->getASTContext().getDiagnostics());
@@ -1460,11 +1638,49 @@ AnalyzeTranslationUnit(const clang::TranslationUnitDecl* tu,
   llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError> result =
       AnalyzeTranslationUnitAndCollectTemplates(
           tu, lifetime_context, diag_reporter, debug_info,
-          uninstantiated_templates, base_to_overrides);
+          uninstantiated_templates, base_to_overrides, imported_summaries);
 
   return result;
 }
 
+FunctionAnalysisSummaries ExportFunctionSummaries(
+    const llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>&
+        analysis_result) {
+  FunctionAnalysisSummaries summaries;
+  for (const auto& [func, lifetimes_or_error] : analysis_result) {
+    const auto* lifetimes = std::get_if<FunctionLifetimes>(&lifetimes_or_error);
+    if (lifetimes == nullptr) {
+      continue;
+    }
+    // A fresh symbol table per function: summary strings only need to be
+    // consistent within one signature.
+    LifetimeSymbolTable symbol_table;
+    bool has_local_lifetime = false;
+    std::string serialized = lifetimes->DebugString(
+        [&symbol_table, &has_local_lifetime](Lifetime l) -> std::string {
+          if (l.IsLocal()) {
+            has_local_lifetime = true;
+            return "local";
+          }
+          if (l == Lifetime::Static()) {
+            return "static";
+          }
+          return symbol_table.LookupLifetimeAndMaybeDeclare(l).str();
+        });
+    if (has_local_lifetime) {
+      continue;
+    }
+    summaries[GetFunctionUSRString(func)] = std::move(serialized);
+  }
+  return summaries;
+}
+
+// Note on sharing: every uninstantiated template is analyzed exactly once,
+// against one explicit instantiation with an opaque placeholder type (see
+// GenerateTemplateInstantiationCode), and the single FunctionLifetimes
+// result is keyed by the template's USR. All uses of the template share that
+// result by construction, so substitution-invariant templates do not get
+// re-analyzed per use; only the placeholder variant itself is ever analyzed.
 void AnalyzeTranslationUnitWithTemplatePlaceholder(
     const clang::TranslationUnitDecl* tu,
     const LifetimeAnnotationContext& lifetime_context,
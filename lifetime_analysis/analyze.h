@@ -6,6 +6,7 @@
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_ANALYZE_H_
 
 #include <functional>
+#include <map>
 #include <string>
 #include <variant>
 
@@ -48,6 +49,22 @@ bool IsIsomorphic(const FunctionLifetimes& a, const FunctionLifetimes& b);
 using FunctionDebugInfoMap =
     llvm::DenseMap<const clang::FunctionDecl*, FunctionDebugInfo>;
 
+// Serialized analysis results, keyed by function USR. Each value is the
+// `ParseLifetimeAnnotations`-compatible rendering of the function's
+// `FunctionLifetimes` (e.g. "a, b -> a"). USRs are stable across ASTContexts
+// and processes, so summaries exported from one invocation can seed another
+// one that sees the same declarations; the ordered map makes exports
+// deterministic.
+using FunctionAnalysisSummaries = std::map<std::string, std::string>;
+
+// Serializes the successfully analyzed functions in `analysis_result` into
+// summaries. Functions that failed to analyze are skipped, as are the rare
+// functions whose signature lifetimes reference local lifetimes (those have
+// no re-parseable rendering).
+FunctionAnalysisSummaries ExportFunctionSummaries(
+    const llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>&
+        analysis_result);
+
 // Runs a static analysis on `func` and returns the result.
 FunctionLifetimesOrError AnalyzeFunction(
     const clang::FunctionDecl* func,
@@ -56,11 +73,21 @@ FunctionLifetimesOrError AnalyzeFunction(
 
 // Runs a static analysis on all function definitions in `tu`.
 // The map that is returned references functions by their canonical declaration.
+// If `imported_summaries` is non-null, functions defined in `tu` whose USR
+// appears there are not re-analyzed: their lifetimes are parsed from the
+// summary and recorded as if the analysis had computed them, and their
+// callees are not visited on their behalf. Together with
+// `ExportFunctionSummaries` this lets the analysis of one large TU be
+// partitioned across processes: each worker analyzes a subset of the call
+// graph and exports summaries, and a merging invocation imports them and
+// only analyzes what is missing.
 llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>
 AnalyzeTranslationUnit(const clang::TranslationUnitDecl* tu,
                        const LifetimeAnnotationContext& lifetime_context,
                        DiagnosticReporter diag_reporter = {},
-                       FunctionDebugInfoMap* debug_info = nullptr);
+                       FunctionDebugInfoMap* debug_info = nullptr,
+                       const FunctionAnalysisSummaries* imported_summaries =
+                           nullptr);
 
 // Callback that is used to report function analysis results.
 // Do not retain the `FunctionDecl*`, the `FunctionLifetimes`, or other objects
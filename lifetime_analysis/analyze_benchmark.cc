@@ -0,0 +1,137 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Benchmarks for the lifetime analysis itself (as opposed to annotation
+// parsing or bindings generation). The inputs are generated programmatically
+// so that individual scalability dimensions -- loop nesting depth, pointer
+// density within a function, and call-graph size -- can be swept
+// independently through benchmark arguments.
+//
+// Run with:
+//   bazel run -c opt //lifetime_analysis:analyze_benchmark
+
+#include <cstdint>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "lifetime_analysis/analyze.h"
+#include "lifetime_annotations/lifetime_annotations.h"
+#include "lifetime_annotations/test/run_on_code.h"
+#include "clang/AST/ASTContext.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang {
+namespace tidy {
+namespace lifetimes {
+namespace {
+
+// Analyzes `code` once per benchmark iteration. Each iteration re-parses the
+// code, so the reported time includes the Clang frontend; `num_functions` is
+// reported as items so that throughput is comparable across inputs of
+// different sizes.
+void RunAnalysisBenchmark(benchmark::State& state, const std::string& code,
+                          int64_t num_functions) {
+  for (auto _ : state) {
+    bool success = runOnCodeWithLifetimeHandlers(
+        code,
+        [](clang::ASTContext& ast_context,
+           const LifetimeAnnotationContext& lifetime_context) {
+          auto result = AnalyzeTranslationUnit(
+              ast_context.getTranslationUnitDecl(), lifetime_context);
+          benchmark::DoNotOptimize(result);
+        },
+        {});
+    if (!success) {
+      state.SkipWithError("failed to analyze generated code");
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_functions);
+}
+
+// A single function containing `depth` nested loops, each of which swaps two
+// pointers. Every additional nesting level adds a back edge, so this sweeps
+// the number of fixpoint iterations the dataflow framework needs before the
+// points-to maps stabilize.
+std::string GenerateNestedLoops(int depth) {
+  std::string body;
+  for (int i = 0; i < depth; ++i) {
+    absl::StrAppend(&body, "for (int i", i, " = 0; i", i, " < n; ++i", i,
+                    ") {\n");
+  }
+  absl::StrAppend(&body, "int* tmp = p; p = q; q = tmp;\n");
+  for (int i = 0; i < depth; ++i) {
+    absl::StrAppend(&body, "}\n");
+  }
+  return absl::StrCat("int* Target(int* p, int* q, int n) {\n", body,
+                      "return p;\n}\n");
+}
+
+void BM_AnalyzeNestedLoops(benchmark::State& state) {
+  RunAnalysisBenchmark(state, GenerateNestedLoops(state.range(0)),
+                       /*num_functions=*/1);
+}
+BENCHMARK(BM_AnalyzeNestedLoops)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Unit(benchmark::kMillisecond);
+
+// A single function with `num_pointers` pointer locals that are repeatedly
+// shuffled inside one loop. This grows the points-to maps that the lattice
+// join and equality checks have to walk on every fixpoint iteration.
+std::string GeneratePointerDense(int num_pointers) {
+  std::string decls;
+  std::string shuffles;
+  for (int i = 0; i < num_pointers; ++i) {
+    absl::StrAppendFormat(&decls, "int* p%d = a;\n", i);
+    absl::StrAppendFormat(&shuffles, "p%d = p%d;\n", i,
+                          (i + 1) % num_pointers);
+  }
+  return absl::StrCat("int* Target(int* a, int n) {\n", decls,
+                      "for (int i = 0; i < n; ++i) {\n", shuffles,
+                      "}\nreturn p0;\n}\n");
+}
+
+void BM_AnalyzePointerDense(benchmark::State& state) {
+  RunAnalysisBenchmark(state, GeneratePointerDense(state.range(0)),
+                       /*num_functions=*/1);
+}
+BENCHMARK(BM_AnalyzePointerDense)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->Unit(benchmark::kMillisecond);
+
+// A chain of `num_functions` pointer-returning functions, each calling the
+// next. AnalyzeTranslationUnit analyzes callees before callers and
+// substitutes callee lifetimes at each call site, so this sweeps the
+// call-graph dimension.
+std::string GenerateCallChain(int num_functions) {
+  std::string code = "int* F0(int* p) { return p; }\n";
+  for (int i = 1; i < num_functions; ++i) {
+    absl::StrAppendFormat(&code, "int* F%d(int* p) { return F%d(p); }\n", i,
+                          i - 1);
+  }
+  return code;
+}
+
+void BM_AnalyzeCallChain(benchmark::State& state) {
+  RunAnalysisBenchmark(state, GenerateCallChain(state.range(0)),
+                       state.range(0));
+}
+BENCHMARK(BM_AnalyzeCallChain)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace lifetimes
+}  // namespace tidy
+}  // namespace clang
+
+BENCHMARK_MAIN();
@@ -47,6 +47,39 @@ class ForwardAndMoveFactory : public FunctionLifetimeFactory {
   }
 };
 
+// Lifetime annotation signatures for the builtins we understand, in the
+// format accepted by `ParseLifetimeAnnotations`. The table is data, not code:
+// adding support for a builtin is one line here (unless it needs a custom
+// factory, like `forward` and `move` below).
+struct BuiltinLifetimeSignature {
+  unsigned builtin_id;
+  const char* lifetimes;
+};
+
+constexpr BuiltinLifetimeSignature kBuiltinLifetimeSignatures[] = {
+    {clang::Builtin::BI__builtin_addressof, "a -> a"},
+    {clang::Builtin::BIstrtod, "a, (a, b)"},
+    {clang::Builtin::BIstrtof, "a, (a, b)"},
+    {clang::Builtin::BIstrtoll, "a, (a, b), ()"},
+    {clang::Builtin::BIstrtol, "a, (a, b), ()"},
+    {clang::Builtin::BI__builtin_memchr, "a, (), () -> a"},
+    {clang::Builtin::BI__builtin_strchr, "a, () -> a"},
+    {clang::Builtin::BI__builtin_strrchr, "a, () -> a"},
+    {clang::Builtin::BI__builtin_strstr, "a, b -> a"},
+    {clang::Builtin::BI__builtin_strpbrk, "a, b -> a"},
+};
+
+// Returns the annotation signature for `builtin_id`, or null if the builtin
+// is not in the table.
+const char* FindBuiltinLifetimeSignature(unsigned builtin_id) {
+  for (const BuiltinLifetimeSignature& entry : kBuiltinLifetimeSignatures) {
+    if (entry.builtin_id == builtin_id) {
+      return entry.lifetimes;
+    }
+  }
+  return nullptr;
+}
+
 }  // namespace
 
 FunctionLifetimesOrError GetBuiltinLifetimes(const clang::FunctionDecl* decl) {
@@ -64,29 +97,14 @@ FunctionLifetimesOrError GetBuiltinLifetimes(const clang::FunctionDecl* decl) {
                }))
         .get();
   }
+  if (const char* signature = FindBuiltinLifetimeSignature(builtin_id)) {
+    return ParseLifetimeAnnotations(decl, signature).get();
+  }
   switch (builtin_id) {
-    case clang::Builtin::BI__builtin_addressof:
-      return ParseLifetimeAnnotations(decl, "a -> a").get();
-    case clang::Builtin::BIstrtod:
-    case clang::Builtin::BIstrtof:
-      return ParseLifetimeAnnotations(decl, "a, (a, b)").get();
-    case clang::Builtin::BIstrtoll:
-    case clang::Builtin::BIstrtol:
-      return ParseLifetimeAnnotations(decl, "a, (a, b), ()").get();
-    case clang::Builtin::BI__builtin_memchr:
-      return ParseLifetimeAnnotations(decl, "a, (), () -> a").get();
-    case clang::Builtin::BI__builtin_strchr:
-    case clang::Builtin::BI__builtin_strrchr:
-      return ParseLifetimeAnnotations(decl, "a, () -> a").get();
-    case clang::Builtin::BI__builtin_strstr:
-    case clang::Builtin::BI__builtin_strpbrk:
-      return ParseLifetimeAnnotations(decl, "a, b -> a").get();
     case clang::Builtin::BIforward:
-    case clang::Builtin::BImove: {
-      FunctionLifetimes result;
+    case clang::Builtin::BImove:
       return FunctionLifetimes::CreateForDecl(decl, ForwardAndMoveFactory())
           .get();
-    }
     // TODO(veluca): figure out variadic functions.
     default:
       return FunctionAnalysisError(
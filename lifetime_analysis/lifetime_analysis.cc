@@ -353,10 +353,27 @@ void LifetimeAnalysis::transfer(const clang::CFGElement& elt,
                                 clang::dataflow::Environment& /*environment*/) {
   if (state.IsError()) return;
 
+  if (--transfer_budget_ < 0) {
+    // Degrade gracefully: the error lattice propagates to the exit block, so
+    // this function gets a FunctionAnalysisError (surfaced like any other
+    // analysis failure) and the tool moves on to the next function instead
+    // of iterating indefinitely.
+    state = LifetimeLattice("lifetime analysis of '" +
+                            func_->getNameAsString() +
+                            "' exceeded its transfer-evaluation budget");
+    return;
+  }
+
   auto cfg_stmt = elt.getAs<clang::CFGStmt>();
   if (!cfg_stmt) return;
   auto stmt = cfg_stmt->getStmt();
 
+  // Note that there is no fast path that skips "pointer-free" statements:
+  // the analysis is required to record an object set for every glvalue
+  // expression, including ones of builtin type (`GetExprObjectSet` treats a
+  // missing entry as a fatal error), so even arithmetic-only statements
+  // change the lattice. Statement classes without a `Visit...` override
+  // already fall through the visitor as a no-op.
   TransferStmtVisitor visitor(object_repository_, state.PointsTo(),
                               state.Constraints(), state.SingleValuedObjects(),
                               func_, callee_lifetimes_, diag_reporter_);
@@ -769,15 +786,16 @@ std::optional<std::string> TransferStmtVisitor::VisitCXXThisExpr(
   return std::nullopt;
 }
 
-void SetExprObjectSetRespectingType(const clang::Expr* expr,
-                                    const ObjectSet& points_to,
-                                    PointsToMap& points_to_map,
-                                    clang::ASTContext& ast_context) {
+void SetExprObjectSetRespectingType(
+    const clang::Expr* expr, const ObjectSet& points_to,
+    PointsToMap& points_to_map, clang::ASTContext& ast_context,
+    PointerCompatibilityCache& compatibility_cache) {
   ObjectSet points_to_filtered;
 
   for (auto object : points_to) {
     if (expr->isGLValue()) {
-      if (PointeesCompatible(expr->getType(), object->Type(), ast_context)) {
+      if (compatibility_cache.PointeesCompatible(expr->getType(),
+                                                 object->Type(), ast_context)) {
         points_to_filtered.Add(object);
       }
     } else {
@@ -800,7 +818,8 @@ void SetExprObjectSetRespectingType(const clang::Expr* expr,
         expr_type = ast_context.getPointerType(expr_type);
       }
 
-      if (MayPointTo(expr_type, object->Type(), ast_context)) {
+      if (compatibility_cache.MayPointTo(expr_type, object->Type(),
+                                         ast_context)) {
         points_to_filtered.Add(object);
       }
     }
@@ -850,7 +869,7 @@ std::optional<std::string> TransferStmtVisitor::VisitCallExpr(
       [&callees, call,
        this](const clang::FunctionDecl* decl) -> std::optional<std::string> {
     const FunctionLifetimesOrError& callee_lifetimes_or_error =
-        GetFunctionLifetimes(decl, callee_lifetimes_);
+        object_repository_.GetCalleeLifetimes(decl, callee_lifetimes_);
 
     if (!std::holds_alternative<FunctionLifetimes>(callee_lifetimes_or_error)) {
       return "No lifetimes for callee '" + decl->getNameAsString() + "': " +
@@ -60,17 +60,28 @@ class LifetimeAnalysis
     : public clang::dataflow::DataflowAnalysis<LifetimeAnalysis,
                                                LifetimeLattice> {
  public:
+  // Maximum number of transfer-function evaluations for one function before
+  // the analysis gives up and reports an error for it (which callers already
+  // treat as "lifetimes could not be inferred"). The count is proportional
+  // to statements times fixpoint iterations, so unlike a wall-clock cap it
+  // is deterministic across machines. The default never triggers on
+  // reasonable code; it exists so that one pathological function cannot
+  // stall the whole tool.
+  static constexpr int64_t kDefaultTransferBudget = 10'000'000;
+
   explicit LifetimeAnalysis(
       const clang::FunctionDecl* func, ObjectRepository& object_repository,
       const llvm::DenseMap<const clang::FunctionDecl*,
                            FunctionLifetimesOrError>& callee_lifetimes,
-      const DiagnosticReporter& diag_reporter)
+      const DiagnosticReporter& diag_reporter,
+      int64_t transfer_budget = kDefaultTransferBudget)
       : clang::dataflow::DataflowAnalysis<LifetimeAnalysis, LifetimeLattice>(
             func->getASTContext(), /*ApplyBuiltinTransfer=*/false),
         func_(func),
         object_repository_(object_repository),
         callee_lifetimes_(callee_lifetimes),
-        diag_reporter_(diag_reporter) {}
+        diag_reporter_(diag_reporter),
+        transfer_budget_(transfer_budget) {}
 
   LifetimeLattice initialElement();
 
@@ -94,6 +105,8 @@ class LifetimeAnalysis
   const llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>&
       callee_lifetimes_;
   const DiagnosticReporter& diag_reporter_;
+  // Remaining transfer evaluations; decremented by `transfer`.
+  int64_t transfer_budget_;
 };
 
 }  // namespace lifetimes
@@ -4,9 +4,14 @@
 
 #include "lifetime_analysis/lifetime_constraints.h"
 
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallVector.h>
 
 #include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "lifetime_annotations/lifetime.h"
 #include "lifetime_annotations/lifetime_substitutions.h"
@@ -18,14 +23,38 @@ namespace lifetimes {
 
 clang::dataflow::LatticeJoinEffect LifetimeConstraints::join(
     const LifetimeConstraints& other) {
+  // Undiverged copies carry identical constraints; nothing to merge.
+  if (constraints_ == other.constraints_) {
+    return clang::dataflow::LatticeJoinEffect::Unchanged;
+  }
+  // Joining into an empty set can share `other`'s state wholesale.
+  if (constraints_->empty()) {
+    if (other.constraints_->empty()) {
+      return clang::dataflow::LatticeJoinEffect::Unchanged;
+    }
+    constraints_ = other.constraints_;
+    return clang::dataflow::LatticeJoinEffect::Changed;
+  }
   bool changed = false;
-  for (auto p : other.outlives_constraints_) {
-    changed |= outlives_constraints_.insert(p).second;
+  for (const auto& p : *other.constraints_) {
+    // Check before inserting so that a join that adds nothing (the common
+    // case once the fixpoint is near) never clones the shared set.
+    if (!constraints_->contains(p)) {
+      Mutable().insert(p);
+      changed = true;
+    }
   }
   return changed ? clang::dataflow::LatticeJoinEffect::Changed
                  : clang::dataflow::LatticeJoinEffect::Unchanged;
 }
 
+LifetimeConstraints::ConstraintSet& LifetimeConstraints::Mutable() {
+  if (constraints_.use_count() != 1) {
+    constraints_ = std::make_shared<ConstraintSet>(*constraints_);
+  }
+  return *constraints_;
+}
+
 namespace {
 
 // Simple Disjoint-Set-Union with path compression (but no union-by-rank). This
@@ -49,30 +78,51 @@ class LifetimeDSU {
   llvm::DenseMap<Lifetime, Lifetime> parent_;
 };
 
-}  // namespace
+// Adjacency-list view of a constraint set, mapping each lifetime to the
+// lifetimes that directly outlive it. Built once so that reachability queries
+// don't have to rescan the whole constraint set for every node they visit.
+using ConstraintGraph =
+    llvm::DenseMap<Lifetime, llvm::SmallVector<Lifetime, 2>>;
+
+ConstraintGraph BuildConstraintGraph(
+    const llvm::DenseSet<std::pair<Lifetime, Lifetime>>& constraints) {
+  ConstraintGraph graph;
+  for (const auto& [shorter, longer] : constraints) {
+    graph[shorter].push_back(longer);
+  }
+  return graph;
+}
 
-llvm::DenseSet<Lifetime> LifetimeConstraints::GetOutlivingLifetimes(
-    const Lifetime l) const {
-  // TODO(veluca): here we could certainly reduce complexity, for example by
-  // constructing the constraint graph instead of iterating over all constraints
-  // each time.
+// Returns all lifetimes that `graph` says must (transitively) outlive `l`,
+// not including `l` itself.
+llvm::DenseSet<Lifetime> CollectOutlivingLifetimes(const ConstraintGraph& graph,
+                                                   Lifetime l) {
   std::vector<Lifetime> stack{l};
   llvm::DenseSet<Lifetime> visited;
   while (!stack.empty()) {
     Lifetime v = stack.back();
     stack.pop_back();
-    if (visited.contains(v)) continue;
-    visited.insert(v);
-    for (auto [shorter, longer] : outlives_constraints_) {
-      if (shorter == v) {
-        stack.push_back(longer);
-      }
+    if (!visited.insert(v).second) continue;
+    auto iter = graph.find(v);
+    if (iter == graph.end()) continue;
+    for (Lifetime longer : iter->second) {
+      stack.push_back(longer);
     }
   }
   visited.erase(l);
   return visited;
 }
 
+}  // namespace
+
+llvm::DenseSet<Lifetime> LifetimeConstraints::GetOutlivingLifetimes(
+    const Lifetime l) const {
+  // Callers that query many lifetimes against the same constraint set should
+  // build the graph once and use CollectOutlivingLifetimes() directly, as
+  // ApplyToFunctionLifetimes() and ForCallableSubstitution() do.
+  return CollectOutlivingLifetimes(BuildConstraintGraph(*constraints_), l);
+}
+
 llvm::Error LifetimeConstraints::ApplyToFunctionLifetimes(
     FunctionLifetimes& function_lifetimes) {
   // We want to make output-only lifetimes as long as possible; thus, we collect
@@ -97,8 +147,11 @@ llvm::Error LifetimeConstraints::ApplyToFunctionLifetimes(
   // computed.
   llvm::DenseSet<Lifetime> already_have_substitutions;
 
+  ConstraintGraph constraint_graph = BuildConstraintGraph(*constraints_);
+
   // First of all, substitute everything that outlives 'static with 'static.
-  for (Lifetime outlives_static : GetOutlivingLifetimes(Lifetime::Static())) {
+  for (Lifetime outlives_static :
+       CollectOutlivingLifetimes(constraint_graph, Lifetime::Static())) {
     if (outlives_static.IsLocal()) {
       return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                      "Function assigns local to static");
@@ -114,7 +167,8 @@ llvm::Error LifetimeConstraints::ApplyToFunctionLifetimes(
   }
 
   for (Lifetime lifetime : all_interesting_lifetimes) {
-    llvm::DenseSet<Lifetime> longer_lifetimes = GetOutlivingLifetimes(lifetime);
+    llvm::DenseSet<Lifetime> longer_lifetimes =
+        CollectOutlivingLifetimes(constraint_graph, lifetime);
     longer_lifetimes.erase(Lifetime::Static());
 
     // If constrained to be outlived by 'local, replace the lifetime with
@@ -302,9 +356,12 @@ LifetimeConstraints LifetimeConstraints::ForCallableSubstitution(
   callable.Traverse(
       [&all_lifetimes](Lifetime l, Variance) { all_lifetimes.insert(l); });
 
+  ConstraintGraph constraint_graph =
+      BuildConstraintGraph(constraints.AllConstraints());
+
   LifetimeConstraints ret;
   for (auto l : all_lifetimes) {
-    for (auto outliving : constraints.GetOutlivingLifetimes(l)) {
+    for (auto outliving : CollectOutlivingLifetimes(constraint_graph, l)) {
       if (all_lifetimes.contains(outliving)) {
         ret.AddOutlivesConstraint(l, outliving);
       }
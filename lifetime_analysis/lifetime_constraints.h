@@ -5,6 +5,9 @@
 #ifndef THIRD_PARTY_CRUBIT_LIFETIME_ANALYSIS_LIFETIME_CONSTRAINTS_H_
 #define THIRD_PARTY_CRUBIT_LIFETIME_ANALYSIS_LIFETIME_CONSTRAINTS_H_
 
+#include <memory>
+#include <utility>
+
 #include "lifetime_annotations/function_lifetimes.h"
 #include "lifetime_annotations/lifetime.h"
 #include "clang/Analysis/FlowSensitive/DataflowLattice.h"
@@ -14,10 +17,16 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+// A set of "outlives" constraints between lifetimes.
+//
+// The constraint set is held behind a shared, copy-on-write state, like the
+// maps in `PointsToMap`: copying a `LifetimeConstraints` (which happens with
+// every lattice clone at CFG block boundaries) only bumps a reference count,
+// and joins between undiverged copies are O(1).
 class LifetimeConstraints {
  public:
   // Creates empty constraints.
-  LifetimeConstraints() {}
+  LifetimeConstraints() : constraints_(std::make_shared<ConstraintSet>()) {}
 
   // Returns the constraints on `callable` that allow `replacement_callable` to
   // be used where `callable` is requested.
@@ -33,7 +42,7 @@ class LifetimeConstraints {
 
   // Imposes the constraint shorter <= longer.
   void AddOutlivesConstraint(Lifetime shorter, Lifetime longer) {
-    outlives_constraints_.insert({shorter, longer});
+    Mutable().insert({shorter, longer});
   }
 
   // Returns all the lifetimes that this set of constraints implies must outlive
@@ -48,17 +57,25 @@ class LifetimeConstraints {
   llvm::Error ApplyToFunctionLifetimes(FunctionLifetimes& function_lifetimes);
 
   bool operator==(const LifetimeConstraints& other) const {
-    return outlives_constraints_ == other.outlives_constraints_;
+    return constraints_ == other.constraints_ ||
+           *constraints_ == *other.constraints_;
   }
 
   // Accessor for debug purposes.
   const llvm::DenseSet<std::pair<Lifetime, Lifetime>>& AllConstraints() const {
-    return outlives_constraints_;
+    return *constraints_;
   }
 
  private:
   // Constraints of the form p.first <= p.second
-  llvm::DenseSet<std::pair<Lifetime, Lifetime>> outlives_constraints_;
+  using ConstraintSet = llvm::DenseSet<std::pair<Lifetime, Lifetime>>;
+
+  // Returns the constraint set for mutation, cloning it first if it is
+  // shared with another `LifetimeConstraints`.
+  ConstraintSet& Mutable();
+
+  // Never null.
+  std::shared_ptr<ConstraintSet> constraints_;
 };
 
 }  // namespace lifetimes
@@ -51,7 +51,7 @@ const ObjectSet& LifetimeLattice::SingleValuedObjects() const {
 }
 
 llvm::StringRef LifetimeLattice::Error() const {
-  return std::get<std::string>(var_);
+  return *std::get<ErrorState>(var_);
 }
 
 clang::dataflow::LatticeJoinEffect LifetimeLattice::join(
@@ -67,16 +67,24 @@ clang::dataflow::LatticeJoinEffect LifetimeLattice::join(
   auto effect = Constraints().join(other.Constraints());
 
   PointsToMap joined_points_to_map = PointsTo().Union(other.PointsTo());
-  if (PointsTo() != joined_points_to_map) {
+  // `Union` shares this map's state exactly when `other` added nothing, so
+  // convergence is detectable without walking the maps.
+  if (!PointsTo().SharesStateWith(joined_points_to_map)) {
     PointsTo() = std::move(joined_points_to_map);
     effect = clang::dataflow::LatticeJoinEffect::Changed;
   }
 
-  ObjectSet joined_single_valued_objects =
-      SingleValuedObjects().Intersection(other.SingleValuedObjects());
-  if (SingleValuedObjects() != joined_single_valued_objects) {
-    SingleValuedObjects() = std::move(joined_single_valued_objects);
-    effect = clang::dataflow::LatticeJoinEffect::Changed;
+  // Skip the intersection when the sets are already equal: once a region of
+  // the CFG has converged, every further join lands here, and the equality
+  // walk over two small sorted vectors is cheaper than materializing an
+  // intersection that would compare equal anyway.
+  if (SingleValuedObjects() != other.SingleValuedObjects()) {
+    ObjectSet joined_single_valued_objects =
+        SingleValuedObjects().Intersection(other.SingleValuedObjects());
+    if (SingleValuedObjects() != joined_single_valued_objects) {
+      SingleValuedObjects() = std::move(joined_single_valued_objects);
+      effect = clang::dataflow::LatticeJoinEffect::Changed;
+    }
   }
 
   return effect;
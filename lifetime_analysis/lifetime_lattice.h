@@ -5,6 +5,7 @@
 #ifndef DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_LIFETIME_LATTICE_H_
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_LIFETIME_LATTICE_H_
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <variant>
@@ -20,6 +21,20 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+// The analysis state for one CFG block: a points-to map, the lifetime
+// constraints collected so far, and the set of single-valued objects (or, in
+// the error state, just an error message).
+//
+// The dataflow framework keeps one lattice per CFG block alive for the whole
+// analysis of a function, and it owns that storage -- there is no hook for
+// evicting or recomputing the state of blocks that have already stabilized.
+// Memory therefore scales with the number of blocks, but not with the full
+// size of each state: `PointsToMap` and `LifetimeConstraints` are
+// copy-on-write, so the lattices of all blocks that a given state merely
+// flowed through unchanged share a single underlying map. In practice this
+// means peak memory tracks the number of blocks whose states actually
+// diverge (roughly, the branchy and loopy parts of the function) rather than
+// the block count times the state size.
 class LifetimeLattice {
  public:
   // Creates a lattice holding an empty points-to map and empty constraints.
@@ -38,7 +53,12 @@ class LifetimeLattice {
                              std::move(single_valued_objects))) {}
 
   // Creates an error state containing the error message `err`.
-  explicit LifetimeLattice(std::string err) : var_(err) {}
+  // The message is allocated once here and shared immutably from then on:
+  // propagating the error state through joins and lattice copies only bumps
+  // a reference count, and the message itself is rendered only when the
+  // caller reports it (see `Error`).
+  explicit LifetimeLattice(std::string err)
+      : var_(std::make_shared<const std::string>(std::move(err))) {}
 
   // Returns the points-to map.
   // Precondition: !IsError().
@@ -61,7 +81,7 @@ class LifetimeLattice {
   const ObjectSet& SingleValuedObjects() const;
 
   // Returns whether the lattice is in the error state.
-  bool IsError() const { return std::holds_alternative<std::string>(var_); }
+  bool IsError() const { return std::holds_alternative<ErrorState>(var_); }
 
   // Returns the error string.
   // Precondition: IsError().
@@ -84,8 +104,11 @@ class LifetimeLattice {
   }
 
  private:
+  // Shared, immutable error message; never null in the error state.
+  using ErrorState = std::shared_ptr<const std::string>;
+
   std::variant<std::tuple<PointsToMap, LifetimeConstraints, ObjectSet>,
-               std::string>
+               ErrorState>
       var_;
 };
 
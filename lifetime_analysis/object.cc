@@ -4,7 +4,10 @@
 
 #include "lifetime_analysis/object.h"
 
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -17,16 +20,26 @@ namespace lifetimes {
 
 Object::Object(Lifetime lifetime, clang::QualType type,
                std::optional<FunctionLifetimes> func_lifetimes)
-    : lifetime_(lifetime),
-      type_(type),
-      func_lifetimes_(std::move(func_lifetimes)) {
+    : lifetime_(lifetime), type_(type) {
   assert(!type.isNull());
+  if (func_lifetimes.has_value()) {
+    func_lifetimes_ = std::make_unique<const std::optional<FunctionLifetimes>>(
+        std::move(func_lifetimes));
+  }
+}
+
+const std::optional<FunctionLifetimes>& Object::GetFuncLifetimes() const {
+  // Shared empty optional for the (common) objects that don't represent a
+  // function; never destroyed so that returned references stay valid.
+  static const std::optional<FunctionLifetimes>& empty =
+      *new std::optional<FunctionLifetimes>();
+  return func_lifetimes_ ? *func_lifetimes_ : empty;
 }
 
 std::string Object::DebugString() const {
   std::string result = absl::StrFormat("p%p %s", this, lifetime_.DebugString());
-  if (func_lifetimes_.has_value()) {
-    absl::StrAppend(&result, " (fn: ", func_lifetimes_->DebugString(), ")");
+  if (GetFuncLifetimes().has_value()) {
+    absl::StrAppend(&result, " (fn: ", GetFuncLifetimes()->DebugString(), ")");
   }
   if (!type_.isNull()) {
     absl::StrAppend(&result, " (", type_.getAsString(), ")");
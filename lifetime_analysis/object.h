@@ -7,6 +7,8 @@
 
 #include <atomic>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 
 #include "lifetime_annotations/function_lifetimes.h"
@@ -46,14 +48,17 @@ class Object {
 
   // Returns the lifetimes of function that this object represents, if known;
   // note that lifetimes may not be known even if GetFunc() returns non-null.
-  const std::optional<FunctionLifetimes>& GetFuncLifetimes() const {
-    return func_lifetimes_;
-  }
+  const std::optional<FunctionLifetimes>& GetFuncLifetimes() const;
 
  private:
   Lifetime lifetime_;
   clang::QualType type_;
-  std::optional<FunctionLifetimes> func_lifetimes_;
+  // Boxed, and null whenever the optional would be empty. Objects live
+  // densely in a bump allocator and the analysis reads their lifetime and
+  // type constantly while iterating ObjectSets; an inline
+  // optional<FunctionLifetimes> would blow each object up by an order of
+  // magnitude for a field that only the few function objects populate.
+  std::unique_ptr<const std::optional<FunctionLifetimes>> func_lifetimes_;
 };
 
 std::ostream& operator<<(std::ostream& os, Object object);
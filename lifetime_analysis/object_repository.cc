@@ -47,6 +47,42 @@ FunctionLifetimesOrError GetFunctionLifetimes(
   return known_lifetimes.lookup(decl->getCanonicalDecl());
 }
 
+namespace {
+
+// Returns whether objects of `type` can never carry points-to edges, i.e.
+// whether the type transitively contains no pointers, references or other
+// pointer-like parts. Conservatively returns false for any type it does not
+// understand (including incomplete types, which cannot be inspected).
+bool IsPointerFreeType(clang::QualType type) {
+  type = type.getCanonicalType();
+  if (type->isIncompleteType()) {
+    return false;
+  }
+  if (const auto* array_type =
+          clang::dyn_cast<clang::ArrayType>(type.getTypePtr())) {
+    return IsPointerFreeType(array_type->getElementType());
+  }
+  if (const auto* record_type = type->getAs<clang::RecordType>()) {
+    for (const clang::FieldDecl* field : record_type->getDecl()->fields()) {
+      if (!IsPointerFreeType(field->getType())) {
+        return false;
+      }
+    }
+    if (const auto* cxx_record =
+            clang::dyn_cast<clang::CXXRecordDecl>(record_type->getDecl())) {
+      for (const clang::CXXBaseSpecifier& base : cxx_record->bases()) {
+        if (!IsPointerFreeType(base.getType())) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+  return type->isBuiltinType() || type->isEnumeralType();
+}
+
+}  // namespace
+
 class ObjectRepository::VarDeclVisitor
     : public clang::RecursiveASTVisitor<VarDeclVisitor> {
  public:
@@ -221,11 +257,13 @@ class ObjectRepository::VarDeclVisitor
 
     Lifetime lifetime;
     LifetimeFactory lifetime_factory;
+    bool is_static = false;
 
     switch (var->getStorageClass()) {
       case clang::SC_Extern:
       case clang::SC_Static:
       case clang::SC_PrivateExtern:
+        is_static = true;
         lifetime = Lifetime::Static();
         lifetime_factory = [](const clang::Expr*) {
           return Lifetime::Static();
@@ -239,8 +277,17 @@ class ObjectRepository::VarDeclVisitor
         break;
     }
 
-    const Object* object = object_repository_.CreateObject(
-        var->getType(), lifetime, lifetime_factory);
+    // Globals and statics of pointer-free record type only get their root
+    // object up front; objects for their fields and bases are materialized
+    // if and when the analysis looks at them. A function that merely reads a
+    // few scalars out of a large global structure then never pays for the
+    // rest of it.
+    const Object* object =
+        is_static && var->getType()->isRecordType() &&
+                IsPointerFreeType(var->getType())
+            ? object_repository_.CreateLazyRecordObject(var->getType())
+            : object_repository_.CreateObject(var->getType(), lifetime,
+                                              lifetime_factory);
 
     object_repository_.object_repository_[var] = object;
     if (!var->getType()->isArrayType()) {
@@ -263,8 +310,8 @@ class ObjectRepository::VarDeclVisitor
       return;
     }
 
-    FunctionLifetimesOrError func_lifetimes =
-        GetFunctionLifetimes(func, callee_lifetimes_);
+    const FunctionLifetimesOrError& func_lifetimes =
+        object_repository_.GetCalleeLifetimes(func, callee_lifetimes_);
     if (std::holds_alternative<FunctionAnalysisError>(func_lifetimes)) {
       error_ = "No lifetimes for callee '" + func->getNameAsString() +
                "': " + std::get<FunctionAnalysisError>(func_lifetimes).message;
@@ -531,6 +578,28 @@ std::string ObjectRepository::DebugString() const {
   return result;
 }
 
+const FunctionLifetimesOrError& ObjectRepository::GetCalleeLifetimes(
+    const clang::FunctionDecl* decl,
+    const FunctionLifetimesMap& known_lifetimes) const {
+  if (decl->getBuiltinID() != 0) {
+    auto [iter, inserted] = callee_lifetimes_cache_.try_emplace(decl);
+    if (inserted) {
+      iter->second = GetBuiltinLifetimes(decl);
+    }
+    return iter->second;
+  }
+  if (auto iter = known_lifetimes.find(decl->getCanonicalDecl());
+      iter != known_lifetimes.end()) {
+    return iter->second;
+  }
+  auto [iter, inserted] = callee_lifetimes_cache_.try_emplace(decl);
+  if (inserted) {
+    iter->second = FunctionAnalysisError(
+        absl::StrCat("Unknown callee ", decl->getNameAsString()));
+  }
+  return iter->second;
+}
+
 const Object* ObjectRepository::GetDeclObject(
     const clang::ValueDecl* decl) const {
   auto iter = object_repository_.find(decl);
@@ -718,6 +787,7 @@ ObjectSet ObjectRepository::GetFieldObject(
 const Object* ObjectRepository::GetBaseClassObject(
     const Object* struct_object, const clang::Type* base) const {
   base = base->getCanonicalTypeInternal().getTypePtr();
+  MaterializeLazySubobjects(struct_object);
   auto iter = base_object_map_.find(std::make_pair(struct_object, base));
   if (iter == base_object_map_.end()) {
     llvm::errs() << "On object " << struct_object->DebugString()
@@ -840,6 +910,16 @@ struct ObjectRepository::ObjectCreator {
     }
 
     // Record type.
+    //
+    // Field and base objects are materialized eagerly, not on first
+    // pointer-relevant access: the recursion below also seeds the initial
+    // points-to edges for pointer-typed fields, and those edges must exist
+    // before the dataflow analysis computes any block state - an object
+    // created lazily mid-analysis would be missing from already-joined
+    // lattices. The per-field cost is bounded by `object_cache_` (see
+    // below), which shares one Object among all sub-objects with equal type
+    // and lifetimes, so e.g. forty scalar fields with the same lifetime
+    // produce one object, not forty.
     if (type->getAs<clang::RecordType>()) {
       ForEachFieldAndBase(
           type, object_lifetimes,
@@ -886,10 +966,72 @@ const Object* ObjectRepository::CreateObject(clang::QualType type,
 }
 
 template <typename... Args>
-const Object* ObjectRepository::ConstructObject(Args&&... args) {
+const Object* ObjectRepository::ConstructObject(Args&&... args) const {
   return new (object_allocator_.Allocate()) Object(args...);
 }
 
+const Object* ObjectRepository::CreateLazyRecordObject(clang::QualType type) {
+  ObjectLifetimes object_lifetimes(
+      Lifetime::Static(),
+      ValueLifetimes::Create(
+          type, [](const clang::Expr*) { return Lifetime::Static(); })
+          .get());
+  const Object* object = ConstructObject(Lifetime::Static(), type,
+                                         std::optional<FunctionLifetimes>());
+  initial_object_lifetimes_[object] = object_lifetimes;
+  lazy_record_objects_.insert({object, std::move(object_lifetimes)});
+  return object;
+}
+
+void ObjectRepository::MaterializeLazySubobjects(const Object* object) const {
+  auto iter = lazy_record_objects_.find(object);
+  if (iter == lazy_record_objects_.end()) {
+    return;
+  }
+  ObjectLifetimes object_lifetimes = std::move(iter->second);
+  // Erase before materializing so that this is a cheap no-op from then on.
+  lazy_record_objects_.erase(iter);
+  llvm::DenseMap<ObjectLifetimes, const Object*> object_cache;
+  MaterializeSubobjectsOf(object, object_lifetimes, object_cache);
+}
+
+const Object* ObjectRepository::GetOrMaterializeObject(
+    const ObjectLifetimes& object_lifetimes,
+    llvm::DenseMap<ObjectLifetimes, const Object*>& object_cache) const {
+  if (auto it = object_cache.find(object_lifetimes);
+      it != object_cache.end()) {
+    return it->second;
+  }
+  const Object* object =
+      ConstructObject(object_lifetimes.GetLifetime(), object_lifetimes.Type(),
+                      std::optional<FunctionLifetimes>());
+  object_cache[object_lifetimes] = object;
+  if (object_lifetimes.Type()->getAs<clang::RecordType>()) {
+    MaterializeSubobjectsOf(object, object_lifetimes, object_cache);
+  }
+  return object;
+}
+
+void ObjectRepository::MaterializeSubobjectsOf(
+    const Object* object, const ObjectLifetimes& object_lifetimes,
+    llvm::DenseMap<ObjectLifetimes, const Object*>& object_cache) const {
+  // Like `ObjectCreator::CreateObjectsRecursively`, this maps the fields of
+  // bases onto `object` as well (`ForEachFieldAndBase` recurses into bases),
+  // in addition to giving each base object its own field mappings.
+  ForEachFieldAndBase(
+      object_lifetimes.Type(), object_lifetimes,
+      [this, object, &object_cache](const ObjectLifetimes& field_lifetimes,
+                                    const clang::FieldDecl* field) {
+        field_object_map_[std::make_pair(object, field)] =
+            GetOrMaterializeObject(field_lifetimes, object_cache);
+      },
+      [this, object, &object_cache](const ObjectLifetimes& base_lifetimes,
+                                    const clang::Type* base_type) {
+        base_object_map_[std::make_pair(object, base_type)] =
+            GetOrMaterializeObject(base_lifetimes, object_cache);
+      });
+}
+
 // Clones an object and its base classes and fields, if any.
 const Object* ObjectRepository::CloneObject(const Object* object) {
   struct ObjectPair {
@@ -942,6 +1084,7 @@ const Object* ObjectRepository::CloneObject(const Object* object) {
 
 std::optional<const Object*> ObjectRepository::GetFieldObjectInternal(
     const Object* struct_object, const clang::FieldDecl* field) const {
+  MaterializeLazySubobjects(struct_object);
   auto iter = field_object_map_.find(std::make_pair(struct_object, field));
   if (iter != field_object_map_.end()) {
     return iter->second;
@@ -48,7 +48,10 @@ FunctionLifetimesOrError GetFunctionLifetimes(
 // declarations) and the objects that represent them. It also stores additional
 // information about objects that does not change during the analysis.
 // The `ObjectRepository` only stores state that does not change during the
-// analysis; it is therefore not part of the lattice.
+// analysis; it is therefore not part of the lattice. (Sub-objects of certain
+// global variables are materialized lazily behind the `const` accessors, but
+// what gets created is fully determined at construction time, so the
+// repository remains logically immutable; see `MaterializeLazySubobjects`.)
 class ObjectRepository {
  private:
   using MapType = llvm::DenseMap<const clang::ValueDecl*, const Object*>;
@@ -98,6 +101,16 @@ class ObjectRepository {
   // Returns the object associated with a variable or function.
   const Object* GetDeclObject(const clang::ValueDecl* decl) const;
 
+  // Like the free `GetFunctionLifetimes`, but memoizes expanded builtin
+  // lifetimes (and unknown-callee errors) for the duration of this
+  // function's analysis, so that the per-statement transfer functions do not
+  // re-parse builtin signatures on every fixpoint iteration. The returned
+  // reference is invalidated by the next call.
+  const FunctionLifetimesOrError& GetCalleeLifetimes(
+      const clang::FunctionDecl* decl,
+      const llvm::DenseMap<const clang::FunctionDecl*,
+                           FunctionLifetimesOrError>& known_lifetimes) const;
+
   // Returns the object associated with a materialize temporary expression.
   const Object* GetTemporaryObject(
       const clang::MaterializeTemporaryExpr* expr) const;
@@ -236,15 +249,45 @@ class ObjectRepository {
                              LifetimeFactory lifetime_factory);
 
   template <typename... Args>
-  const Object* ConstructObject(Args&&... args);
+  const Object* ConstructObject(Args&&... args) const;
 
   const Object* CloneObject(const Object* object);
 
+  // Creates only the root object for a global or static variable of a
+  // pointer-free record type and registers it in `lazy_record_objects_`;
+  // its field and base objects are materialized on first access.
+  const Object* CreateLazyRecordObject(clang::QualType type);
+
+  // If `object` is a lazy record root whose sub-objects have not been
+  // created yet, creates its field and base objects (recording them in
+  // `field_object_map_` and `base_object_map_`); otherwise does nothing.
+  void MaterializeLazySubobjects(const Object* object) const;
+
+  // Creates the object (and, recursively, the sub-objects) for one
+  // field or base encountered during lazy materialization. Like
+  // `ObjectCreator`, shares one object among all sub-objects with equal type
+  // and lifetimes via `object_cache`.
+  const Object* GetOrMaterializeObject(
+      const ObjectLifetimes& object_lifetimes,
+      llvm::DenseMap<ObjectLifetimes, const Object*>& object_cache) const;
+
+  // Records the field and base objects of `object` (creating them through
+  // `GetOrMaterializeObject` as needed) during lazy materialization.
+  void MaterializeSubobjectsOf(
+      const Object* object, const ObjectLifetimes& object_lifetimes,
+      llvm::DenseMap<ObjectLifetimes, const Object*>& object_cache) const;
+
   std::optional<const Object*> GetFieldObjectInternal(
       const Object* struct_object, const clang::FieldDecl* field) const;
 
   // Owns all the `const Object*` members of the object repository.
-  llvm::SpecificBumpPtrAllocator<Object> object_allocator_;
+  // This is a per-function bump arena: objects are allocated contiguously
+  // within slabs (an `ObjectRepository` is built for one analyzed function),
+  // their addresses serve as identities in `ObjectSet` and `PointsToMap`,
+  // and everything is freed in O(1) when the repository is destroyed.
+  // `mutable` so that lazily materialized sub-objects can be allocated
+  // behind the `const` accessors.
+  mutable llvm::SpecificBumpPtrAllocator<Object> object_allocator_;
 
   // Map from each variable declaration to the object which it declares.
   MapType object_repository_;
@@ -274,8 +317,9 @@ class ObjectRepository {
   class VarDeclVisitor;
 
   PointsToMap initial_points_to_map_;
-  FieldObjects field_object_map_;
-  BaseObjects base_object_map_;
+  // `mutable` for lazy materialization; see `lazy_record_objects_`.
+  mutable FieldObjects field_object_map_;
+  mutable BaseObjects base_object_map_;
 
   llvm::DenseMap<std::pair<const clang::Expr*, size_t>, const Object*>
       call_expr_args_objects_;
@@ -293,6 +337,21 @@ class ObjectRepository {
 
   llvm::DenseMap<const Object*, ObjectLifetimes> initial_object_lifetimes_;
 
+  // Roots of global/static record objects whose field and base objects have
+  // not been created yet, with the lifetimes those sub-objects will get.
+  // Only pointer-free types are registered here: their sub-objects carry no
+  // points-to edges, so creating them after `initial_points_to_map_` has
+  // been copied into the lattice cannot lose information. Entries are
+  // removed once materialized.
+  mutable llvm::DenseMap<const Object*, ObjectLifetimes> lazy_record_objects_;
+
+  // Memo for `GetCalleeLifetimes`: builtin lifetimes expanded for this
+  // function's analysis, plus unknown-callee errors. Scoped to the
+  // repository (not the process) because the cached values reference types
+  // from an `ASTContext` that does not outlive the analysis.
+  mutable llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>
+      callee_lifetimes_cache_;
+
   struct ObjectCreator;
 };
 
@@ -5,21 +5,29 @@
 #ifndef DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_OBJECT_SET_H_
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_OBJECT_SET_H_
 
+#include <algorithm>
 #include <initializer_list>
+#include <iterator>
 #include <string>
 
 #include "lifetime_analysis/object.h"
 #include "llvm/ADT/STLExtras.h"
-#include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/SmallVector.h"
 
 namespace clang {
 namespace tidy {
 namespace lifetimes {
 
 // A set of `Object`s.
+//
+// The set is stored as a sorted vector. The sets handled by the points-to
+// analysis are almost always tiny, so keeping the elements contiguous makes
+// the innermost operations (union, subset checks, and the equality
+// comparisons used for fixpoint detection) linear merges over adjacent
+// memory instead of per-element hash probes.
 class ObjectSet {
  public:
-  using const_iterator = llvm::SmallSet<const Object*, 2>::const_iterator;
+  using const_iterator = llvm::SmallVector<const Object*, 2>::const_iterator;
   using value_type = const Object*;
 
   ObjectSet() = default;
@@ -30,10 +38,10 @@ class ObjectSet {
   ObjectSet& operator=(ObjectSet&&) = default;
 
   // Initializes the object set with `objects`.
-  ObjectSet(std::initializer_list<const Object*> objects) {
-    for (const Object* object : objects) {
-      objects_.insert(object);
-    }
+  ObjectSet(std::initializer_list<const Object*> objects) : objects_(objects) {
+    llvm::sort(objects_);
+    objects_.erase(std::unique(objects_.begin(), objects_.end()),
+                   objects_.end());
   }
 
   // Returns a human-readable string representation of the object set.
@@ -49,18 +57,14 @@ class ObjectSet {
 
   // Returns whether this set contains `object`.
   bool Contains(const Object* object) const {
-    return objects_.contains(object);
+    return std::binary_search(objects_.begin(), objects_.end(), object);
   }
 
   // Returns whether this set contains all objects in `other`, i.e. whether
   // this set is a superset of `other`.
   bool Contains(const ObjectSet& other) const {
-    for (const Object* object : other) {
-      if (!Contains(object)) {
-        return false;
-      }
-    }
-    return true;
+    return std::includes(objects_.begin(), objects_.end(),
+                         other.objects_.begin(), other.objects_.end());
   }
 
   // Returns a `ObjectSet` containing the union of the pointees from this
@@ -75,18 +79,61 @@ class ObjectSet {
   // `ObjectSet` and `other`.
   ObjectSet Intersection(const ObjectSet& other) const {
     ObjectSet result;
-    for (const Object* obj : *this) {
-      if (other.Contains(obj)) result.Add(obj);
+    // Sets whose element ranges don't even overlap (e.g. objects from
+    // different allocation batches) intersect to nothing; skip the merge.
+    if (objects_.empty() || other.objects_.empty() ||
+        objects_.back() < other.objects_.front() ||
+        other.objects_.back() < objects_.front()) {
+      return result;
     }
+    result.objects_.reserve(std::min(objects_.size(), other.objects_.size()));
+    std::set_intersection(objects_.begin(), objects_.end(),
+                          other.objects_.begin(), other.objects_.end(),
+                          std::back_inserter(result.objects_));
     return result;
   }
 
   // Adds `object` to this object set.
-  void Add(const Object* object) { objects_.insert(object); }
+  void Add(const Object* object) {
+    auto iter = llvm::lower_bound(objects_, object);
+    if (iter == objects_.end() || *iter != object) {
+      objects_.insert(iter, object);
+    }
+  }
 
-  // Adds the `other` objects to this object set.
+  // Adds the `other` objects to this object set. This is the innermost
+  // kernel of the analysis: `PointsToMap::Union` calls it for every entry at
+  // every CFG join, so the common shapes are special-cased to bulk copies
+  // and read-only scans before falling back to a single-pass merge.
   void Add(const ObjectSet& other) {
-    objects_.insert(other.objects_.begin(), other.objects_.end());
+    if (other.objects_.empty()) {
+      return;
+    }
+    if (objects_.empty()) {
+      objects_ = other.objects_;
+      return;
+    }
+    // Non-overlapping element ranges concatenate without a merge.
+    if (objects_.back() < other.objects_.front()) {
+      objects_.append(other.objects_.begin(), other.objects_.end());
+      return;
+    }
+    if (other.objects_.back() < objects_.front()) {
+      objects_.insert(objects_.begin(), other.objects_.begin(),
+                      other.objects_.end());
+      return;
+    }
+    // In late fixpoint iterations `other` usually adds nothing; detect that
+    // with a read-only subset scan and leave the set untouched, rather than
+    // re-merging it into itself.
+    if (Contains(other)) {
+      return;
+    }
+    llvm::SmallVector<const Object*, 2> merged;
+    merged.reserve(objects_.size() + other.objects_.size());
+    std::set_union(objects_.begin(), objects_.end(), other.objects_.begin(),
+                   other.objects_.end(), std::back_inserter(merged));
+    objects_ = std::move(merged);
   }
 
   bool operator==(const ObjectSet& other) const {
@@ -100,7 +147,8 @@ class ObjectSet {
     return os << object_set.DebugString();
   }
 
-  llvm::SmallSet<const Object*, 2> objects_;
+  // Sorted by address; contains no duplicates.
+  llvm::SmallVector<const Object*, 2> objects_;
 };
 
 }  // namespace lifetimes
@@ -105,6 +105,36 @@ TEST(ObjectSet, Add) {
           object_set.Add({&o2, &o3});
           EXPECT_THAT(object_set, UnorderedElementsAre(&o1, &o2, &o3));
         }
+        {
+          ObjectSet object_set;
+          object_set.Add({&o1, &o2});
+          EXPECT_THAT(object_set, UnorderedElementsAre(&o1, &o2));
+        }
+        {
+          // Adding a subset leaves the set unchanged.
+          ObjectSet object_set = {&o1, &o2, &o3};
+          object_set.Add({&o1, &o3});
+          EXPECT_THAT(object_set, UnorderedElementsAre(&o1, &o2, &o3));
+        }
+      },
+      {});
+}
+
+TEST(ObjectSet, Intersection) {
+  runOnCodeWithLifetimeHandlers(
+      "",
+      [](const clang::ASTContext& ast_context,
+         const LifetimeAnnotationContext&) {
+        Object o1(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        Object o2(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        Object o3(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+
+        EXPECT_EQ(ObjectSet({&o1, &o2}).Intersection(ObjectSet({&o2, &o3})),
+                  ObjectSet({&o2}));
+        EXPECT_EQ(ObjectSet({&o1, &o2, &o3}).Intersection({&o1, &o2, &o3}),
+                  ObjectSet({&o1, &o2, &o3}));
+        EXPECT_EQ(ObjectSet({&o1}).Intersection(ObjectSet({&o2})), ObjectSet());
+        EXPECT_EQ(ObjectSet().Intersection(ObjectSet({&o1})), ObjectSet());
       },
       {});
 }
@@ -88,6 +88,36 @@ bool MayPointTo(clang::QualType pointer_type, clang::QualType object_type,
   return PointeesCompatible(pointee_type, object_type, ast_context);
 }
 
+bool PointerCompatibilityCache::PointeesCompatible(
+    clang::QualType pointee_type, clang::QualType object_type,
+    clang::ASTContext& ast_context) {
+  assert(!pointee_type.isNull());
+  assert(!object_type.isNull());
+
+  std::pair<const void*, const void*> key(
+      pointee_type.getCanonicalType().getAsOpaquePtr(),
+      object_type.getCanonicalType().getAsOpaquePtr());
+  auto [iter, inserted] = memo_.try_emplace(key, false);
+  if (inserted) {
+    iter->second =
+        lifetimes::PointeesCompatible(pointee_type, object_type, ast_context);
+  }
+  return iter->second;
+}
+
+bool PointerCompatibilityCache::MayPointTo(clang::QualType pointer_type,
+                                           clang::QualType object_type,
+                                           clang::ASTContext& ast_context) {
+  assert(!pointer_type.isNull());
+  assert(!object_type.isNull());
+
+  clang::QualType pointee_type = PointeeType(pointer_type.getCanonicalType());
+  if (pointee_type.isNull()) {
+    llvm::report_fatal_error("pointee_type is null");
+  }
+  return PointeesCompatible(pointee_type, object_type, ast_context);
+}
+
 }  // namespace lifetimes
 }  // namespace tidy
 }  // namespace clang
@@ -5,7 +5,10 @@
 #ifndef DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_POINTER_COMPATIBILITY_H_
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_POINTER_COMPATIBILITY_H_
 
+#include <utility>
+
 #include "clang/AST/Type.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace clang {
 namespace tidy {
@@ -28,6 +31,26 @@ bool PointeesCompatible(clang::QualType pointee_type,
 bool MayPointTo(clang::QualType pointer_type, clang::QualType object_type,
                 clang::ASTContext& ast_context);
 
+// Memoizes `PointeesCompatible` and `MayPointTo` verdicts for one analysis
+// session. The verdict for a pair of types never changes within an
+// `ASTContext`, and the transfer functions ask about the same few pairs for
+// every object on every fixpoint iteration, so each distinct pair walks the
+// type system only once. The cache must not outlive the `ASTContext` the
+// queried types belong to.
+class PointerCompatibilityCache {
+ public:
+  bool PointeesCompatible(clang::QualType pointee_type,
+                          clang::QualType object_type,
+                          clang::ASTContext& ast_context);
+  bool MayPointTo(clang::QualType pointer_type, clang::QualType object_type,
+                  clang::ASTContext& ast_context);
+
+ private:
+  // Keyed on the opaque representations of the canonical types, preserving
+  // qualifiers.
+  llvm::DenseMap<std::pair<const void*, const void*>, bool> memo_;
+};
+
 }  // namespace lifetimes
 }  // namespace tidy
 }  // namespace clang
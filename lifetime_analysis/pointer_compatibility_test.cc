@@ -193,6 +193,43 @@ TEST(PointerCompatibilityTest, MayPointTo) {
       {});
 }
 
+TEST(PointerCompatibilityTest, CacheAgreesWithUncachedChecks) {
+  runOnCodeWithLifetimeHandlers(
+      "class Base {};"
+      "class Derived : public Base {};"
+      "class Unrelated {};",
+      [](const clang::ASTContext& ast_context,
+         const LifetimeAnnotationContext&) {
+        auto& mutable_ast_context =
+            const_cast<clang::ASTContext&>(ast_context);
+        auto pointer_to = [&ast_context](clang::QualType type) {
+          return ast_context.getPointerType(type);
+        };
+
+        clang::QualType base_type = getClassType("Base", ast_context);
+        clang::QualType derived_type = getClassType("Derived", ast_context);
+        clang::QualType unrelated_type = getClassType("Unrelated", ast_context);
+
+        PointerCompatibilityCache cache;
+        // Query each pair twice so that both the miss and the hit path are
+        // exercised.
+        for (int i = 0; i < 2; ++i) {
+          EXPECT_TRUE(cache.MayPointTo(pointer_to(base_type), derived_type,
+                                       mutable_ast_context));
+          EXPECT_FALSE(cache.MayPointTo(pointer_to(base_type), unrelated_type,
+                                        mutable_ast_context));
+          EXPECT_TRUE(cache.PointeesCompatible(base_type, derived_type,
+                                               mutable_ast_context));
+          EXPECT_FALSE(cache.PointeesCompatible(base_type, unrelated_type,
+                                                mutable_ast_context));
+          // Qualifiers are part of the key, not stripped from it.
+          EXPECT_TRUE(cache.PointeesCompatible(base_type.withConst(), base_type,
+                                               mutable_ast_context));
+        }
+      },
+      {});
+}
+
 }  // namespace
 }  // namespace lifetimes
 }  // namespace tidy
@@ -4,6 +4,8 @@
 
 #include "lifetime_analysis/points_to_map.h"
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -17,43 +19,143 @@ namespace tidy {
 namespace lifetimes {
 
 bool PointsToMap::operator==(const PointsToMap& other) const {
-  return pointer_points_tos_ == other.pointer_points_tos_ &&
-         expr_objects_ == other.expr_objects_;
+  // Copies that have not diverged share their state, so equality (which the
+  // dataflow driver checks on every join to detect the fixpoint) is a pointer
+  // comparison in that case.
+  if (maps_ == other.maps_) {
+    return true;
+  }
+  return maps_->pointer_points_tos == other.maps_->pointer_points_tos &&
+         ExprMappingsEqual(other);
+}
+
+bool PointsToMap::ExprMappingsEqual(const PointsToMap& other) const {
+  const Maps& lhs = *maps_;
+  const Maps& rhs = *other.maps_;
+  if (expr_ids_ == other.expr_ids_) {
+    // Shared numbering: slots correspond directly. The vectors may have
+    // different lengths; slots past the end are dead.
+    size_t num_slots =
+        std::max(lhs.expr_objects.size(), rhs.expr_objects.size());
+    for (size_t id = 0; id < num_slots; ++id) {
+      bool lhs_live = lhs.IsLive(id);
+      if (lhs_live != rhs.IsLive(id)) {
+        return false;
+      }
+      if (lhs_live && lhs.expr_objects[id] != rhs.expr_objects[id]) {
+        return false;
+      }
+    }
+    return true;
+  }
+  // Independent numberings: compare by expression.
+  if (lhs.expr_live.count() != rhs.expr_live.count()) {
+    return false;
+  }
+  for (unsigned id : lhs.expr_live.set_bits()) {
+    const ObjectSet* other_objects =
+        other.GetExprSlot(expr_ids_->exprs[id]);
+    if (other_objects == nullptr || lhs.expr_objects[id] != *other_objects) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const ObjectSet* PointsToMap::GetExprSlot(const clang::Expr* expr) const {
+  auto iter = expr_ids_->index.find(expr);
+  if (iter == expr_ids_->index.end() || !maps_->IsLive(iter->second)) {
+    return nullptr;
+  }
+  return &maps_->expr_objects[iter->second];
+}
+
+PointsToMap::Maps& PointsToMap::Mutable() {
+  if (maps_.use_count() != 1) {
+    maps_ = std::make_shared<Maps>(*maps_);
+  }
+  return *maps_;
 }
 
 std::string PointsToMap::DebugString() const {
   std::vector<std::string> parts;
-  for (const auto& [pointer, points_to] : pointer_points_tos_) {
+  for (const auto& [pointer, points_to] : maps_->pointer_points_tos) {
     parts.push_back(absl::StrFormat("%s -> %s", pointer->DebugString(),
                                     points_to.DebugString()));
   }
-  for (const auto& [expr, objects] : expr_objects_) {
+  for (unsigned id : maps_->expr_live.set_bits()) {
+    const clang::Expr* expr = expr_ids_->exprs[id];
     parts.push_back(absl::StrFormat("%s (%p) -> %s", expr->getStmtClassName(),
-                                    expr, objects.DebugString()));
+                                    expr,
+                                    maps_->expr_objects[id].DebugString()));
   }
   return absl::StrJoin(parts, "\n");
 }
 
 PointsToMap PointsToMap::Union(const PointsToMap& other) const {
-  PointsToMap result;
+  // Unioning a map with itself (or an undiverged copy) is a no-op; share the
+  // state instead of building a third map.
+  if (maps_ == other.maps_) {
+    return *this;
+  }
+
+  // In late fixpoint iterations, `other` usually adds nothing. Detect that
+  // with a read-only subset walk so that the result can share this map's
+  // state and the caller's convergence check (see `SharesStateWith`) stays a
+  // pointer comparison.
+  bool subsumed = true;
+  for (const auto& [pointer, points_to] : other.maps_->pointer_points_tos) {
+    auto iter = maps_->pointer_points_tos.find(pointer);
+    if (iter == maps_->pointer_points_tos.end() ||
+        !iter->second.Contains(points_to)) {
+      subsumed = false;
+      break;
+    }
+  }
+  if (subsumed) {
+    bool shared_ids = expr_ids_ == other.expr_ids_;
+    for (unsigned id : other.maps_->expr_live.set_bits()) {
+      const ObjectSet* objects =
+          shared_ids ? (maps_->IsLive(id) ? &maps_->expr_objects[id] : nullptr)
+                     : GetExprSlot(other.expr_ids_->exprs[id]);
+      if (objects == nullptr ||
+          !objects->Contains(other.maps_->expr_objects[id])) {
+        subsumed = false;
+        break;
+      }
+    }
+  }
+  if (subsumed) {
+    return *this;
+  }
+
+  PointsToMap result = *this;
+  Maps& maps = result.Mutable();
 
-  result.pointer_points_tos_ = pointer_points_tos_;
-  for (const auto& [pointer, points_to] : other.pointer_points_tos_) {
-    result.pointer_points_tos_[pointer].Add(points_to);
+  for (const auto& [pointer, points_to] : other.maps_->pointer_points_tos) {
+    maps.pointer_points_tos[pointer].Add(points_to);
   }
   // TODO(mboehme): Do we even need to perform a union on expression object
   // sets?
-  result.expr_objects_ = expr_objects_;
-  for (const auto& [expr, objects] : other.expr_objects_) {
-    result.expr_objects_[expr].Add(objects);
+  for (unsigned other_id : other.maps_->expr_live.set_bits()) {
+    // When the numbering is shared (the production case - all lattice states
+    // of a function descend from the initial map), `IdFor` is a hit that
+    // returns `other_id` unchanged.
+    unsigned id = result.expr_ids_->IdFor(other.expr_ids_->exprs[other_id]);
+    if (maps.expr_objects.size() <= id) {
+      maps.expr_objects.resize(id + 1);
+      maps.expr_live.resize(id + 1);
+    }
+    maps.expr_objects[id].Add(other.maps_->expr_objects[other_id]);
+    maps.expr_live.set(id);
   }
 
   return result;
 }
 
 ObjectSet PointsToMap::GetPointerPointsToSet(const Object* pointer) const {
-  auto iter = pointer_points_tos_.find(pointer);
-  if (iter == pointer_points_tos_.end()) {
+  auto iter = maps_->pointer_points_tos.find(pointer);
+  if (iter == maps_->pointer_points_tos.end()) {
     return ObjectSet();
   }
   return iter->second;
@@ -61,7 +163,7 @@ ObjectSet PointsToMap::GetPointerPointsToSet(const Object* pointer) const {
 
 void PointsToMap::SetPointerPointsToSet(const Object* pointer,
                                         ObjectSet points_to) {
-  pointer_points_tos_[pointer] = std::move(points_to);
+  Mutable().pointer_points_tos[pointer] = std::move(points_to);
 }
 
 void PointsToMap::SetPointerPointsToSet(const ObjectSet& pointers,
@@ -73,15 +175,15 @@ void PointsToMap::SetPointerPointsToSet(const ObjectSet& pointers,
 
 void PointsToMap::ExtendPointerPointsToSet(const Object* pointer,
                                            const ObjectSet& points_to) {
-  ObjectSet& set = pointer_points_tos_[pointer];
+  ObjectSet& set = Mutable().pointer_points_tos[pointer];
   set.Add(points_to);
 }
 
 ObjectSet PointsToMap::GetPointerPointsToSet(const ObjectSet& pointers) const {
   ObjectSet result;
   for (const Object* pointer : pointers) {
-    auto iter = pointer_points_tos_.find(pointer);
-    if (iter != pointer_points_tos_.end()) {
+    auto iter = maps_->pointer_points_tos.find(pointer);
+    if (iter != maps_->pointer_points_tos.end()) {
       result.Add(iter->second);
     }
   }
@@ -100,25 +202,32 @@ ObjectSet PointsToMap::GetExprObjectSet(const clang::Expr* expr) const {
          expr->getType()->isArrayType() || expr->getType()->isFunctionType() ||
          expr->getType()->isBuiltinType());
 
-  auto iter = expr_objects_.find(expr);
-  if (iter == expr_objects_.end()) {
+  const ObjectSet* objects = GetExprSlot(expr);
+  if (objects == nullptr) {
     llvm::errs() << "Didn't find object set for expression:\n";
     expr->dump();
     llvm::report_fatal_error("Didn't find object set for expression");
   }
-  return iter->second;
+  return *objects;
 }
 
 void PointsToMap::SetExprObjectSet(const clang::Expr* expr, ObjectSet objects) {
   assert(expr->isGLValue() || expr->getType()->isPointerType() ||
          expr->getType()->isArrayType() || expr->getType()->isBuiltinType());
-  expr_objects_[expr] = std::move(objects);
+  unsigned id = expr_ids_->IdFor(expr);
+  Maps& maps = Mutable();
+  if (maps.expr_objects.size() <= id) {
+    maps.expr_objects.resize(id + 1);
+    maps.expr_live.resize(id + 1);
+  }
+  maps.expr_objects[id] = std::move(objects);
+  maps.expr_live.set(id);
 }
 
 std::vector<const Object*> PointsToMap::GetAllPointersWithLifetime(
     Lifetime lifetime) const {
   std::vector<const Object*> result;
-  for (const auto& [pointer, _] : pointer_points_tos_) {
+  for (const auto& [pointer, _] : maps_->pointer_points_tos) {
     if (pointer->GetLifetime() == lifetime) {
       result.push_back(pointer);
     }
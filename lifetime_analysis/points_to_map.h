@@ -5,10 +5,14 @@
 #ifndef DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_POINTS_TO_MAP_H_
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_POINTS_TO_MAP_H_
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "lifetime_analysis/object_set.h"
 #include "clang/AST/Expr.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
 
 namespace clang {
@@ -34,9 +38,35 @@ namespace lifetimes {
 // The PointsToMap class does not enforce these type relationships because we
 // intend to allow type punning (at least within the implementations of
 // functions).
+//
+// The underlying maps are held behind a shared, copy-on-write state: copying
+// a `PointsToMap` (which the dataflow framework does every time a lattice is
+// cloned at a CFG block boundary) only bumps a reference count, and the maps
+// are cloned lazily on the first mutation of a shared copy. At the fixpoint,
+// where most block states no longer change, clones are never materialized.
+//
+// Expression object sets are not kept in a per-state hash map. The
+// expressions of one function are numbered densely on first use (see
+// `ExprIds`); the numbering is shared by all copies of a map, and each state
+// stores only a vector of object sets indexed by it, with a bit vector
+// marking the live slots. Cloning a diverged copy is thus a flat vector copy
+// whose cost is dominated by the live entries (dead slots are empty
+// inline-storage `ObjectSet`s), and the union/equality walks that the
+// fixpoint iteration performs per block traverse contiguous slots instead of
+// hash buckets. The only remaining hash structure, the numbering itself, is
+// append-only and built once per function rather than copied with every
+// lattice.
+//
+// Sharing is deliberately per-map rather than per-entry: hash-consing the
+// individual `ObjectSet` values into canonical handles would make every
+// `ExtendPointerPointsToSet` re-intern the grown set through a hash table,
+// which costs more than the in-place merge it replaces for the tiny sets
+// this analysis produces.
 class PointsToMap {
  public:
-  PointsToMap() = default;
+  PointsToMap()
+      : expr_ids_(std::make_shared<ExprIds>()),
+        maps_(std::make_shared<Maps>()) {}
 
   PointsToMap(const PointsToMap&) = default;
   PointsToMap(PointsToMap&&) = default;
@@ -50,7 +80,7 @@ class PointsToMap {
   std::string DebugString() const;
 
   const llvm::DenseMap<const Object*, ObjectSet>& PointerPointsTos() const {
-    return pointer_points_tos_;
+    return maps_->pointer_points_tos;
   }
 
   // Returns a `PointsToMap` containing the union of mappings from this map and
@@ -58,8 +88,18 @@ class PointsToMap {
   // If both this map and `other` associate a points-to set with the same
   // entity, the returned map associates that entity with the union of the
   // corresponding points-to sets.
+  // Postcondition: the result shares this map's state (in the sense of
+  // `SharesStateWith`) if and only if `other` added nothing.
   PointsToMap Union(const PointsToMap& other) const;
 
+  // Returns whether this map shares its copy-on-write state with `other`,
+  // i.e. whether the two are undiverged copies of one another. This is the
+  // O(1) stabilization check used by `LifetimeLattice::join`; maps with
+  // separate state may still compare equal via `operator==`.
+  bool SharesStateWith(const PointsToMap& other) const {
+    return maps_ == other.maps_;
+  }
+
   // Returns the points-to set associated with `pointer`, or an empty set if
   // `pointer` is not associated with a points-to set.
   ObjectSet GetPointerPointsToSet(const Object* pointer) const;
@@ -95,8 +135,58 @@ class PointsToMap {
       Lifetime lifetime) const;
 
  private:
-  llvm::DenseMap<const Object*, ObjectSet> pointer_points_tos_;
-  llvm::DenseMap<const clang::Expr*, ObjectSet> expr_objects_;
+  // Dense per-function numbering of the expressions that carry object sets.
+  // Ids are assigned on first use and never reused. Every copy of a map
+  // shares the numbering of the map it was copied from, so slot indices
+  // agree across all the lattice states of one function (they all descend
+  // from `ObjectRepository::InitialPointsToMap`). Maps built independently
+  // (which only happens in tests) are merged and compared by expression
+  // through the reverse mapping.
+  struct ExprIds {
+    llvm::DenseMap<const clang::Expr*, unsigned> index;
+    // Reverse mapping from id to expression; used for debug output and for
+    // merging maps that do not share a numbering.
+    std::vector<const clang::Expr*> exprs;
+
+    unsigned IdFor(const clang::Expr* expr) {
+      auto [iter, inserted] = index.try_emplace(expr, exprs.size());
+      if (inserted) {
+        exprs.push_back(expr);
+      }
+      return iter->second;
+    }
+  };
+
+  struct Maps {
+    llvm::DenseMap<const Object*, ObjectSet> pointer_points_tos;
+    // Slot `id` holds the object set of the expression numbered `id` in the
+    // owning map's `ExprIds`; `expr_live` marks the slots that hold a
+    // mapping. Both vectors always have the same size, which may trail the
+    // numbering's size.
+    std::vector<ObjectSet> expr_objects;
+    llvm::BitVector expr_live;
+
+    bool IsLive(size_t id) const {
+      return id < expr_live.size() && expr_live[id];
+    }
+  };
+
+  // Returns the maps for mutation, cloning them first if they are shared
+  // with another `PointsToMap`.
+  Maps& Mutable();
+
+  // Returns the object set slot for `expr`, or null if `expr` has no
+  // mapping in this map.
+  const ObjectSet* GetExprSlot(const clang::Expr* expr) const;
+
+  // Compares the expression mappings of this map and `other`, by slot if the
+  // numbering is shared and by expression otherwise.
+  bool ExprMappingsEqual(const PointsToMap& other) const;
+
+  // Never null; shared (and appended to) by all copies of this map.
+  std::shared_ptr<ExprIds> expr_ids_;
+  // Never null.
+  std::shared_ptr<Maps> maps_;
 };
 
 }  // namespace lifetimes
@@ -148,6 +148,34 @@ TEST(PointsToMapTest, GetExprObjectSet) {
       {});
 }
 
+TEST(PointsToMapTest, DivergedCopiesShareExprNumbering) {
+  runOnCodeWithLifetimeHandlers(
+      "int *return_int_ptr();"
+      "int* p = return_int_ptr();",
+      [](const clang::ASTContext& ast_context,
+         const LifetimeAnnotationContext&) {
+        Object p1(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        Object p2(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        const clang::CallExpr* expr = getFirstCallExpr(ast_context);
+
+        // Copies diverge slot-by-slot (they index their expression sets
+        // through the numbering they share), so equality and union need to
+        // behave the same as for independently built maps.
+        PointsToMap map1;
+        map1.SetExprObjectSet(expr, {&p1});
+        PointsToMap map2 = map1;
+        EXPECT_EQ(map1, map2);
+
+        map2.SetExprObjectSet(expr, {&p2});
+        EXPECT_NE(map1, map2);
+        EXPECT_EQ(map1.GetExprObjectSet(expr), ObjectSet({&p1}));
+
+        PointsToMap union_map = map1.Union(map2);
+        EXPECT_EQ(union_map.GetExprObjectSet(expr), ObjectSet({&p1, &p2}));
+      },
+      {});
+}
+
 }  // namespace
 }  // namespace lifetimes
 }  // namespace tidy
@@ -4,6 +4,7 @@
 
 #include "lifetime_analysis/template_placeholder_support.h"
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
@@ -24,6 +25,8 @@
 #include "clang/Tooling/Transformer/Stencil.h"
 #include "clang/Tooling/Transformer/Transformer.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/VirtualFileSystem.h"
 
@@ -88,6 +91,31 @@ llvm::Expected<GeneratedCode> GenerateTemplateInstantiationCode(
           source_manager.getLocForEndOfFile(file_id)),
       source_manager, context.getLangOpts());
 
+  // Cache of previously generated placeholder code, keyed by the main file's
+  // source text and the set of templates to instantiate. Generating the code
+  // runs a transformer pass over the whole TU, and callers (tests, iterative
+  // analysis runs) frequently re-analyze identical source in fresh
+  // ASTContexts. The cached value is plain text, so unlike an AST it can
+  // safely outlive the context it was generated from. The template-set hash
+  // is combined order-independently because `templates` is a DenseMap and
+  // its iteration order (which also picks the placeholder suffixes) is not
+  // stable; any previously generated variant is equivalent. Analysis is
+  // single-threaded, so the cache is unsynchronized.
+  static llvm::StringMap<GeneratedCode>& code_cache =
+      *new llvm::StringMap<GeneratedCode>();
+  size_t template_set_hash = 0;
+  for (const auto& [tmpl, func] : templates) {
+    template_set_hash += llvm::hash_combine(
+        llvm::hash_value(func->getNameAsString()),
+        tmpl->getTemplateParameters()->size());
+  }
+  std::string cache_key =
+      absl::StrCat(size_t{llvm::hash_value(source_code)}, ":",
+                   template_set_hash, ":", source_filename.str());
+  if (auto cached = code_cache.find(cache_key); cached != code_cache.end()) {
+    return cached->second;
+  }
+
   llvm::Error err = llvm::Error::success();
   clang::tooling::AtomicChanges changes;
   std::vector<std::unique_ptr<Transformer>> transformers;
@@ -188,6 +216,7 @@ llvm::Expected<GeneratedCode> GenerateTemplateInstantiationCode(
   generated.code = absl::StrCat("#include \"", source_filename.str(), "\"\n",
                                 absl::StrJoin(placeholder_definitions, ""),
                                 instantiation_code);
+  code_cache.try_emplace(cache_key, generated);
   return generated;
 }
 
@@ -0,0 +1,98 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests for exporting function analysis summaries and seeding an analysis
+// with imported ones.
+
+#include <string>
+#include <variant>
+
+#include "gtest/gtest.h"
+#include "lifetime_analysis/analyze.h"
+#include "lifetime_annotations/test/named_func_lifetimes.h"
+#include "lifetime_annotations/test/run_on_code.h"
+
+namespace clang {
+namespace tidy {
+namespace lifetimes {
+namespace {
+
+// Returns the named lifetimes recorded for the function called `name` in
+// `result`, or an empty string if there is no such (successful) entry.
+std::string LifetimesForFunction(
+    const llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>&
+        result,
+    llvm::StringRef name) {
+  for (const auto& [func, lifetimes_or_error] : result) {
+    if (func->getNameAsString() != name) continue;
+    const auto* lifetimes = std::get_if<FunctionLifetimes>(&lifetimes_or_error);
+    if (lifetimes == nullptr) return "";
+    return NameLifetimes(*lifetimes);
+  }
+  return "";
+}
+
+TEST(FunctionSummaries, ExportedSummariesNameLifetimes) {
+  runOnCodeWithLifetimeHandlers(
+      R"(
+        int* target(int* p) { return p; }
+        int* caller(int* p) { return target(p); }
+      )",
+      [](const clang::ASTContext& ast_context,
+         const LifetimeAnnotationContext& lifetime_context) {
+        auto result = AnalyzeTranslationUnit(
+            ast_context.getTranslationUnitDecl(), lifetime_context);
+
+        FunctionAnalysisSummaries summaries = ExportFunctionSummaries(result);
+        ASSERT_EQ(summaries.size(), 2);
+        for (const auto& [usr, serialized] : summaries) {
+          EXPECT_EQ(serialized, "a -> a");
+        }
+      },
+      {});
+}
+
+TEST(FunctionSummaries, ImportedSummariesSeedTheAnalysis) {
+  runOnCodeWithLifetimeHandlers(
+      R"(
+        int* target(int* p) { return p; }
+        int* caller(int* p) { return target(p); }
+      )",
+      [](const clang::ASTContext& ast_context,
+         const LifetimeAnnotationContext& lifetime_context) {
+        auto result = AnalyzeTranslationUnit(
+            ast_context.getTranslationUnitDecl(), lifetime_context);
+        FunctionAnalysisSummaries summaries = ExportFunctionSummaries(result);
+
+        // Keep only `target`'s summary, replaced with one that a local
+        // analysis would never produce; if the import is honored, `target`'s
+        // recorded lifetimes must reflect it verbatim, and so must `caller`
+        // (analyzed locally, consuming the imported lifetimes at its call
+        // site).
+        bool replaced = false;
+        for (auto iter = summaries.begin(); iter != summaries.end();) {
+          if (iter->first.find("target") != std::string::npos) {
+            iter->second = "a -> b";
+            replaced = true;
+            ++iter;
+          } else {
+            iter = summaries.erase(iter);
+          }
+        }
+        ASSERT_TRUE(replaced);
+
+        auto seeded_result = AnalyzeTranslationUnit(
+            ast_context.getTranslationUnitDecl(), lifetime_context,
+            /*diag_reporter=*/{}, /*debug_info=*/nullptr, &summaries);
+
+        EXPECT_EQ(LifetimesForFunction(seeded_result, "target"), "a -> b");
+        EXPECT_EQ(LifetimesForFunction(seeded_result, "caller"), "a -> b");
+      },
+      {});
+}
+
+}  // namespace
+}  // namespace lifetimes
+}  // namespace tidy
+}  // namespace clang
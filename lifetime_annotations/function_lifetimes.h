@@ -161,6 +161,12 @@ class FunctionLifetimes {
   void Traverse(std::function<void(const Lifetime&, Variance)> visitor) const;
 
  private:
+  // The default inline capacity (one element, given the size of
+  // ValueLifetimes) is a deliberate choice: FunctionLifetimes is stored by
+  // value in DenseMap buckets (see FunctionLifetimesMap below), so any extra
+  // inline capacity is paid for by every bucket of every such map, while the
+  // allocation it would save is dwarfed by the heap state each ValueLifetimes
+  // owns internally.
   llvm::SmallVector<ValueLifetimes> param_lifetimes_;
   ValueLifetimes return_lifetimes_;
   std::optional<ValueLifetimes> this_lifetimes_;
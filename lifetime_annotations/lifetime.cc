@@ -10,6 +10,12 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+// The compact representation matters: lifetimes are stored by the million in
+// constraint sets and points-to state, so `Lifetime` must stay exactly one
+// int wide.
+static_assert(sizeof(Lifetime) == sizeof(int),
+              "Lifetime is meant to be a bare 32-bit id");
+
 constexpr int INVALID_LIFETIME_ID_EMPTY = 0;
 constexpr int INVALID_LIFETIME_ID_TOMBSTONE = 1;
 constexpr int STATIC_LIFETIME_ID = -1;
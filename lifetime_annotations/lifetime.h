@@ -19,6 +19,14 @@ namespace tidy {
 namespace lifetimes {
 
 // A lifetime variable or constant lifetime.
+//
+// A `Lifetime` is a single 32-bit id; the kind is packed into its value
+// rather than stored alongside it: positive ids are lifetime variables,
+// `-1` is 'static, and ids of -2 and below are local lifetime constants
+// (see the constants in lifetime.cc). Everything that flows through
+// constraint sets and substitution maps therefore copies and compares
+// register-width values, and `DebugString` derives the human-readable name
+// from the id on demand instead of the id carrying a name around.
 class Lifetime {
  public:
   // Creates an invalid lifetime.
@@ -309,6 +309,19 @@ llvm::Expected<FunctionLifetimes> GetLifetimeAnnotations(
   // TODO(mboehme): if we have multiple declarations of a function, make sure
   // they are all annotated with the same lifetimes.
 
+  // Only calls that don't request the symbol table are memoized (see the
+  // comment on `lifetimes_cache`). The cache is keyed on the exact
+  // declaration (not the canonical one) because lifetime elision depends on
+  // the file the declaration appears in. Errors are not cached; they are
+  // rare and `llvm::Error` is not copyable.
+  bool use_cache = symbol_table == nullptr;
+  if (use_cache) {
+    auto cache_iter = context.lifetimes_cache.find(func);
+    if (cache_iter != context.lifetimes_cache.end()) {
+      return cache_iter->second;
+    }
+  }
+
   clang::SourceManager& source_manager =
       func->getASTContext().getSourceManager();
   clang::FileID file_id =
@@ -319,7 +332,12 @@ llvm::Expected<FunctionLifetimes> GetLifetimeAnnotations(
   if (!symbol_table) {
     symbol_table = &throw_away_symbol_table;
   }
-  return GetLifetimeAnnotationsInternal(func, *symbol_table, elision_enabled);
+  llvm::Expected<FunctionLifetimes> result =
+      GetLifetimeAnnotationsInternal(func, *symbol_table, elision_enabled);
+  if (use_cache && result) {
+    context.lifetimes_cache.try_emplace(func, *result);
+  }
+  return result;
 }
 
 llvm::Expected<FunctionLifetimes> ParseLifetimeAnnotations(
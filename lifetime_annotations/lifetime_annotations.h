@@ -11,6 +11,7 @@
 #include "lifetime_annotations/lifetime_symbol_table.h"
 #include "clang/AST/Decl.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Error.h"
 
 namespace clang {
@@ -21,6 +22,17 @@ namespace lifetimes {
 struct LifetimeAnnotationContext {
   // Files in which the `lifetime_elision` pragma was specified.
   llvm::DenseSet<clang::FileID> lifetime_elision_files;
+
+  // Memoized successful results of GetLifetimeAnnotations() for calls that
+  // don't ask for the symbol table. The parsed lifetimes for a given
+  // declaration never change, but populating a symbol table is a side effect
+  // that has to happen for every table a caller passes in, so those calls
+  // bypass the cache. This matters for the analysis, which looks up
+  // annotations of undefined functions once per call site.
+  // `mutable` because GetLifetimeAnnotations() takes the context by const
+  // reference.
+  mutable llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimes>
+      lifetimes_cache;
 };
 
 // Returns the lifetimes annotated on `func`.
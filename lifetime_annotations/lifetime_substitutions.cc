@@ -30,13 +30,36 @@ void LifetimeSubstitutions::Add(Lifetime variable, Lifetime substitution) {
 }
 
 Lifetime LifetimeSubstitutions::Substitute(Lifetime l) const {
+  auto iter = substitutions_.find(l);
+  if (iter == substitutions_.end()) {
+    return l;
+  }
+
+  // Find the end of the substitution chain.
+  Lifetime result = iter->second;
   while (true) {
-    auto iter = substitutions_.find(l);
-    if (iter == substitutions_.end()) {
-      return l;
+    auto next = substitutions_.find(result);
+    if (next == substitutions_.end()) {
+      break;
+    }
+    result = next->second;
+  }
+
+  // Path compression: Repoint every chain entry directly at the final
+  // substitution, so that subsequent lookups of any lifetime on this chain
+  // terminate after a single find. This only rewrites values (never inserts),
+  // so it doesn't invalidate any iterators, and it doesn't change the
+  // observable mapping, which is why `substitutions_` is `mutable`.
+  while (l != result) {
+    auto cur = substitutions_.find(l);
+    if (cur == substitutions_.end()) {
+      break;
     }
-    l = iter->second;
+    l = cur->second;
+    cur->second = result;
   }
+
+  return result;
 }
 
 void LifetimeSubstitutions::Dump() const {
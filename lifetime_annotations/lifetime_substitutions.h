@@ -27,13 +27,19 @@ class LifetimeSubstitutions {
   // to `l`.
   // For convenience, `l` may be a constant lifetime; in this case, `l` is
   // always returned unchanged.
+  // Chains of substitutions are compressed as they are traversed (as in
+  // union-find), so repeated lookups are amortized near-constant even when
+  // substitutions were added in an order that created long chains.
   Lifetime Substitute(Lifetime l) const;
 
   // Dumps the substitutions to llvm::errs().
   void Dump() const;
 
  private:
-  llvm::DenseMap<Lifetime, Lifetime> substitutions_;
+  // `mutable` so that Substitute() can perform path compression; compression
+  // rewrites chain entries to point at their final substitution but never
+  // changes the mapping that Substitute() returns.
+  mutable llvm::DenseMap<Lifetime, Lifetime> substitutions_;
 };
 
 }  // namespace lifetimes
@@ -14,6 +14,20 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+LifetimeSymbolTable& LifetimeSymbolTable::operator=(
+    const LifetimeSymbolTable& other) {
+  name_to_lifetime_ = other.name_to_lifetime_;
+  next_name_index_ = other.next_name_index_;
+  // Rebuild the reverse mapping so that it references this table's own keys
+  // rather than `other`'s. The mapping is one-to-one (see the class comment),
+  // so it is fully determined by `name_to_lifetime_`.
+  lifetime_to_name_.clear();
+  for (const auto& entry : name_to_lifetime_) {
+    lifetime_to_name_[entry.second] = entry.first();
+  }
+  return *this;
+}
+
 std::optional<Lifetime> LifetimeSymbolTable::LookupName(
     llvm::StringRef name) const {
   if (name == "static") {
@@ -38,7 +52,7 @@ Lifetime LifetimeSymbolTable::LookupNameAndMaybeDeclare(llvm::StringRef name) {
     Lifetime lifetime = Lifetime::CreateVariable();
     iter->second = lifetime;
     assert(!lifetime_to_name_.count(lifetime));
-    lifetime_to_name_[lifetime] = name;
+    lifetime_to_name_[lifetime] = iter->first();
   }
   return iter->second;
 }
@@ -90,18 +104,18 @@ llvm::StringRef LifetimeSymbolTable::LookupLifetimeAndMaybeDeclare(
     auto [name_to_lifetime_iter, inserted] =
         name_to_lifetime_.try_emplace(name, lifetime);
     if (inserted) {
-      lifetime_to_name_[lifetime] = name;
+      lifetime_to_name_[lifetime] = name_to_lifetime_iter->first();
       return name_to_lifetime_iter->first();
     }
   }
 }
 
 void LifetimeSymbolTable::Add(llvm::StringRef name, Lifetime lifetime) {
-  auto [_, inserted] = name_to_lifetime_.try_emplace(name, lifetime);
+  auto [iter, inserted] = name_to_lifetime_.try_emplace(name, lifetime);
   if (!inserted) {
     llvm::report_fatal_error("duplicate lifetime parameter");
   }
-  lifetime_to_name_[lifetime] = name;
+  lifetime_to_name_[lifetime] = iter->first();
 }
 
 void LifetimeSymbolTable::Rebind(llvm::StringRef name, Lifetime lifetime) {
@@ -110,7 +124,7 @@ void LifetimeSymbolTable::Rebind(llvm::StringRef name, Lifetime lifetime) {
     llvm::report_fatal_error("invalid call to rebind");
   }
   lifetime_to_name_.erase(iter->second);
-  lifetime_to_name_[lifetime] = name;
+  lifetime_to_name_[lifetime] = iter->first();
   iter->second = lifetime;
 }
 
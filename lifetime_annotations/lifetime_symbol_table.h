@@ -20,6 +20,18 @@ namespace lifetimes {
 // One-to-one mapping between lifetime names and the corresponding lifetimes.
 class LifetimeSymbolTable {
  public:
+  LifetimeSymbolTable() = default;
+
+  // The copy operations are user-defined because `lifetime_to_name_`
+  // references the keys of `name_to_lifetime_` and needs to be re-pointed at
+  // the copy's own keys. Moves can be defaulted: StringMap entries are
+  // separately allocated, so they (and the StringRefs into them) survive a
+  // move of the map.
+  LifetimeSymbolTable(const LifetimeSymbolTable& other) { *this = other; }
+  LifetimeSymbolTable& operator=(const LifetimeSymbolTable& other);
+  LifetimeSymbolTable(LifetimeSymbolTable&&) = default;
+  LifetimeSymbolTable& operator=(LifetimeSymbolTable&&) = default;
+
   // Looks up a lifetime name in the symbol table.
   // Returns the corresponding lifetime if the name was present in the symbol
   // table, or nullopt if the lifetime name wasn't found.
@@ -62,7 +74,11 @@ class LifetimeSymbolTable {
 
  private:
   llvm::StringMap<Lifetime> name_to_lifetime_;
-  llvm::DenseMap<Lifetime, std::string> lifetime_to_name_;
+  // The reverse mapping references the keys of `name_to_lifetime_` instead of
+  // storing a second copy of every name. This is safe because StringMap
+  // allocates its entries separately from the bucket array (so keys don't
+  // move on rehashing) and we never erase from `name_to_lifetime_`.
+  llvm::DenseMap<Lifetime, llvm::StringRef> lifetime_to_name_;
   int next_name_index_ = 0;
 };
 
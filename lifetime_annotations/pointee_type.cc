@@ -11,10 +11,14 @@ namespace tidy {
 namespace lifetimes {
 
 clang::QualType PointeeType(clang::QualType type) {
-  if (auto ptr_type = type->getAs<clang::PointerType>()) {
-    return ptr_type->getPointeeType();
-  } else if (auto ref_type = type->getAs<clang::ReferenceType>()) {
-    return ref_type->getPointeeType();
+  // Check the canonical type before calling `getAs`: most callers use this
+  // function to ask "is this a type we infer lifetimes for" on arbitrary
+  // types, and `isPointerType`/`isReferenceType` are single checks on the
+  // canonical type, whereas `getAs` walks the type's sugar.
+  if (type->isPointerType()) {
+    return type->getAs<clang::PointerType>()->getPointeeType();
+  } else if (type->isReferenceType()) {
+    return type->getAs<clang::ReferenceType>()->getPointeeType();
   }
 
   return clang::QualType();
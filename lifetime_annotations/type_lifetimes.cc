@@ -173,14 +173,11 @@ ValueLifetimes& ValueLifetimes::operator=(const ValueLifetimes& other) {
   type_ = other.type_;
   template_argument_lifetimes_ = other.template_argument_lifetimes_;
   lifetime_parameters_by_name_ = other.lifetime_parameters_by_name_;
-  auto pointee_lifetimes =
-      other.pointee_lifetimes_
-          ? std::make_unique<ObjectLifetimes>(*other.pointee_lifetimes_)
-          : nullptr;
-  auto function_lifetimes =
-      other.function_lifetimes_
-          ? std::make_unique<FunctionLifetimes>(*other.function_lifetimes_)
-          : nullptr;
+  // Copies share the pointee/function subtrees with `other`; they are only
+  // cloned if one of the copies needs to mutate them (see the comment on the
+  // member declarations).
+  auto pointee_lifetimes = other.pointee_lifetimes_;
+  auto function_lifetimes = other.function_lifetimes_;
   // Note: because ValueLifetimes is a recursive type (pointee_lifetimes_
   // contains a ValueLifetimes), the following line can destroy `other`.
   // (Thus the temporary local variables before we perform the assignment.)
@@ -271,6 +268,16 @@ bool SameType(clang::QualType type1, clang::QualType type2) {
   return Undecay(type1) == Undecay(type2);
 }
 
+// Clones `ptr`'s pointee if it is shared with other owners, so that the
+// caller can mutate it without affecting the copies that share the subtree
+// (see the comment on `ValueLifetimes::pointee_lifetimes_`).
+template <typename T>
+void EnsureUniquelyOwned(std::shared_ptr<T>& ptr) {
+  if (ptr.use_count() > 1) {
+    ptr = std::make_shared<T>(*ptr);
+  }
+}
+
 }  // namespace
 
 ValueLifetimes ValueLifetimes::PointerTo(const clang::QualType pointer_type,
@@ -279,7 +286,7 @@ ValueLifetimes ValueLifetimes::PointerTo(const clang::QualType pointer_type,
   ret.type_ = pointer_type;
   assert(pointer_type->getPointeeType().getCanonicalType() ==
          obj.Type().getCanonicalType());
-  ret.pointee_lifetimes_ = std::make_unique<ObjectLifetimes>(obj);
+  ret.pointee_lifetimes_ = std::make_shared<ObjectLifetimes>(obj);
   return ret;
 }
 
@@ -316,7 +323,7 @@ llvm::Expected<ValueLifetimes> ValueLifetimes::Create(
       return std::move(err);
     }
     ret.function_lifetimes_ =
-        std::make_unique<FunctionLifetimes>(std::move(fn_lftm));
+        std::make_shared<FunctionLifetimes>(std::move(fn_lftm));
     return ret;
   }
 
@@ -402,7 +409,7 @@ llvm::Expected<ValueLifetimes> ValueLifetimes::Create(
     return std::move(err);
   }
   ret.pointee_lifetimes_ =
-      std::make_unique<ObjectLifetimes>(object_lifetime, value_lifetimes);
+      std::make_shared<ObjectLifetimes>(object_lifetime, value_lifetimes);
   return ret;
 }
 
@@ -416,7 +423,7 @@ ValueLifetimes ValueLifetimes::ForPointerLikeType(
   assert(!PointeeType(type).isNull());
   ValueLifetimes result(type);
   result.pointee_lifetimes_ =
-      std::make_unique<ObjectLifetimes>(object_lifetimes);
+      std::make_shared<ObjectLifetimes>(object_lifetimes);
   return result;
 }
 
@@ -548,6 +555,7 @@ void ValueLifetimes::SubstituteLifetimes(const LifetimeSubstitutions& subst) {
     }
   }
   if (pointee_lifetimes_) {
+    EnsureUniquelyOwned(pointee_lifetimes_);
     pointee_lifetimes_->SubstituteLifetimes(subst);
   }
   for (const auto& lftm_arg : GetLifetimeParameters(type_)) {
@@ -557,6 +565,7 @@ void ValueLifetimes::SubstituteLifetimes(const LifetimeSubstitutions& subst) {
     lifetime_parameters_by_name_.Rebind(lftm_arg, subst.Substitute(*lifetime));
   }
   if (function_lifetimes_) {
+    EnsureUniquelyOwned(function_lifetimes_);
     function_lifetimes_->SubstituteLifetimes(subst);
   }
 }
@@ -571,6 +580,7 @@ void ValueLifetimes::Traverse(std::function<void(Lifetime&, Variance)> visitor,
     }
   }
   if (pointee_lifetimes_) {
+    EnsureUniquelyOwned(pointee_lifetimes_);
     pointee_lifetimes_->Traverse(visitor, variance, Type());
   }
   for (const auto& lftm_arg : GetLifetimeParameters(type_)) {
@@ -580,25 +590,47 @@ void ValueLifetimes::Traverse(std::function<void(Lifetime&, Variance)> visitor,
     Lifetime new_lifetime = *lifetime;
     visitor(new_lifetime, variance);
 
-    // Note that this check is not an optimization, but a guard against UB:
-    // if one calls the const version of Traverse, with a callback that does not
-    // mutate the lifetime, on a const instance of the Value/ObjectLifetimes,
-    // then calling Rebind would be UB, even if Rebind would do nothing in
-    // practice.
+    // Skip the Rebind if the visitor left the lifetime unchanged. (This used
+    // to be a guard against UB back when the const overload of Traverse was
+    // implemented as a `const_cast` into this one; now it just avoids a
+    // pointless map write.)
     if (new_lifetime != lifetime) {
       lifetime_parameters_by_name_.Rebind(lftm_arg, new_lifetime);
     }
   }
   if (function_lifetimes_) {
+    EnsureUniquelyOwned(function_lifetimes_);
     function_lifetimes_->Traverse(visitor);
   }
 }
 
+// The const overload is a real implementation rather than a `const_cast` into
+// the overload above so that a read-only traversal never triggers the
+// copy-on-write cloning of shared subtrees.
 void ValueLifetimes::Traverse(
     std::function<void(const Lifetime&, Variance)> visitor,
     Variance variance) const {
-  const_cast<ValueLifetimes*>(this)->Traverse(
-      [&visitor](Lifetime& l, Variance v) { visitor(l, v); }, variance);
+  for (const auto& tmpl_arg_at_depth : template_argument_lifetimes_) {
+    for (const std::optional<ValueLifetimes>& tmpl_arg : tmpl_arg_at_depth) {
+      if (tmpl_arg) {
+        tmpl_arg->Traverse(visitor, kInvariant);
+      }
+    }
+  }
+  if (pointee_lifetimes_) {
+    const ObjectLifetimes& pointee = *pointee_lifetimes_;
+    pointee.Traverse(visitor, variance, Type());
+  }
+  for (const auto& lftm_arg : GetLifetimeParameters(type_)) {
+    std::optional<Lifetime> lifetime =
+        lifetime_parameters_by_name_.LookupName(lftm_arg);
+    assert(lifetime.has_value());
+    visitor(*lifetime, variance);
+  }
+  if (function_lifetimes_) {
+    const FunctionLifetimes& func = *function_lifetimes_;
+    func.Traverse(visitor);
+  }
 }
 
 ValueLifetimes::ValueLifetimes(clang::QualType type) : type_(type) {}
@@ -880,12 +912,19 @@ void ObjectLifetimes::Traverse(std::function<void(Lifetime&, Variance)> visitor,
   visitor(lifetime_, variance);
 }
 
+// Implemented directly (not via `const_cast`) for the same reason as the
+// const overload of ValueLifetimes::Traverse().
 void ObjectLifetimes::Traverse(
     std::function<void(const Lifetime&, Variance)> visitor, Variance variance,
     clang::QualType indirection_type) const {
-  const_cast<ObjectLifetimes*>(this)->Traverse(
-      [&visitor](Lifetime& l, Variance v) { visitor(l, v); }, variance,
-      indirection_type);
+  assert(indirection_type.isNull() ||
+         StripAttributes(indirection_type->getPointeeType().IgnoreParens()) ==
+             Type());
+  value_lifetimes_.Traverse(
+      visitor, indirection_type.isNull() || indirection_type.isConstQualified()
+                   ? kCovariant
+                   : kInvariant);
+  visitor(lifetime_, variance);
 }
 
 llvm::Expected<llvm::StringRef> EvaluateAsStringLiteral(
@@ -202,8 +202,15 @@ class ValueLifetimes {
 
   // Note: only one of `pointee_lifetimes_`, `function_lifetimes_` or
   // `template_argument_lifetimes_` is non-empty.
-  std::unique_ptr<ObjectLifetimes> pointee_lifetimes_;
-  std::unique_ptr<FunctionLifetimes> function_lifetimes_;
+  //
+  // `pointee_lifetimes_` and `function_lifetimes_` are shared between copies
+  // and only cloned when a copy needs to mutate them (copy-on-write).
+  // ValueLifetimes gets copied once per occurrence of a type, while the
+  // mutating operations (SubstituteLifetimes(), non-const Traverse()) are
+  // comparatively rare, so deeply nested types share one subtree per type
+  // shape instead of reallocating it on every copy.
+  std::shared_ptr<ObjectLifetimes> pointee_lifetimes_;
+  std::shared_ptr<FunctionLifetimes> function_lifetimes_;
   std::vector<std::vector<std::optional<ValueLifetimes>>>
       template_argument_lifetimes_;
   clang::QualType type_;
@@ -4,6 +4,9 @@
 
 #include "migrator/rs_from_cc/converter.h"
 
+#include <string>
+#include <utility>
+
 #include "absl/strings/str_split.h"
 #include "clang/AST/CXXInheritance.h"
 #include "clang/AST/Decl.h"
@@ -23,6 +26,15 @@ void Converter::Convert(const clang::TranslationUnitDecl* translation_unit) {
     }
     Convert(decl);
   }
+
+  // The single gather-write of the conversion: `result_` is sized once and
+  // each chunk is copied into it exactly once.
+  result_.reserve(result_.size() + total_chunk_size_);
+  for (const std::string& chunk : chunks_) {
+    result_ += chunk;
+  }
+  chunks_.clear();
+  total_chunk_size_ = 0;
 }
 
 void Converter::Convert(const clang::Decl* decl) {
@@ -48,14 +60,26 @@ void Converter::ConvertUnhandled(const clang::Decl* decl) {
   // Also remove spaces at the end of each line, those are a pain in golden
   // tests since IDEs often strip spaces at end of line.
   RE2::GlobalReplace(&ast, "(?m) 0x[a-z0-9]+| +$", "");
+  std::string chunk;
+  // The chunk is roughly the dump itself plus a "// " prefix per line; the
+  // slack of the estimate is irrelevant since the buffer is decl-local.
+  chunk.reserve(ast.size() + 64);
+  chunk += "\n";
+  chunk += "// Unsupported decl:\n//\n";
   for (auto line : absl::StrSplit(ast, '\n')) {
     if (line.empty()) {
       continue;
     }
-    result_ += "// ";
-    result_ += line;
-    result_ += '\n';
+    chunk += "// ";
+    chunk += line;
+    chunk += '\n';
   }
+  EmitChunk(std::move(chunk));
+}
+
+void Converter::EmitChunk(std::string chunk) {
+  total_chunk_size_ += chunk.size();
+  chunks_.push_back(std::move(chunk));
 }
 
 }  // namespace crubit_rs_from_cc
@@ -5,6 +5,7 @@
 #ifndef CRUBIT_MIGRATOR_RS_FROM_CC_CONVERTER_H_
 #define CRUBIT_MIGRATOR_RS_FROM_CC_CONVERTER_H_
 
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <set>
@@ -49,9 +50,22 @@ class Converter {
 
   void ConvertUnhandled(const clang::Decl* decl);
 
+  // Appends the Rust source generated for one decl to the output.
+  //
+  // The output is accumulated as a list of per-decl chunks rather than by
+  // concatenating onto `result_` directly: growing one accumulated string
+  // re-copies the whole prefix on every reallocation, which hurts on large
+  // files. The chunks are gathered into `result_` exactly once (with an
+  // exact-size reserve) at the end of the translation unit.
+  void EmitChunk(std::string chunk);
+
   // The main output of the conversion process (Rust code).
   std::string& result_;
 
+  // Per-decl output chunks (see `EmitChunk`) and their total size.
+  std::vector<std::string> chunks_;
+  size_t total_chunk_size_ = 0;
+
   clang::ASTContext& ctx_;
 };  // class Converter
 
@@ -4,6 +4,9 @@
 
 // Parses C++ code and generates an equivalent Rust source file.
 
+#include <cstddef>
+#include <iostream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -13,22 +16,81 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "common/file_io.h"
 #include "migrator/rs_from_cc/rs_from_cc_lib.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 
 ABSL_FLAG(std::string, cc_in, "",
           "input path for the C++ source file (it may or may not be a header)");
 ABSL_FLAG(std::string, rs_out, "",
           "output path for the Rust source file; will be overwritten if it "
           "already exists");
+ABSL_FLAG(std::vector<std::string>, cc_batch_in, {},
+          "comma-separated input paths for batch conversion; mutually "
+          "exclusive with --cc_in. The files are converted in parallel within "
+          "one process, so Clang startup is not paid once per file");
+ABSL_FLAG(std::string, rs_out_dir, "",
+          "output directory for --cc_batch_in; each input FILE.cc is written "
+          "to <rs_out_dir>/FILE.rs, overwriting it if it already exists");
+
+namespace {
+
+int BatchMain(const std::vector<std::string>& cc_batch_in,
+              absl::Span<const absl::string_view> extra_args) {
+  auto rs_out_dir = absl::GetFlag(FLAGS_rs_out_dir);
+  if (rs_out_dir.empty()) {
+    std::cerr << "please specify --rs_out_dir when using --cc_batch_in"
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<crubit_rs_from_cc::BatchFileInput> inputs;
+  inputs.reserve(cc_batch_in.size());
+  for (const std::string& cc_in : cc_batch_in) {
+    auto status_or_cc_file_content = crubit::GetFileContents(cc_in);
+    CHECK(status_or_cc_file_content.ok());
+    inputs.push_back({cc_in, *std::move(status_or_cc_file_content)});
+  }
+
+  std::vector<absl::StatusOr<std::string>> results =
+      crubit_rs_from_cc::RsFromCcBatch(inputs, extra_args);
+
+  // Unlike the single-file mode, one file that fails to convert doesn't
+  // abort the whole batch - it is reported and the batch exits non-zero.
+  int exit_code = 0;
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (!results[i].ok()) {
+      std::cerr << cc_batch_in[i] << ": " << results[i].status() << std::endl;
+      exit_code = 1;
+      continue;
+    }
+    llvm::SmallString<128> rs_out_path(rs_out_dir);
+    llvm::sys::path::append(rs_out_path,
+                            llvm::sys::path::filename(cc_batch_in[i]));
+    llvm::sys::path::replace_extension(rs_out_path, ".rs");
+    CHECK(crubit::SetFileContents(std::string(rs_out_path.str()), *results[i])
+              .ok());
+  }
+  return exit_code;
+}
+
+}  // namespace
 
 int main(int argc, char* argv[]) {
   auto args = absl::ParseCommandLine(argc, argv);
 
+  auto cc_batch_in = absl::GetFlag(FLAGS_cc_batch_in);
+  if (!cc_batch_in.empty()) {
+    std::vector<absl::string_view> extra_args(args.begin() + 1, args.end());
+    return BatchMain(cc_batch_in, extra_args);
+  }
+
   auto cc_in = absl::GetFlag(FLAGS_cc_in);
   if (cc_in.empty()) {
-    std::cerr << "please specify --cc_in" << std::endl;
+    std::cerr << "please specify --cc_in or --cc_batch_in" << std::endl;
     return 1;
   }
   auto rs_out = absl::GetFlag(FLAGS_rs_out);
@@ -4,6 +4,7 @@
 
 #include "migrator/rs_from_cc/rs_from_cc_lib.h"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <utility>
@@ -21,22 +22,31 @@
 #include "clang/Basic/FileSystemOptions.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 
 namespace crubit_rs_from_cc {
 
-absl::StatusOr<std::string> RsFromCc(const absl::string_view cc_file_content,
-                                     const absl::string_view cc_file_name,
-                                     absl::Span<const absl::string_view> args) {
+namespace {
+
+std::vector<std::string> BuildClangArgs(
+    absl::Span<const absl::string_view> args) {
   std::vector<std::string> args_as_strings{
       // Parse non-doc comments that are used as documention
       "-fparse-all-comments"};
   args_as_strings.insert(args_as_strings.end(), args.begin(), args.end());
+  return args_as_strings;
+}
 
+absl::StatusOr<std::string> RunToolOnSingleFile(
+    absl::string_view cc_file_content, absl::string_view cc_file_name,
+    const std::vector<std::string>& args_as_strings,
+    std::shared_ptr<clang::PCHContainerOperations> pch_container_operations) {
   Converter::Invocation invocation;
   if (clang::tooling::runToolOnCodeWithArgs(
           std::make_unique<FrontendAction>(invocation), cc_file_content,
           args_as_strings, cc_file_name, "rs_from_cc",
-          std::make_shared<clang::PCHContainerOperations>(),
+          std::move(pch_container_operations),
           clang::tooling::FileContentMappings())) {
     return invocation.rs_code_;
   } else {
@@ -45,4 +55,40 @@ absl::StatusOr<std::string> RsFromCc(const absl::string_view cc_file_content,
   }
 }
 
+}  // namespace
+
+absl::StatusOr<std::string> RsFromCc(const absl::string_view cc_file_content,
+                                     const absl::string_view cc_file_name,
+                                     absl::Span<const absl::string_view> args) {
+  return RunToolOnSingleFile(cc_file_content, cc_file_name,
+                             BuildClangArgs(args),
+                             std::make_shared<clang::PCHContainerOperations>());
+}
+
+std::vector<absl::StatusOr<std::string>> RsFromCcBatch(
+    absl::Span<const BatchFileInput> inputs,
+    absl::Span<const absl::string_view> args) {
+  // The Clang argument list and the PCH container registry are built once and
+  // shared by all files; both are only read during a conversion.  Each file
+  // still gets its own `Invocation` (it holds that file's output) and its own
+  // compiler instance (each file is a separate translation unit).
+  std::vector<std::string> args_as_strings = BuildClangArgs(args);
+  auto pch_container_operations =
+      std::make_shared<clang::PCHContainerOperations>();
+
+  std::vector<absl::StatusOr<std::string>> results(inputs.size());
+  llvm::ThreadPool pool(llvm::hardware_concurrency());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    pool.async([&results, &inputs, &args_as_strings, pch_container_operations,
+                i] {
+      results[i] =
+          RunToolOnSingleFile(inputs[i].cc_file_content,
+                              inputs[i].cc_file_name, args_as_strings,
+                              pch_container_operations);
+    });
+  }
+  pool.wait();
+  return results;
+}
+
 }  // namespace crubit_rs_from_cc
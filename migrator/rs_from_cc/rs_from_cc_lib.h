@@ -6,6 +6,7 @@
 #define CRUBIT_MIGRATOR_RS_FROM_CC_RS_FROM_CC_LIB_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
@@ -27,6 +28,23 @@ absl::StatusOr<std::string> RsFromCc(
     absl::string_view cc_file_name = "testing/file_name.cc",
     absl::Span<const absl::string_view> args = {});
 
+// One input file of an `RsFromCcBatch` conversion.
+struct BatchFileInput {
+  std::string cc_file_name;
+  std::string cc_file_content;
+};
+
+// Converts a batch of independent C++ source files into Rust.
+//
+// Each file is converted exactly like a standalone `RsFromCc` call, but the
+// per-invocation setup (Clang argument list, PCH container operations) is
+// built once, and the files are converted in parallel on a thread pool.
+// Results are returned in the same order as `inputs`; a failure to convert
+// one file doesn't affect the other files.
+std::vector<absl::StatusOr<std::string>> RsFromCcBatch(
+    absl::Span<const BatchFileInput> inputs,
+    absl::Span<const absl::string_view> args = {});
+
 }  // namespace crubit_rs_from_cc
 
 #endif  // CRUBIT_MIGRATOR_RS_FROM_CC_RS_FROM_CC_LIB_H_
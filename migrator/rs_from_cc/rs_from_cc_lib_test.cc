@@ -4,11 +4,14 @@
 
 #include "migrator/rs_from_cc/rs_from_cc_lib.h"
 
+#include <string>
 #include <variant>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "common/status_test_matchers.h"
 #include "clang/AST/ASTContext.h"
@@ -50,5 +53,28 @@ TEST(RsFromCcTest, FunctionDeclaration) {
 )end_of_string"));
 }
 
+TEST(RsFromCcTest, Batch) {
+  std::vector<BatchFileInput> inputs = {
+      {"a.cc", "void f() {}"},
+      {"b.cc", "int foo(); But this is not C++"},
+      {"c.cc", "// This is a comment"},
+  };
+
+  std::vector<absl::StatusOr<std::string>> results = RsFromCcBatch(inputs);
+
+  ASSERT_EQ(results.size(), 3);
+  ASSERT_OK(results[0]);
+  EXPECT_THAT(*results[0], Eq(R"end_of_string(
+// Unsupported decl:
+//
+// FunctionDecl <a.cc:1:1, col:11> col:6 f 'void ()'
+// `-CompoundStmt <col:10, col:11>
+)end_of_string"));
+  // One failing file doesn't affect the other files of the batch.
+  EXPECT_THAT(results[1], StatusIs(absl::StatusCode::kInvalidArgument));
+  ASSERT_OK(results[2]);
+  EXPECT_THAT(*results[2], IsEmpty());
+}
+
 }  // namespace
 }  // namespace crubit_rs_from_cc
@@ -197,6 +197,18 @@ NullabilityKind getPointerNullability(const Expr* E,
       }
     }
   }
+
+  // At call sites with no annotation from either source, fall back to the
+  // callee's function summary, which may have inferred a nullability from the
+  // callee's definition.
+  if (Nullability.value_or(NullabilityKind::Unspecified) ==
+      NullabilityKind::Unspecified) {
+    if (const auto* CE = dyn_cast<CallExpr>(E->IgnoreParenImpCasts())) {
+      if (const auto* Callee = CE->getDirectCallee()) {
+        Nullability = L.functionSummaries().getReturnNullability(*Callee);
+      }
+    }
+  }
   return Nullability.value_or(NullabilityKind::Unspecified);
 }
 
@@ -451,13 +463,34 @@ auto buildFlowSensitiveTransferer() {
                            transferFlowSensitiveNullCheckImplicitCastPtrToBool)
       .Build();
 }
+// The match switches are stateless (all per-run state is threaded through the
+// `TransferState` argument), so they are built once per process and shared by
+// every analysis instance: copying a switch only bumps reference counts on
+// the underlying matchers, whereas rebuilding it constructs every matcher
+// anew for each analyzed function.
+const dataflow::CFGMatchSwitch<TransferState<PointerNullabilityLattice>>&
+nonFlowSensitiveTransferer() {
+  static const auto& Transferer =
+      *new dataflow::CFGMatchSwitch<TransferState<PointerNullabilityLattice>>(
+          buildNonFlowSensitiveTransferer());
+  return Transferer;
+}
+
+const dataflow::CFGMatchSwitch<TransferState<PointerNullabilityLattice>>&
+flowSensitiveTransferer() {
+  static const auto& Transferer =
+      *new dataflow::CFGMatchSwitch<TransferState<PointerNullabilityLattice>>(
+          buildFlowSensitiveTransferer());
+  return Transferer;
+}
+
 }  // namespace
 
 PointerNullabilityAnalysis::PointerNullabilityAnalysis(ASTContext& Context)
     : DataflowAnalysis<PointerNullabilityAnalysis, PointerNullabilityLattice>(
           Context),
-      NonFlowSensitiveTransferer(buildNonFlowSensitiveTransferer()),
-      FlowSensitiveTransferer(buildFlowSensitiveTransferer()) {}
+      NonFlowSensitiveTransferer(nonFlowSensitiveTransferer()),
+      FlowSensitiveTransferer(flowSensitiveTransferer()) {}
 
 void PointerNullabilityAnalysis::transfer(const CFGElement& Elt,
                                           PointerNullabilityLattice& Lattice,
@@ -474,28 +507,31 @@ BoolValue& mergeBoolValues(BoolValue& Bool1, const Environment& Env1,
     return Bool1;
   }
 
-  auto& MergedBool = MergedEnv.makeAtomicBoolValue();
+  // If `Bool1` and `Bool2` are constrained to the same true / false value,
+  // the merged value *is* that constant: returning the interned literal
+  // instead of a fresh atom keeps the common known-nonnull / known-nullable
+  // shapes canonical, so they add neither an atom nor a flow-condition
+  // conjunct to the solver's universe, and repeated merges of the same state
+  // hit the pointer-equality fast path above.
+  if (Env1.flowConditionImplies(Bool1) && Env2.flowConditionImplies(Bool2)) {
+    return MergedEnv.getBoolLiteralValue(true);
+  }
+  if (Env1.flowConditionImplies(Env1.makeNot(Bool1)) &&
+      Env2.flowConditionImplies(Env2.makeNot(Bool2))) {
+    return MergedEnv.getBoolLiteralValue(false);
+  }
 
-  // If `Bool1` and `Bool2` is constrained to the same true / false value,
-  // `MergedBool` can be constrained similarly without needing to consider the
-  // path taken - this simplifies the flow condition tracked in `MergedEnv`.
   // Otherwise, information about which path was taken is used to associate
   // `MergedBool` with `Bool1` and `Bool2`.
-  if (Env1.flowConditionImplies(Bool1) && Env2.flowConditionImplies(Bool2)) {
-    MergedEnv.addToFlowCondition(MergedBool);
-  } else if (Env1.flowConditionImplies(Env1.makeNot(Bool1)) &&
-             Env2.flowConditionImplies(Env2.makeNot(Bool2))) {
-    MergedEnv.addToFlowCondition(MergedEnv.makeNot(MergedBool));
-  } else {
-    // TODO(b/233582219): Flow conditions are not necessarily mutually
-    // exclusive, a fix is in order: https://reviews.llvm.org/D130270. Update
-    // this section when the patch is commited.
-    auto& FC1 = Env1.getFlowConditionToken();
-    auto& FC2 = Env2.getFlowConditionToken();
-    MergedEnv.addToFlowCondition(MergedEnv.makeOr(
-        MergedEnv.makeAnd(FC1, MergedEnv.makeIff(MergedBool, Bool1)),
-        MergedEnv.makeAnd(FC2, MergedEnv.makeIff(MergedBool, Bool2))));
-  }
+  auto& MergedBool = MergedEnv.makeAtomicBoolValue();
+  // TODO(b/233582219): Flow conditions are not necessarily mutually
+  // exclusive, a fix is in order: https://reviews.llvm.org/D130270. Update
+  // this section when the patch is commited.
+  auto& FC1 = Env1.getFlowConditionToken();
+  auto& FC2 = Env2.getFlowConditionToken();
+  MergedEnv.addToFlowCondition(MergedEnv.makeOr(
+      MergedEnv.makeAnd(FC1, MergedEnv.makeIff(MergedBool, Bool1)),
+      MergedEnv.makeAnd(FC2, MergedEnv.makeIff(MergedBool, Bool2))));
   return MergedBool;
 }
 
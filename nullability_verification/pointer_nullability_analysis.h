@@ -6,6 +6,7 @@
 #define CRUBIT_NULLABILITY_VERIFICATION_POINTER_NULLABILITY_ANALYSIS_H_
 
 #include "nullability_verification/pointer_nullability_lattice.h"
+#include "nullability_verification/pointer_nullability_summaries.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Type.h"
 #include "clang/Analysis/FlowSensitive/CFGMatchSwitch.h"
@@ -26,11 +27,13 @@ class PointerNullabilityAnalysis
   absl::flat_hash_map<const Expr*, std::vector<NullabilityKind>>
       ExprToNullability;
 
+  FunctionNullabilitySummaries Summaries;
+
  public:
   explicit PointerNullabilityAnalysis(ASTContext& context);
 
   PointerNullabilityLattice initialElement() {
-    return PointerNullabilityLattice(&ExprToNullability);
+    return PointerNullabilityLattice(&ExprToNullability, &Summaries);
   }
 
   void transfer(const CFGElement& Elt, PointerNullabilityLattice& Lattice,
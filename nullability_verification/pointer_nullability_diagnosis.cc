@@ -4,10 +4,15 @@
 
 #include "nullability_verification/pointer_nullability_diagnosis.h"
 
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
+#include "common/cfg_cache.h"
+#include "common/timing.h"
 #include "nullability_verification/pointer_nullability.h"
+#include "nullability_verification/pointer_nullability_analysis.h"
 #include "nullability_verification/pointer_nullability_matchers.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclCXX.h"
@@ -15,8 +20,13 @@
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/Stmt.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
 #include "clang/Analysis/FlowSensitive/CFGMatchSwitch.h"
+#include "clang/Analysis/FlowSensitive/ControlFlowContext.h"
+#include "clang/Analysis/FlowSensitive/DataflowAnalysis.h"
+#include "clang/Analysis/FlowSensitive/DataflowAnalysisContext.h"
 #include "clang/Analysis/FlowSensitive/DataflowEnvironment.h"
+#include "clang/Analysis/FlowSensitive/WatchedLiteralsSolver.h"
 #include "clang/Basic/Specifiers.h"
 
 namespace clang {
@@ -268,10 +278,122 @@ auto buildDiagnoser() {
       .Build();
 }
 
+// The diagnosis switch is stateless, so it is built once per process and
+// copied into each diagnoser: a copy only bumps reference counts on the
+// underlying matchers, whereas rebuilding it constructs every matcher anew.
+// The analysis transferers use the same pattern.
+const auto& sharedDiagnoser() {
+  static const auto& Diagnoser = *new decltype(buildDiagnoser())(
+      buildDiagnoser());
+  return Diagnoser;
+}
+
+// Returns true if the subtree rooted at `S` contains an expression that could
+// feed one of the diagnoser cases above: an expression of pointer type (the
+// operand of every dereference, arrow access, and incompatible assignment is
+// pointer-typed, including the implicit casts materialized for conversions
+// from `nullptr`), or a call to `__assert_nullability` (whose argument may be
+// an aggregate that merely contains pointers).
+bool hasPointerTypedExpr(const Stmt* S) {
+  if (const auto* E = dyn_cast<Expr>(S)) {
+    QualType Type = E->getType();
+    if (Type->isAnyPointerType() || Type->isNullPtrType()) return true;
+    if (const auto* CE = dyn_cast<CallExpr>(E)) {
+      const auto* FD = CE->getDirectCallee();
+      if (FD && FD->getDeclName().isIdentifier() &&
+          FD->getName() == "__assert_nullability") {
+        return true;
+      }
+    }
+  }
+  for (const Stmt* Child : S->children()) {
+    if (Child != nullptr && hasPointerTypedExpr(Child)) return true;
+  }
+  return false;
+}
+
+// Returns true unless a cheap syntactic scan proves that no diagnoser case
+// can fire in `Func`, in which case the dataflow run can be skipped entirely.
+// In typical code a large fraction of functions perform no pointer operations
+// at all, so this filter removes their per-function CFG and analysis cost.
+bool mayRequireNullabilityDiagnosis(const FunctionDecl& Func) {
+  if (Func.getReturnType()->isAnyPointerType()) return true;
+  if (const auto* Ctor = dyn_cast<CXXConstructorDecl>(&Func)) {
+    for (const auto* Init : Ctor->inits()) {
+      if (Init->isAnyMemberInitializer() &&
+          Init->getAnyMember()->getType()->isAnyPointerType()) {
+        return true;
+      }
+      if (Init->getInit() != nullptr && hasPointerTypedExpr(Init->getInit())) {
+        return true;
+      }
+    }
+  }
+  return hasPointerTypedExpr(Func.getBody());
+}
+
 }  // namespace
 
 PointerNullabilityDiagnoser::PointerNullabilityDiagnoser()
-    : Diagnoser(buildDiagnoser()) {}
+    : Diagnoser(sharedDiagnoser()) {}
+
+llvm::Expected<std::vector<CFGElement>> diagnoseTranslationUnit(
+    ASTContext& Ctx, crubit::FunctionCfgCache* CfgCache) {
+  using ast_matchers::findAll;
+  using ast_matchers::functionDecl;
+  using ast_matchers::hasBody;
+  using ast_matchers::isDefinition;
+  using ast_matchers::match;
+  using ast_matchers::stmt;
+
+  std::vector<CFGElement> Diagnostics;
+  PointerNullabilityDiagnoser Diagnoser;
+  // Used when the caller doesn't supply a shared cache. Each function is
+  // diagnosed once here, so a local cache buys nothing on its own; the
+  // sharing pays off when the caller passes the cache a previous dataflow
+  // client already filled for this AST.
+  crubit::FunctionCfgCache LocalCfgCache;
+  if (CfgCache == nullptr) CfgCache = &LocalCfgCache;
+
+  for (const auto& Node : match(
+           findAll(functionDecl(isDefinition(), hasBody(stmt())).bind("func")),
+           Ctx)) {
+    const auto* Func = Node.getNodeAs<FunctionDecl>("func");
+    if (!mayRequireNullabilityDiagnosis(*Func)) continue;
+    CRUBIT_SCOPED_TIMER("nullability_diagnosis_function");
+    auto CFCtx = CfgCache->Get(Func);
+    if (!CFCtx) return CFCtx.takeError();
+    CRUBIT_RECORD_TIMING_HISTOGRAM("nullability_cfg_blocks",
+                                   (*CFCtx)->getCFG().size());
+
+    // One analysis context (and thus solver) per function: the contexts
+    // intern state for the lifetime of the object and expose no reset API, so
+    // sharing one across the whole translation unit would grow without bound.
+    dataflow::DataflowAnalysisContext AnalysisContext(
+        std::make_unique<dataflow::WatchedLiteralsSolver>());
+    dataflow::Environment Env(AnalysisContext, *Func);
+    PointerNullabilityAnalysis Analysis(Ctx);
+
+    llvm::Expected<std::vector<std::optional<
+        dataflow::DataflowAnalysisState<PointerNullabilityLattice>>>>
+        BlockToOutputState = dataflow::runDataflowAnalysis(
+            **CFCtx, Analysis, Env,
+            [&](const CFGElement& Elt,
+                const dataflow::DataflowAnalysisState<
+                    PointerNullabilityLattice>& State) {
+              auto EltDiagnostics = Diagnoser.diagnose(
+                  &Elt, Ctx,
+                  TransferStateForDiagnostics<PointerNullabilityLattice>(
+                      State.Lattice, State.Env));
+              if (EltDiagnostics.has_value()) {
+                Diagnostics.push_back(EltDiagnostics.value());
+              }
+            });
+    if (!BlockToOutputState) return BlockToOutputState.takeError();
+  }
+
+  return Diagnostics;
+}
 
 }  // namespace nullability
 }  // namespace tidy
@@ -5,12 +5,16 @@
 #ifndef CRUBIT_NULLABILITY_VERIFICATION_POINTER_NULLABILITY_DIAGNOSIS_H_
 #define CRUBIT_NULLABILITY_VERIFICATION_POINTER_NULLABILITY_DIAGNOSIS_H_
 
+#include <vector>
+
+#include "common/cfg_cache.h"
 #include "nullability_verification/pointer_nullability_lattice.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Stmt.h"
 #include "clang/Analysis/FlowSensitive/CFGMatchSwitch.h"
 #include "clang/Analysis/FlowSensitive/DataflowEnvironment.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/Support/Error.h"
 
 namespace clang {
 namespace tidy {
@@ -45,6 +49,24 @@ class PointerNullabilityDiagnoser {
       Diagnoser;
 };
 
+/// Runs `PointerNullabilityAnalysis` followed by diagnosis over every function
+/// definition in the translation unit and returns the combined diagnostics, in
+/// the order in which the function definitions appear.
+///
+/// Functions are verified one at a time. They are independent for this check,
+/// but they share the `ASTContext`, which is not thread-safe (even "read-only"
+/// AST walks can lazily deserialize and canonicalize state), so the work
+/// cannot be farmed out to a thread pool. Per-function dataflow state is
+/// still isolated: each function gets its own `DataflowAnalysisContext` and
+/// solver.
+///
+/// If `CfgCache` is non-null, CFGs are looked up in (and added to) it rather
+/// than built locally. Pass the cache another dataflow client (e.g. the
+/// lifetime analysis) used over the same AST so each function's CFG is built
+/// only once per pass; the cache must not outlive `Ctx`.
+llvm::Expected<std::vector<CFGElement>> diagnoseTranslationUnit(
+    ASTContext& Ctx, crubit::FunctionCfgCache* CfgCache = nullptr);
+
 }  // namespace nullability
 }  // namespace tidy
 }  // namespace clang
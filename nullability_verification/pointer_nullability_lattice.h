@@ -10,6 +10,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "nullability_verification/pointer_nullability_summaries.h"
 #include "clang/Analysis/FlowSensitive/DataflowAnalysis.h"
 #include "clang/Analysis/FlowSensitive/DataflowAnalysisContext.h"
 #include "clang/Analysis/FlowSensitive/DataflowLattice.h"
@@ -21,20 +22,34 @@ namespace nullability {
 class PointerNullabilityLattice {
  private:
   // Owned by the PointerNullabilityAnalysis object, shared by all lattice
-  // elements within one analysis run.
+  // elements within one analysis run. Because the map is shared rather than
+  // copied per CFG block (joins are no-ops), a lattice element is just this
+  // pointer, and an expression's nullability vector is computed and stored
+  // once per function regardless of how many fixpoint iterations revisit it.
   absl::flat_hash_map<const Expr *, std::vector<NullabilityKind>>
       *ExprToNullability;
 
+  // Also owned by the PointerNullabilityAnalysis object and shared by all
+  // lattice elements; see `FunctionNullabilitySummaries`.
+  FunctionNullabilitySummaries *Summaries;
+
  public:
   PointerNullabilityLattice(
       absl::flat_hash_map<const Expr *, std::vector<NullabilityKind>>
-          *ExprToNullability)
-      : ExprToNullability(ExprToNullability) {}
+          *ExprToNullability,
+      FunctionNullabilitySummaries *Summaries)
+      : ExprToNullability(ExprToNullability), Summaries(Summaries) {}
+
+  FunctionNullabilitySummaries &functionSummaries() const {
+    return *Summaries;
+  }
 
   std::optional<ArrayRef<NullabilityKind>> getExprNullability(
       const Expr *E) const {
+    // `ignoreCFGOmittedNodes` is idempotent, so normalize `E` once rather
+    // than again for the lookup key.
     E = &dataflow::ignoreCFGOmittedNodes(*E);
-    auto I = ExprToNullability->find(&dataflow::ignoreCFGOmittedNodes(*E));
+    auto I = ExprToNullability->find(E);
     return I == ExprToNullability->end()
                ? std::nullopt
                : std::optional<ArrayRef<NullabilityKind>>(I->second);
@@ -0,0 +1,124 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "nullability_verification/pointer_nullability_summaries.h"
+
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/Stmt.h"
+#include "clang/AST/Type.h"
+#include "clang/Basic/Specifiers.h"
+
+namespace clang {
+namespace tidy {
+namespace nullability {
+
+namespace {
+
+// Invokes `Visit` on every return statement in the subtree rooted at `S`,
+// without descending into lambdas (their return statements belong to the
+// lambda's call operator, not to the enclosing function). Returns false if
+// any visit returns false.
+template <typename Visitor>
+bool forEachReturnStmt(const Stmt& S, const Visitor& Visit) {
+  if (const auto* RS = dyn_cast<ReturnStmt>(&S)) {
+    if (!Visit(*RS)) return false;
+  }
+  if (isa<LambdaExpr>(&S)) return true;
+  for (const Stmt* Child : S.children()) {
+    if (Child != nullptr && !forEachReturnStmt(*Child, Visit)) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+NullabilityKind FunctionNullabilitySummaries::getReturnNullability(
+    const FunctionDecl& Func) {
+  // A declared annotation is authoritative; no summary is needed.
+  if (auto Declared = Func.getReturnType()->getNullability();
+      Declared.value_or(NullabilityKind::Unspecified) !=
+      NullabilityKind::Unspecified) {
+    return *Declared;
+  }
+  if (!Func.getReturnType()->isAnyPointerType()) {
+    return NullabilityKind::Unspecified;
+  }
+
+  const FunctionDecl* Canonical = Func.getCanonicalDecl();
+  if (auto It = Summaries.find(Canonical); It != Summaries.end()) {
+    return It->second;
+  }
+
+  const FunctionDecl* Def = nullptr;
+  if (!Func.hasBody(Def)) {
+    return NullabilityKind::Unspecified;
+  }
+  // Cut off call-graph cycles: a recursive call contributes `Unspecified`,
+  // which conservatively keeps every function on the cycle unsummarized.
+  if (!InProgress.insert(Canonical).second) {
+    return NullabilityKind::Unspecified;
+  }
+  NullabilityKind Result = computeReturnNullability(*Def);
+  InProgress.erase(Canonical);
+  Summaries.insert({Canonical, Result});
+  return Result;
+}
+
+NullabilityKind FunctionNullabilitySummaries::computeReturnNullability(
+    const FunctionDecl& Def) {
+  bool SawReturn = false;
+  auto VisitReturn = [&](const ReturnStmt& RS) {
+    const Expr* RetVal = RS.getRetValue();
+    if (RetVal == nullptr || !RetVal->getType()->isAnyPointerType()) {
+      return true;
+    }
+    SawReturn = true;
+    return classifyReturnedExpr(*RetVal->IgnoreParenImpCasts()) ==
+           NullabilityKind::NonNull;
+  };
+  bool AllNonNull = forEachReturnStmt(*Def.getBody(), VisitReturn);
+  return SawReturn && AllNonNull ? NullabilityKind::NonNull
+                                 : NullabilityKind::Unspecified;
+}
+
+NullabilityKind FunctionNullabilitySummaries::classifyReturnedExpr(
+    const Expr& E) {
+  // An annotation on the returned expression's own type is authoritative.
+  if (auto Declared = E.getType()->getNullability();
+      Declared.value_or(NullabilityKind::Unspecified) !=
+      NullabilityKind::Unspecified) {
+    return *Declared;
+  }
+  // Expressions that denote the address of an object are never null.
+  if (isa<CXXThisExpr>(&E) || isa<StringLiteral>(&E) ||
+      isa<PredefinedExpr>(&E)) {
+    return NullabilityKind::NonNull;
+  }
+  if (const auto* UO = dyn_cast<UnaryOperator>(&E);
+      UO != nullptr && UO->getOpcode() == UO_AddrOf) {
+    return NullabilityKind::NonNull;
+  }
+  // `IgnoreParenImpCasts` strips array-to-pointer decay, so an array-typed
+  // expression here is a decayed array, whose address is never null.
+  if (E.getType()->isArrayType()) {
+    return NullabilityKind::NonNull;
+  }
+  // A throwing `new` never returns null; a nothrow `new` may.
+  if (const auto* NE = dyn_cast<CXXNewExpr>(&E);
+      NE != nullptr && !NE->shouldNullCheckAllocation()) {
+    return NullabilityKind::NonNull;
+  }
+  // Follow direct calls bottom-up into their summaries.
+  if (const auto* CE = dyn_cast<CallExpr>(&E)) {
+    if (const auto* Callee = CE->getDirectCallee()) {
+      return getReturnNullability(*Callee);
+    }
+  }
+  return NullabilityKind::Unspecified;
+}
+
+}  // namespace nullability
+}  // namespace tidy
+}  // namespace clang
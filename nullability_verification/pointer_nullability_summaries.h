@@ -0,0 +1,52 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_NULLABILITY_VERIFICATION_POINTER_NULLABILITY_SUMMARIES_H_
+#define CRUBIT_NULLABILITY_VERIFICATION_POINTER_NULLABILITY_SUMMARIES_H_
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/Specifiers.h"
+
+namespace clang {
+namespace tidy {
+namespace nullability {
+
+/// Caches per-function nullability summaries so that call sites can be modeled
+/// more precisely than the callee's declared type alone allows.
+///
+/// A summary is currently just the return nullability of a function. For
+/// callees whose return type carries no annotation but whose definition is
+/// visible, the summary is inferred from the returned expressions, following
+/// calls to other visible functions bottom-up over the call graph (recursion
+/// is cut off conservatively). Summaries are cached per canonical declaration,
+/// so each function body is scanned at most once no matter how many call
+/// sites the analysis visits across a translation unit.
+///
+/// Only `NonNull` is ever inferred: an unannotated function that can return
+/// null stays `Unspecified` rather than becoming `Nullable`, because the
+/// gradual verification model must not start diagnosing code whose types the
+/// user has not annotated yet.
+class FunctionNullabilitySummaries {
+ public:
+  /// Returns the nullability of `Func`'s return value: the declared
+  /// annotation if there is one, otherwise a summary inferred from the
+  /// definition, otherwise `Unspecified`.
+  NullabilityKind getReturnNullability(const FunctionDecl& Func);
+
+ private:
+  NullabilityKind computeReturnNullability(const FunctionDecl& Def);
+  NullabilityKind classifyReturnedExpr(const Expr& E);
+
+  absl::flat_hash_map<const FunctionDecl*, NullabilityKind> Summaries;
+  // Guards against call-graph cycles while a summary is being computed.
+  absl::flat_hash_set<const FunctionDecl*> InProgress;
+};
+
+}  // namespace nullability
+}  // namespace tidy
+}  // namespace clang
+
+#endif  // CRUBIT_NULLABILITY_VERIFICATION_POINTER_NULLABILITY_SUMMARIES_H_
@@ -1409,6 +1409,63 @@ TEST(PointerNullabilityTest, CallExprWithPointerReturnType) {
   )cc"));
 }
 
+TEST(PointerNullabilityTest, CallExprWithReturnNullabilitySummary) {
+  // An unannotated callee whose definition only ever returns the address of
+  // an object is summarized as returning nonnull, so null checks against its
+  // result prune the null branch.
+  EXPECT_TRUE(checkDiagnostics(R"cc(
+    int* makeNonnullUnannotated() {
+      static int i = 0;
+      return &i;
+    }
+    void target(int* _Nullable q) {
+      int* x = makeNonnullUnannotated();
+      if (x == nullptr) *q;
+    }
+  )cc"));
+
+  // The summary follows calls bottom-up through other visible definitions.
+  EXPECT_TRUE(checkDiagnostics(R"cc(
+    int* makeNonnullUnannotated() {
+      static int i = 0;
+      return &i;
+    }
+    int* forwardsNonnull() { return makeNonnullUnannotated(); }
+    void target(int* _Nullable q) {
+      int* x = forwardsNonnull();
+      if (x == nullptr) *q;
+    }
+  )cc"));
+
+  // A callee that can return null stays unannotated rather than becoming
+  // nullable: the null branch is still live, but dereferencing the result
+  // directly is not diagnosed.
+  EXPECT_TRUE(checkDiagnostics(R"cc(
+    int* makeMaybeNull(bool b) {
+      static int i = 0;
+      return b ? &i : nullptr;
+    }
+    void target(int* _Nullable q) {
+      int* x = makeMaybeNull(true);
+      *x;
+      if (x == nullptr) *q;  // [[unsafe]]
+    }
+  )cc"));
+
+  // Recursive callees are conservatively left unsummarized.
+  EXPECT_TRUE(checkDiagnostics(R"cc(
+    int* makeRecursive(int n) {
+      static int i = 0;
+      if (n > 0) return makeRecursive(n - 1);
+      return &i;
+    }
+    void target(int* _Nullable q) {
+      int* x = makeRecursive(3);
+      if (x == nullptr) *q;  // [[unsafe]]
+    }
+  )cc"));
+}
+
 TEST(PointerNullabilityTest, DoubleDereference) {
   EXPECT_TRUE(checkDiagnostics(R"cc(
     void target(int** p) {
@@ -6,12 +6,16 @@
 
 #include "absl/log/check.h"
 #include "rs_bindings_from_cc/importer.h"
+#include "rs_bindings_from_cc/ir.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/Frontend/CompilerInstance.h"
 
 namespace crubit {
 
 void AstConsumer::HandleTranslationUnit(clang::ASTContext& ast_context) {
+  // This is a fresh AST; decl pointers memoized from a previously destroyed
+  // AST may have been reused and must not resolve to the old ids.
+  ClearStableItemIdCache();
   if (ast_context.getDiagnostics().hasErrorOccurred()) {
     // We do not need to process partially incorrect headers, we assume all
     // input is valid C++. If there is an error Clang already printed it to
@@ -20,8 +24,13 @@ void AstConsumer::HandleTranslationUnit(clang::ASTContext& ast_context) {
     return;
   }
   CHECK(instance_.hasSema());
-  Importer importer(invocation_, ast_context, instance_.getSema());
-  importer.Import(ast_context.getTranslationUnitDecl());
+  for (Invocation* invocation : invocations_) {
+    Importer importer(*invocation, ast_context, instance_.getSema());
+    importer.Import(ast_context.getTranslationUnitDecl());
+  }
+  for (const TuConsumer& tu_consumer : tu_consumers_) {
+    tu_consumer(ast_context);
+  }
 }
 
 }  // namespace crubit
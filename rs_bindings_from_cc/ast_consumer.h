@@ -5,6 +5,10 @@
 #ifndef CRUBIT_RS_BINDINGS_FROM_CC_AST_CONSUMER_H_
 #define CRUBIT_RS_BINDINGS_FROM_CC_AST_CONSUMER_H_
 
+#include <functional>
+#include <utility>
+#include <vector>
+
 #include "rs_bindings_from_cc/decl_importer.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
@@ -12,19 +16,44 @@
 
 namespace crubit {
 
+// An additional consumer of the fully parsed translation unit, run after the
+// importer(s). This is the shared-frontend hook: analyses that would
+// otherwise re-parse the same headers in their own Clang invocation (e.g.
+// `clang::tidy::lifetimes::AnalyzeTranslationUnit` or
+// `clang::tidy::nullability::diagnoseTranslationUnit`) can instead be
+// registered on the `FrontendAction` and handed the AST that bindings
+// generation already paid to build.
+using TuConsumer = std::function<void(clang::ASTContext&)>;
+
 // Consumes the Clang AST created from the invocation's entry header and
-// generates the intermediate representation (`IR`) in the invocation object.
+// generates the intermediate representation (`IR`) in the invocation
+// object(s). With several invocations, each one is imported in turn against
+// the same AST; any `TuConsumer`s run afterwards.
 class AstConsumer : public clang::ASTConsumer {
  public:
   explicit AstConsumer(clang::CompilerInstance& instance,
-                       Invocation& invocation)
-      : instance_(instance), invocation_(invocation) {}
+                       std::vector<Invocation*> invocations,
+                       std::vector<TuConsumer> tu_consumers = {})
+      : instance_(instance),
+        invocations_(std::move(invocations)),
+        tu_consumers_(std::move(tu_consumers)) {}
 
   void HandleTranslationUnit(clang::ASTContext& context) override;
 
+  // Consulted by `Sema::canSkipFunctionBody` when `SkipFunctionBodies` is on
+  // (see `FrontendAction::BeginInvocation`). The importer never looks inside
+  // a body, so everything Sema itself doesn't insist on parsing (constexpr
+  // functions, undeduced return types) is skipped. `TuConsumer`s, in
+  // contrast, are typically dataflow analyses that do look inside bodies, so
+  // their presence turns skipping off wholesale.
+  bool shouldSkipFunctionBody(clang::Decl* decl) override {
+    return tu_consumers_.empty();
+  }
+
  private:
   clang::CompilerInstance& instance_;
-  Invocation& invocation_;
+  std::vector<Invocation*> invocations_;
+  std::vector<TuConsumer> tu_consumers_;
 };  // class AstConsumer
 
 }  // namespace crubit
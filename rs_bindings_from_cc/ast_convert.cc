@@ -105,6 +105,14 @@ SpecialMemberFunc GetSpecialMemberFunc(
 
 }  // namespace
 
+SpecialMemberFuncs GetSpecialMemberFuncs(const clang::RecordDecl& record_decl) {
+  return {
+      .copy_constructor = GetCopyCtorSpecialMemberFunc(record_decl),
+      .move_constructor = GetMoveCtorSpecialMemberFunc(record_decl),
+      .destructor = GetDestructorSpecialMemberFunc(record_decl),
+  };
+}
+
 SpecialMemberFunc GetCopyCtorSpecialMemberFunc(
     const clang::RecordDecl& record_decl) {
   return GetSpecialMemberFunc(record_decl, &GetCopyCtor);
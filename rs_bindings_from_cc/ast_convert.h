@@ -15,6 +15,20 @@
 
 namespace crubit {
 
+// Classification of all of a record's special member functions that the IR
+// cares about.
+struct SpecialMemberFuncs {
+  SpecialMemberFunc copy_constructor = SpecialMemberFunc::kUnavailable;
+  SpecialMemberFunc move_constructor = SpecialMemberFunc::kUnavailable;
+  SpecialMemberFunc destructor = SpecialMemberFunc::kUnavailable;
+};
+
+// Computes the classification of all special member functions of `record_decl`
+// in one go.  Prefer `ImportContext::GetSpecialMemberFuncs`, which caches the
+// result per canonical record decl; the computation walks the record's
+// constructor list and all of its base classes.
+SpecialMemberFuncs GetSpecialMemberFuncs(const clang::RecordDecl& record_decl);
+
 SpecialMemberFunc GetCopyCtorSpecialMemberFunc(
     const clang::RecordDecl& record_decl);
 
@@ -48,7 +48,7 @@ def generate_bindings(
     """
     cc_output = ctx.actions.declare_file(ctx.label.name + "_rust_api_impl.cc")
     rs_output = ctx.actions.declare_file(ctx.label.name + "_rust_api.rs")
-    namespaces_output = ctx.actions.declare_file(ctx.label.name + "_namespaces.json")
+    namespaces_output = ctx.actions.declare_file(ctx.label.name + "_namespaces.bin")
     error_report_output = None
 
     rs_bindings_from_cc_flags = [
@@ -29,7 +29,8 @@ def generate_and_compile_bindings(
         extra_rs_srcs,
         deps_for_cc_file,
         deps_for_rs_file,
-        extra_cc_compilation_action_inputs = []):
+        extra_cc_compilation_action_inputs = [],
+        prebuilt_bindings = None):
     """Runs the bindings generator.
 
     Args:
@@ -45,6 +46,10 @@ def generate_and_compile_bindings(
       deps_for_cc_file: list[CcInfo]: CcInfos needed by the generated C++ source file.
       deps_for_rs_file: list[DepVariantInfo]: DepVariantInfos needed by the generated Rust source file.
       extra_cc_compilation_action_inputs: A list of input files for the C++ compilation action.
+      prebuilt_bindings: An optional struct(cc_file, rust_file, namespaces_file) of previously
+                        generated bindings sources. When set, the generator is not run; the
+                        prebuilt sources are compiled instead. The caller is responsible for
+                        ensuring the sources actually match the headers of the current target.
 
     Returns:
       A RustBindingsFromCcInfo containing the result of the compilation of the generated source
@@ -59,18 +64,30 @@ def generate_and_compile_bindings(
         unsupported_features = ctx.disabled_features + ["module_maps"],
     )
 
-    cc_output, rs_output, namespaces_output, error_report_output = generate_bindings(
-        ctx = ctx,
-        attr = attr,
-        cc_toolchain = cc_toolchain,
-        feature_configuration = feature_configuration,
-        compilation_context = compilation_context,
-        public_hdrs = public_hdrs,
-        header_includes = header_includes,
-        action_inputs = action_inputs,
-        targets_and_headers = targets_and_headers,
-        extra_rs_srcs = extra_rs_srcs,
-    )
+    if prebuilt_bindings:
+        # Substitute previously published bindings sources for the generator
+        # action. The sources are symlinked under this rule's own name so that
+        # downstream actions see the same paths as for generated bindings.
+        cc_output = ctx.actions.declare_file(ctx.label.name + "_rust_api_impl.cc")
+        rs_output = ctx.actions.declare_file(ctx.label.name + "_rust_api.rs")
+        namespaces_output = ctx.actions.declare_file(ctx.label.name + "_namespaces.bin")
+        error_report_output = None
+        ctx.actions.symlink(output = cc_output, target_file = prebuilt_bindings.cc_file)
+        ctx.actions.symlink(output = rs_output, target_file = prebuilt_bindings.rust_file)
+        ctx.actions.symlink(output = namespaces_output, target_file = prebuilt_bindings.namespaces_file)
+    else:
+        cc_output, rs_output, namespaces_output, error_report_output = generate_bindings(
+            ctx = ctx,
+            attr = attr,
+            cc_toolchain = cc_toolchain,
+            feature_configuration = feature_configuration,
+            compilation_context = compilation_context,
+            public_hdrs = public_hdrs,
+            header_includes = header_includes,
+            action_inputs = action_inputs,
+            targets_and_headers = targets_and_headers,
+            extra_rs_srcs = extra_rs_srcs,
+        )
 
     # Relocate the rs files so that they can be read by rustc using relative paths.
     extra_rs_srcs_relocated = []
@@ -69,6 +69,28 @@ def _bindings_for_toolchain_headers_impl(ctx):
         header_includes.append("-include")
         header_includes.append(hdr)
 
+    # Generating bindings for the toolchain headers costs tens of CPU-minutes
+    # and its inputs (the toolchain header set) are independent of the
+    # consuming workspace. When the prebuilt_* attributes point at bindings
+    # sources fetched from a shared cache (published from CI, content-addressed
+    # by the header set), the generator action is skipped on cold builds and
+    # only the compilation of the sources runs locally.
+    prebuilt_files = [
+        ctx.file.prebuilt_rs_api,
+        ctx.file.prebuilt_rs_api_impl,
+        ctx.file.prebuilt_namespaces,
+    ]
+    prebuilt_bindings = None
+    if any(prebuilt_files):
+        if not all(prebuilt_files):
+            fail("prebuilt_rs_api, prebuilt_rs_api_impl and prebuilt_namespaces " +
+                 "must either all be set or all be unset")
+        prebuilt_bindings = struct(
+            rust_file = ctx.file.prebuilt_rs_api,
+            cc_file = ctx.file.prebuilt_rs_api_impl,
+            namespaces_file = ctx.file.prebuilt_namespaces,
+        )
+
     return [RustToolchainHeadersInfo(headers = std_and_builtin_files)] + generate_and_compile_bindings(
         ctx,
         ctx.attr,
@@ -80,6 +102,7 @@ def _bindings_for_toolchain_headers_impl(ctx):
         extra_rs_srcs = ctx.files.extra_rs_srcs,
         deps_for_cc_file = ctx.attr._deps_for_bindings[DepsForBindingsInfo].deps_for_cc_file,
         deps_for_rs_file = ctx.attr._deps_for_bindings[DepsForBindingsInfo].deps_for_rs_file,
+        prebuilt_bindings = prebuilt_bindings,
     )
 
 bindings_for_toolchain_headers = rule(
@@ -90,6 +113,20 @@ bindings_for_toolchain_headers = rule(
             "public_libc_hdrs": attr.string_list(),
             "public_libcxx_hdrs": attr.string_list(),
             "extra_rs_srcs": attr.label_list(allow_files = True),
+            "prebuilt_rs_api": attr.label(
+                doc = "Previously generated ..._rust_api.rs for this header set, e.g. " +
+                      "fetched from a shared cache. Must be set together with the other " +
+                      "prebuilt_* attributes; when set, the bindings generator is not run.",
+                allow_single_file = True,
+            ),
+            "prebuilt_rs_api_impl": attr.label(
+                doc = "Previously generated ..._rust_api_impl.cc for this header set.",
+                allow_single_file = True,
+            ),
+            "prebuilt_namespaces": attr.label(
+                doc = "Previously generated ..._namespaces.bin for this header set.",
+                allow_single_file = True,
+            ),
             "_stl": attr.label(default = "//third_party/stl:stl"),
         }.items(),
     ),
@@ -12,7 +12,9 @@
 namespace crubit {
 
 // Representation of a Bazel label (for example //foo/bar:baz).
-CRUBIT_DEFINE_STRING_TYPE(BazelLabel);
+// Labels are hash-map keys on the per-decl import path (`headers_to_targets`
+// via `GetOwningTarget`), so they cache their hash at construction.
+CRUBIT_DEFINE_STRING_TYPE_WITH_CACHED_HASH(BazelLabel);
 
 // Coverts the argument to a valid C++ identifier (e.g. replacing characters
 // like ":" or "/" with "_").
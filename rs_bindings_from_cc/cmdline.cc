@@ -6,14 +6,17 @@
 
 #include <algorithm>
 #include <iterator>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
 #include "absl/log/log.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "common/status_macros.h"
 #include "llvm/Support/JSON.h"
 
@@ -32,11 +35,15 @@ ABSL_FLAG(std::string, crubit_support_path, "",
           "should be used in the #include directives inside the generated .cc "
           "files.");
 ABSL_FLAG(std::string, clang_format_exe_path, "",
-          "Path to a clang-format executable that will be used to format the "
-          ".cc files generated by the tool.");
+          "(optional) path to a clang-format executable that will be used to "
+          "format the .cc files generated by the tool. When empty, the tool "
+          "formats in-process with a built-in indentation-aware printer "
+          "instead of spawning a subprocess.");
 ABSL_FLAG(std::string, rustfmt_exe_path, "",
-          "Path to a rustfmt executable that will be used to format the "
-          ".rs files generated by the tool.");
+          "(optional) path to a rustfmt executable that will be used to "
+          "format the .rs files generated by the tool. When empty, the tool "
+          "formats in-process with a simple line-breaking printer instead of "
+          "spawning a subprocess.");
 ABSL_FLAG(std::string, rustfmt_config_path, "",
           "(optional) path to a rustfmt.toml file that should replace the "
           "default formatting of the .rs files generated by the tool.");
@@ -70,6 +77,36 @@ ABSL_FLAG(std::string, namespaces_out, "",
           "namespace hierarchy.");
 ABSL_FLAG(std::string, error_report_out, "",
           "(optional) output path for the JSON error report");
+ABSL_FLAG(std::string, fingerprint_out, "",
+          "(optional) output path for a fingerprint manifest of the "
+          "invocation's inputs. When the file already matches the current "
+          "inputs and all requested outputs exist, the tool exits without "
+          "regenerating anything.");
+ABSL_FLAG(std::string, timing_report_out, "",
+          "(optional) output path for a JSON report with per-phase wall/cpu "
+          "times and item counts of this invocation.");
+ABSL_FLAG(bool, stable_item_ids, false,
+          "derive IR item ids from a hash of each decl's USR instead of its "
+          "decl pointer. Stable ids are reproducible across processes, which "
+          "cross-process consumers of the IR (shard merging, caching) need; "
+          "pointer-derived ids are cheaper and remain the default.");
+ABSL_FLAG(bool, thin_ir_only, false,
+          "emit only the serialized IR subset that dependent targets consume "
+          "(records, enums, aliases, namespaces - no functions), and skip "
+          "source generation and formatting entirely. Requires --ir_out; the "
+          "--rs_out/--cc_out outputs are written as empty placeholders.");
+ABSL_FLAG(bool, no_doc_comments, false,
+          "do not import comments: attached doc comments are dropped from the "
+          "IR and the generated bindings, and free-standing comments are not "
+          "collected. Shrinks the outputs for builds that do not need docs, "
+          "e.g. CI.");
+ABSL_FLAG(int, shard_count, 0,
+          "(optional) when > 1, partition --public_headers into this many "
+          "contiguous slices, parse and import each slice in its own Clang "
+          "invocation, and merge the per-shard IRs before generating one "
+          "combined set of outputs. Caps peak AST memory for targets whose "
+          "header set is too large for a single parse. Headers of one slice "
+          "must not include headers of another slice of the same target.");
 
 namespace crubit {
 
@@ -88,8 +125,133 @@ bool fromJSON(const llvm::json::Value& json, TargetAndHeaders& out,
 
 }  // namespace
 
+absl::StatusOr<std::shared_ptr<const InvocationContext>>
+InvocationContext::Create(absl::string_view targets_and_headers_json) {
+  if (targets_and_headers_json.empty()) {
+    return absl::InvalidArgumentError("please specify --targets_and_headers");
+  }
+  auto targets_and_headers = llvm::json::parse<std::vector<TargetAndHeaders>>(
+      llvm::StringRef(targets_and_headers_json.data(),
+                      targets_and_headers_json.size()));
+  if (auto err = targets_and_headers.takeError()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Malformed `--targets_and_headers` argument: ",
+                     toString(std::move(err))));
+  }
+  std::shared_ptr<InvocationContext> context(new InvocationContext);
+  for (const TargetAndHeaders& it : *targets_and_headers) {
+    const std::string& target = it.target;
+    if (target.empty()) {
+      return absl::InvalidArgumentError(
+          "Expected `t` fields of `--targets_and_headers` to be a non-empty "
+          "string");
+    }
+    // One label per target entry: all its headers share copies of this
+    // interned label (a copy reuses the cached hash instead of re-hashing
+    // the string).
+    BazelLabel target_label(target);
+    for (const std::string& header : it.headers) {
+      if (header.empty()) {
+        return absl::InvalidArgumentError(
+            "Expected `h` fields of `--targets_and_headers` to be an array of "
+            "non-empty strings");
+      }
+      auto [map_it, inserted] = context->headers_to_targets_.try_emplace(
+          HeaderName(header), target_label);
+      if (!inserted) {
+        LOG(WARNING) << "The `--targets_and_headers` cmdline argument assigns "
+                        "`"
+                     << header << "` header to two conflicting targets: `"
+                     << target << "` vs `" << map_it->second.value() << "`";
+        // Assign the one that comes first alphabetically, to get a consistent
+        // result.
+        if (target_label.value() < map_it->second.value()) {
+          map_it->second = target_label;
+        }
+      }
+    }
+  }
+  return context;
+}
+
+absl::StatusOr<std::shared_ptr<const InvocationContext>>
+InvocationContext::CreateCached(absl::string_view targets_and_headers_json) {
+  // A single-entry cache is enough: a persistent worker sees the same JSON
+  // request after request, and a one-shot invocation parses it exactly once
+  // either way. Comparing the raw JSON is far cheaper than re-parsing it.
+  static absl::Mutex& mutex = *new absl::Mutex;
+  static std::string& cached_json = *new std::string;
+  static std::shared_ptr<const InvocationContext>& cached =
+      *new std::shared_ptr<const InvocationContext>;
+  {
+    absl::MutexLock lock(&mutex);
+    if (cached != nullptr && cached_json == targets_and_headers_json) {
+      return cached;
+    }
+  }
+  CRUBIT_ASSIGN_OR_RETURN(std::shared_ptr<const InvocationContext> context,
+                          Create(targets_and_headers_json));
+  absl::MutexLock lock(&mutex);
+  cached_json = std::string(targets_and_headers_json);
+  cached = context;
+  return context;
+}
+
+absl::StatusOr<BazelLabel> InvocationContext::FindHeader(
+    const HeaderName& header) const {
+  auto it = headers_to_targets_.find(header);
+  if (it == headers_to_targets_.end()) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "Couldn't find header '$0' in the `headers_to_target` map "
+        "derived from the --targets_and_headers cmdline argument",
+        header.IncludePath()));
+  }
+  return it->second;
+}
+
+absl::StatusOr<Cmdline> Cmdline::CreateFromWorkerArgs(
+    std::vector<std::string> args, std::vector<std::string>& clang_args) {
+  // Reset every flag to its default so that a flag omitted from this request
+  // doesn't inherit the value it had in the previous request served by this
+  // process.
+  absl::SetFlag(&FLAGS_do_nothing, false);
+  absl::SetFlag(&FLAGS_rs_out, "");
+  absl::SetFlag(&FLAGS_cc_out, "");
+  absl::SetFlag(&FLAGS_ir_out, "");
+  absl::SetFlag(&FLAGS_crubit_support_path, "");
+  absl::SetFlag(&FLAGS_clang_format_exe_path, "");
+  absl::SetFlag(&FLAGS_rustfmt_exe_path, "");
+  absl::SetFlag(&FLAGS_rustfmt_config_path, "");
+  absl::SetFlag(&FLAGS_public_headers, {});
+  absl::SetFlag(&FLAGS_target, "");
+  absl::SetFlag(&FLAGS_targets_and_headers, "");
+  absl::SetFlag(&FLAGS_extra_rs_srcs, {});
+  absl::SetFlag(&FLAGS_srcs_to_scan_for_instantiations, {});
+  absl::SetFlag(&FLAGS_instantiations_out, "");
+  absl::SetFlag(&FLAGS_namespaces_out, "");
+  absl::SetFlag(&FLAGS_error_report_out, "");
+  absl::SetFlag(&FLAGS_fingerprint_out, "");
+  absl::SetFlag(&FLAGS_timing_report_out, "");
+  absl::SetFlag(&FLAGS_stable_item_ids, false);
+  absl::SetFlag(&FLAGS_thin_ir_only, false);
+  absl::SetFlag(&FLAGS_no_doc_comments, false);
+  absl::SetFlag(&FLAGS_shard_count, 0);
+
+  static char kProgramName[] = "rs_bindings_from_cc";
+  std::vector<char*> argv;
+  argv.reserve(args.size() + 1);
+  argv.push_back(kProgramName);
+  for (std::string& arg : args) {
+    argv.push_back(arg.data());
+  }
+  std::vector<char*> positional_args =
+      absl::ParseCommandLine(static_cast<int>(argv.size()), argv.data());
+  clang_args.assign(positional_args.begin(), positional_args.end());
+  return Create();
+}
+
 absl::StatusOr<Cmdline> Cmdline::Create() {
-  return CreateFromArgs(
+  absl::StatusOr<Cmdline> cmdline = CreateFromArgs(
       absl::GetFlag(FLAGS_target), absl::GetFlag(FLAGS_cc_out),
       absl::GetFlag(FLAGS_rs_out), absl::GetFlag(FLAGS_ir_out),
       absl::GetFlag(FLAGS_namespaces_out),
@@ -103,6 +265,28 @@ absl::StatusOr<Cmdline> Cmdline::Create() {
       absl::GetFlag(FLAGS_srcs_to_scan_for_instantiations),
       absl::GetFlag(FLAGS_instantiations_out),
       absl::GetFlag(FLAGS_error_report_out));
+  if (cmdline.ok()) {
+    cmdline->fingerprint_out_ = absl::GetFlag(FLAGS_fingerprint_out);
+    cmdline->timing_report_out_ = absl::GetFlag(FLAGS_timing_report_out);
+    if (absl::GetFlag(FLAGS_shard_count) < 0) {
+      return absl::InvalidArgumentError("--shard_count must be non-negative");
+    }
+    cmdline->shard_count_ = absl::GetFlag(FLAGS_shard_count);
+    cmdline->stable_item_ids_ = absl::GetFlag(FLAGS_stable_item_ids);
+    cmdline->thin_ir_only_ = absl::GetFlag(FLAGS_thin_ir_only);
+    cmdline->no_doc_comments_ = absl::GetFlag(FLAGS_no_doc_comments);
+    if (cmdline->thin_ir_only_) {
+      if (cmdline->ir_out_.empty()) {
+        return absl::InvalidArgumentError("--thin_ir_only requires --ir_out");
+      }
+      if (!cmdline->instantiations_out_.empty()) {
+        return absl::InvalidArgumentError(
+            "template instantiation mode is not supported with "
+            "--thin_ir_only");
+      }
+    }
+  }
+  return cmdline;
 }
 
 absl::StatusOr<Cmdline> Cmdline::CreateFromArgs(
@@ -139,14 +323,10 @@ absl::StatusOr<Cmdline> Cmdline::CreateFromArgs(
   }
   cmdline.crubit_support_path_ = std::move(crubit_support_path);
 
-  if (clang_format_exe_path.empty()) {
-    return absl::InvalidArgumentError("please specify --clang_format_exe_path");
-  }
+  // An empty --clang_format_exe_path selects the built-in printer.
   cmdline.clang_format_exe_path_ = std::move(clang_format_exe_path);
 
-  if (rustfmt_exe_path.empty()) {
-    return absl::InvalidArgumentError("please specify --rustfmt_exe_path");
-  }
+  // An empty --rustfmt_exe_path selects the in-process formatting backend.
   cmdline.rustfmt_exe_path_ = std::move(rustfmt_exe_path);
 
   cmdline.rustfmt_config_path_ = std::move(rustfmt_config_path);
@@ -171,45 +351,9 @@ absl::StatusOr<Cmdline> Cmdline::CreateFromArgs(
       std::move(srcs_to_scan_for_instantiations);
   cmdline.error_report_out_ = std::move(error_report_out);
 
-  if (targets_and_headers_str.empty()) {
-    return absl::InvalidArgumentError("please specify --targets_and_headers");
-  }
-  auto targets_and_headers = llvm::json::parse<std::vector<TargetAndHeaders>>(
-      std::move(targets_and_headers_str));
-  if (auto err = targets_and_headers.takeError()) {
-    return absl::InvalidArgumentError(
-        absl::StrCat("Malformed `--targets_and_headers` argument: ",
-                     toString(std::move(err))));
-  }
-  for (const TargetAndHeaders& it : *targets_and_headers) {
-    const std::string& target = it.target;
-    if (target.empty()) {
-      return absl::InvalidArgumentError(
-          "Expected `t` fields of `--targets_and_headers` to be a non-empty "
-          "string");
-    }
-    for (const std::string& header : it.headers) {
-      if (header.empty()) {
-        return absl::InvalidArgumentError(
-            "Expected `h` fields of `--targets_and_headers` to be an array of "
-            "non-empty strings");
-      }
-      BazelLabel target_label(target);
-      auto [it, inserted] = cmdline.headers_to_targets_.try_emplace(
-          HeaderName(header), std::move(target_label));
-      if (!inserted) {
-        LOG(WARNING) << "The `--targets_and_headers` cmdline argument assigns "
-                        "`"
-                     << header << "` header to two conflicting targets: `"
-                     << target << "` vs `" << it->second.value() << "`";
-        // Assign the one that comes first alphabetically, to get a consistent
-        // result.
-        if (target_label.value() < it->second.value()) {
-          it->second = std::move(target_label);
-        }
-      }
-    }
-  }
+  CRUBIT_ASSIGN_OR_RETURN(
+      cmdline.invocation_context_,
+      InvocationContext::CreateCached(targets_and_headers_str));
 
   for (const HeaderName& public_header : cmdline.public_headers_) {
     CRUBIT_RETURN_IF_ERROR(cmdline.FindHeader(public_header).status());
@@ -219,14 +363,7 @@ absl::StatusOr<Cmdline> Cmdline::CreateFromArgs(
 }
 
 absl::StatusOr<BazelLabel> Cmdline::FindHeader(const HeaderName& header) const {
-  auto it = headers_to_targets_.find(header);
-  if (it == headers_to_targets_.end()) {
-    return absl::InvalidArgumentError(absl::Substitute(
-        "Couldn't find header '$0' in the `headers_to_target` map "
-        "derived from the --targets_and_headers cmdline argument",
-        header.IncludePath()));
-  }
-  return it->second;
+  return invocation_context_->FindHeader(header);
 }
 
 Cmdline::Cmdline() = default;
@@ -5,6 +5,7 @@
 #ifndef CRUBIT_RS_BINDINGS_FROM_CC_CMDLINE_H_
 #define CRUBIT_RS_BINDINGS_FROM_CC_CMDLINE_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -16,12 +17,58 @@
 
 namespace crubit {
 
+// Immutable result of parsing the `--targets_and_headers` JSON: the
+// header-to-target index, with one interned label per target entry. Building
+// this index is the expensive part of `Cmdline` construction, and it is also
+// the part that typically stays the same across the requests served by a
+// persistent worker process, so it is shared: `Cmdline`s created from the
+// same JSON hold the same context, and only the request-specific fields
+// (output paths, instantiation sources, ...) are parsed per request.
+class InvocationContext {
+ public:
+  InvocationContext(const InvocationContext&) = delete;
+  InvocationContext& operator=(const InvocationContext&) = delete;
+
+  // Parses `targets_and_headers_json` and builds the index.
+  static absl::StatusOr<std::shared_ptr<const InvocationContext>> Create(
+      absl::string_view targets_and_headers_json);
+
+  // Like `Create`, but serves repeats of the most recently seen JSON from a
+  // process-wide cache, so a persistent worker only re-parses the flag when
+  // its value actually changes.
+  static absl::StatusOr<std::shared_ptr<const InvocationContext>> CreateCached(
+      absl::string_view targets_and_headers_json);
+
+  const absl::flat_hash_map<HeaderName, BazelLabel>& headers_to_targets()
+      const {
+    return headers_to_targets_;
+  }
+
+  // Returns the target owning `header`, or an error if the header is absent
+  // from the index.
+  absl::StatusOr<BazelLabel> FindHeader(const HeaderName& header) const;
+
+ private:
+  InvocationContext() = default;
+
+  absl::flat_hash_map<HeaderName, BazelLabel> headers_to_targets_;
+};
+
 // Parses and validates command line arguments.
 class Cmdline {
  public:
   // Creates `Cmdline` based on the actual cmdline arguments.
   static absl::StatusOr<Cmdline> Create();
 
+  // Creates `Cmdline` from `args`, the argument vector of a single persistent
+  // worker request (without the program name). All flags are reset to their
+  // defaults before parsing so that values from a previous request in the same
+  // process don't leak into this one. Positional (non-flag) arguments are
+  // returned via `clang_args`; they are passed on to Clang, mirroring what
+  // `main` does with the leftover arguments of the process command line.
+  static absl::StatusOr<Cmdline> CreateFromWorkerArgs(
+      std::vector<std::string> args, std::vector<std::string>& clang_args);
+
   // Creates `Cmdline` based on the provided cmdline arguments - `cc_out`,
   // `rs_out`, and so forth.
   static absl::StatusOr<Cmdline> CreateForTesting(
@@ -61,7 +108,13 @@ class Cmdline {
   absl::string_view rustfmt_config_path() const { return rustfmt_config_path_; }
   absl::string_view instantiations_out() const { return instantiations_out_; }
   absl::string_view error_report_out() const { return error_report_out_; }
+  absl::string_view fingerprint_out() const { return fingerprint_out_; }
+  absl::string_view timing_report_out() const { return timing_report_out_; }
   bool do_nothing() const { return do_nothing_; }
+  int shard_count() const { return shard_count_; }
+  bool stable_item_ids() const { return stable_item_ids_; }
+  bool thin_ir_only() const { return thin_ir_only_; }
+  bool no_doc_comments() const { return no_doc_comments_; }
 
   const std::vector<HeaderName>& public_headers() const {
     return public_headers_;
@@ -79,7 +132,12 @@ class Cmdline {
 
   const absl::flat_hash_map<HeaderName, BazelLabel>& headers_to_targets()
       const {
-    return headers_to_targets_;
+    return invocation_context_->headers_to_targets();
+  }
+
+  // The shared, request-independent part of this cmdline.
+  const std::shared_ptr<const InvocationContext>& invocation_context() const {
+    return invocation_context_;
   }
 
  private:
@@ -106,11 +164,17 @@ class Cmdline {
   std::string rustfmt_exe_path_;
   std::string rustfmt_config_path_;
   std::string error_report_out_;
+  std::string fingerprint_out_;
+  std::string timing_report_out_;
   bool do_nothing_ = true;
+  int shard_count_ = 0;
+  bool stable_item_ids_ = false;
+  bool thin_ir_only_ = false;
+  bool no_doc_comments_ = false;
 
   BazelLabel current_target_;
   std::vector<HeaderName> public_headers_;
-  absl::flat_hash_map<HeaderName, BazelLabel> headers_to_targets_;
+  std::shared_ptr<const InvocationContext> invocation_context_;
 
   std::vector<std::string> extra_rs_srcs_;
 
@@ -4,38 +4,96 @@
 
 #include "rs_bindings_from_cc/collect_instantiations.h"
 
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "common/ffi_types.h"
+#include "common/file_io.h"
+#include "common/fingerprint.h"
+#include "common/status_macros.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 // This function is implemented in Rust.
-extern "C" crubit::FfiU8SliceBox CollectInstantiationsImpl(
-    crubit::FfiU8Slice json);
+extern "C" crubit::FfiU8SliceTableBox CollectInstantiationsImpl(
+    crubit::FfiU8SliceTable rust_sources);
 
 namespace crubit {
 
 absl::StatusOr<std::vector<std::string>> CollectInstantiations(
     absl::Span<const std::string> rust_sources) {
-  llvm::json::Value rust_sources_json = llvm::json::Array(rust_sources);
-  std::string json = llvm::formatv("{0}", rust_sources_json);
-  FfiU8SliceBox result = CollectInstantiationsImpl(MakeFfiU8Slice(json));
-  std::string result_string = std::string(result.ptr, result.size);
-  llvm::Expected<llvm::json::Value> expected_instantiations =
-      llvm::json::parse(result_string);
-  if (auto error = expected_instantiations.takeError()) {
-    return absl::InternalError(llvm::toString(std::move(error)));
+  // The paths cross the FFI boundary as a single packed table, and the
+  // instantiation names come back the same way: one allocation and one copy
+  // in each direction, with no serialization round-trip.
+  PackedFfiU8SliceTable paths(rust_sources);
+  return ConsumeFfiU8SliceTableBox(CollectInstantiationsImpl(paths.table()));
+}
+
+absl::StatusOr<std::vector<std::string>> CollectInstantiationsWithCache(
+    absl::Span<const std::string> rust_sources, absl::string_view cache_path) {
+  // Load the cache; a missing or malformed cache simply means a full rescan.
+  absl::flat_hash_map<std::string, std::vector<std::string>> cached;
+  if (absl::StatusOr<std::string> contents = GetFileContents(cache_path);
+      contents.ok()) {
+    if (llvm::Expected<llvm::json::Value> parsed = llvm::json::parse(*contents)) {
+      if (const llvm::json::Object* object = parsed->getAsObject()) {
+        for (const auto& [digest, value] : *object) {
+          const llvm::json::Array* names = value.getAsArray();
+          if (names == nullptr) continue;
+          std::vector<std::string> entry;
+          entry.reserve(names->size());
+          for (const llvm::json::Value& name : *names) {
+            if (std::optional<llvm::StringRef> s = name.getAsString()) {
+              entry.push_back(std::string(*s));
+            }
+          }
+          cached.insert({std::string(digest.str()), std::move(entry)});
+        }
+      }
+    } else {
+      llvm::consumeError(parsed.takeError());
+    }
   }
 
-  llvm::json::Value instantiations = *expected_instantiations;
-  FreeFfiU8SliceBox(result);
-  std::vector<std::string> instantiations_vector;
-  llvm::json::Path::Root root;
-  if (llvm::json::fromJSON(instantiations, instantiations_vector, root)) {
-    return instantiations_vector;
+  llvm::json::Object new_cache;
+  std::set<std::string> merged;
+  for (const std::string& path : rust_sources) {
+    CRUBIT_ASSIGN_OR_RETURN(std::unique_ptr<llvm::MemoryBuffer> buffer,
+                            GetFileBuffer(path));
+    std::string digest =
+        Fingerprint().Update(BufferContents(*buffer)).HexDigest();
+    std::vector<std::string> names;
+    if (auto it = cached.find(digest); it != cached.end()) {
+      names = it->second;
+    } else {
+      CRUBIT_ASSIGN_OR_RETURN(
+          names, CollectInstantiations(absl::MakeConstSpan(&path, 1)));
+    }
+    llvm::json::Array json_names;
+    for (const std::string& name : names) {
+      json_names.push_back(name);
+      merged.insert(name);
+    }
+    new_cache[digest] = std::move(json_names);
   }
-  return absl::InternalError(llvm::toString(root.getError()));
+
+  // Persist entries for the current file set only, so digests of files that
+  // no longer exist do not accumulate. The cache is best-effort: failing to
+  // write it only costs a rescan next time.
+  SetFileContentsAtomically(
+      cache_path,
+      std::string(llvm::formatv("{0}", llvm::json::Value(std::move(new_cache)))))
+      .IgnoreError();
+
+  return std::vector<std::string>(merged.begin(), merged.end());
 }
 
 }  // namespace crubit
@@ -8,6 +8,7 @@
 #include <string>
 
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 
 namespace crubit {
@@ -18,6 +19,16 @@ namespace crubit {
 absl::StatusOr<std::vector<std::string>> CollectInstantiations(
     absl::Span<const std::string> rust_sources);
 
+// Like `CollectInstantiations`, but memoizes per-file results in a JSON cache
+// at `cache_path` (kept beside the tool's outputs), keyed by each file's
+// content digest. Unchanged files contribute their cached instantiations
+// without being re-parsed; only files whose digest is absent from the cache
+// are handed to the scanner. A missing or malformed cache means a full
+// rescan, and the rewritten cache only retains entries for the current file
+// set; cache write failures are ignored.
+absl::StatusOr<std::vector<std::string>> CollectInstantiationsWithCache(
+    absl::Span<const std::string> rust_sources, absl::string_view cache_path);
+
 }  // namespace crubit
 
 #endif  // THIRD_PARTY_CRUBIT_RS_BINDINGS_FROM_CC_COLLECT_INSTANTIATIONS_H_
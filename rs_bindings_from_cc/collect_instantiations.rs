@@ -3,8 +3,8 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 use arc_anyhow::{Context, Result};
-use ffi_types::FfiU8Slice;
-use ffi_types::FfiU8SliceBox;
+use ffi_types::FfiU8SliceTable;
+use ffi_types::FfiU8SliceTableBox;
 use proc_macro2::TokenStream;
 use proc_macro2::TokenTree;
 use std::collections::HashSet;
@@ -13,46 +13,73 @@ use std::panic::catch_unwind;
 use std::path::PathBuf;
 use std::process;
 
-/// Parses given files and returns a Json list with all  C++ class
-/// template instantiations requested by calls to the `cc_template!` macro.
+/// Parses the files named by `rust_sources` and returns a table with all C++
+/// class template instantiations requested by calls to the `cc_template!`
+/// macro.
 ///
 /// This function panics on error.
 ///
 /// # Safety
 ///
 /// Expectations:
-///    * function expects that param `json` is a FfiU8Slice for a valid array of
-///      bytes with the given size.
-///    * function expects that param `json` doesn't change during the call.
+///    * function expects that param `rust_sources` is a valid
+///      `FfiU8SliceTable` of UTF-8 encoded paths.
+///    * function expects that param `rust_sources` doesn't change during the
+///      call.
 ///
 /// Ownership:
 ///    * function doesn't take ownership of (in other words it borrows) the
-///      param `json`
+///      param `rust_sources`
 ///    * function passes ownership of the returned value to the caller
 #[no_mangle]
-pub unsafe extern "C" fn CollectInstantiationsImpl(json: FfiU8Slice) -> FfiU8SliceBox {
+pub unsafe extern "C" fn CollectInstantiationsImpl(
+    rust_sources: FfiU8SliceTable,
+) -> FfiU8SliceTableBox {
     catch_unwind(|| {
-        let filenames: Vec<PathBuf> = serde_json::from_reader(json.as_slice())
-            .with_context(|| {
-                let json_str = std::str::from_utf8(json.as_slice()).unwrap();
-                format!("Couldn't deserialize json '{}'", json_str)
-            })
-            .unwrap();
+        let filenames: Vec<PathBuf> = rust_sources
+            .as_slices()
+            .into_iter()
+            .map(|path| PathBuf::from(std::str::from_utf8(path).unwrap()))
+            .collect();
         let instantiations = collect_instantiations_impl(filenames).unwrap();
-        let result_json = serde_json::to_string(&instantiations).unwrap();
-        FfiU8SliceBox::from_boxed_slice(result_json.into_bytes().into_boxed_slice())
+        FfiU8SliceTableBox::from_strings(instantiations)
     })
     .unwrap_or_else(|_| process::abort())
 }
 
 fn collect_instantiations_impl(filenames: Vec<PathBuf>) -> Result<Vec<String>> {
-    let mut result = HashSet::<String>::new();
+    // First tier: read every file and scan for the macro name. Most sources
+    // never invoke `cc_template!`, and a substring scan is orders of magnitude
+    // cheaper than a full `syn` parse, so files without a hit are skipped
+    // outright (even if they would not parse as Rust).
+    let mut candidates = Vec::new();
     for filename in filenames {
         let content = fs::read_to_string(&filename)
             .with_context(|| format!("Couldn't read '{}'", filename.display()))?;
-        let token_stream = syn::parse_str(&content)
-            .with_context(|| format!("Couldn't parse the file '{}'", filename.display()))?;
-        find_cc_template_calls(token_stream, &mut result);
+        if content.contains("cc_template") {
+            candidates.push((filename, content));
+        }
+    }
+
+    // Second tier: fully parse the files that might contain an invocation, one
+    // thread per file. The prescan keeps this set small, so there is no need
+    // to bound the thread count.
+    let handles = candidates
+        .into_iter()
+        .map(|(filename, content)| {
+            std::thread::spawn(move || -> Result<HashSet<String>> {
+                let token_stream = syn::parse_str(&content).with_context(|| {
+                    format!("Couldn't parse the file '{}'", filename.display())
+                })?;
+                let mut calls = HashSet::<String>::new();
+                find_cc_template_calls(token_stream, &mut calls);
+                Ok(calls)
+            })
+        })
+        .collect::<Vec<_>>();
+    let mut result = HashSet::<String>::new();
+    for handle in handles {
+        result.extend(handle.join().unwrap()?);
     }
     let mut result_vec = result.into_iter().collect::<Vec<_>>();
     result_vec.sort();
@@ -125,7 +152,8 @@ mod tests {
 
     #[test]
     fn test_file_doesnt_parse() {
-        let input = make_tmp_input_file("does_not_parse", "This is not (Rust>!");
+        let input =
+            make_tmp_input_file("does_not_parse", "cc_template! This is not (Rust>!");
         let err = collect_instantiations_impl(vec![input.clone()]).unwrap_err();
         assert_eq!(
             format!("{:#}", err),
@@ -133,6 +161,14 @@ mod tests {
         );
     }
 
+    #[test]
+    fn test_prescan_skips_file_without_macro() {
+        // Without a `cc_template` hit the file is never parsed, so not even
+        // invalid Rust causes an error.
+        let input = make_tmp_input_file("skipped_does_not_parse", "This is not (Rust>!");
+        assert!(collect_instantiations_impl(vec![input]).unwrap().is_empty());
+    }
+
     #[test]
     fn test_single_template_parens() {
         let result =
@@ -206,22 +242,17 @@ mod tests {
         assert_eq!(result, vec!["std :: vector < Foo >".to_string(),]);
     }
 
-    fn collect_instantiations_from_json(json: &str) -> String {
-        let u8_slice = unsafe {
-            CollectInstantiationsImpl(FfiU8Slice::from_slice(json.as_bytes())).into_boxed_slice()
-        };
-        std::str::from_utf8(&u8_slice).unwrap().to_string()
-    }
-
     #[test]
-    fn test_collect_instantiations_json() {
+    fn test_collect_instantiations_ffi() {
         let filename = make_tmp_input_file(
-            "json",
+            "ffi",
             "cc_template!(std::vector<int>); cc_template!(std::vector<bool>);",
         );
+        let paths = FfiU8SliceTableBox::from_strings(vec![filename.display().to_string()]);
+        let result = unsafe { CollectInstantiationsImpl(paths.as_table()) };
         assert_eq!(
-            collect_instantiations_from_json(&format!("[\"{}\"]", filename.display())),
-            "[\"std :: vector < bool >\",\"std :: vector < int >\"]"
+            result.into_strings(),
+            vec!["std :: vector < bool >".to_string(), "std :: vector < int >".to_string()]
         );
     }
 }
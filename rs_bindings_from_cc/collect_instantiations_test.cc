@@ -31,5 +31,25 @@ TEST(CollectInstantiationsTest, ReturnInstantiationsFromRustTest) {
               IsOkAndHolds(ElementsAre(StrEq("std :: vector < bool >"))));
 }
 
+TEST(CollectInstantiationsTest, CachedResultsSurviveRescanTest) {
+  std::string path =
+      WriteFileForCurrentTest("a.rs", "cc_template!(std::vector<bool>);");
+  // WriteFileForCurrentTest only creates the parent directory; "reserve" the
+  // cache path by writing an (ignored, malformed) placeholder.
+  std::string cache_path = WriteFileForCurrentTest("cache", "not json");
+
+  // First scan populates the cache, second is served from it; both runs must
+  // agree.
+  EXPECT_THAT(CollectInstantiationsWithCache({path}, cache_path),
+              IsOkAndHolds(ElementsAre(StrEq("std :: vector < bool >"))));
+  EXPECT_THAT(CollectInstantiationsWithCache({path}, cache_path),
+              IsOkAndHolds(ElementsAre(StrEq("std :: vector < bool >"))));
+
+  // A changed file misses the cache and gets re-scanned.
+  path = WriteFileForCurrentTest("a.rs", "cc_template!(std::vector<int>);");
+  EXPECT_THAT(CollectInstantiationsWithCache({path}, cache_path),
+              IsOkAndHolds(ElementsAre(StrEq("std :: vector < int >"))));
+}
+
 }  // namespace
 }  // namespace crubit
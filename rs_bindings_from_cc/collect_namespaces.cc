@@ -4,160 +4,103 @@
 
 #include "rs_bindings_from_cc/collect_namespaces.h"
 
-#include <string_view>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "rs_bindings_from_cc/bazel_types.h"
 #include "rs_bindings_from_cc/ir.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/Parallel.h"
 
 namespace crubit {
 namespace {
 
-// A Trie that stores the namespace hierarchy.
-//
-// Consider the following namespace structure:
-// namespace top_level_one {
-// namespace internal {}
-// }  // namespace A
-//
-// namespace top_level_two {
-// namespace internal {}
-// }
-//
-// namespace top_level_one {
-// namespace inner {}
-// }
-//
-// A Namespace trie allows us to convert the above to:
-//
-// top_level_one -> [internal, inner]
-// top_level_two -> [internal]
-//
-// Which we can then serialize to JSON.
-class NamespaceTrie {
- private:
-  struct Node {
-    absl::string_view name;
-    // A map of child namespace name to the index of the namespace node in the
-    // trie_nodes_ vector. We use a btree_map so that at conversion time we get
-    // deterministic JSON output.
-    absl::btree_map<absl::string_view, int> child_name_to_idx;
-  };
-
-  std::vector<Node> trie_nodes_;
-  // A map of top level namespace name to the index of the namespace node in the
-  // trie_nodes_ vector. We use a btree_map so that at conversion time we get
-  // deterministic JSON output.
-  absl::btree_map<absl::string_view, int> top_level_name_to_idx_;
-  // The current target's label.
-  BazelLabel label_;
-  // A map of item id to the IR Namespace item. It allows us to look up the
-  // children namespace items.
-  absl::flat_hash_map<ItemId, const Namespace*>& id_to_namespace_;
-
-  // Creates a node from a Namespace and inserts it into the trie.
-  void InsertNode(int parent_idx, const Namespace* ns) {
-    auto name = ns->name.Ident();
-    auto parent = &trie_nodes_[parent_idx];
-    int child_idx;
-    if (parent->child_name_to_idx.find(name) ==
-        parent->child_name_to_idx.end()) {
-      child_idx = trie_nodes_.size();
-      parent->child_name_to_idx.insert({name, child_idx});
-      // The following line potentially invalidates the "parent" pointer.
-      trie_nodes_.push_back({name, {}});
-    } else {
-      child_idx = parent->child_name_to_idx[name];
-    }
-
-    for (auto ns_child_id : ns->child_item_ids) {
-      if (id_to_namespace_.find(ns_child_id) == id_to_namespace_.end()) {
+// Namespaces that share a name at the same level (reopened namespaces) are
+// presented as a single node, so construction groups same-named namespaces
+// and merges their children. We use a btree_map so that sibling order (and
+// thus the JSON output) is deterministic.
+using NamespacesByName =
+    absl::btree_map<absl::string_view, std::vector<const Namespace*>>;
+
+// Groups the direct namespace children of all `namespaces` by name. Child
+// ids are resolved through the IR's ItemId index; children from other
+// targets do not resolve to current-target namespaces of interest and are
+// skipped.
+NamespacesByName GroupChildrenByName(
+    absl::Span<const Namespace* const> namespaces, const IR& ir) {
+  NamespacesByName grouped;
+  for (const Namespace* ns : namespaces) {
+    for (ItemId child_id : ns->child_item_ids) {
+      const auto* child = ir.FindItemById<Namespace>(child_id);
+      if (child == nullptr || child->owning_target != ir.current_target) {
         continue;
       }
-      auto ns_child = id_to_namespace_[ns_child_id];
-      InsertNode(child_idx, ns_child);
-    }
-  }
-
-  // Converts a trie node into the JSON serializable NamespaceNode.
-  NamespaceNode NodeToNamespaceNode(const Node* node) const {
-    std::vector<NamespaceNode> namespaces;
-    namespaces.reserve(node->child_name_to_idx.size());
-    for (const auto& [_, idx] : node->child_name_to_idx) {
-      namespaces.push_back(NodeToNamespaceNode(&trie_nodes_[idx]));
-    }
-    return NamespaceNode{std::string(node->name), std::move(namespaces)};
-  }
-
- public:
-  NamespaceTrie(BazelLabel label,
-                absl::flat_hash_map<ItemId, const Namespace*>& id_to_namespace)
-      : label_(label), id_to_namespace_(id_to_namespace) {}
-
-  NamespaceTrie(NamespaceTrie&) = delete;
-  NamespaceTrie& operator=(NamespaceTrie&) = delete;
-
-  // Creates a trie node from the top level namespace and inserts it into the
-  // trie.
-  void InsertTopLevel(const Namespace* ns) {
-    auto name = ns->name.Ident();
-    int node_idx;
-    if (top_level_name_to_idx_.find(name) == top_level_name_to_idx_.end()) {
-      node_idx = trie_nodes_.size();
-      top_level_name_to_idx_.insert({name, node_idx});
-      trie_nodes_.push_back({name, {}});
-    } else {
-      node_idx = top_level_name_to_idx_[name];
-    }
-
-    for (auto ns_child_id : ns->child_item_ids) {
-      if (id_to_namespace_.find(ns_child_id) == id_to_namespace_.end()) {
-        continue;
-      }
-      auto ns_child = id_to_namespace_[ns_child_id];
-      InsertNode(node_idx, ns_child);
+      grouped[child->name.Ident()].push_back(child);
     }
   }
+  return grouped;
+}
 
-  // Converts the trie into the JSON serializable NamespacesHierarchy.
-  NamespacesHierarchy ToNamespacesHierarchy() {
-    std::vector<NamespaceNode> namespaces;
-    namespaces.reserve(this->top_level_name_to_idx_.size());
-    for (auto& [_, idx] : this->top_level_name_to_idx_) {
-      namespaces.push_back(NodeToNamespaceNode(&trie_nodes_[idx]));
-    }
-    return NamespacesHierarchy{label_, std::move(namespaces)};
+// Builds the subtree for the same-named `namespaces`, recursively merging
+// their children. Each top-level invocation only touches its own subtree, so
+// the per-top-level calls in CollectNamespaces can run concurrently.
+NamespaceNode BuildNamespaceNode(absl::string_view name,
+                                 absl::Span<const Namespace* const> namespaces,
+                                 const IR& ir) {
+  NamespacesByName children = GroupChildrenByName(namespaces, ir);
+  std::vector<NamespaceNode> child_nodes;
+  child_nodes.reserve(children.size());
+  for (const auto& [child_name, child_namespaces] : children) {
+    child_nodes.push_back(BuildNamespaceNode(child_name, child_namespaces, ir));
   }
-};
+  return NamespaceNode{std::string(name), std::move(child_nodes)};
+}
 
 }  // namespace
 
 // Returns the current target's namespace hierarchy in JSON serializable format.
 NamespacesHierarchy CollectNamespaces(const IR& ir) {
-  auto all_namespaces = ir.get_items_if<Namespace>();
-  absl::flat_hash_map<ItemId, const Namespace*> id_to_namespace;
-  for (auto ns : all_namespaces) {
-    // We are not interested in namespaces from different targets.
-    if (ns->owning_target != ir.current_target) {
+  // Group the top-level namespaces by name. This resolves ids through
+  // `FindItemById` instead of scanning all items, and — since `IR`'s ItemId
+  // index is built lazily on first lookup — warms the index so that the
+  // concurrent lookups below only ever read it.
+  NamespacesByName top_level;
+  for (ItemId id : ir.top_level_item_ids) {
+    const auto* ns = ir.FindItemById<Namespace>(id);
+    if (ns == nullptr || ns->owning_target != ir.current_target) {
       continue;
     }
-    id_to_namespace.insert({ns->id, ns});
+    top_level[ns->name.Ident()].push_back(ns);
   }
 
-  NamespaceTrie trie(ir.current_target, id_to_namespace);
-  for (auto namespace_id : ir.top_level_item_ids) {
-    if (id_to_namespace.count(namespace_id) == 0) {
-      continue;
-    }
-    auto ns = id_to_namespace[namespace_id];
-    trie.InsertTopLevel(ns);
+  // Build the per-top-level-namespace subtrees in parallel; deeply namespaced
+  // targets spend this whole phase on one core otherwise. Each task writes
+  // only its own output slot, so order stays deterministic.
+  struct TopLevelTask {
+    absl::string_view name;
+    absl::Span<const Namespace* const> namespaces;
+    NamespaceNode* result;
+  };
+  std::vector<NamespaceNode> namespaces(top_level.size());
+  std::vector<TopLevelTask> tasks;
+  tasks.reserve(top_level.size());
+  for (const auto& [name, top_level_namespaces] : top_level) {
+    tasks.push_back(
+        {name, top_level_namespaces, &namespaces[tasks.size()]});
   }
+  llvm::parallelForEach(tasks.begin(), tasks.end(), [&](TopLevelTask& task) {
+    *task.result = BuildNamespaceNode(task.name, task.namespaces, ir);
+  });
 
-  return trie.ToNamespacesHierarchy();
+  return NamespacesHierarchy{ir.current_target, std::move(namespaces)};
 }
 
 llvm::json::Value NamespaceNode::ToJson() const {
@@ -174,11 +117,22 @@ llvm::json::Value NamespaceNode::ToJson() const {
 }
 
 llvm::json::Value NamespacesHierarchy::ToJson() const {
-  std::vector<llvm::json::Value> json_namespaces;
-  json_namespaces.reserve(namespaces.size());
+  // Serialize the top-level subtrees in parallel, mirroring the construction
+  // above; each task fills in its own preallocated slot.
+  std::vector<llvm::json::Value> json_namespaces(namespaces.size(),
+                                                 llvm::json::Value(nullptr));
+  struct SerializeTask {
+    const NamespaceNode* node;
+    llvm::json::Value* result;
+  };
+  std::vector<SerializeTask> tasks;
+  tasks.reserve(namespaces.size());
   for (const auto& ns : namespaces) {
-    json_namespaces.push_back(ns.ToJson());
+    tasks.push_back({&ns, &json_namespaces[tasks.size()]});
   }
+  llvm::parallelForEach(tasks.begin(), tasks.end(), [](SerializeTask& task) {
+    *task.result = task.node->ToJson();
+  });
 
   return llvm::json::Object{
       {"label", label.value()},
@@ -186,4 +140,87 @@ llvm::json::Value NamespacesHierarchy::ToJson() const {
   };
 }
 
+std::string NamespacesAsBinary(const NamespacesHierarchy& hierarchy) {
+  // Flatten breadth-first. Index 0 is a synthetic root whose children are the
+  // top-level namespaces; the children of every node end up contiguous, and
+  // sorting them by name bytes gives consumers a binary-searchable range and
+  // a deterministic file.
+  std::vector<const NamespaceNode*> nodes;
+  std::vector<std::pair<uint32_t, uint32_t>> child_ranges;
+  nodes.push_back(nullptr);
+  child_ranges.push_back({0, 0});
+  auto append_children = [&](std::vector<const NamespaceNode*> children,
+                             size_t parent) {
+    std::sort(children.begin(), children.end(),
+              [](const NamespaceNode* a, const NamespaceNode* b) {
+                return a->name < b->name;
+              });
+    child_ranges[parent] = {static_cast<uint32_t>(nodes.size()),
+                            static_cast<uint32_t>(children.size())};
+    nodes.insert(nodes.end(), children.begin(), children.end());
+    child_ranges.resize(nodes.size());
+  };
+  {
+    std::vector<const NamespaceNode*> top_level;
+    top_level.reserve(hierarchy.namespaces.size());
+    for (const NamespaceNode& ns : hierarchy.namespaces) {
+      top_level.push_back(&ns);
+    }
+    append_children(std::move(top_level), 0);
+  }
+  for (size_t i = 1; i < nodes.size(); ++i) {
+    std::vector<const NamespaceNode*> children;
+    children.reserve(nodes[i]->children.size());
+    for (const NamespaceNode& child : nodes[i]->children) {
+      children.push_back(&child);
+    }
+    append_children(std::move(children), i);
+  }
+
+  // Layout (documented for the consumer in merged_namespaces.rs): a 16-byte
+  // header, a fixed-width node table, then a string heap with one entry per
+  // distinct string. All offsets are relative to the start of the file.
+  constexpr size_t kHeaderSize = 16;
+  constexpr size_t kNodeSize = 16;
+  std::string heap;
+  absl::flat_hash_map<absl::string_view, uint32_t> interned;
+  const uint32_t heap_base =
+      static_cast<uint32_t>(kHeaderSize + kNodeSize * nodes.size());
+  auto intern = [&](absl::string_view s) -> std::pair<uint32_t, uint32_t> {
+    if (s.empty()) {
+      return {0, 0};
+    }
+    auto [it, inserted] =
+        interned.try_emplace(s, heap_base + static_cast<uint32_t>(heap.size()));
+    if (inserted) {
+      heap.append(s.data(), s.size());
+    }
+    return {it->second, static_cast<uint32_t>(s.size())};
+  };
+
+  std::string out;
+  out.reserve(heap_base);
+  auto append_u32 = [&out](uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+  };
+  out.append("CNH1");
+  append_u32(static_cast<uint32_t>(nodes.size()));
+  auto [label_offset, label_len] = intern(hierarchy.label.value());
+  append_u32(label_offset);
+  append_u32(label_len);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    auto [name_offset, name_len] =
+        nodes[i] == nullptr ? std::pair<uint32_t, uint32_t>{0, 0}
+                            : intern(nodes[i]->name);
+    append_u32(name_offset);
+    append_u32(name_len);
+    append_u32(child_ranges[i].first);
+    append_u32(child_ranges[i].second);
+  }
+  out.append(heap);
+  return out;
+}
+
 }  //  namespace crubit
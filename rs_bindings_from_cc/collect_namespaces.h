@@ -48,6 +48,15 @@ NamespacesHierarchy CollectNamespaces(const IR& ir);
 inline std::string NamespacesAsJson(const NamespacesHierarchy& topLevel) {
   return llvm::formatv("{0:2}", topLevel.ToJson());
 }
+
+// Serializes `hierarchy` into the compact binary namespace manifest read by
+// `support/cc_import/merged_namespaces.rs`, which documents the layout: a
+// magic/count header, a fixed-width node table in breadth-first order with
+// the children of every node contiguous and sorted by name bytes, then a
+// string heap. Consumers walk or binary-search the raw (e.g. memory-mapped)
+// bytes without any textual parsing, and the sorted layout makes the output
+// byte-for-byte deterministic for caching.
+std::string NamespacesAsBinary(const NamespacesHierarchy& hierarchy);
 }  // namespace crubit
 
 #endif  // THIRD_PARTY_CRUBIT_RS_BINDINGS_FROM_CC_COLLECT_NAMESPACES_H_
@@ -4,6 +4,9 @@
 
 #include "rs_bindings_from_cc/collect_namespaces.h"
 
+#include <cstdint>
+#include <string>
+
 #include "gmock/gmock.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -117,5 +120,39 @@ TEST(CollectNamespacesTest, SameNameDifferentParent) {
   EXPECT_THAT(should_contain_only_d[0], NameIs("inner_one"));
 }
 
+// Pins down the binary manifest layout that support/cc_import depends on;
+// keep in sync with the decoder in support/cc_import/merged_namespaces.rs.
+TEST(CollectNamespacesTest, BinaryManifestLayout) {
+  NamespacesHierarchy hierarchy{
+      BazelLabel("//:t"),
+      {NamespaceNode{"b", {}}, NamespaceNode{"a", {NamespaceNode{"c", {}}}}},
+  };
+
+  std::string manifest = NamespacesAsBinary(hierarchy);
+
+  std::string expected;
+  auto append_u32 = [&expected](uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      expected.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+  };
+  // Header: magic, node count (synthetic root + 3 namespaces), label.
+  expected.append("CNH1");
+  append_u32(4);
+  const uint32_t heap_base = 16 + 16 * 4;
+  append_u32(heap_base);  // label offset
+  append_u32(4);          // label length
+  // Node table: root, then "a" and "b" (sorted), then "a"'s child "c".
+  append_u32(0), append_u32(0), append_u32(1), append_u32(2);
+  append_u32(heap_base + 4), append_u32(1), append_u32(3), append_u32(1);
+  append_u32(heap_base + 5), append_u32(1), append_u32(4), append_u32(0);
+  append_u32(heap_base + 6), append_u32(1), append_u32(4), append_u32(0);
+  // String heap.
+  expected.append("//:t");
+  expected.append("abc");
+
+  EXPECT_EQ(manifest, expected);
+}
+
 }  // namespace
 }  // namespace crubit
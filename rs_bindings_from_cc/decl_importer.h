@@ -11,6 +11,7 @@
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "lifetime_annotations/lifetime_annotations.h"
+#include "rs_bindings_from_cc/ast_convert.h"
 #include "rs_bindings_from_cc/bazel_types.h"
 #include "rs_bindings_from_cc/ir.h"
 
@@ -86,10 +87,16 @@ class ImportContext {
   virtual std::optional<IR::Item> ImportDecl(clang::Decl* decl) = 0;
 
   // Returns the Item of a Decl, importing it first if necessary.
-  // Updates the cache.
-  virtual std::optional<IR::Item> GetDeclItem(clang::Decl* decl) = 0;
+  // Updates the cache. The returned reference points into the cache and is
+  // only valid until the next import touches the cache; callers must consume
+  // it before importing further decls.
+  virtual const std::optional<IR::Item>& GetDeclItem(clang::Decl* decl) = 0;
 
-  virtual std::optional<IR::Item> GetImportedItem(const clang::Decl* decl) = 0;
+  // Returns the already-imported Item of a Decl, or `nullptr` if the decl has
+  // not been imported (or its import produced no item). Unlike `GetDeclItem`,
+  // never triggers an import. The returned pointer points into the cache and
+  // is only valid until the next import touches the cache.
+  virtual const IR::Item* GetImportedItem(const clang::Decl* decl) = 0;
 
   // Imports children of `decl`.
   //
@@ -109,6 +116,13 @@ class ImportContext {
   // other redeclarations of the decl.
   virtual bool IsFromCurrentTarget(const clang::Decl* decl) const = 0;
 
+  // Returns `crubit::IsFullClassTemplateSpecializationOrChild(decl)`, with the
+  // answer memoized per enclosing `DeclContext`; this is queried for every
+  // imported decl, and the decl-context chains of nested template hierarchies
+  // are long.
+  virtual bool IsFullClassTemplateSpecializationOrChild(
+      const clang::Decl* decl) const = 0;
+
   // Gets an IR UnqualifiedIdentifier for the named decl.
   //
   // If the decl's name is an identifier, this returns that identifier as-is.
@@ -165,9 +179,28 @@ class ImportContext {
   // MarkAsSuccessfullyImported.
   virtual bool EnsureSuccessfullyImported(clang::TypeDecl* decl) = 0;
 
+  // Returns the classification of `record_decl`'s special member functions,
+  // computing it at most once per canonical record decl.  The computation
+  // walks the record's constructor list and all of its base classes, so
+  // callers should go through this cache instead of calling
+  // `crubit::GetSpecialMemberFuncs` directly.
+  SpecialMemberFuncs GetSpecialMemberFuncs(
+      const clang::RecordDecl* record_decl) {
+    auto [it, inserted] =
+        special_member_funcs_.try_emplace(record_decl->getCanonicalDecl());
+    if (inserted) {
+      it->second = crubit::GetSpecialMemberFuncs(*record_decl);
+    }
+    return it->second;
+  }
+
   Invocation& invocation_;
   clang::ASTContext& ctx_;
   clang::Sema& sema_;
+
+ private:
+  absl::flat_hash_map<const clang::RecordDecl*, SpecialMemberFuncs>
+      special_member_funcs_;
 };
 
 // Interface for components that can import decls of a certain category.
@@ -14,6 +14,7 @@ pub mod macro_internal {
 
     pub use anyhow;
     pub use arc_anyhow;
+    pub use once_cell::sync::OnceCell;
     pub use std::format_args;
 
     /// An error that stores its format string as well as the formatted message.
@@ -33,6 +34,33 @@ pub mod macro_internal {
             }))
         }
 
+        /// Like [`new_static`], but interns the error in `cache` when the
+        /// format string has no parameters.
+        ///
+        /// Parameterless messages are the typical fixed rejection reasons on
+        /// the codegen bail paths, and they are identical on every hit of
+        /// their call site, so after the first hit the "allocation" is one
+        /// `Arc` refcount bump.
+        pub fn new_static_cached(
+            cache: &OnceCell<arc_anyhow::Error>,
+            fmt: &'static str,
+            args: Arguments,
+        ) -> arc_anyhow::Error {
+            match args.as_str() {
+                Some(s) => cache
+                    .get_or_init(|| {
+                        arc_anyhow::Error::from(anyhow::Error::from(Self {
+                            fmt: Cow::Borrowed(s),
+                            message: Cow::Borrowed(s),
+                        }))
+                    })
+                    .clone(),
+                // The format string has inline captured parameters; the
+                // message differs per occurrence and cannot be interned.
+                None => Self::new_static(fmt, args),
+            }
+        }
+
         pub fn new_dynamic(err: impl Display) -> arc_anyhow::Error {
             // Use the whole error as the format string. This is preferable to
             // grouping all dynamic errors under the "{}" format string.
@@ -60,12 +88,16 @@ use crate::macro_internal::AttributedError;
 /// Otherwise similar to [`anyhow::anyhow`].
 #[macro_export]
 macro_rules! anyhow {
-    ($fmt:literal $(,)?) => {
-        $crate::macro_internal::AttributedError::new_static(
+    ($fmt:literal $(,)?) => {{
+        static CACHED: $crate::macro_internal::OnceCell<
+            $crate::macro_internal::arc_anyhow::Error,
+        > = $crate::macro_internal::OnceCell::new();
+        $crate::macro_internal::AttributedError::new_static_cached(
+            &CACHED,
             $fmt,
             $crate::macro_internal::format_args!($fmt),
         )
-    };
+    }};
     ($err:expr $(,)?) => {
         $crate::macro_internal::AttributedError::new_dynamic($err)
     };
@@ -127,6 +159,13 @@ impl ErrorReporting for IgnoreErrors {
 }
 
 /// An aggregate of zero or more errors.
+///
+/// Errors are bucketed by their format string, which acts as a compact error
+/// code: only a count and a few distinct sample messages are kept per bucket
+/// (see [`MAX_SAMPLE_MESSAGES`]), so report memory is bounded by the number
+/// of distinct error kinds, not by the number of occurrences - a message
+/// repeated across thousands of template instantiations costs a map lookup
+/// and a counter increment.
 #[derive(Default, Serialize)]
 pub struct ErrorReport {
     #[serde(flatten)]
@@ -143,6 +182,13 @@ impl ErrorReporting for ErrorReport {
     fn insert(&mut self, error: &arc_anyhow::Error) {
         if let Some(error) = error.downcast_ref::<AttributedError>() {
             let sample_message = if error.message != error.fmt { &*error.message } else { "" };
+            // Avoid cloning the (possibly owned) format string when its bucket
+            // already exists; the message itself is only cloned if the bucket
+            // retains it as a new distinct sample.
+            if let Some(entry) = self.map.get_mut(&*error.fmt) {
+                entry.add(Cow::Borrowed(sample_message));
+                return;
+            }
             self.map.entry(error.fmt.clone()).or_default().add(Cow::Borrowed(sample_message));
         } else {
             self.map.entry(Cow::Borrowed("{}")).or_default().add(Cow::Owned(format!("{error}")));
@@ -154,17 +200,27 @@ impl ErrorReporting for ErrorReport {
     }
 }
 
+/// Cap on the distinct sample messages retained per bucket. Different
+/// occurrences of one format string usually differ only in the item they name
+/// (e.g. the instantiation an unsupported construct appeared in); a few
+/// examples are enough to locate the problem, and the cap keeps the report
+/// bounded no matter how many items fail.
+const MAX_SAMPLE_MESSAGES: usize = 3;
+
 #[derive(Default, Serialize)]
 struct ErrorReportEntry {
     count: u64,
-    #[serde(skip_serializing_if = "String::is_empty")]
-    sample_message: String,
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    sample_messages: Vec<String>,
 }
 
 impl ErrorReportEntry {
     fn add(&mut self, message: Cow<str>) {
-        if self.count == 0 {
-            self.sample_message = message.into_owned();
+        if !message.is_empty()
+            && self.sample_messages.len() < MAX_SAMPLE_MESSAGES
+            && !self.sample_messages.iter().any(|m| *m == message)
+        {
+            self.sample_messages.push(message.into_owned());
         }
         self.count += 1;
     }
@@ -340,20 +396,40 @@ mod tests {
             r#"{
   "abc{}": {
     "count": 2,
-    "sample_message": "abcdef"
+    "sample_messages": [
+      "abcdef",
+      "abc123"
+    ]
   },
   "error code: {}": {
     "count": 1,
-    "sample_message": "error code: 65535"
+    "sample_messages": [
+      "error code: 65535"
+    ]
   },
   "no parameters": {
     "count": 3
   },
   "{}": {
     "count": 1,
-    "sample_message": "not attributed"
+    "sample_messages": [
+      "not attributed"
+    ]
   }
 }"#,
         );
     }
+
+    #[test]
+    fn error_report_samples_deduplicated_and_capped() {
+        let mut report = ErrorReport::new();
+        for i in 0..10 {
+            report.insert(&anyhow!("err: {}", i % 5));
+        }
+
+        assert_eq!(
+            serde_json::to_string(&report).unwrap(),
+            r#"{"err: {}":{"count":10,"sample_messages":["err: 0","err: 1","err: 2"]}}"#,
+        );
+    }
 }
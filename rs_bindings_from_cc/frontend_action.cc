@@ -5,6 +5,7 @@
 #include "rs_bindings_from_cc/frontend_action.h"
 
 #include <memory>
+#include <utility>
 
 #include "rs_bindings_from_cc/ast_consumer.h"
 #include "clang/AST/ASTConsumer.h"
@@ -12,11 +13,25 @@
 
 namespace crubit {
 
+bool FrontendAction::BeginInvocation(clang::CompilerInstance& instance) {
+  // The importer only consumes declarations, so parsing function bodies in
+  // headers is dead work. `Sema::canSkipFunctionBody` still parses the bodies
+  // that later semantic analysis may need - constexpr/consteval functions and
+  // functions with undeduced return types - together with whatever
+  // `AstConsumer::shouldSkipFunctionBody` carves out. In shared-frontend mode
+  // the registered `TuConsumer`s do look inside bodies, so skipping is off.
+  if (tu_consumers_.empty()) {
+    instance.getFrontendOpts().SkipFunctionBodies = true;
+  }
+  return clang::ASTFrontendAction::BeginInvocation(instance);
+}
+
 std::unique_ptr<clang::ASTConsumer> FrontendAction::CreateASTConsumer(
     clang::CompilerInstance& instance, llvm::StringRef) {
   AddLifetimeAnnotationHandlers(instance.getPreprocessor(),
-                                invocation_.lifetime_context_);
-  return std::make_unique<AstConsumer>(instance, invocation_);
+                                invocations_.front()->lifetime_context_);
+  return std::make_unique<AstConsumer>(instance, invocations_,
+                                       std::move(tu_consumers_));
 }
 
 }  // namespace crubit
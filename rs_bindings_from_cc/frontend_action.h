@@ -6,7 +6,10 @@
 #define CRUBIT_RS_BINDINGS_FROM_CC_FRONTEND_ACTION_H_
 
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include "rs_bindings_from_cc/ast_consumer.h"
 #include "rs_bindings_from_cc/decl_importer.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/Frontend/CompilerInstance.h"
@@ -15,16 +18,36 @@
 namespace crubit {
 
 // Creates an `ASTConsumer` that generates the intermediate representation
-// (`IR`) into the invocation object.
+// (`IR`) into the invocation object(s).
+//
+// `tu_consumers` is the shared-frontend mode: each registered `TuConsumer`
+// is handed the fully parsed translation unit after the import, so analyses
+// that would otherwise run their own Clang invocation over the same headers
+// (lifetime analysis, nullability verification) amortize the parse - by far
+// the dominant cost - with bindings generation. Registering any `TuConsumer`
+// disables function-body skipping, since such analyses generally need bodies.
 class FrontendAction : public clang::ASTFrontendAction {
  public:
-  explicit FrontendAction(Invocation& invocation) : invocation_(invocation) {}
+  explicit FrontendAction(Invocation& invocation,
+                          std::vector<TuConsumer> tu_consumers = {})
+      : invocations_({&invocation}), tu_consumers_(std::move(tu_consumers)) {}
+
+  // Batched form: runs one import per invocation against the shared AST. All
+  // invocations must share one `lifetime_context_`, since the lifetime
+  // annotation handlers are registered on the preprocessor only once.
+  explicit FrontendAction(std::vector<Invocation*> invocations,
+                          std::vector<TuConsumer> tu_consumers = {})
+      : invocations_(std::move(invocations)),
+        tu_consumers_(std::move(tu_consumers)) {}
+
+  bool BeginInvocation(clang::CompilerInstance& instance) override;
 
   std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(
       clang::CompilerInstance& instance, llvm::StringRef) override;
 
  private:
-  Invocation& invocation_;
+  std::vector<Invocation*> invocations_;
+  std::vector<TuConsumer> tu_consumers_;
 };
 
 }  // namespace crubit
@@ -4,14 +4,21 @@
 
 #include "rs_bindings_from_cc/generate_bindings_and_metadata.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <utility>
+#include <variant>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
-#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "common/status_macros.h"
+#include "common/timing.h"
 #include "rs_bindings_from_cc/collect_instantiations.h"
 #include "rs_bindings_from_cc/collect_namespaces.h"
 #include "rs_bindings_from_cc/ir.h"
@@ -20,38 +27,209 @@
 
 namespace crubit {
 
-std::optional<const Namespace*> FindNamespace(const IR& ir,
-                                              absl::string_view name) {
-  for (const auto* ns : ir.get_items_if<Namespace>()) {
-    if (ns->name.Ident() == kInstantiationsNamespaceName) {
-      return ns;
+// Computes the cc_name -> rs_name map of explicitly requested template
+// instantiations: the type aliases that live in the magic instantiations
+// namespace (see `kInstantiationsNamespaceName`).
+//
+// The namespace item and the aliases are collected in one walk over
+// `ir.items`; aliases may precede their namespace item, so candidates are
+// kept until the namespace id is known. The other metadata product of the
+// post-import tail, `CollectNamespaces`, resolves `top_level_item_ids`
+// through the id index and never scans `ir.items`, so there is nothing left
+// to fuse it with.
+static absl::flat_hash_map<std::string, std::string> CollectInstantiationsMap(
+    const IR& ir) {
+  std::optional<ItemId> namespace_id;
+  std::vector<const TypeAlias*> candidate_aliases;
+  for (const IR::Item& item : ir.items) {
+    if (const auto* ns = std::get_if<Namespace>(&item)) {
+      if (!namespace_id.has_value() &&
+          ns->name.Ident() == kInstantiationsNamespaceName) {
+        namespace_id = ns->id;
+      }
+    } else if (const auto* type_alias = std::get_if<TypeAlias>(&item)) {
+      if (type_alias->enclosing_namespace_id.has_value()) {
+        candidate_aliases.push_back(type_alias);
+      }
     }
   }
-  return std::nullopt;
+
+  absl::flat_hash_map<std::string, std::string> instantiations;
+  if (!namespace_id.has_value()) {
+    return instantiations;
+  }
+  for (const TypeAlias* type_alias : candidate_aliases) {
+    if (type_alias->enclosing_namespace_id != namespace_id) {
+      continue;
+    }
+    const MappedType& mapped_type = type_alias->underlying_type;
+    CHECK(mapped_type.cc_type.decl_id.has_value());
+    CHECK(mapped_type.rs_type.decl_id.has_value());
+    CHECK(mapped_type.cc_type.decl_id.value() ==
+          mapped_type.rs_type.decl_id.value());
+    const Record* record =
+        ir.FindItemById<Record>(mapped_type.rs_type.decl_id.value());
+    if (record != nullptr) {
+      instantiations.insert({record->cc_name, record->rs_name});
+    }
+  }
+  return instantiations;
 }
 
-std::vector<const Record*> FindInstantiationsInNamespace(const IR& ir,
-                                                         ItemId namespace_id) {
-  absl::flat_hash_set<ItemId> record_ids;
-  for (const auto* type_alias : ir.get_items_if<TypeAlias>()) {
-    if (type_alias->enclosing_namespace_id.has_value() &&
-        type_alias->enclosing_namespace_id == namespace_id) {
-      const MappedType* mapped_type = &type_alias->underlying_type;
-      CHECK(mapped_type->cc_type.decl_id.has_value());
-      CHECK(mapped_type->rs_type.decl_id.has_value());
-      CHECK(mapped_type->cc_type.decl_id.value() ==
-            mapped_type->rs_type.decl_id.value());
-      record_ids.insert(mapped_type->rs_type.decl_id.value());
+void ThinIrForDependents(IR& ir) {
+  ItemIdSet removed_ids;
+  std::vector<IR::Item> kept_items;
+  kept_items.reserve(ir.items.size());
+  for (IR::Item& item : ir.items) {
+    if (std::holds_alternative<Func>(item) ||
+        std::holds_alternative<UnsupportedItem>(item) ||
+        std::holds_alternative<Comment>(item)) {
+      removed_ids.insert(std::visit([](auto&& item) { return item.id; }, item));
+    } else {
+      kept_items.push_back(std::move(item));
     }
   }
+  ir.items = std::move(kept_items);
 
-  std::vector<const Record*> result;
-  for (const auto* record : ir.get_items_if<Record>()) {
-    if (record_ids.find(record->id) != record_ids.end()) {
-      result.push_back(record);
+  auto remove_dropped_ids = [&removed_ids](std::vector<ItemId>& ids) {
+    ids.erase(std::remove_if(
+                  ids.begin(), ids.end(),
+                  [&removed_ids](ItemId id) { return removed_ids.contains(id); }),
+              ids.end());
+  };
+  remove_dropped_ids(ir.top_level_item_ids);
+  for (IR::Item& item : ir.items) {
+    if (auto* record = std::get_if<Record>(&item)) {
+      remove_dropped_ids(record->child_item_ids);
+    } else if (auto* ns = std::get_if<Namespace>(&item)) {
+      remove_dropped_ids(ns->child_item_ids);
     }
   }
-  return result;
+}
+
+// Generates bindings and metadata for `ir` as configured by `cmdline`; the
+// shared tail of the one-shot and batched entry points.
+static absl::StatusOr<BindingsAndMetadata> BindingsFromIr(
+    IR ir, const Cmdline& cmdline) {
+  if (cmdline.thin_ir_only()) {
+    // Thin IR mode: the invocation exists solely so that downstream targets
+    // can reference this target's types, and dependents consume nothing but
+    // type/layout information from the IR. Function bindings dominate both
+    // the IR size and source generation time, so they are dropped and no
+    // sources are generated - in particular, clang-format and rustfmt never
+    // run.
+    ThinIrForDependents(ir);
+    auto top_level_namespaces = crubit::CollectNamespaces(ir);
+    return BindingsAndMetadata{
+        .ir = std::move(ir),
+        .rs_api = ScopedFfiU8SliceBox(),
+        .rs_api_impl = ScopedFfiU8SliceBox(),
+        .namespaces = std::move(top_level_namespaces),
+        .instantiations = {},
+        .error_report = ScopedFfiU8SliceBox(),
+    };
+  }
+
+  if (!cmdline.instantiations_out().empty()) {
+    ir.crate_root_path = "__cc_template_instantiations_rs_api";
+  }
+
+  bool generate_error_report = !cmdline.error_report_out().empty();
+  // Covers source code generation - including the clang-format/rustfmt runs
+  // on the Rust side of the FFI boundary - plus the (cheap) metadata
+  // collection below.
+  ScopedTimer timer("bindings_from_ir");
+  CRUBIT_ASSIGN_OR_RETURN(
+      Bindings bindings,
+      GenerateBindings(ir, cmdline.crubit_support_path(),
+                       cmdline.clang_format_exe_path(),
+                       cmdline.rustfmt_exe_path(),
+                       cmdline.rustfmt_config_path(), generate_error_report));
+
+  absl::flat_hash_map<std::string, std::string> instantiations =
+      CollectInstantiationsMap(ir);
+
+  auto top_level_namespaces = crubit::CollectNamespaces(ir);
+
+  return BindingsAndMetadata{
+      .ir = std::move(ir),
+      .rs_api = std::move(bindings.rs_api),
+      .rs_api_impl = std::move(bindings.rs_api_impl),
+      .namespaces = std::move(top_level_namespaces),
+      .instantiations = std::move(instantiations),
+      .error_report = std::move(bindings.error_report),
+  };
+}
+
+// Merges per-shard IRs (see the shard mode below) into one IR. Items and
+// top-level item ids are concatenated in shard order, which preserves header
+// order because the shards partition `public_headers` contiguously. Item ids
+// are minted from decl pointers and every shard parses into a live AST of its
+// own, so ids are expected to be distinct across shards; a collision is
+// reported instead of silently splicing two unrelated items together.
+static absl::StatusOr<IR> MergeShardIrs(std::vector<IR> shard_irs) {
+  IR merged = std::move(shard_irs.front());
+  ItemIdSet seen_ids;
+  seen_ids.reserve(merged.items.size());
+  for (const IR::Item& item : merged.items) {
+    std::visit([&](auto&& item) { seen_ids.insert(item.id); }, item);
+  }
+  for (size_t i = 1; i < shard_irs.size(); ++i) {
+    IR& shard_ir = shard_irs[i];
+    merged.public_headers.insert(merged.public_headers.end(),
+                                 shard_ir.public_headers.begin(),
+                                 shard_ir.public_headers.end());
+    merged.items.reserve(merged.items.size() + shard_ir.items.size());
+    for (IR::Item& item : shard_ir.items) {
+      ItemId id = std::visit([](auto&& item) { return item.id; }, item);
+      if (!seen_ids.insert(id).second) {
+        return absl::InternalError(absl::StrCat(
+            "item id ", id.value(),
+            " was produced by more than one shard; cannot merge shard IRs"));
+      }
+      merged.items.push_back(std::move(item));
+    }
+    merged.top_level_item_ids.insert(merged.top_level_item_ids.end(),
+                                     shard_ir.top_level_item_ids.begin(),
+                                     shard_ir.top_level_item_ids.end());
+  }
+  return merged;
+}
+
+// Shard mode: parses `cmdline.public_headers()` as `cmdline.shard_count()`
+// contiguous slices, each in a Clang invocation of its own whose AST is freed
+// before the next slice is parsed, capping peak AST memory at roughly one
+// shard's worth instead of the whole target's. A header that is `#include`d
+// by another slice of the same target would be imported (and get bindings) by
+// both shards, hence the include-disjointness requirement documented on
+// `--shard_count`.
+static absl::StatusOr<IR> IrFromCcSharded(
+    const Cmdline& cmdline, absl::Span<const absl::string_view> clang_args,
+    const absl::flat_hash_map<const HeaderName, const std::string>&
+        virtual_headers_contents_for_testing) {
+  const std::vector<HeaderName>& headers = cmdline.public_headers();
+  size_t shard_count =
+      std::min<size_t>(cmdline.shard_count(), headers.size());
+  std::vector<IR> shard_irs;
+  shard_irs.reserve(shard_count);
+  size_t begin = 0;
+  for (size_t shard = 0; shard < shard_count; ++shard) {
+    // Balanced contiguous partition: each shard takes its even share of the
+    // headers that remain.
+    size_t end = begin + (headers.size() - begin) / (shard_count - shard);
+    std::vector<HeaderName> slice(headers.begin() + begin,
+                                  headers.begin() + end);
+    CRUBIT_ASSIGN_OR_RETURN(
+        IR shard_ir,
+        IrFromCc(
+            /* extra_source_code_for_testing= */ "", cmdline.current_target(),
+            slice, virtual_headers_contents_for_testing,
+            cmdline.headers_to_targets(), /* extra_rs_srcs= */ {},
+            clang_args));
+    shard_irs.push_back(std::move(shard_ir));
+    begin = end;
+  }
+  return MergeShardIrs(std::move(shard_irs));
 }
 
 absl::StatusOr<BindingsAndMetadata> GenerateBindingsAndMetadata(
@@ -62,9 +240,30 @@ absl::StatusOr<BindingsAndMetadata> GenerateBindingsAndMetadata(
   clang_args_view.insert(clang_args_view.end(), clang_args.begin(),
                          clang_args.end());
 
+  // In instantiation mode (`--instantiations_out` implies sources to scan,
+  // and vice versa), the per-file scan results are cached beside the output
+  // so that unchanged sources are not re-parsed on the next invocation.
   CRUBIT_ASSIGN_OR_RETURN(
       std::vector<std::string> requested_instantiations,
-      CollectInstantiations(cmdline.srcs_to_scan_for_instantiations()));
+      cmdline.instantiations_out().empty()
+          ? CollectInstantiations(cmdline.srcs_to_scan_for_instantiations())
+          : CollectInstantiationsWithCache(
+                cmdline.srcs_to_scan_for_instantiations(),
+                absl::StrCat(cmdline.instantiations_out(), ".scan_cache")));
+
+  if (cmdline.shard_count() > 1) {
+    // Template instantiations and extra Rust sources are appended to a single
+    // translation unit / IR and have no well-defined home shard.
+    if (!requested_instantiations.empty() || !cmdline.extra_rs_srcs().empty()) {
+      return absl::InvalidArgumentError(
+          "template instantiation mode and --extra_rs_srcs are not supported "
+          "with --shard_count");
+    }
+    CRUBIT_ASSIGN_OR_RETURN(
+        IR ir, IrFromCcSharded(cmdline, clang_args_view,
+                               virtual_headers_contents_for_testing));
+    return BindingsFromIr(std::move(ir), cmdline);
+  }
 
   CRUBIT_ASSIGN_OR_RETURN(
       IR ir,
@@ -74,39 +273,61 @@ absl::StatusOr<BindingsAndMetadata> GenerateBindingsAndMetadata(
           cmdline.headers_to_targets(), cmdline.extra_rs_srcs(),
           clang_args_view, requested_instantiations));
 
-  if (!cmdline.instantiations_out().empty()) {
-    ir.crate_root_path = "__cc_template_instantiations_rs_api";
-  }
+  return BindingsFromIr(std::move(ir), cmdline);
+}
 
-  bool generate_error_report = !cmdline.error_report_out().empty();
-  CRUBIT_ASSIGN_OR_RETURN(
-      Bindings bindings,
-      GenerateBindings(ir, cmdline.crubit_support_path(),
-                       cmdline.clang_format_exe_path(),
-                       cmdline.rustfmt_exe_path(),
-                       cmdline.rustfmt_config_path(), generate_error_report));
+absl::StatusOr<std::vector<BindingsAndMetadata>>
+GenerateBindingsAndMetadataBatch(absl::Span<Cmdline> cmdlines,
+                                 std::vector<std::string> clang_args) {
+  std::vector<absl::string_view> clang_args_view;
+  clang_args_view.insert(clang_args_view.end(), clang_args.begin(),
+                         clang_args.end());
 
-  absl::flat_hash_map<std::string, std::string> instantiations;
-  std::optional<const Namespace*> ns =
-      FindNamespace(ir, kInstantiationsNamespaceName);
-  if (ns.has_value()) {
-    std::vector<const Record*> records =
-        FindInstantiationsInNamespace(ir, ns.value()->id);
-    for (const auto* record : records) {
-      instantiations.insert({record->cc_name, record->rs_name});
+  std::vector<IrFromCcBatchTarget> targets;
+  targets.reserve(cmdlines.size());
+  bool share_one_context = true;
+  for (const Cmdline& cmdline : cmdlines) {
+    if (!cmdline.srcs_to_scan_for_instantiations().empty() ||
+        !cmdline.extra_rs_srcs().empty()) {
+      return absl::InvalidArgumentError(
+          "template instantiation mode and --extra_rs_srcs are not supported "
+          "in a batched invocation");
     }
+    targets.push_back(
+        {cmdline.current_target(), cmdline.public_headers()});
+    share_one_context &=
+        cmdline.invocation_context() == cmdlines[0].invocation_context();
   }
 
-  auto top_level_namespaces = crubit::CollectNamespaces(ir);
+  // The per-cmdline maps are merged into one headers-to-targets view of the
+  // whole batch; entries are expected to agree, the first one wins otherwise.
+  // The requests of a batch normally carry identical --targets_and_headers
+  // and thus share one invocation context, in which case the merged view is
+  // a single copy of it.
+  absl::flat_hash_map<HeaderName, BazelLabel> headers_to_targets;
+  if (share_one_context && !cmdlines.empty()) {
+    headers_to_targets = cmdlines[0].headers_to_targets();
+  } else {
+    for (const Cmdline& cmdline : cmdlines) {
+      for (const auto& [header, target] : cmdline.headers_to_targets()) {
+        headers_to_targets.try_emplace(header, target);
+      }
+    }
+  }
 
-  return BindingsAndMetadata{
-      .ir = ir,
-      .rs_api = bindings.rs_api,
-      .rs_api_impl = bindings.rs_api_impl,
-      .namespaces = std::move(top_level_namespaces),
-      .instantiations = std::move(instantiations),
-      .error_report = bindings.error_report,
-  };
+  CRUBIT_ASSIGN_OR_RETURN(
+      std::vector<IR> irs,
+      IrsFromCcBatch(targets, std::move(headers_to_targets), clang_args_view));
+
+  std::vector<BindingsAndMetadata> results;
+  results.reserve(irs.size());
+  for (size_t i = 0; i < irs.size(); ++i) {
+    CRUBIT_ASSIGN_OR_RETURN(
+        BindingsAndMetadata bindings_and_metadata,
+        BindingsFromIr(std::move(irs[i]), cmdlines[i]));
+    results.push_back(std::move(bindings_and_metadata));
+  }
+  return results;
 }
 
 }  // namespace crubit
@@ -9,6 +9,8 @@
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "common/ffi_types.h"
 #include "rs_bindings_from_cc/cmdline.h"
 #include "rs_bindings_from_cc/collect_namespaces.h"
 #include "rs_bindings_from_cc/ir.h"
@@ -19,25 +21,41 @@ struct BindingsAndMetadata {
   // Intermediate representation of the Clang AST from which we generated
   // bindings.
   IR ir;
-  // Generated Rust source code.
-  std::string rs_api;
-  // Generated C++ source code.
-  std::string rs_api_impl;
+  // Generated Rust source code (Rust-allocated, adopted without copying).
+  ScopedFfiU8SliceBox rs_api;
+  // Generated C++ source code (Rust-allocated, adopted without copying).
+  ScopedFfiU8SliceBox rs_api_impl;
   // A hierarchy tree for all C++ namespaces used in the target.
   NamespacesHierarchy namespaces;
   // C++ class templates explicitly instantiated in this TU and their Rust
   // struct name.
   absl::flat_hash_map<std::string, std::string> instantiations;
   // A JSON error report, if requested.
-  std::string error_report;
+  ScopedFfiU8SliceBox error_report;
 };
 
+// Reduces `ir` in place to the subset that dependent targets consume: records,
+// enums, aliases and namespaces. Functions, comments and per-item diagnostics
+// are dropped, and the dropped ids are pruned from the top-level and child
+// item id lists. Used by `--thin_ir_only` (see the flag's description).
+void ThinIrForDependents(IR& ir);
+
 // Returns `BindingsAndMetadata` as requested by the user on the command line.
 absl::StatusOr<BindingsAndMetadata> GenerateBindingsAndMetadata(
     Cmdline& cmdline, std::vector<std::string> clang_args,
     absl::flat_hash_map<const HeaderName, const std::string>
         virtual_headers_contents_for_testing = {});
 
+// Batched variant for targets that share most of their header closure: one
+// `Cmdline` per (target, public_headers, output paths) tuple. The union of
+// all public headers is parsed in a single Clang invocation, then bindings
+// are generated per target against the shared AST (see `IrsFromCcBatch`),
+// returned in the same order as `cmdlines`. Template instantiation mode and
+// `--extra_rs_srcs` are not supported in batch mode.
+absl::StatusOr<std::vector<BindingsAndMetadata>>
+GenerateBindingsAndMetadataBatch(absl::Span<Cmdline> cmdlines,
+                                 std::vector<std::string> clang_args);
+
 }  // namespace crubit
 
 #endif  // THIRD_PARTY_CRUBIT_RS_BINDINGS_FROM_CC_GENERATE_BINDINGS_AND_METADATA_H_
@@ -57,13 +57,53 @@ TEST(GenerateBindingsAndMetadataTest, GeneratingIR) {
 
   ASSERT_EQ(result.ir.public_headers.size(), 1);
   ASSERT_EQ(result.ir.public_headers.front().IncludePath(), "a.h");
-  ASSERT_EQ(result.error_report, "");
+  ASSERT_EQ(result.error_report.value(), "");
 
   // Check that IR items have the proper owning target set.
   auto item = result.ir.get_items_if<Namespace>().front();
   ASSERT_EQ(item->owning_target.value(), "target1");
 }
 
+TEST(GenerateBindingsAndMetadataTest, ThinIrDropsFunctionsButKeepsTypes) {
+  constexpr absl::string_view kTargetsAndHeaders = R"([
+    {"t": "target1", "h": ["a.h"]}
+  ])";
+
+  ASSERT_OK_AND_ASSIGN(
+      Cmdline cmdline,
+      Cmdline::CreateForTesting(
+          "//:target", "cc_out", "rs_out", "ir_out", "namespaces_out",
+          "crubit_support_path", std::string(kDefaultClangFormatExePath),
+          std::string(kDefaultRustfmtExePath), "nowhere/rustfmt.toml",
+          /* do_nothing= */ false,
+          /* public_headers= */ {"a.h"}, std::string(kTargetsAndHeaders),
+          /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "",
+          /* error_report_out= */ ""));
+
+  ASSERT_OK_AND_ASSIGN(
+      BindingsAndMetadata result,
+      GenerateBindingsAndMetadata(
+          cmdline, DefaultClangArgs(),
+          /* virtual_headers_contents= */
+          {{HeaderName("a.h"), "struct S { int field; };\nvoid f();"}}));
+
+  // Besides the free function, the record's implicit member functions are
+  // `Func` items too.
+  ASSERT_FALSE(result.ir.get_items_if<Func>().empty());
+  ASSERT_EQ(result.ir.get_items_if<Record>().size(), 1);
+  size_t top_level_item_count = result.ir.top_level_item_ids.size();
+
+  ThinIrForDependents(result.ir);
+
+  // The functions are gone - from the items as well as from the top-level id
+  // list - while the record survives with its layout information.
+  ASSERT_THAT(result.ir.get_items_if<Func>(), IsEmpty());
+  ASSERT_EQ(result.ir.get_items_if<Record>().size(), 1);
+  ASSERT_LT(result.ir.top_level_item_ids.size(), top_level_item_count);
+}
+
 TEST(GenerateBindingsAndMetadataTest, InstantiationsAreEmptyInNormalMode) {
   constexpr absl::string_view kTargetsAndHeaders = R"([
     {"t": "target1", "h": ["a.h"]}
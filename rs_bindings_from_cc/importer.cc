@@ -29,6 +29,7 @@
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "common/status_macros.h"
+#include "common/timing.h"
 #include "lifetime_annotations/type_lifetimes.h"
 #include "rs_bindings_from_cc/ast_util.h"
 #include "rs_bindings_from_cc/bazel_types.h"
@@ -39,6 +40,7 @@
 #include "clang/AST/DeclBase.h"
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclFriend.h"
+#include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Mangle.h"
 #include "clang/AST/RawCommentList.h"
 #include "clang/AST/Type.h"
@@ -51,6 +53,7 @@
 #include "clang/Sema/Sema.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Regex.h"
@@ -156,6 +159,34 @@ absl::StatusOr<absl::string_view> ConvertCcCallConvIntoRsAbi(
                        clang::FunctionType::getNameForCallConv(cc_call_conv))));
 }
 
+// Decl counts gathered by `CountDecls` below. Used purely as `reserve` hints
+// for the importer's memo tables, so they only have to be upper bounds of the
+// eventual table sizes, not exact.
+struct AstDeclStatistics {
+  size_t total_decls = 0;
+  size_t type_decls = 0;
+  size_t function_decls = 0;
+};
+
+// Counts the declarations reachable from `decl_context` in a single walk.
+// The walk chases decl pointers and checks decl kinds only - no name lookup,
+// mangling, or type conversion - so it is cheap relative to the import whose
+// tables it pre-sizes.
+void CountDecls(const clang::DeclContext* decl_context,
+                AstDeclStatistics& stats) {
+  for (const clang::Decl* decl : decl_context->decls()) {
+    ++stats.total_decls;
+    if (clang::isa<clang::TypeDecl>(decl)) {
+      ++stats.type_decls;
+    } else if (clang::isa<clang::FunctionDecl>(decl)) {
+      ++stats.function_decls;
+    }
+    if (const auto* inner = clang::dyn_cast<clang::DeclContext>(decl)) {
+      CountDecls(inner, stats);
+    }
+  }
+}
+
 }  // namespace
 
 // Multiple IR items can be associated with the same source location (e.g. the
@@ -189,29 +220,52 @@ static int GetDeclOrder(const clang::Decl* decl) {
   return 999;
 }
 
+// Computes a lexicographic key that orders `loc` by its position in the
+// translation unit without any further `SourceManager` queries: the offsets
+// of the enclosing `#include` directives from the main file down to `loc`'s
+// file, followed by `loc`'s offset within that file. This is the chain that
+// `SourceManager::isBeforeInTranslationUnit` re-derives pairwise on every
+// comparison; precomputing it once per item makes the O(n log n) item sorts
+// compare plain integers. An invalid `loc` yields an empty chain.
+static std::vector<uint32_t> GetTuOrderChain(const clang::SourceManager& sm,
+                                             clang::SourceLocation loc) {
+  std::vector<uint32_t> chain;
+  if (loc.isInvalid()) return chain;
+  auto [fid, offset] = sm.getDecomposedExpansionLoc(loc);
+  while (fid.isValid()) {
+    chain.push_back(offset);
+    std::tie(fid, offset) = sm.getDecomposedIncludedLoc(fid);
+  }
+  std::reverse(chain.begin(), chain.end());
+  return chain;
+}
+
 class Importer::SourceOrderKey {
  public:
-  SourceOrderKey(clang::SourceRange source_range, int decl_order = 0,
+  SourceOrderKey(std::vector<uint32_t> begin_chain,
+                 std::vector<uint32_t> end_chain, int decl_order = 0,
                  std::string name = "")
-      : source_range_(source_range), decl_order_(decl_order), name_(name) {}
+      : begin_chain_(std::move(begin_chain)),
+        end_chain_(std::move(end_chain)),
+        decl_order_(decl_order),
+        name_(name) {}
 
   SourceOrderKey(const SourceOrderKey&) = default;
   SourceOrderKey& operator=(const SourceOrderKey&) = default;
 
-  bool isBefore(const SourceOrderKey& other,
-                const clang::SourceManager& sm) const {
-    if (!source_range_.isValid() || !other.source_range_.isValid()) {
-      if (source_range_.isValid() != other.source_range_.isValid())
-        return !source_range_.isValid() && other.source_range_.isValid();
+  bool isBefore(const SourceOrderKey& other) const {
+    // An empty chain corresponds to an invalid source location; those sort
+    // before items with valid locations, mirroring what
+    // `isBeforeInTranslationUnit`-based ordering used to produce.
+    if (begin_chain_.empty() || other.begin_chain_.empty()) {
+      if (begin_chain_.empty() != other.begin_chain_.empty())
+        return begin_chain_.empty() && !other.begin_chain_.empty();
     } else {
-      if (source_range_.getBegin() != other.source_range_.getBegin()) {
-        return sm.isBeforeInTranslationUnit(source_range_.getBegin(),
-                                            other.source_range_.getBegin());
-      }
-      if (source_range_.getEnd() != other.source_range_.getEnd()) {
-        return sm.isBeforeInTranslationUnit(source_range_.getEnd(),
-                                            other.source_range_.getEnd());
-      }
+      // A shorter chain that is a prefix of a longer one belongs to the
+      // `#include` directive itself, which precedes the included content.
+      if (begin_chain_ != other.begin_chain_)
+        return begin_chain_ < other.begin_chain_;
+      if (end_chain_ != other.end_chain_) return end_chain_ < other.end_chain_;
     }
 
     if (decl_order_ < other.decl_order_) {
@@ -223,20 +277,27 @@ class Importer::SourceOrderKey {
   }
 
  private:
-  clang::SourceRange source_range_;
+  std::vector<uint32_t> begin_chain_;
+  std::vector<uint32_t> end_chain_;
   int decl_order_;
   std::string name_;
 };
 
 Importer::SourceOrderKey Importer::GetSourceOrderKey(
     const clang::Decl* decl) const {
-  return SourceOrderKey(decl->getSourceRange(), GetDeclOrder(decl),
-                        GetNameForSourceOrder(decl));
+  const clang::SourceManager& sm = ctx_.getSourceManager();
+  clang::SourceRange source_range = decl->getSourceRange();
+  return SourceOrderKey(GetTuOrderChain(sm, source_range.getBegin()),
+                        GetTuOrderChain(sm, source_range.getEnd()),
+                        GetDeclOrder(decl), GetNameForSourceOrder(decl));
 }
 
 Importer::SourceOrderKey Importer::GetSourceOrderKey(
     const clang::RawComment* comment) const {
-  return SourceOrderKey(comment->getSourceRange());
+  const clang::SourceManager& sm = ctx_.getSourceManager();
+  clang::SourceRange source_range = comment->getSourceRange();
+  return SourceOrderKey(GetTuOrderChain(sm, source_range.getBegin()),
+                        GetTuOrderChain(sm, source_range.getEnd()));
 }
 
 class Importer::SourceLocationComparator {
@@ -259,13 +320,11 @@ class Importer::SourceLocationComparator {
   }
 
   using OrderedItemId = std::pair<SourceOrderKey, ItemId>;
-  using OrderedItem = std::pair<SourceOrderKey, IR::Item>;
+  using OrderedItemPtr = std::pair<SourceOrderKey, IR::Item*>;
 
   template <typename OrderedItemOrId>
   bool operator()(const OrderedItemOrId& a, const OrderedItemOrId& b) const {
-    auto a_source_order = a.first;
-    auto b_source_order = b.first;
-    return a_source_order.isBefore(b_source_order, sm);
+    return a.first.isBefore(b.first);
   }
   SourceLocationComparator(const clang::SourceManager& sm) : sm(sm) {}
 
@@ -306,6 +365,10 @@ static std::vector<clang::Decl*> GetCanonicalChildren(
 
 std::vector<ItemId> Importer::GetItemIdsInSourceOrder(
     clang::Decl* parent_decl) {
+  if (auto it = item_ids_in_source_order_cache_.find(parent_decl);
+      it != item_ids_in_source_order_cache_.end()) {
+    return it->second;
+  }
   clang::SourceManager& sm = ctx_.getSourceManager();
   std::vector<SourceLocationComparator::OrderedItemId> items;
   auto compare_locations = SourceLocationComparator(sm);
@@ -324,11 +387,11 @@ std::vector<ItemId> Importer::GetItemIdsInSourceOrder(
     ordered_comments.insert({comment->getBeginLoc(), comment});
   }
 
-  absl::flat_hash_set<ItemId> visited_item_ids;
+  ItemIdSet visited_item_ids;
 
   auto* decl_context = clang::cast<clang::DeclContext>(parent_decl);
   for (auto decl : GetCanonicalChildren(decl_context)) {
-    auto item = GetDeclItem(decl);
+    const std::optional<IR::Item>& item = GetDeclItem(decl);
     // We generated IR for top level items coming from different targets,
     // however we shouldn't generate bindings for them, so we don't add them
     // to ir.top_level_item_ids.
@@ -348,7 +411,7 @@ std::vector<ItemId> Importer::GetItemIdsInSourceOrder(
 
     // We remove comments attached to a child decl or that are within a child
     // decl.
-    if (auto raw_comment = ctx_.getRawCommentForDeclNoCache(decl)) {
+    if (const clang::RawComment* raw_comment = GetAttachedComment(decl)) {
       ordered_comments.erase(raw_comment->getBeginLoc());
     }
     ordered_comments.erase(ordered_comments.lower_bound(decl->getBeginLoc()),
@@ -365,6 +428,7 @@ std::vector<ItemId> Importer::GetItemIdsInSourceOrder(
   for (auto& ordered_item : items) {
     ordered_item_ids.push_back(ordered_item.second);
   }
+  item_ids_in_source_order_cache_.insert({parent_decl, ordered_item_ids});
   return ordered_item_ids;
 }
 
@@ -389,6 +453,7 @@ std::vector<ItemId> Importer::GetOrderedItemIdsOfTemplateInstantiations()
 }
 
 void Importer::ImportFreeComments() {
+  if (DocCommentsDisabled()) return;
   clang::SourceManager& sm = ctx_.getSourceManager();
   for (const auto& header : invocation_.public_headers_) {
     if (auto file = sm.getFileManager().getFile(header.IncludePath())) {
@@ -404,25 +469,62 @@ void Importer::ImportFreeComments() {
 }
 
 void Importer::Import(clang::TranslationUnitDecl* translation_unit_decl) {
+  ScopedTimer timer("import");
+
+  // Pre-size the memo tables from a cheap decl-count pre-pass over the TU.
+  // On large TUs the tables grow towards roughly these sizes, and reserving
+  // up front replaces their rehash cascades (and the re-hashing of every
+  // resident key that comes with each one) with a single allocation per
+  // table. The counts are upper bounds - they include decls that are never
+  // imported, e.g. ones from headers of targets this invocation only depends
+  // on - which hash tables tolerate well: capacity is a load-factor multiple
+  // of size either way.
+  AstDeclStatistics stats;
+  CountDecls(translation_unit_decl, stats);
+  import_cache_.reserve(stats.total_decls);
+  raw_comment_cache_.reserve(stats.total_decls);
+  known_type_decls_.reserve(stats.type_decls);
+  qual_type_conversion_cache_.reserve(stats.type_decls);
+  mangled_name_cache_.reserve(stats.function_decls);
+
   ImportFreeComments();
   clang::SourceManager& sm = ctx_.getSourceManager();
-  std::vector<SourceLocationComparator::OrderedItem> ordered_items;
 
+  ImportDeclsFromDeclContext(translation_unit_decl);
+
+  invocation_.ir_.top_level_item_ids =
+      GetItemIdsInSourceOrder(translation_unit_decl);
+
+  // TODO(b/257302656): Consider placing the generated template instantiations
+  // into a separate namespace (maybe `crubit::instantiated_templates` ?).
+  llvm::copy(GetOrderedItemIdsOfTemplateInstantiations(),
+             std::back_inserter(invocation_.ir_.top_level_item_ids));
+
+  // Items own dozens of strings and vectors each, so everything below sorts
+  // *pointers* to the items and then moves each item into the IR exactly
+  // once, instead of deep-copying the items into the sorting vector and again
+  // into `ir_.items`.
+  std::vector<IR::Item> comment_items;
+  comment_items.reserve(comments_.size());
   for (auto& comment : comments_) {
-    ordered_items.push_back(
-        {GetSourceOrderKey(comment),
-         Comment{.text = comment->getFormattedText(sm, sm.getDiagnostics()),
-                 .id = GenerateItemId(comment)}});
+    comment_items.push_back(
+        Comment{.text = comment->getFormattedText(sm, sm.getDiagnostics()),
+                .id = GenerateItemId(comment)});
   }
 
-  ImportDeclsFromDeclContext(translation_unit_decl);
-  for (const auto& [decl, item] : import_cache_) {
+  std::vector<SourceLocationComparator::OrderedItemPtr> ordered_items;
+  ordered_items.reserve(comment_items.size() + import_cache_.size());
+  for (size_t i = 0; i < comment_items.size(); ++i) {
+    ordered_items.push_back(
+        {GetSourceOrderKey(comments_[i]), &comment_items[i]});
+  }
+  for (auto& [decl, item] : import_cache_) {
     if (item.has_value()) {
       if (std::holds_alternative<UnsupportedItem>(*item) &&
           !IsFromCurrentTarget(decl)) {
         continue;
       }
-      ordered_items.push_back({GetSourceOrderKey(decl), *item});
+      ordered_items.push_back({GetSourceOrderKey(decl), &*item});
     }
   }
 
@@ -430,15 +532,10 @@ void Importer::Import(clang::TranslationUnitDecl* translation_unit_decl) {
 
   invocation_.ir_.items.reserve(ordered_items.size());
   for (auto& ordered_item : ordered_items) {
-    invocation_.ir_.items.push_back(ordered_item.second);
+    // Moves the item out of `import_cache_` (or `comment_items`); the cache
+    // only answers `has_value()` queries from here on.
+    invocation_.ir_.items.push_back(std::move(*ordered_item.second));
   }
-  invocation_.ir_.top_level_item_ids =
-      GetItemIdsInSourceOrder(translation_unit_decl);
-
-  // TODO(b/257302656): Consider placing the generated template instantiations
-  // into a separate namespace (maybe `crubit::instantiated_templates` ?).
-  llvm::copy(GetOrderedItemIdsOfTemplateInstantiations(),
-             std::back_inserter(invocation_.ir_.top_level_item_ids));
 }
 
 void Importer::ImportDeclsFromDeclContext(
@@ -448,7 +545,7 @@ void Importer::ImportDeclsFromDeclContext(
   }
 }
 
-std::optional<IR::Item> Importer::GetDeclItem(clang::Decl* decl) {
+const std::optional<IR::Item>& Importer::GetDeclItem(clang::Decl* decl) {
   // TODO: Move `decl->getCanonicalDecl()` from callers into here.
   if (auto it = import_cache_.find(decl); it != import_cache_.end()) {
     return it->second;
@@ -519,7 +616,11 @@ std::optional<IR::Item> Importer::GetDeclItem(clang::Decl* decl) {
     // IR::top_level_item_ids.
     class_template_instantiations_.insert(specialization_decl);
   }
-  return result;
+  // `ImportDeclsFromDeclContext` above may have grown `import_cache_` and
+  // invalidated `it`, so look the entry up again instead of returning a copy
+  // of `result` - items own dozens of strings and vectors each, and this
+  // function runs once per decl of our largest headers.
+  return import_cache_.find(decl)->second;
 }
 
 /// Returns true if a decl is inside a private section, or is inside a
@@ -550,66 +651,142 @@ bool IsTransitivelyInPrivate(clang::Decl* decl_to_check) {
 
 std::optional<IR::Item> Importer::ImportDecl(clang::Decl* decl) {
   if (IsTransitivelyInPrivate(decl)) return std::nullopt;
-  std::optional<IR::Item> result;
   for (auto& importer : decl_importers_) {
+    // At most one importer is authoritative for a decl (they discriminate on
+    // disjoint decl classes), so stop probing once it is found.
     if (importer->CanImport(decl)) {
-      result = importer->ImportDecl(decl);
+      // Phase name is the decl kind (e.g. "CXXRecord"); imports recurse, so
+      // a kind's time includes the imports of its dependencies.
+      ScopedTimer timer(decl->getDeclKindName());
+      return importer->ImportDecl(decl);
     }
   }
-  return result;
+  return std::nullopt;
 }
 
-std::optional<IR::Item> Importer::GetImportedItem(const clang::Decl* decl) {
+const IR::Item* Importer::GetImportedItem(const clang::Decl* decl) {
   auto it = import_cache_.find(decl);
-  if (it != import_cache_.end()) {
-    return it->second;
+  if (it != import_cache_.end() && it->second.has_value()) {
+    return &*it->second;
   }
-  return std::nullopt;
+  return nullptr;
 }
 
-BazelLabel Importer::GetOwningTarget(const clang::Decl* decl) const {
-  // Template instantiations need to be generated in the target that triggered
-  // the instantiation (not in the target where the template is defined).
-  if (IsFullClassTemplateSpecializationOrChild(decl)) {
-    return invocation_.target_;
-  }
+const BazelLabel& Importer::GetOwningTargetForLocation(
+    clang::SourceLocation source_location) const {
+  static const BazelLabel& no_location_target =
+      *new BazelLabel("//:virtual_clang_resource_dir_target");
 
   clang::SourceManager& source_manager = ctx_.getSourceManager();
-  auto source_location = decl->getLocation();
 
-  // If the header this decl comes from is not associated with a target we
+  // If the header this location comes from is not associated with a target we
   // consider it a textual header. In that case we go up the include stack
   // until we find a header that has an owning target.
+  //
+  // The walk depends only on the file a location is in, so the result is
+  // memoized per `FileID` (for every file visited along the include stack):
+  // a small header pulling in <vector> would otherwise repeat the whole
+  // classification for tens of thousands of foreign decls.
 
+  llvm::SmallVector<unsigned, 8> visited_file_ids;
+  BazelLabel target("//:virtual_clang_resource_dir_target");
   while (source_location.isValid()) {
     if (source_location.isMacroID()) {
       source_location = source_manager.getExpansionLoc(source_location);
     }
     auto id = source_manager.getFileID(source_location);
+    if (auto it = file_target_cache_.find(id.getHashValue());
+        it != file_target_cache_.end()) {
+      // The hot path: every decl after the first one in a file resolves with
+      // this single lookup, without copying the label.
+      if (visited_file_ids.empty()) return it->second;
+      target = it->second;
+      break;
+    }
+    visited_file_ids.push_back(id.getHashValue());
+
     llvm::Optional<llvm::StringRef> filename =
         source_manager.getNonBuiltinFilenameForID(id);
     if (!filename) {
-      return BazelLabel("//:_nothing_should_depend_on_private_builtin_hdrs");
+      target = BazelLabel("//:_nothing_should_depend_on_private_builtin_hdrs");
+      break;
     }
     if (filename->startswith("./")) {
       filename = filename->substr(2);
     }
 
-    if (auto target = invocation_.header_target(HeaderName(filename->str()))) {
-      return *target;
+    if (auto header_target =
+            invocation_.header_target(HeaderName(filename->str()))) {
+      target = *header_target;
+      break;
     }
     source_location = source_manager.getIncludeLoc(id);
   }
 
-  return BazelLabel("//:virtual_clang_resource_dir_target");
+  if (visited_file_ids.empty()) return no_location_target;
+
+  for (unsigned file_id : visited_file_ids) {
+    file_target_cache_.insert({file_id, target});
+  }
+  return file_target_cache_.find(visited_file_ids.front())->second;
+}
+
+bool Importer::IsFullClassTemplateSpecializationOrChild(
+    const clang::Decl* decl) const {
+  // The leaf checks mirror `crubit::IsFullClassTemplateSpecializationOrChild`;
+  // the recursion through the enclosing contexts is memoized here instead,
+  // since all decls sharing a context share the answer.
+  if (clang::isa<clang::ClassTemplatePartialSpecializationDecl>(decl)) {
+    return false;
+  }
+  if (clang::isa<clang::ClassTemplateSpecializationDecl>(decl)) {
+    return true;
+  }
+
+  const clang::DeclContext* decl_context = decl->getDeclContext();
+  if (decl_context == nullptr) {
+    return false;
+  }
+  if (auto it = template_specialization_ancestry_cache_.find(decl_context);
+      it != template_specialization_ancestry_cache_.end()) {
+    return it->second;
+  }
+  bool result = IsFullClassTemplateSpecializationOrChild(
+      clang::dyn_cast<clang::Decl>(decl_context));
+  template_specialization_ancestry_cache_.insert({decl_context, result});
+  return result;
+}
+
+BazelLabel Importer::GetOwningTarget(const clang::Decl* decl) const {
+  // Template instantiations need to be generated in the target that triggered
+  // the instantiation (not in the target where the template is defined).
+  if (IsFullClassTemplateSpecializationOrChild(decl)) {
+    return invocation_.target_;
+  }
+  return GetOwningTargetForLocation(decl->getLocation());
 }
 
 bool Importer::IsFromCurrentTarget(const clang::Decl* decl) const {
-  return invocation_.target_ == GetOwningTarget(decl);
+  if (IsFullClassTemplateSpecializationOrChild(decl)) {
+    return true;
+  }
+  // Compares against the cached label in place; with ~100k foreign decls per
+  // TU the reject path must not copy a `BazelLabel` per decl.
+  return invocation_.target_ ==
+         GetOwningTargetForLocation(decl->getLocation());
 }
 
 IR::Item Importer::ImportUnsupportedItem(const clang::Decl* decl,
                                          std::string error) {
+  // Unsupported items from other targets are dropped when the IR is
+  // finalized (see `Import`), so nobody ever reads their human-readable
+  // fields. Rendering them anyway - qualified-name printing and
+  // source-location formatting dominate the cost of an unsupported item -
+  // would be pure waste, and big TUs produce tens of thousands of foreign
+  // unsupported decls.
+  if (!IsFromCurrentTarget(decl)) {
+    return UnsupportedItem{.id = GenerateItemId(decl)};
+  }
   std::string name = "unnamed";
   if (const auto* named_decl = clang::dyn_cast<clang::NamedDecl>(decl)) {
     name = named_decl->getQualifiedNameAsString();
@@ -623,6 +800,11 @@ IR::Item Importer::ImportUnsupportedItem(const clang::Decl* decl,
 
 IR::Item Importer::ImportUnsupportedItem(const clang::Decl* decl,
                                          std::set<std::string> errors) {
+  // Skip the join for foreign decls; the string overload would drop the
+  // message anyway.
+  if (!IsFromCurrentTarget(decl)) {
+    return UnsupportedItem{.id = GenerateItemId(decl)};
+  }
   return ImportUnsupportedItem(decl, absl::StrJoin(errors, "\n\n"));
 }
 
@@ -636,13 +818,26 @@ static bool ShouldKeepCommentLine(absl::string_view line) {
   return !patterns_to_ignore.match(line);
 }
 
+const clang::RawComment* Importer::GetAttachedComment(
+    const clang::Decl* decl) const {
+  auto [it, inserted] = raw_comment_cache_.try_emplace(decl, nullptr);
+  if (inserted) {
+    it->second = ctx_.getRawCommentForDeclNoCache(decl);
+  }
+  return it->second;
+}
+
 std::optional<std::string> Importer::GetComment(const clang::Decl* decl) const {
   // This does currently not distinguish between different types of comments.
   // In general it is not possible in C++ to reliably only extract doc comments.
   // This is going to be a heuristic that needs to be tuned over time.
 
+  // Skipped before the attached-comment lookup, so that `--no_doc_comments`
+  // also saves the per-decl raw comment search.
+  if (DocCommentsDisabled()) return {};
+
   clang::SourceManager& sm = ctx_.getSourceManager();
-  clang::RawComment* raw_comment = ctx_.getRawCommentForDeclNoCache(decl);
+  const clang::RawComment* raw_comment = GetAttachedComment(decl);
 
   if (raw_comment == nullptr) {
     return {};
@@ -704,6 +899,23 @@ std::string Importer::ConvertSourceLocation(clang::SourceLocation loc) const {
   return absl::StrCat(spelling_loc_str, "\n", expansion_loc_str);
 }
 
+// Returns the nesting depth of template specializations within the template
+// arguments of `decl`: `vector<int>` has depth 1, `map<int, vector<int>>`
+// has depth 2, and so on.
+static int GetSpecializationDepth(
+    const clang::ClassTemplateSpecializationDecl* decl) {
+  int max_arg_depth = 0;
+  for (const clang::TemplateArgument& arg : decl->getTemplateArgs().asArray()) {
+    if (arg.getKind() != clang::TemplateArgument::Type) continue;
+    if (const auto* nested =
+            clang::dyn_cast_or_null<clang::ClassTemplateSpecializationDecl>(
+                arg.getAsType()->getAsCXXRecordDecl())) {
+      max_arg_depth = std::max(max_arg_depth, GetSpecializationDepth(nested));
+    }
+  }
+  return max_arg_depth + 1;
+}
+
 absl::StatusOr<MappedType> Importer::ConvertTemplateSpecializationType(
     const clang::TemplateSpecializationType* type) {
   // Qualifiers are handled separately in TypeMapper::ConvertQualType().
@@ -722,6 +934,18 @@ absl::StatusOr<MappedType> Importer::ConvertTemplateSpecializationType(
   if (HasBeenAlreadySuccessfullyImported(specialization_decl))
     return ConvertTypeDecl(specialization_decl);
 
+  // Deterministic instantiation budget, so that one pathological template
+  // (e.g. a recursively self-nesting specialization) cannot stall the whole
+  // target. The limit is far above anything a reasonable API surface
+  // produces.
+  constexpr int kMaxSpecializationDepth = 64;
+  if (GetSpecializationDepth(specialization_decl) > kMaxSpecializationDepth) {
+    return absl::InvalidArgumentError(absl::Substitute(
+        "Template specialization '$0' is nested deeper than $1 levels; "
+        "bindings are not generated for it.",
+        type_string, kMaxSpecializationDepth));
+  }
+
   // `Sema::isCompleteType` will try to instantiate the class template as a
   // side-effect and we rely on this here. `decl->getDefinition()` can
   // return nullptr before the call to sema and return its definition
@@ -729,9 +953,6 @@ absl::StatusOr<MappedType> Importer::ConvertTemplateSpecializationType(
   (void)sema_.isCompleteType(specialization_decl->getLocation(),
                              ctx_.getRecordType(specialization_decl));
 
-  // TODO(lukasza): Limit specialization depth? (e.g. using
-  // `isSpecializationDepthGreaterThan` from earlier prototypes).
-
   absl::Status import_status =
       CheckImportStatus(GetDeclItem(specialization_decl));
   if (!import_status.ok()) {
@@ -905,10 +1126,28 @@ absl::StatusOr<MappedType> Importer::ConvertQualType(
     std::optional<clang::tidy::lifetimes::ValueLifetimes>& lifetimes,
     bool nullable) {
   qual_type = GetUnelaboratedType(std::move(qual_type), ctx_);
-  std::string type_string = qual_type.getAsString();
+
+  // Memoize lifetime-free conversions; the same type recurs at every one of
+  // its use sites. Conversions under lifetimes are not cached because
+  // `lifetimes` is both consumed and reassigned while recursing through
+  // pointee types.
+  const bool cacheable = !lifetimes.has_value();
+  const std::pair<const void*, bool> cache_key(qual_type.getAsOpaquePtr(),
+                                               nullable);
+  if (cacheable) {
+    if (auto it = qual_type_conversion_cache_.find(cache_key);
+        it != qual_type_conversion_cache_.end()) {
+      return it->second;
+    }
+  }
+
   absl::StatusOr<MappedType> type =
       ConvertType(qual_type.getTypePtr(), lifetimes, nullable);
   if (!type.ok()) {
+    // The pretty-printed spelling is only needed for diagnostics;
+    // `getAsString` allocates and runs the type printer, so it is computed
+    // only on the failure paths, not once per type occurrence.
+    std::string type_string = qual_type.getAsString();
     absl::Status error = absl::UnimplementedError(absl::Substitute(
         "Unsupported type '$0': $1", type_string, type.status().message()));
     error.SetPayload(kTypeStatusPayloadUrl, absl::Cord(type_string));
@@ -918,14 +1157,32 @@ absl::StatusOr<MappedType> Importer::ConvertQualType(
   // Handle cv-qualification.
   type->cc_type.is_const = qual_type.isConstQualified();
   if (qual_type.isVolatileQualified()) {
-    return absl::UnimplementedError(
-        absl::StrCat("Unsupported `volatile` qualifier: ", type_string));
+    return absl::UnimplementedError(absl::StrCat(
+        "Unsupported `volatile` qualifier: ", qual_type.getAsString()));
   }
 
+  // Only successful conversions are cached: a failure can be transient when
+  // it is produced mid-import of a cyclic record (before the record is marked
+  // as successfully imported), and must not poison later conversions.
+  if (cacheable) {
+    qual_type_conversion_cache_.insert({cache_key, *type});
+  }
   return type;
 }
 
 std::string Importer::GetMangledName(const clang::NamedDecl* named_decl) const {
+  // Mangling is pure in the decl, so the result is memoized: the same decl is
+  // mangled for its item, for source-order tie-breaking, and again for thunk
+  // naming decisions, and template specializations are expensive to mangle.
+  auto [it, inserted] = mangled_name_cache_.try_emplace(named_decl);
+  if (inserted) {
+    it->second = MangleNameUncached(named_decl);
+  }
+  return it->second;
+}
+
+std::string Importer::MangleNameUncached(
+    const clang::NamedDecl* named_decl) const {
   if (auto record_decl = clang::dyn_cast<clang::RecordDecl>(named_decl)) {
     // Mangled record names are used to 1) provide valid Rust identifiers for
     // C++ template specializations, and 2) help build unique names for virtual
@@ -1017,25 +1274,47 @@ std::string Importer::GetNameForSourceOrder(const clang::Decl* decl) const {
   }
 }
 
+// Translates a C++ identifier spelling into the Rust-side `Identifier`.
+static absl::StatusOr<Identifier> TranslateIdentifier(llvm::StringRef name) {
+  if (name.empty()) {
+    return absl::InvalidArgumentError("Missing identifier");
+  }
+
+  // `r#foo` syntax in Rust can't be used to escape `crate`, `self`,
+  // `super`, not `Self` identifiers - see
+  // https://doc.rust-lang.org/reference/identifiers.html#identifiers
+  if (name == "crate" || name == "self" || name == "super" ||
+      name == "Self") {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unescapable identifier: ", std::string(name)));
+  }
+
+  return Identifier(std::string(name));
+}
+
 absl::StatusOr<UnqualifiedIdentifier> Importer::GetTranslatedName(
     const clang::NamedDecl* named_decl) const {
   switch (named_decl->getDeclName().getNameKind()) {
     case clang::DeclarationName::Identifier: {
-      auto name = std::string(named_decl->getName());
-      if (name.empty()) {
+      // Identifier spellings repeat massively across a TU (`size`, `begin`,
+      // `get`, ...), and Clang already interns them, so the translation is
+      // memoized per `IdentifierInfo`.
+      const clang::IdentifierInfo* identifier_info =
+          named_decl->getDeclName().getAsIdentifierInfo();
+      if (identifier_info == nullptr) {
         return absl::InvalidArgumentError("Missing identifier");
       }
-
-      // `r#foo` syntax in Rust can't be used to escape `crate`, `self`,
-      // `super`, not `Self` identifiers - see
-      // https://doc.rust-lang.org/reference/identifiers.html#identifiers
-      if (name == "crate" || name == "self" || name == "super" ||
-          name == "Self") {
-        return absl::InvalidArgumentError(
-            absl::StrCat("Unescapable identifier: ", name));
+      auto it = translated_identifier_cache_.find(identifier_info);
+      if (it == translated_identifier_cache_.end()) {
+        it = translated_identifier_cache_
+                 .insert({identifier_info,
+                          TranslateIdentifier(identifier_info->getName())})
+                 .first;
       }
-
-      return {Identifier(std::move(name))};
+      if (!it->second.ok()) {
+        return it->second.status();
+      }
+      return {*it->second};
     }
     case clang::DeclarationName::CXXConstructorName:
       return {SpecialName::kConstructor};
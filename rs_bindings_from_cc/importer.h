@@ -62,11 +62,13 @@ class Importer final : public ImportContext {
   IR::Item ImportUnsupportedItem(const clang::Decl* decl,
                                  std::set<std::string> errors) override;
   std::optional<IR::Item> ImportDecl(clang::Decl* decl) override;
-  std::optional<IR::Item> GetImportedItem(const clang::Decl* decl) override;
+  const IR::Item* GetImportedItem(const clang::Decl* decl) override;
   std::vector<ItemId> GetItemIdsInSourceOrder(clang::Decl* decl) override;
   std::string GetMangledName(const clang::NamedDecl* named_decl) const override;
   BazelLabel GetOwningTarget(const clang::Decl* decl) const override;
   bool IsFromCurrentTarget(const clang::Decl* decl) const override;
+  bool IsFullClassTemplateSpecializationOrChild(
+      const clang::Decl* decl) const override;
   absl::StatusOr<UnqualifiedIdentifier> GetTranslatedName(
       const clang::NamedDecl* named_decl) const override;
   absl::StatusOr<Identifier> GetTranslatedIdentifier(
@@ -108,15 +110,30 @@ class Importer final : public ImportContext {
   // Returns a name for `decl` that should be used for ordering declarations.
   std::string GetNameForSourceOrder(const clang::Decl* decl) const;
 
+  // Computes the mangled name of `named_decl`; only called on
+  // `mangled_name_cache_` misses (see `GetMangledName`).
+  std::string MangleNameUncached(const clang::NamedDecl* named_decl) const;
+
   // Returns the item ids of template instantiations that have been triggered
   // from the current target.  The returned items are in an arbitrary,
   // deterministic/reproducible order.
   std::vector<ItemId> GetOrderedItemIdsOfTemplateInstantiations() const;
 
-  std::optional<IR::Item> GetDeclItem(clang::Decl* decl) override;
+  const std::optional<IR::Item>& GetDeclItem(clang::Decl* decl) override;
   // Stores the comments of this target in source order.
   void ImportFreeComments();
 
+  // Returns the comment attached to `decl` (or nullptr), memoizing the
+  // result; see `raw_comment_cache_`.
+  const clang::RawComment* GetAttachedComment(const clang::Decl* decl) const;
+
+  // Returns the owning target of `source_location` by walking up the include
+  // stack for textual headers; the returned reference points into
+  // `file_target_cache_`, so on a cache hit this is a single lookup with no
+  // label copy. Backs both `GetOwningTarget` and `IsFromCurrentTarget`.
+  const BazelLabel& GetOwningTargetForLocation(
+      clang::SourceLocation source_location) const;
+
   absl::StatusOr<MappedType> ConvertType(
       const clang::Type* type,
       std::optional<clang::tidy::lifetimes::ValueLifetimes>& lifetimes,
@@ -130,6 +147,12 @@ class Importer final : public ImportContext {
 
   std::vector<std::unique_ptr<DeclImporter>> decl_importers_;
   std::unique_ptr<clang::MangleContext> mangler_;
+  // All memoization below is deliberately single-threaded: an import is
+  // re-entrant (importers recurse through `GetDeclItem` and force template
+  // instantiations through `Sema`, which mutates the AST), so independent
+  // decl subtrees do not exist to parallelize over, and thread-safe maps
+  // would buy only overhead. See `docs/incremental_bindings_generation.md`
+  // for the same invocation-granularity reasoning.
   absl::flat_hash_map<const clang::Decl*, std::optional<IR::Item>>
       import_cache_;
   absl::flat_hash_set<const clang::ClassTemplateSpecializationDecl*>
@@ -140,6 +163,57 @@ class Importer final : public ImportContext {
   // present in the IR output / that will not produce dangling ItemIds in the IR
   // output).
   absl::flat_hash_set<const clang::TypeDecl*> known_type_decls_;
+
+  // Memoizes lifetime-free `ConvertQualType` conversions, keyed on the
+  // (unelaborated) `clang::QualType` opaque pointer and `nullable`. The same
+  // type is converted at every one of its use sites - e.g. `const
+  // std::string&` parameters across a large header - and conversions never
+  // become invalid within one invocation. Only successful conversions are
+  // cached; see `ConvertQualType` for why.
+  absl::flat_hash_map<std::pair<const void*, bool>, MappedType>
+      qual_type_conversion_cache_;
+
+  // Memoizes `GetMangledName`; mangling is pure in the decl within one
+  // invocation.
+  mutable absl::flat_hash_map<const clang::NamedDecl*, std::string>
+      mangled_name_cache_;
+
+  // Memoizes identifier translation (keyword escaping checks and validation)
+  // per interned `clang::IdentifierInfo`; see `GetTranslatedName`. The cached
+  // `Identifier` is copied out on hits - typical identifier spellings fit the
+  // small-string optimization, so the copy does not allocate.
+  mutable absl::flat_hash_map<const clang::IdentifierInfo*,
+                              absl::StatusOr<Identifier>>
+      translated_identifier_cache_;
+
+  // Memoizes `ASTContext::getRawCommentForDeclNoCache`, which re-runs a
+  // binary search over the file's comments plus the intervening-text
+  // heuristics on every call. Each decl is queried at least twice (once by
+  // `GetComment`, once by the comment bookkeeping in
+  // `GetItemIdsInSourceOrder`); the attachment never changes after parsing.
+  mutable absl::flat_hash_map<const clang::Decl*, const clang::RawComment*>
+      raw_comment_cache_;
+
+  // Memoizes the owning target of each file (keyed on
+  // `clang::FileID::getHashValue`), including the files visited while walking
+  // up the include stack for textual headers; see `GetOwningTarget`.
+  mutable absl::flat_hash_map<unsigned, BazelLabel> file_target_cache_;
+
+  // Memoizes `GetItemIdsInSourceOrder`: collecting the ordered child list
+  // imports every child and sorts by source order, and the result never
+  // changes once computed (child decls are fixed and imports are cached).
+  // Keyed on the specific parent decl, not its canonical decl: every reopened
+  // block of a namespace is its own `DeclContext`, and each `Namespace` item
+  // must list only the children of its own block.
+  absl::flat_hash_map<const clang::Decl*, std::vector<ItemId>>
+      item_ids_in_source_order_cache_;
+
+  // Memoizes, per `DeclContext`, whether the context lives inside a full class
+  // template specialization; see `IsFullClassTemplateSpecializationOrChild`.
+  // Every contained decl asks the same question about its context, so the
+  // ancestry walk is performed once per context instead of once per decl.
+  mutable absl::flat_hash_map<const clang::DeclContext*, bool>
+      template_specialization_ancestry_cache_;
 };  // class Importer
 
 }  // namespace crubit
@@ -283,6 +283,8 @@ std::optional<IR::Item> CXXRecordDeclImporter::Import(
   bool is_effectively_final = record_decl->isEffectivelyFinal() ||
                               record_decl->isUnion() ||
                               FinalOverrides().contains(preferred_cc_name);
+  SpecialMemberFuncs special_member_funcs =
+      ictx_.GetSpecialMemberFuncs(record_decl);
   auto item_ids = ictx_.GetItemIdsInSourceOrder(record_decl);
   const clang::TypedefNameDecl* anon_typedef =
       record_decl->getTypedefNameForAnonDecl();
@@ -301,9 +303,9 @@ std::optional<IR::Item> CXXRecordDeclImporter::Import(
       .alignment = layout.getAlignment().getQuantity(),
       .is_derived_class = is_derived_class,
       .override_alignment = override_alignment,
-      .copy_constructor = GetCopyCtorSpecialMemberFunc(*record_decl),
-      .move_constructor = GetMoveCtorSpecialMemberFunc(*record_decl),
-      .destructor = GetDestructorSpecialMemberFunc(*record_decl),
+      .copy_constructor = special_member_funcs.copy_constructor,
+      .move_constructor = special_member_funcs.move_constructor,
+      .destructor = special_member_funcs.destructor,
       .is_trivial_abi = record_decl->canPassInRegisters(),
       .is_inheritable = !is_effectively_final,
       .is_abstract = record_decl->isAbstract(),
@@ -387,9 +389,8 @@ std::vector<Field> CXXRecordDeclImporter::ImportFields(
     if (field_record) {
       // If it is a record as a direct member, its item must be already
       // imported.
-      auto item = ictx_.GetImportedItem(field_record);
-      if (item.has_value()) {
-        if (const auto* record = std::get_if<Record>(&item.value())) {
+      if (const IR::Item* item = ictx_.GetImportedItem(field_record)) {
+        if (const auto* record = std::get_if<Record>(item)) {
           is_inheritable = record->is_inheritable;
         }
       }
@@ -4,6 +4,8 @@
 
 #include "rs_bindings_from_cc/importers/enum.h"
 
+#include "llvm/ADT/APSInt.h"
+
 namespace crubit {
 
 std::optional<IR::Item> EnumDeclImporter::Import(clang::EnumDecl* enum_decl) {
@@ -54,9 +56,19 @@ std::optional<IR::Item> EnumDeclImporter::Import(clang::EnumDecl* enum_decl) {
                                   enumerator_name.status().message()));
     }
 
+    const llvm::APSInt& init_val = enumerator->getInitVal();
+    if (init_val.getSignificantBits() > 64) {
+      // `IntegerConstant` can only represent values in [-2**63, 2**64);
+      // larger enumerators (e.g. with an `__int128` underlying type) must not
+      // take down the whole invocation.
+      return ictx_.ImportUnsupportedItem(
+          enum_decl,
+          "Enumerator values that are wider than 64 bits are not supported");
+    }
+
     enumerators.push_back(Enumerator{
         .identifier = *enumerator_name,
-        .value = IntegerConstant(enumerator->getInitVal()),
+        .value = IntegerConstant(init_val),
     });
   }
 
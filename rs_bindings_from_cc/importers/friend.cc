@@ -44,10 +44,14 @@ std::optional<IR::Item> FriendDeclImporter::Import(
   // function (typically, an overloaded operator) that is defined entirely
   // within a class or class template, even if it was never declared at
   // namespace level."
-  std::optional<IR::Item> item = ictx_.ImportDecl(named_decl);
+  // Go through the import cache: the same function is commonly befriended by
+  // many records (and redeclared at namespace scope), and the underlying
+  // import only has to happen once per canonical decl. The cached item is
+  // copied below before any further import can touch the cache.
+  const std::optional<IR::Item>& item = ictx_.GetDeclItem(named_decl);
   if (!item.has_value()) return std::nullopt;
   if (std::holds_alternative<UnsupportedItem>(*item)) return std::nullopt;
-  Func* func_item = std::get_if<Func>(&*item);
+  const Func* func_item = std::get_if<Func>(&*item);
   CHECK(func_item);  // Guaranteed by `isa<clang::FunctionDecl>` above.
   // Return the recursively generated function item almost as-is. It needs a
   // fresh item ID because it came from this friend_decl. And it needs an ADL
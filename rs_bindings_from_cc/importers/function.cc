@@ -7,7 +7,6 @@
 #include <optional>
 
 #include "absl/strings/substitute.h"
-#include "rs_bindings_from_cc/ast_util.h"
 #include "clang/Sema/Sema.h"
 #include "llvm/ADT/StringRef.h"
 
@@ -83,6 +82,17 @@ std::optional<IR::Item> FunctionDeclImporter::Import(
     }
   }
 
+  absl::StatusOr<UnqualifiedIdentifier> translated_name =
+      ictx_.GetTranslatedName(function_decl);
+  if (!translated_name.ok()) {
+    return ictx_.ImportUnsupportedItem(
+        function_decl, absl::StrCat("Function name is not supported: ",
+                                    translated_name.status().message()));
+  }
+
+  // Lifetime analysis is the most expensive per-overload step, so it runs
+  // only after all the cheap rejections above.
+  //
   // TODO(lukasza, mboehme): Consider changing the GetLifetimeAnnotations API to
   // distinguish 1) no lifetime annotations found vs 2) erroneous lifetime
   // annotations found.  This will allow avoiding the call to
@@ -93,14 +103,6 @@ std::optional<IR::Item> FunctionDeclImporter::Import(
           function_decl, *ictx_.invocation_.lifetime_context_,
           &lifetime_symbol_table));
 
-  absl::StatusOr<UnqualifiedIdentifier> translated_name =
-      ictx_.GetTranslatedName(function_decl);
-  if (!translated_name.ok()) {
-    return ictx_.ImportUnsupportedItem(
-        function_decl, absl::StrCat("Function name is not supported: ",
-                                    translated_name.status().message()));
-  }
-
   std::vector<FuncParam> params;
   std::set<std::string> errors;
   auto add_error = [&errors](std::string msg) {
@@ -229,7 +231,7 @@ std::optional<IR::Item> FunctionDeclImporter::Import(
       function_decl->getType()->getAs<clang::FunctionType>()->getCallConv() ==
       clang::CC_C;
   bool is_member_or_descendant_of_class_template =
-      IsFullClassTemplateSpecializationOrChild(function_decl);
+      ictx_.IsFullClassTemplateSpecializationOrChild(function_decl);
 
   std::optional<std::string> doc_comment = ictx_.GetComment(function_decl);
   if (!doc_comment.has_value() && is_member_or_descendant_of_class_template) {
@@ -7,9 +7,11 @@
 #include <optional>
 
 #include "absl/log/check.h"
+#include "absl/strings/string_view.h"
 #include "rs_bindings_from_cc/known_types_map.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
+#include "llvm/ADT/StringRef.h"
 
 namespace crubit {
 
@@ -37,7 +39,14 @@ std::optional<IR::Item> crubit::TypedefNameDeclImporter::Import(
     // into their item, instead of having a separate TypeAlias item in addition.
     return std::nullopt;
   }
-  if (MapKnownCcTypeToRsType(type.getAsString()).has_value()) {
+  // Aliases to well-known types (e.g. `std::size_t`) map directly to Rust
+  // primitives and produce no TypeAlias item. Printing the type allocates a
+  // string per alias, so only print when the unqualified name is itself a
+  // well-known spelling - every qualified entry in the table ends in one.
+  llvm::StringRef name = typedef_name_decl->getName();
+  if (MapKnownCcTypeToRsType(absl::string_view(name.data(), name.size()))
+          .has_value() &&
+      MapKnownCcTypeToRsType(type.getAsString()).has_value()) {
     return std::nullopt;
   }
 
@@ -6,6 +6,7 @@
 
 #include <stdint.h>
 
+#include <limits>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -13,14 +14,102 @@
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "common/strong_int.h"
 #include "rs_bindings_from_cc/bazel_types.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Compression.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 
 namespace crubit {
 
+namespace internal {
+std::atomic<bool> stable_item_ids_enabled{false};
+std::atomic<bool> doc_comments_disabled{false};
+}  // namespace internal
+
+void EnableStableItemIds() {
+  internal::stable_item_ids_enabled.store(true, std::memory_order_relaxed);
+}
+
+void DisableDocComments() {
+  internal::doc_comments_disabled.store(true, std::memory_order_relaxed);
+}
+
+namespace {
+
+// Guards the decl-to-id memoization below. Imports are single-threaded
+// today, but the cache is process-wide state, so it is locked like the other
+// process-wide caches in this tool.
+absl::Mutex& StableItemIdMutex() {
+  static absl::Mutex& mutex = *new absl::Mutex;
+  return mutex;
+}
+
+absl::flat_hash_map<const clang::Decl*, ItemId>& StableItemIdCache() {
+  static auto& cache = *new absl::flat_hash_map<const clang::Decl*, ItemId>;
+  return cache;
+}
+
+}  // namespace
+
+ItemId StableItemIdForDecl(const clang::Decl* decl) {
+  // Mirrors the pointer-mode keying in `GenerateItemId`: one id per canonical
+  // decl, but one id per *redecl* for namespaces, since every reopening of a
+  // namespace is a separate IR item.
+  const clang::Decl* key = clang::isa<clang::NamespaceDecl>(decl)
+                               ? decl
+                               : decl->getCanonicalDecl();
+  {
+    absl::MutexLock lock(&StableItemIdMutex());
+    if (auto it = StableItemIdCache().find(key);
+        it != StableItemIdCache().end()) {
+      return it->second;
+    }
+  }
+
+  ItemId id(reinterpret_cast<uintptr_t>(key));
+  llvm::SmallString<128> hash_input;
+  if (!clang::index::generateUSRForDecl(key, hash_input)) {
+    if (const auto* namespace_decl = clang::dyn_cast<clang::NamespaceDecl>(key);
+        namespace_decl != nullptr) {
+      // All redecls of a namespace share one USR; disambiguate them by where
+      // this reopening is spelled.
+      clang::PresumedLoc loc =
+          namespace_decl->getASTContext().getSourceManager().getPresumedLoc(
+              namespace_decl->getLocation());
+      if (loc.isValid()) {
+        llvm::raw_svector_ostream(hash_input)
+            << '@' << loc.getFilename() << ':' << loc.getLine() << ':'
+            << loc.getColumn();
+      }
+    }
+    id = ItemId(llvm::xxHash64(hash_input));
+  }
+  // else: Clang cannot produce a USR for this decl (`generateUSRForDecl`
+  // returns true on failure); keep the pointer-derived id, which is unique
+  // within this process but not spliceable across processes.
+
+  absl::MutexLock lock(&StableItemIdMutex());
+  return StableItemIdCache().insert({key, id}).first->second;
+}
+
+void ClearStableItemIdCache() {
+  absl::MutexLock lock(&StableItemIdMutex());
+  StableItemIdCache().clear();
+}
+
 template <class T>
 llvm::json::Value toJSON(const T& t) {
   return t.ToJson();
@@ -58,23 +147,37 @@ llvm::json::Value LifetimeName::ToJson() const {
 }
 
 llvm::json::Value RsType::ToJson() const {
-  return llvm::json::Object{
-      {"name", decl_id.has_value() ? llvm::json::Value(nullptr)
-                                   : llvm::json::Value(name)},
-      {"lifetime_args", lifetime_args},
-      {"type_args", type_args},
-      {"decl_id", decl_id},
-  };
+  // Fields at their default values are omitted from the wire format; the
+  // deserializer in ir.rs fills them back in via serde defaults.
+  llvm::json::Object result;
+  if (decl_id.has_value()) {
+    result["decl_id"] = *decl_id;
+  } else {
+    result["name"] = name;
+  }
+  if (!lifetime_args.empty()) {
+    result["lifetime_args"] = lifetime_args;
+  }
+  if (!type_args.empty()) {
+    result["type_args"] = type_args;
+  }
+  return std::move(result);
 }
 
 llvm::json::Value CcType::ToJson() const {
-  return llvm::json::Object{
-      {"name", decl_id.has_value() ? llvm::json::Value(nullptr)
-                                   : llvm::json::Value(name)},
-      {"is_const", is_const},
-      {"type_args", type_args},
-      {"decl_id", decl_id},
-  };
+  llvm::json::Object result;
+  if (decl_id.has_value()) {
+    result["decl_id"] = *decl_id;
+  } else {
+    result["name"] = name;
+  }
+  if (is_const) {
+    result["is_const"] = is_const;
+  }
+  if (!type_args.empty()) {
+    result["type_args"] = type_args;
+  }
+  return std::move(result);
 }
 
 namespace {
@@ -279,10 +382,13 @@ llvm::json::Value MemberFuncMetadata::InstanceMethodMetadata::ToJson() const {
 }
 
 llvm::json::Value MemberFuncMetadata::ToJson() const {
-  return llvm::json::Object{
+  llvm::json::Object result{
       {"record_id", record_id},
-      {"instance_method_metadata", instance_method_metadata},
   };
+  if (instance_method_metadata.has_value()) {
+    result["instance_method_metadata"] = *instance_method_metadata;
+  }
+  return std::move(result);
 }
 
 llvm::json::Value UseMod::ToJson() const {
@@ -301,21 +407,39 @@ llvm::json::Value Func::ToJson() const {
   llvm::json::Object func{
       {"name", name},
       {"owning_target", owning_target},
-      {"doc_comment", doc_comment},
       {"mangled_name", mangled_name},
       {"return_type", return_type},
-      {"params", params},
-      {"lifetime_params", lifetime_params},
-      {"is_inline", is_inline},
-      {"member_func_metadata", member_func_metadata},
-      {"has_c_calling_convention", has_c_calling_convention},
-      {"is_member_or_descendant_of_class_template",
-       is_member_or_descendant_of_class_template},
       {"source_loc", source_loc},
       {"id", id},
-      {"enclosing_namespace_id", enclosing_namespace_id},
-      {"adl_enclosing_record", adl_enclosing_record},
   };
+  if (doc_comment.has_value()) {
+    func["doc_comment"] = *doc_comment;
+  }
+  if (!params.empty()) {
+    func["params"] = params;
+  }
+  if (!lifetime_params.empty()) {
+    func["lifetime_params"] = lifetime_params;
+  }
+  if (is_inline) {
+    func["is_inline"] = is_inline;
+  }
+  if (member_func_metadata.has_value()) {
+    func["member_func_metadata"] = *member_func_metadata;
+  }
+  if (!has_c_calling_convention) {
+    func["has_c_calling_convention"] = has_c_calling_convention;
+  }
+  if (is_member_or_descendant_of_class_template) {
+    func["is_member_or_descendant_of_class_template"] =
+        is_member_or_descendant_of_class_template;
+  }
+  if (enclosing_namespace_id.has_value()) {
+    func["enclosing_namespace_id"] = *enclosing_namespace_id;
+  }
+  if (adl_enclosing_record.has_value()) {
+    func["adl_enclosing_record"] = *adl_enclosing_record;
+  }
 
   return llvm::json::Object{
       {"Func", std::move(func)},
@@ -338,17 +462,28 @@ std::ostream& operator<<(std::ostream& o, const AccessSpecifier& access) {
 }
 
 llvm::json::Value Field::ToJson() const {
-  return llvm::json::Object{
-      {"identifier", identifier},
-      {"doc_comment", doc_comment},
+  llvm::json::Object result{
       {"type", type},
       {"access", AccessToString(access)},
       {"offset", offset},
       {"size", size},
-      {"is_no_unique_address", is_no_unique_address},
-      {"is_bitfield", is_bitfield},
-      {"is_inheritable", is_inheritable},
   };
+  if (identifier.has_value()) {
+    result["identifier"] = *identifier;
+  }
+  if (doc_comment.has_value()) {
+    result["doc_comment"] = *doc_comment;
+  }
+  if (is_no_unique_address) {
+    result["is_no_unique_address"] = is_no_unique_address;
+  }
+  if (is_bitfield) {
+    result["is_bitfield"] = is_bitfield;
+  }
+  if (is_inheritable) {
+    result["is_inheritable"] = is_inheritable;
+  }
+  return std::move(result);
 }
 
 llvm::json::Value toJSON(const SpecialMemberFunc& f) {
@@ -365,10 +500,13 @@ llvm::json::Value toJSON(const SpecialMemberFunc& f) {
 }
 
 llvm::json::Value BaseClass::ToJson() const {
-  return llvm::json::Object{
+  llvm::json::Object result{
       {"base_record_id", base_record_id},
-      {"offset", offset},
   };
+  if (offset.has_value()) {
+    result["offset"] = *offset;
+  }
+  return std::move(result);
 }
 
 static std::string RecordTypeToString(RecordType record_type) {
@@ -393,8 +531,10 @@ llvm::json::Value IncompleteRecord::ToJson() const {
       {"id", id},
       {"owning_target", owning_target},
       {"record_type", RecordTypeToString(record_type)},
-      {"enclosing_namespace_id", enclosing_namespace_id},
   };
+  if (enclosing_namespace_id.has_value()) {
+    record["enclosing_namespace_id"] = *enclosing_namespace_id;
+  }
 
   return llvm::json::Object{
       {"IncompleteRecord", std::move(record)},
@@ -402,40 +542,65 @@ llvm::json::Value IncompleteRecord::ToJson() const {
 }
 
 llvm::json::Value Record::ToJson() const {
-  std::vector<llvm::json::Value> json_item_ids;
-  json_item_ids.reserve(child_item_ids.size());
-  for (const auto& id : child_item_ids) {
-    json_item_ids.push_back(id.value());
-  }
-
   llvm::json::Object record{
       {"rs_name", rs_name},
       {"cc_name", cc_name},
       {"mangled_cc_name", mangled_cc_name},
       {"id", id},
       {"owning_target", owning_target},
-      {"doc_comment", doc_comment},
       {"source_loc", source_loc},
-      {"unambiguous_public_bases", unambiguous_public_bases},
-      {"fields", fields},
-      {"lifetime_params", lifetime_params},
       {"size", size},
       {"original_cc_size", original_cc_size},
       {"alignment", alignment},
-      {"is_derived_class", is_derived_class},
-      {"override_alignment", override_alignment},
       {"copy_constructor", copy_constructor},
       {"move_constructor", move_constructor},
       {"destructor", destructor},
-      {"is_trivial_abi", is_trivial_abi},
-      {"is_inheritable", is_inheritable},
-      {"is_abstract", is_abstract},
       {"record_type", RecordTypeToString(record_type)},
-      {"is_aggregate", is_aggregate},
-      {"is_anon_record_with_typedef", is_anon_record_with_typedef},
-      {"child_item_ids", std::move(json_item_ids)},
-      {"enclosing_namespace_id", enclosing_namespace_id},
   };
+  if (doc_comment.has_value()) {
+    record["doc_comment"] = *doc_comment;
+  }
+  if (!unambiguous_public_bases.empty()) {
+    record["unambiguous_public_bases"] = unambiguous_public_bases;
+  }
+  if (!fields.empty()) {
+    record["fields"] = fields;
+  }
+  if (!lifetime_params.empty()) {
+    record["lifetime_params"] = lifetime_params;
+  }
+  if (is_derived_class) {
+    record["is_derived_class"] = is_derived_class;
+  }
+  if (override_alignment) {
+    record["override_alignment"] = override_alignment;
+  }
+  if (is_trivial_abi) {
+    record["is_trivial_abi"] = is_trivial_abi;
+  }
+  if (is_inheritable) {
+    record["is_inheritable"] = is_inheritable;
+  }
+  if (is_abstract) {
+    record["is_abstract"] = is_abstract;
+  }
+  if (is_aggregate) {
+    record["is_aggregate"] = is_aggregate;
+  }
+  if (is_anon_record_with_typedef) {
+    record["is_anon_record_with_typedef"] = is_anon_record_with_typedef;
+  }
+  if (!child_item_ids.empty()) {
+    std::vector<llvm::json::Value> json_item_ids;
+    json_item_ids.reserve(child_item_ids.size());
+    for (const auto& id : child_item_ids) {
+      json_item_ids.push_back(id.value());
+    }
+    record["child_item_ids"] = std::move(json_item_ids);
+  }
+  if (enclosing_namespace_id.has_value()) {
+    record["enclosing_namespace_id"] = *enclosing_namespace_id;
+  }
 
   return llvm::json::Object{
       {"Record", std::move(record)},
@@ -456,9 +621,13 @@ llvm::json::Value Enum::ToJson() const {
       {"owning_target", owning_target},
       {"source_loc", source_loc},
       {"underlying_type", underlying_type},
-      {"enumerators", enumerators},
-      {"enclosing_namespace_id", enclosing_namespace_id},
   };
+  if (!enumerators.empty()) {
+    enum_ir["enumerators"] = enumerators;
+  }
+  if (enclosing_namespace_id.has_value()) {
+    enum_ir["enclosing_namespace_id"] = *enclosing_namespace_id;
+  }
 
   return llvm::json::Object{
       {"Enum", std::move(enum_ir)},
@@ -470,12 +639,18 @@ llvm::json::Value TypeAlias::ToJson() const {
       {"identifier", identifier},
       {"id", id},
       {"owning_target", owning_target},
-      {"doc_comment", doc_comment},
       {"underlying_type", underlying_type},
       {"source_loc", source_loc},
-      {"enclosing_record_id", enclosing_record_id},
-      {"enclosing_namespace_id", enclosing_namespace_id},
   };
+  if (doc_comment.has_value()) {
+    type_alias["doc_comment"] = *doc_comment;
+  }
+  if (enclosing_record_id.has_value()) {
+    type_alias["enclosing_record_id"] = *enclosing_record_id;
+  }
+  if (enclosing_namespace_id.has_value()) {
+    type_alias["enclosing_namespace_id"] = *enclosing_namespace_id;
+  }
 
   return llvm::json::Object{
       {"TypeAlias", std::move(type_alias)},
@@ -507,21 +682,26 @@ llvm::json::Value Comment::ToJson() const {
 }
 
 llvm::json::Value Namespace::ToJson() const {
-  std::vector<llvm::json::Value> json_item_ids;
-  json_item_ids.reserve(child_item_ids.size());
-  for (const auto& id : child_item_ids) {
-    json_item_ids.push_back(id.value());
-  }
-
   llvm::json::Object ns{
       {"name", name},
       {"id", id},
       {"canonical_namespace_id", canonical_namespace_id},
       {"owning_target", owning_target},
-      {"child_item_ids", std::move(json_item_ids)},
-      {"enclosing_namespace_id", enclosing_namespace_id},
-      {"is_inline", is_inline},
   };
+  if (!child_item_ids.empty()) {
+    std::vector<llvm::json::Value> json_item_ids;
+    json_item_ids.reserve(child_item_ids.size());
+    for (const auto& id : child_item_ids) {
+      json_item_ids.push_back(id.value());
+    }
+    ns["child_item_ids"] = std::move(json_item_ids);
+  }
+  if (enclosing_namespace_id.has_value()) {
+    ns["enclosing_namespace_id"] = *enclosing_namespace_id;
+  }
+  if (is_inline) {
+    ns["is_inline"] = is_inline;
+  }
 
   return llvm::json::Object{
       {"Namespace", std::move(ns)},
@@ -554,6 +734,165 @@ llvm::json::Value IR::ToJson() const {
   return std::move(result);
 }
 
+void IR::BuildItemKindIndex() const {
+  item_kind_index_cache_.assign(std::variant_size_v<Item>,
+                                std::vector<size_t>());
+  for (size_t idx = 0; idx < items.size(); ++idx) {
+    item_kind_index_cache_[items[idx].index()].push_back(idx);
+  }
+  item_kind_index_items_size_ = items.size();
+}
+
+const IR::Item* IR::FindItemById(ItemId id) const {
+  // `items` only ever grows, so a size mismatch is a reliable staleness
+  // signal for the cached index.
+  if (item_id_to_item_idx_cache_.size() != items.size()) {
+    item_id_to_item_idx_cache_.clear();
+    item_id_to_item_idx_cache_.reserve(items.size());
+    for (size_t idx = 0; idx < items.size(); ++idx) {
+      std::visit(
+          [&](auto&& item) { item_id_to_item_idx_cache_.insert({item.id, idx}); },
+          items[idx]);
+    }
+  }
+  auto it = item_id_to_item_idx_cache_.find(id);
+  if (it == item_id_to_item_idx_cache_.end()) return nullptr;
+  return &items[it->second];
+}
+
+std::string IrToJson(const IR& ir, int indent) {
+  std::string result;
+  llvm::raw_string_ostream stream(result);
+  llvm::json::OStream json(stream, indent);
+  json.object([&] {
+    json.attributeArray("public_headers", [&] {
+      for (const HeaderName& header : ir.public_headers) {
+        json.value(header.ToJson());
+      }
+    });
+    json.attribute("current_target", toJSON(ir.current_target));
+    json.attributeArray("items", [&] {
+      for (const auto& item : ir.items) {
+        std::visit([&](auto&& item) { json.value(item.ToJson()); }, item);
+      }
+    });
+    json.attributeArray("top_level_item_ids", [&] {
+      for (const ItemId& id : ir.top_level_item_ids) {
+        json.value(id.value());
+      }
+    });
+    if (!ir.crate_root_path.empty()) {
+      json.attribute("crate_root_path", ir.crate_root_path);
+    }
+  });
+  stream.flush();
+  return result;
+}
+
+namespace {
+
+// Magic number and version of the binary IR format.
+// LINT.IfChange
+constexpr absl::string_view kBinaryIrMagic = "CRIR";
+constexpr uint32_t kBinaryIrVersion = 1;
+// LINT.ThenChange(//depot/rs_bindings_from_cc/ir.rs)
+
+// Magic number of the zstd transport compression for IR artifacts.
+// LINT.IfChange
+constexpr absl::string_view kCompressedIrMagic = "CRZ1";
+// LINT.ThenChange(//depot/rs_bindings_from_cc/ir.rs)
+
+void AppendLittleEndianU32(std::string& out, uint32_t value) {
+  char bytes[sizeof(uint32_t)];
+  llvm::support::endian::write32le(bytes, value);
+  out.append(bytes, sizeof(bytes));
+}
+
+// Appends a length-prefixed frame containing the serialization of `value`.
+// The payload is printed straight into `out`; the length prefix is patched in
+// afterwards so that no intermediate string is needed.
+void AppendFrame(std::string& out, const llvm::json::Value& value) {
+  size_t prefix_offset = out.size();
+  AppendLittleEndianU32(out, 0);
+  llvm::raw_string_ostream stream(out);
+  stream << value;
+  stream.flush();
+  size_t payload_size = out.size() - prefix_offset - sizeof(uint32_t);
+  CHECK_LE(payload_size, std::numeric_limits<uint32_t>::max());
+  llvm::support::endian::write32le(&out[prefix_offset],
+                                   static_cast<uint32_t>(payload_size));
+}
+
+}  // namespace
+
+std::string IrToBinary(const IR& ir) {
+  std::string result;
+  result.append(kBinaryIrMagic.data(), kBinaryIrMagic.size());
+  AppendLittleEndianU32(result, kBinaryIrVersion);
+
+  std::vector<llvm::json::Value> top_level_ids;
+  top_level_ids.reserve(ir.top_level_item_ids.size());
+  for (const auto& id : ir.top_level_item_ids) {
+    top_level_ids.push_back(id.value());
+  }
+  llvm::json::Object envelope{
+      {"public_headers", ir.public_headers},
+      {"current_target", ir.current_target},
+      {"top_level_item_ids", std::move(top_level_ids)},
+  };
+  if (!ir.crate_root_path.empty()) {
+    envelope["crate_root_path"] = ir.crate_root_path;
+  }
+  AppendFrame(result, std::move(envelope));
+
+  CHECK_LE(ir.items.size(), std::numeric_limits<uint32_t>::max());
+  AppendLittleEndianU32(result, static_cast<uint32_t>(ir.items.size()));
+
+  // Items are immutable and independent at this point, so big IRs are
+  // serialized shard-per-item on the default executor and concatenated; the
+  // frame format makes the concatenation byte-identical to sequential output.
+  // Small IRs stay on one thread to avoid the fork/join overhead.
+  constexpr size_t kParallelSerializationThreshold = 1024;
+  if (ir.items.size() >= kParallelSerializationThreshold) {
+    std::vector<std::string> item_buffers(ir.items.size());
+    llvm::parallelFor(0, ir.items.size(), [&](size_t idx) {
+      std::visit(
+          [&](auto&& item) { AppendFrame(item_buffers[idx], item.ToJson()); },
+          ir.items[idx]);
+    });
+    for (const std::string& buffer : item_buffers) {
+      result += buffer;
+    }
+  } else {
+    for (const auto& item : ir.items) {
+      std::visit([&](auto&& item) { AppendFrame(result, item.ToJson()); },
+                 item);
+    }
+  }
+  return result;
+}
+
+std::string CompressIrPayload(absl::string_view ir_payload) {
+  if (!llvm::compression::zstd::isAvailable()) {
+    return std::string(ir_payload);
+  }
+  llvm::SmallVector<uint8_t, 0> compressed;
+  llvm::compression::zstd::compress(
+      llvm::ArrayRef<uint8_t>(
+          reinterpret_cast<const uint8_t*>(ir_payload.data()),
+          ir_payload.size()),
+      compressed);
+  std::string result;
+  result.reserve(kCompressedIrMagic.size() + sizeof(uint64_t) +
+                 compressed.size());
+  result.append(kCompressedIrMagic.data(), kCompressedIrMagic.size());
+  char size_bytes[sizeof(uint64_t)];
+  llvm::support::endian::write64le(size_bytes, ir_payload.size());
+  result.append(size_bytes, sizeof(size_bytes));
+  result.append(compressed.begin(), compressed.end());
+  return result;
+}
+
 std::string ItemToString(const IR::Item& item) {
   return std::visit(
       [&](auto&& item) { return llvm::formatv("{0}", item.ToJson()); }, item);
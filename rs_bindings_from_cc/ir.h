@@ -13,15 +13,19 @@
 
 #include <stdint.h>
 
+#include <atomic>
 #include <cstddef>
 #include <iomanip>
 #include <optional>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -63,9 +67,16 @@ inline constexpr int kJsonIndent = 2;
 }  // namespace internal
 
 // A name of a public header of the C++ library.
+//
+// Header names are the keys of `headers_to_targets`, which is consulted on the
+// per-decl import path (see `Invocation::header_target`), so - like
+// `BazelLabel` - they cache their hash at construction. Hashing and equality
+// then never re-walk the pathname: `AbslHashValue` mixes the cached hash, and
+// `operator==` compares it before falling back to the strings.
 class HeaderName {
  public:
-  explicit HeaderName(std::string name) : name_(std::move(name)) {}
+  explicit HeaderName(std::string name)
+      : name_(std::move(name)), hash_(absl::HashOf(name_)) {}
 
   absl::string_view IncludePath() const { return name_; }
 
@@ -73,19 +84,21 @@ class HeaderName {
 
   template <typename H>
   friend H AbslHashValue(H h, const HeaderName& header_name) {
-    return H::combine(std::move(h), header_name.name_);
+    return H::combine(std::move(h), header_name.hash_);
+  }
+
+  friend bool operator==(const HeaderName& lhs, const HeaderName& rhs) {
+    return lhs.hash_ == rhs.hash_ && lhs.name_ == rhs.name_;
   }
 
  private:
   // Header pathname in the format suitable for a google3-relative quote
   // include.
   std::string name_;
+  // `absl::HashOf(name_)`, cached.
+  size_t hash_;
 };
 
-inline bool operator==(const HeaderName& lhs, const HeaderName& rhs) {
-  return lhs.IncludePath() == rhs.IncludePath();
-}
-
 inline std::ostream& operator<<(std::ostream& o, const HeaderName& h) {
   return o << std::string(llvm::formatv("{0:2}", h.ToJson()));
 }
@@ -97,17 +110,76 @@ inline std::ostream& operator<<(std::ostream& o, const HeaderName& h) {
 //  We use ItemIds for this.
 CRUBIT_DEFINE_STRONG_INT_TYPE(ItemId, uintptr_t);
 
+namespace internal {
+// Set (at most once, at startup) by `EnableStableItemIds`; read on every
+// `GenerateItemId` call, hence the inline relaxed load.
+extern std::atomic<bool> stable_item_ids_enabled;
+}  // namespace internal
+
+// Switches `GenerateItemId` from pointer-derived ids to ids hashed from the
+// decl's USR (see `StableItemIdForDecl`). Pointer-derived ids are free but
+// differ from run to run; stable ids let IR fragments produced by different
+// processes (shards, caches, incremental re-imports) be keyed and spliced
+// together. Process-wide and one-way, like `EnableTimingCollection`.
+void EnableStableItemIds();
+
+inline bool StableItemIdsEnabled() {
+  return internal::stable_item_ids_enabled.load(std::memory_order_relaxed);
+}
+
+namespace internal {
+// Set (at most once, at startup) by `DisableDocComments`.
+extern std::atomic<bool> doc_comments_disabled;
+}  // namespace internal
+
+// Disables importing comments altogether: attached doc comments stay out of
+// the imported items and free-standing comments are not collected, so neither
+// the IR nor the generated sources carry docs. Doc-heavy targets spend a
+// measurable share of the import formatting comment text they may not need.
+// Process-wide and one-way, like `EnableStableItemIds`.
+void DisableDocComments();
+
+inline bool DocCommentsDisabled() {
+  return internal::doc_comments_disabled.load(std::memory_order_relaxed);
+}
+
+// The stable-mode implementation of `GenerateItemId`: a hash of the decl's
+// USR, memoized per decl pointer. Reopened namespaces share one USR but are
+// distinct items, so namespace ids additionally hash the redecl's source
+// location. Decls for which Clang cannot produce a USR fall back to the
+// pointer-derived id (and thus stay process-local).
+ItemId StableItemIdForDecl(const clang::Decl* decl);
+
+// Drops the memoized stable ids. Must be called whenever a new AST is
+// created in this process (see `AstConsumer::HandleTranslationUnit`): decl
+// pointers from a destroyed AST may be reused by the next one.
+void ClearStableItemIdCache();
+
 inline ItemId GenerateItemId(const clang::Decl* decl) {
+  if (StableItemIdsEnabled()) {
+    return StableItemIdForDecl(decl);
+  }
   if (auto namespace_decl = clang::dyn_cast<clang::NamespaceDecl>(decl)) {
     return ItemId(reinterpret_cast<uintptr_t>(namespace_decl));
   }
   return ItemId(reinterpret_cast<uintptr_t>(decl->getCanonicalDecl()));
 }
 
+// Comments have no USR, so their ids stay pointer-derived even in stable-id
+// mode; they are target-local and never referenced across IR fragments.
 inline ItemId GenerateItemId(const clang::RawComment* comment) {
   return ItemId(reinterpret_cast<uintptr_t>(comment));
 }
 
+// Hash containers keyed on `ItemId`. Item ids are minted from pointers (see
+// `GenerateItemId`), so their values are already well distributed and the
+// cheap transparent value hash from strong_int.h applies.
+template <typename V>
+using ItemIdMap = absl::flat_hash_map<ItemId, V, StrongIntValueHash<ItemId>,
+                                      StrongIntValueEq<ItemId>>;
+using ItemIdSet = absl::flat_hash_set<ItemId, StrongIntValueHash<ItemId>,
+                                      StrongIntValueEq<ItemId>>;
+
 // Returns the ID of the parent namespace, if such exists, and `std::nullopt`
 // for top level decls. We use this function to assign a parent namespace to all
 // the IR items.
@@ -322,7 +394,10 @@ class IntegerConstant {
  public:
   explicit IntegerConstant(const llvm::APSInt& value) {
     CHECK_LE(value.getSignificantBits(), 64);
-    is_negative_ = value < 0;
+    // `isNegative` reads the sign bit directly instead of materializing an
+    // `APSInt` temporary for a comparison; enum-heavy headers construct one
+    // `IntegerConstant` per enumerator.
+    is_negative_ = value.isNegative();
     // TODO: double-check that the following is correct to adapt for
     // https://github.com/llvm/llvm-project/commit/0a89825a289d149195be390003424adad026067f
     // Before:
@@ -750,19 +825,63 @@ inline std::ostream& operator<<(std::ostream& o, const UseMod& use_mod) {
 // A complete intermediate representation of bindings for publicly accessible
 // declarations of a single C++ library.
 struct IR {
+  using Item = std::variant<Func, Record, IncompleteRecord, Enum, TypeAlias,
+                            UnsupportedItem, Comment, Namespace, UseMod>;
+
   llvm::json::Value ToJson() const;
 
+  // Index of alternative `T` within the `Item` variant.
+  template <typename T, typename... Alternatives>
+  static constexpr size_t AlternativeIndex(
+      const std::variant<Alternatives...>*) {
+    constexpr bool matches[] = {std::is_same_v<T, Alternatives>...};
+    for (size_t index = 0; index < sizeof...(Alternatives); ++index) {
+      if (matches[index]) return index;
+    }
+    return sizeof...(Alternatives);
+  }
+
+  // Returns pointers to all items holding alternative `T`, in `items` order.
+  //
+  // Extraction goes through a lazily built per-kind index over `items`
+  // (rebuilt on the same staleness signal as the `FindItemById` index below),
+  // so consumers that repeatedly pull out one kind - namespace collection,
+  // alias scans, function iteration during source code generation - walk a
+  // dense index instead of striding over every variant slot (whose size is
+  // dominated by the largest alternative, `Record`) on each call.
   template <typename T>
   std::vector<const T*> get_items_if() const {
+    if (item_kind_index_items_size_ != items.size()) {
+      BuildItemKindIndex();
+    }
+    const std::vector<size_t>& indices = item_kind_index_cache_
+        [AlternativeIndex<T>(static_cast<const Item*>(nullptr))];
     std::vector<const T*> filtered_items;
-    for (const auto& item : items) {
-      if (auto* filtered_item = std::get_if<T>(&item)) {
-        filtered_items.push_back(filtered_item);
-      }
+    filtered_items.reserve(indices.size());
+    for (size_t idx : indices) {
+      filtered_items.push_back(std::get_if<T>(&items[idx]));
     }
     return filtered_items;
   }
 
+  // Rebuilds `item_kind_index_cache_`; only called from `get_items_if`.
+  void BuildItemKindIndex() const;
+
+  // Returns the item with the given `id`, or `nullptr` if there is none.
+  //
+  // Lookups go through a lazily built index (rebuilt whenever `items` has
+  // grown since the index was last built), so consumers that resolve many
+  // `ItemId`s don't pay for a scan over `items` per lookup.
+  const Item* FindItemById(ItemId id) const;
+
+  // Like `FindItemById`, but additionally requires the item to hold a `T`;
+  // returns `nullptr` if the item is absent or holds a different variant.
+  template <typename T>
+  const T* FindItemById(ItemId id) const {
+    const auto* item = FindItemById(id);
+    return item == nullptr ? nullptr : std::get_if<T>(item);
+  }
+
   // Collection of public headers that were used to construct the AST this `IR`.
   //
   // In production, these come from the `--public_headers` cmdline flag.
@@ -772,8 +891,6 @@ struct IR {
 
   BazelLabel current_target;
 
-  using Item = std::variant<Func, Record, IncompleteRecord, Enum, TypeAlias,
-                            UnsupportedItem, Comment, Namespace, UseMod>;
   std::vector<Item> items;
   std::vector<ItemId> top_level_item_ids;
   // Empty string signals that the bindings should be generated in the crate
@@ -789,11 +906,56 @@ struct IR {
   // TODO(hlopko): Replace empty strings with std::optional<std::string>
   // throughout the codebase
   std::string crate_root_path;
+
+  // Lazily built index from an item's `ItemId` to its position in `items`;
+  // only accessed through `FindItemById`.  A default member initializer keeps
+  // `IR` an aggregate.
+  mutable ItemIdMap<size_t> item_id_to_item_idx_cache_ = {};
+
+  // Lazily built per-kind index over `items`: for each `Item` alternative,
+  // the positions of the items holding it, in order.  `SIZE_MAX` marks the
+  // index as never built; only accessed through `get_items_if`.
+  mutable std::vector<std::vector<size_t>> item_kind_index_cache_ = {};
+  mutable size_t item_kind_index_items_size_ = SIZE_MAX;
 };
 
-inline std::string IrToJson(const IR& ir) {
-  return std::string(llvm::formatv("{0:2}", ir.ToJson()));
-}
+// Serializes `ir` to JSON, streaming items one at a time into the result
+// buffer instead of materializing one `llvm::json::Value` tree for the whole
+// IR.  This keeps peak memory proportional to the largest single item.
+// `indent` has the same meaning as in `llvm::json::OStream`; 0 produces
+// compact single-line output.
+std::string IrToJson(const IR& ir, int indent = internal::kJsonIndent);
+
+// Serializes `ir` into the compact binary format consumed by
+// `deserialize_ir_binary` in ir.rs.  Unlike `IrToJson` (which stays around as a
+// debug output behind the `--ir_out` flag), this format is framed so that the
+// consumer never has to materialize the whole document at once:
+//
+//   * 4 bytes: magic ("CRIR")
+//   * u32 (little-endian): format version
+//   * frame: the `IR` fields other than `items`
+//   * u32 (little-endian): number of items
+//   * one frame per item
+//
+// where a "frame" is a u32 little-endian payload size followed by that many
+// payload bytes.  Each frame can be sliced out and decoded independently
+// without copying, so peak memory on the consuming side stays proportional to
+// the largest single item rather than to the whole IR.
+std::string IrToBinary(const IR& ir);
+
+// Wraps a serialized IR artifact (the output of `IrToJson` or `IrToBinary`)
+// in the transport compression used for IR files that travel through the
+// remote cache:
+//
+//   * 4 bytes: magic ("CRZ1")
+//   * u64 (little-endian): uncompressed payload size
+//   * the zstd-compressed payload
+//
+// Readers sniff the magic, so compressed and uncompressed artifacts coexist
+// transparently; when the LLVM build has no zstd support, the payload is
+// returned unchanged.  See `maybe_decompress_ir` in ir.rs for the consuming
+// side.
+std::string CompressIrPayload(absl::string_view ir_payload);
 
 inline std::ostream& operator<<(std::ostream& o, const IR& ir) {
   return o << IrToJson(ir);
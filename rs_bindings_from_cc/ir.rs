@@ -11,19 +11,133 @@ use once_cell::unsync::OnceCell;
 use proc_macro2::TokenStream;
 use quote::{quote, ToTokens};
 use serde::Deserialize;
+use std::borrow::Cow;
+use std::cell::RefCell;
 use std::collections::hash_map::{Entry, HashMap};
+use std::collections::HashSet;
 use std::convert::TryFrom;
 use std::fmt::{self, Debug, Formatter};
 use std::hash::{Hash, Hasher};
 use std::io::Read;
 use std::rc::Rc;
 
-/// Deserialize `IR` from JSON given as a reader.
-pub fn deserialize_ir<R: Read>(reader: R) -> Result<IR> {
-    let flat_ir = serde_json::from_reader(reader)?;
+/// Deserialize `IR` from JSON given as a reader.  The input may carry the
+/// zstd transport compression produced by `CompressIrPayload` in ir.cc; it is
+/// stripped transparently.
+pub fn deserialize_ir<R: Read>(mut reader: R) -> Result<IR> {
+    let mut bytes = Vec::new();
+    reader.read_to_end(&mut bytes)?;
+    let bytes = maybe_decompress_ir(&bytes)?;
+    let flat_ir = serde_json::from_slice(&bytes)?;
     make_ir(flat_ir)
 }
 
+// Magic number and version of the binary IR format.
+// LINT.IfChange
+const BINARY_IR_MAGIC: &[u8] = b"CRIR";
+const BINARY_IR_VERSION: u32 = 1;
+// LINT.ThenChange(//depot/rs_bindings_from_cc/ir.cc)
+
+// Magic number of the zstd transport compression for IR artifacts.
+// LINT.IfChange
+const COMPRESSED_IR_MAGIC: &[u8] = b"CRZ1";
+// LINT.ThenChange(//depot/rs_bindings_from_cc/ir.cc)
+
+/// Strips the transport compression from a serialized IR artifact: a payload
+/// starting with `COMPRESSED_IR_MAGIC` (followed by the little-endian u64
+/// uncompressed size and a zstd frame, see `CompressIrPayload` in ir.cc) is
+/// decompressed; anything else is passed through unchanged.
+fn maybe_decompress_ir(bytes: &[u8]) -> Result<Cow<'_, [u8]>> {
+    let Some(rest) = bytes.strip_prefix(COMPRESSED_IR_MAGIC) else {
+        return Ok(Cow::Borrowed(bytes));
+    };
+    if rest.len() < std::mem::size_of::<u64>() {
+        bail!("Truncated compressed IR: missing the uncompressed-size header");
+    }
+    let (size_bytes, compressed) = rest.split_at(std::mem::size_of::<u64>());
+    let uncompressed_size =
+        usize::try_from(u64::from_le_bytes(size_bytes.try_into().unwrap())).unwrap();
+    let decompressed = zstd::bulk::decompress(compressed, uncompressed_size)
+        .context("Failed to decompress the IR payload")?;
+    if decompressed.len() != uncompressed_size {
+        bail!(
+            "Compressed IR declared {uncompressed_size} uncompressed bytes but decompressed to {}",
+            decompressed.len()
+        );
+    }
+    Ok(Cow::Owned(decompressed))
+}
+
+/// Deserialize `IR` from the length-prefixed binary format produced by
+/// `IrToBinary` (see the format description in ir.h), optionally wrapped in
+/// the zstd transport compression produced by `CompressIrPayload`.
+///
+/// Every frame payload is decoded in place from a subslice of `bytes`, so this
+/// never materializes the whole serialized document as a single parse tree
+/// (beyond the decompression buffer for compressed inputs).
+pub fn deserialize_ir_binary(bytes: &[u8]) -> Result<IR> {
+    match maybe_decompress_ir(bytes)? {
+        Cow::Borrowed(bytes) => deserialize_ir_binary_uncompressed(bytes),
+        Cow::Owned(bytes) => deserialize_ir_binary_uncompressed(&bytes),
+    }
+}
+
+fn deserialize_ir_binary_uncompressed(bytes: &[u8]) -> Result<IR> {
+    let mut reader = FrameReader::new(bytes)?;
+    let mut flat_ir: FlatIR = serde_json::from_slice(reader.next_frame()?)?;
+    let item_count = reader.next_u32()? as usize;
+    flat_ir.items.reserve(item_count);
+    for _ in 0..item_count {
+        flat_ir.items.push(serde_json::from_slice(reader.next_frame()?)?);
+    }
+    if !reader.is_empty() {
+        bail!("Trailing garbage after the last binary IR frame");
+    }
+    make_ir(flat_ir)
+}
+
+/// Reader for the length-prefixed frames of the binary IR format.
+struct FrameReader<'a> {
+    bytes: &'a [u8],
+}
+
+impl<'a> FrameReader<'a> {
+    fn new(bytes: &'a [u8]) -> Result<Self> {
+        let mut reader = FrameReader { bytes };
+        if reader.next_bytes(BINARY_IR_MAGIC.len())? != BINARY_IR_MAGIC {
+            bail!("Invalid binary IR magic number");
+        }
+        let version = reader.next_u32()?;
+        if version != BINARY_IR_VERSION {
+            bail!("Unsupported binary IR version {version} (expected {BINARY_IR_VERSION})");
+        }
+        Ok(reader)
+    }
+
+    fn next_bytes(&mut self, len: usize) -> Result<&'a [u8]> {
+        if self.bytes.len() < len {
+            bail!("Truncated binary IR: wanted {len} bytes, got {}", self.bytes.len());
+        }
+        let (result, rest) = self.bytes.split_at(len);
+        self.bytes = rest;
+        Ok(result)
+    }
+
+    fn next_u32(&mut self) -> Result<u32> {
+        let bytes = self.next_bytes(std::mem::size_of::<u32>())?;
+        Ok(u32::from_le_bytes(bytes.try_into().unwrap()))
+    }
+
+    fn next_frame(&mut self) -> Result<&'a [u8]> {
+        let len = self.next_u32()? as usize;
+        self.next_bytes(len)
+    }
+
+    fn is_empty(&self) -> bool {
+        self.bytes.is_empty()
+    }
+}
+
 /// Create a testing `IR` instance from given parts. This function does not use
 /// any mock values.
 pub fn make_ir_from_parts(
@@ -73,6 +187,13 @@ fn make_ir(flat_ir: FlatIR) -> Result<IR> {
             }
         }
     }
+    let mut function_name_to_item_idxs: HashMap<UnqualifiedIdentifier, Vec<usize>> = HashMap::new();
+    for (idx, item) in flat_ir.items.iter().enumerate() {
+        if let Item::Func(func) = item {
+            function_name_to_item_idxs.entry(func.name.clone()).or_default().push(idx);
+        }
+    }
+
     let mut namespace_id_to_number_of_reopened_namespaces = HashMap::new();
     let mut reopened_namespace_id_to_idx = HashMap::new();
 
@@ -98,6 +219,7 @@ fn make_ir(flat_ir: FlatIR) -> Result<IR> {
         lifetimes,
         namespace_id_to_number_of_reopened_namespaces,
         reopened_namespace_id_to_idx,
+        function_name_to_item_idxs,
     })
 }
 
@@ -116,11 +238,53 @@ pub struct LifetimeName {
     pub id: LifetimeId,
 }
 
+thread_local! {
+    /// Interning table for type names; see `deserialize_interned_name`.
+    static INTERNED_TYPE_NAMES: RefCell<HashSet<Rc<str>>> = RefCell::new(HashSet::new());
+}
+
+/// Returns an `Rc` of `s` that is shared with every other interned use of the
+/// same string contents.
+fn intern_str(s: &str) -> Rc<str> {
+    INTERNED_TYPE_NAMES.with(|interner| {
+        let mut interner = interner.borrow_mut();
+        match interner.get(s) {
+            Some(existing) => existing.clone(),
+            None => {
+                let new: Rc<str> = s.into();
+                interner.insert(new.clone());
+                new
+            }
+        }
+    })
+}
+
+/// Deserializes an optional string, interning it.  The same type names ("*",
+/// "&mut", "i32", fully qualified record names, ...) occur thousands of times
+/// across the `RsType`s/`CcType`s of a big IR; interning makes all of them
+/// share a single allocation instead of holding one copy per type node.
+fn deserialize_interned_name<'de, D>(deserializer: D) -> Result<Option<Rc<str>>, D::Error>
+where
+    D: serde::Deserializer<'de>,
+{
+    let name: Option<Cow<'de, str>> = Deserialize::deserialize(deserializer)?;
+    Ok(name.map(|name| intern_str(&name)))
+}
+
+/// `serde(default = ...)` helper for fields whose C++ default is `true`.
+fn serde_default_true() -> bool {
+    true
+}
+
 #[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
 pub struct RsType {
+    #[serde(default, deserialize_with = "deserialize_interned_name")]
     pub name: Option<Rc<str>>,
+    #[serde(default)]
     pub lifetime_args: Rc<[LifetimeId]>,
+    #[serde(default)]
     pub type_args: Rc<[RsType]>,
+    #[serde(default)]
     pub decl_id: Option<ItemId>,
 }
 
@@ -132,9 +296,13 @@ impl RsType {
 
 #[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
 pub struct CcType {
+    #[serde(default, deserialize_with = "deserialize_interned_name")]
     pub name: Option<Rc<str>>,
+    #[serde(default)]
     pub is_const: bool,
+    #[serde(default)]
     pub type_args: Vec<CcType>,
+    #[serde(default)]
     pub decl_id: Option<ItemId>,
 }
 
@@ -278,6 +446,7 @@ pub struct InstanceMethodMetadata {
 #[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
 pub struct MemberFuncMetadata {
     pub record_id: ItemId,
+    #[serde(default)]
     pub instance_method_metadata: Option<InstanceMethodMetadata>,
 }
 
@@ -293,22 +462,31 @@ pub struct Func {
     pub name: UnqualifiedIdentifier,
     pub owning_target: BazelLabel,
     pub mangled_name: Rc<str>,
+    #[serde(default)]
     pub doc_comment: Option<Rc<str>>,
     pub return_type: MappedType,
+    #[serde(default)]
     pub params: Vec<FuncParam>,
     /// For tests and internal use only.
     ///
     /// Prefer to reconstruct the lifetime params from the parameter types, as
     /// needed. This allows new parameters and lifetimes to be added that were
     /// not originally part of the IR.
+    #[serde(default)]
     pub lifetime_params: Vec<LifetimeName>,
+    #[serde(default)]
     pub is_inline: bool,
+    #[serde(default)]
     pub member_func_metadata: Option<MemberFuncMetadata>,
+    #[serde(default = "serde_default_true")]
     pub has_c_calling_convention: bool,
+    #[serde(default)]
     pub is_member_or_descendant_of_class_template: bool,
     pub source_loc: Rc<str>,
     pub id: ItemId,
+    #[serde(default)]
     pub enclosing_namespace_id: Option<ItemId>,
+    #[serde(default)]
     pub adl_enclosing_record: Option<ItemId>,
 }
 
@@ -330,17 +508,22 @@ pub enum AccessSpecifier {
 
 #[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
 pub struct Field {
+    #[serde(default)]
     pub identifier: Option<Identifier>,
+    #[serde(default)]
     pub doc_comment: Option<Rc<str>>,
     #[serde(rename(deserialize = "type"))]
     pub type_: Result<MappedType, String>,
     pub access: AccessSpecifier,
     pub offset: usize,
     pub size: usize,
+    #[serde(default)]
     pub is_no_unique_address: bool,
+    #[serde(default)]
     pub is_bitfield: bool,
     // TODO(kinuko): Consider removing this, it is a duplicate of the same information
     // in `Record`.
+    #[serde(default)]
     pub is_inheritable: bool,
 }
 
@@ -355,6 +538,7 @@ pub enum SpecialMemberFunc {
 #[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
 pub struct BaseClass {
     pub base_record_id: ItemId,
+    #[serde(default)]
     pub offset: Option<i64>,
 }
 
@@ -365,6 +549,7 @@ pub struct IncompleteRecord {
     pub id: ItemId,
     pub owning_target: BazelLabel,
     pub record_type: RecordType,
+    #[serde(default)]
     pub enclosing_namespace_id: Option<ItemId>,
 }
 
@@ -393,26 +578,39 @@ pub struct Record {
     pub mangled_cc_name: Rc<str>,
     pub id: ItemId,
     pub owning_target: BazelLabel,
+    #[serde(default)]
     pub doc_comment: Option<Rc<str>>,
     pub source_loc: Rc<str>,
+    #[serde(default)]
     pub unambiguous_public_bases: Vec<BaseClass>,
+    #[serde(default)]
     pub fields: Vec<Field>,
+    #[serde(default)]
     pub lifetime_params: Vec<LifetimeName>,
     pub size: usize,
     pub original_cc_size: usize,
     pub alignment: usize,
+    #[serde(default)]
     pub is_derived_class: bool,
+    #[serde(default)]
     pub override_alignment: bool,
     pub copy_constructor: SpecialMemberFunc,
     pub move_constructor: SpecialMemberFunc,
     pub destructor: SpecialMemberFunc,
+    #[serde(default)]
     pub is_trivial_abi: bool,
+    #[serde(default)]
     pub is_inheritable: bool,
+    #[serde(default)]
     pub is_abstract: bool,
     pub record_type: RecordType,
+    #[serde(default)]
     pub is_aggregate: bool,
+    #[serde(default)]
     pub is_anon_record_with_typedef: bool,
+    #[serde(default)]
     pub child_item_ids: Vec<ItemId>,
+    #[serde(default)]
     pub enclosing_namespace_id: Option<ItemId>,
 }
 
@@ -462,7 +660,9 @@ pub struct Enum {
     pub owning_target: BazelLabel,
     pub source_loc: Rc<str>,
     pub underlying_type: MappedType,
+    #[serde(default)]
     pub enumerators: Vec<Enumerator>,
+    #[serde(default)]
     pub enclosing_namespace_id: Option<ItemId>,
 }
 
@@ -477,10 +677,13 @@ pub struct TypeAlias {
     pub identifier: Identifier,
     pub id: ItemId,
     pub owning_target: BazelLabel,
+    #[serde(default)]
     pub doc_comment: Option<Rc<str>>,
     pub underlying_type: MappedType,
     pub source_loc: Rc<str>,
+    #[serde(default)]
     pub enclosing_record_id: Option<ItemId>,
+    #[serde(default)]
     pub enclosing_namespace_id: Option<ItemId>,
 }
 
@@ -708,6 +911,11 @@ pub struct IR {
     lifetimes: HashMap<LifetimeId, LifetimeName>,
     namespace_id_to_number_of_reopened_namespaces: HashMap<ItemId, usize>,
     reopened_namespace_id_to_idx: HashMap<ItemId, usize>,
+    // An index from a function's unqualified name to the positions of the
+    // `Item::Func` items carrying that name, in declaration order.  Built once
+    // in `make_ir` so that name-directed lookups (overload sets, probing for a
+    // copy constructor) don't have to scan every item.
+    function_name_to_item_idxs: HashMap<UnqualifiedIdentifier, Vec<usize>>,
 }
 
 impl IR {
@@ -734,6 +942,23 @@ impl IR {
         })
     }
 
+    /// Returns the functions whose unqualified name is `name`, in declaration
+    /// order.  This is an O(1) index lookup; use it instead of filtering
+    /// `functions()` when the name is known up front.
+    pub fn functions_with_name(
+        &self,
+        name: &UnqualifiedIdentifier,
+    ) -> impl Iterator<Item = &Rc<Func>> {
+        self.function_name_to_item_idxs
+            .get(name)
+            .map_or(&[][..], |idxs| idxs.as_slice())
+            .iter()
+            .map(|&idx| match &self.flat_ir.items[idx] {
+                Item::Func(func) => func,
+                other => panic!("Index entry for {name:?} points at a non-function: {other:?}"),
+            })
+    }
+
     pub fn records(&self) -> impl Iterator<Item = &Rc<Record>> {
         self.items().filter_map(|item| match item {
             Item::Record(func) => Some(func),
@@ -900,6 +1125,89 @@ mod tests {
         assert_eq!(ir.flat_ir, expected);
     }
 
+    #[test]
+    fn test_deserialize_ir_binary() {
+        // Assembles the framing that `IrToBinary` in ir.cc produces.
+        fn frame(payload: &str) -> Vec<u8> {
+            let mut result = (payload.len() as u32).to_le_bytes().to_vec();
+            result.extend_from_slice(payload.as_bytes());
+            result
+        }
+        let mut input = b"CRIR".to_vec();
+        input.extend_from_slice(&1u32.to_le_bytes());
+        input.extend_from_slice(&frame(
+            r#"{ "public_headers": [{ "name": "foo/bar.h" }], "current_target": "//foo:bar" }"#,
+        ));
+        input.extend_from_slice(&1u32.to_le_bytes());
+        input.extend_from_slice(&frame(r#"{ "Comment": { "text": "hello", "id": 42 } }"#));
+
+        let ir = deserialize_ir_binary(&input).unwrap();
+        assert_eq!(
+            ir.public_headers().collect::<Vec<_>>(),
+            vec![&HeaderName { name: "foo/bar.h".into() }]
+        );
+        assert_eq!(ir.comments().map(|c| &*c.text).collect::<Vec<_>>(), vec!["hello"]);
+    }
+
+    #[test]
+    fn test_deserialize_ir_binary_bad_magic() {
+        let err = deserialize_ir_binary(b"JUNK").unwrap_err();
+        assert!(err.to_string().contains("magic"), "{err}");
+    }
+
+    // Assembles the transport compression that `CompressIrPayload` in ir.cc
+    // produces.
+    fn compress_ir_payload(payload: &[u8]) -> Vec<u8> {
+        let mut result = b"CRZ1".to_vec();
+        result.extend_from_slice(&(payload.len() as u64).to_le_bytes());
+        result.extend_from_slice(&zstd::bulk::compress(payload, 0).unwrap());
+        result
+    }
+
+    #[test]
+    fn test_deserialize_ir_compressed() {
+        let input = compress_ir_payload(
+            br#"
+            {
+                "public_headers": [{ "name": "foo/bar.h" }],
+                "current_target": "//foo:bar"
+            }
+            "#,
+        );
+        let ir = deserialize_ir(&*input).unwrap();
+        assert_eq!(
+            ir.public_headers().collect::<Vec<_>>(),
+            vec![&HeaderName { name: "foo/bar.h".into() }]
+        );
+    }
+
+    #[test]
+    fn test_deserialize_ir_binary_compressed() {
+        let mut payload = b"CRIR".to_vec();
+        payload.extend_from_slice(&1u32.to_le_bytes());
+        let envelope = br#"{ "public_headers": [], "current_target": "//foo:bar" }"#;
+        payload.extend_from_slice(&(envelope.len() as u32).to_le_bytes());
+        payload.extend_from_slice(envelope);
+        payload.extend_from_slice(&0u32.to_le_bytes());
+
+        let ir = deserialize_ir_binary(&compress_ir_payload(&payload)).unwrap();
+        assert_eq!(&*ir.current_target().0, "//foo:bar");
+    }
+
+    #[test]
+    fn test_deserialize_ir_compressed_truncated_header() {
+        let err = deserialize_ir(&b"CRZ1\x01"[..]).unwrap_err();
+        assert!(err.to_string().contains("Truncated compressed IR"), "{err}");
+    }
+
+    #[test]
+    fn test_type_name_interning() {
+        let input = r#"{ "name": "i32", "lifetime_args": [], "type_args": [], "decl_id": null }"#;
+        let a: RsType = serde_json::from_str(input).unwrap();
+        let b: RsType = serde_json::from_str(input).unwrap();
+        assert!(Rc::ptr_eq(a.name.as_ref().unwrap(), b.name.as_ref().unwrap()));
+    }
+
     #[test]
     fn test_empty_crate_root_path() {
         let input = "{ \"current_target\": \"//foo:bar\" }";
@@ -0,0 +1,153 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Benchmarks for the IR data structures and their serialization.  The IRs are
+// synthesized with a parameterized item count and type nesting depth so that
+// regressions in ir.h/ir.cc data-structure changes show up quantitatively
+// instead of only as wall-time noise in CI.
+//
+// Run with:
+//   bazel run -c opt //rs_bindings_from_cc:ir_benchmark
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "rs_bindings_from_cc/bazel_types.h"
+#include "rs_bindings_from_cc/ir.h"
+
+namespace crubit {
+namespace {
+
+constexpr absl::string_view kBenchmarkTarget = "//foo:bar";
+
+MappedType MakeNestedPointerType(int depth) {
+  MappedType type = MappedType::Simple("i32", "int");
+  for (int i = 0; i < depth; ++i) {
+    type = MappedType::PointerTo(std::move(type), /*lifetime=*/std::nullopt);
+  }
+  return type;
+}
+
+Func MakeFunc(int index, int nesting_depth) {
+  return Func{
+      .name = Identifier(absl::StrCat("func_", index)),
+      .owning_target = BazelLabel{std::string(kBenchmarkTarget)},
+      .mangled_name = absl::StrCat("_Z", index, "func_", index, "v"),
+      .return_type = MakeNestedPointerType(nesting_depth),
+      .params = {FuncParam{MakeNestedPointerType(nesting_depth),
+                           Identifier("param")}},
+      .is_inline = false,
+      .source_loc = "Generated from: benchmark.h;l=1",
+      .id = ItemId(2 * index),
+  };
+}
+
+Record MakeRecord(int index, int nesting_depth) {
+  return Record{
+      .rs_name = absl::StrCat("Record", index),
+      .cc_name = absl::StrCat("Record", index),
+      .mangled_cc_name = absl::StrCat("6Record", index),
+      .id = ItemId(2 * index + 1),
+      .owning_target = BazelLabel{std::string(kBenchmarkTarget)},
+      .source_loc = "Generated from: benchmark.h;l=2",
+      .fields = {Field{.identifier = Identifier("field"),
+                       .type = MakeNestedPointerType(nesting_depth),
+                       .access = kPublic,
+                       .offset = 0,
+                       .size = 64}},
+      .size = 8,
+      .original_cc_size = 8,
+      .alignment = 8,
+      .record_type = kStruct,
+  };
+}
+
+std::vector<IR::Item> MakeSyntheticItems(int num_items, int nesting_depth) {
+  std::vector<IR::Item> items;
+  items.reserve(num_items);
+  for (int i = 0; i < num_items; ++i) {
+    if (i % 2 == 0) {
+      items.push_back(MakeFunc(i, nesting_depth));
+    } else {
+      items.push_back(MakeRecord(i, nesting_depth));
+    }
+  }
+  return items;
+}
+
+IR MakeSyntheticIr(int num_items, int nesting_depth) {
+  IR ir;
+  ir.current_target = BazelLabel{std::string(kBenchmarkTarget)};
+  ir.public_headers = {HeaderName("benchmark.h")};
+  ir.items = MakeSyntheticItems(num_items, nesting_depth);
+  return ir;
+}
+
+void BM_IrToJson(benchmark::State& state) {
+  IR ir = MakeSyntheticIr(state.range(0), state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(IrToJson(ir, /*indent=*/0));
+  }
+  state.SetItemsProcessed(state.iterations() * ir.items.size());
+}
+BENCHMARK(BM_IrToJson)
+    ->ArgPair(100, 2)
+    ->ArgPair(10000, 2)
+    ->ArgPair(10000, 16);
+
+void BM_IrToBinary(benchmark::State& state) {
+  IR ir = MakeSyntheticIr(state.range(0), state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(IrToBinary(ir));
+  }
+  state.SetItemsProcessed(state.iterations() * ir.items.size());
+}
+BENCHMARK(BM_IrToBinary)
+    ->ArgPair(100, 2)
+    ->ArgPair(10000, 2)
+    ->ArgPair(10000, 16);
+
+void BM_ItemInsertion(benchmark::State& state) {
+  std::vector<IR::Item> items =
+      MakeSyntheticItems(state.range(0), /*nesting_depth=*/2);
+  for (auto _ : state) {
+    IR ir;
+    ir.items.reserve(items.size());
+    for (const IR::Item& item : items) {
+      ir.items.push_back(item);
+    }
+    benchmark::DoNotOptimize(ir);
+  }
+  state.SetItemsProcessed(state.iterations() * items.size());
+}
+BENCHMARK(BM_ItemInsertion)->Arg(100)->Arg(10000);
+
+void BM_GetItemsIf(benchmark::State& state) {
+  IR ir = MakeSyntheticIr(state.range(0), /*nesting_depth=*/2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ir.get_items_if<Func>());
+  }
+  state.SetItemsProcessed(state.iterations() * ir.items.size());
+}
+BENCHMARK(BM_GetItemsIf)->Arg(100)->Arg(10000);
+
+void BM_FindItemById(benchmark::State& state) {
+  IR ir = MakeSyntheticIr(state.range(0), /*nesting_depth=*/2);
+  for (auto _ : state) {
+    for (int i = 0; i < state.range(0); ++i) {
+      benchmark::DoNotOptimize(ir.FindItemById(ItemId(i)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FindItemById)->Arg(100)->Arg(10000);
+
+}  // namespace
+}  // namespace crubit
+
+BENCHMARK_MAIN();
@@ -5,11 +5,13 @@
 #include "rs_bindings_from_cc/ir_from_cc.h"
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -17,11 +19,22 @@
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
+#include "common/fingerprint.h"
+#include "common/timing.h"
 #include "rs_bindings_from_cc/bazel_types.h"
 #include "rs_bindings_from_cc/frontend_action.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileSystemOptions.h"
 #include "clang/Frontend/FrontendAction.h"
+#include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 
 namespace crubit {
 
@@ -29,6 +42,88 @@ static constexpr absl::string_view kVirtualHeaderPath =
     "ir_from_cc_virtual_header.h";
 static constexpr absl::string_view kVirtualInputPath =
     "ir_from_cc_virtual_input.cc";
+static constexpr absl::string_view kVirtualPchInputPath =
+    "ir_from_cc_virtual_prologue.h";
+
+namespace {
+
+// Mirrors `clang::tooling::runToolOnCodeWithArgs`, but runs the invocation
+// against the caller's `file_manager`, so consecutive parses within one
+// action share one stat/read cache for the on-disk headers instead of each
+// re-probing the whole include closure. `code` and `file_contents` are
+// remapped into the invocation; a given path must not be remapped with
+// different contents through the same FileManager, since virtual file
+// entries cache their size.
+bool RunToolOnCode(std::unique_ptr<clang::FrontendAction> action,
+                   absl::string_view code, absl::Span<const std::string> args,
+                   absl::string_view input_path,
+                   const clang::tooling::FileContentMappings& file_contents,
+                   clang::FileManager& file_manager) {
+  std::vector<std::string> command_line;
+  command_line.reserve(args.size() + 3);
+  // The same fixed argv prefix/suffix that `runToolOnCodeWithArgs` builds.
+  command_line.push_back("rs_bindings_from_cc");
+  command_line.push_back("-fsyntax-only");
+  command_line.insert(command_line.end(), args.begin(), args.end());
+  command_line.push_back(std::string(input_path));
+
+  clang::tooling::ToolInvocation invocation(std::move(command_line),
+                                            std::move(action), &file_manager);
+  invocation.mapVirtualFile(llvm::StringRef(input_path.data(),
+                                            input_path.size()),
+                            llvm::StringRef(code.data(), code.size()));
+  for (const auto& [path, contents] : file_contents) {
+    invocation.mapVirtualFile(path, contents);
+  }
+  return invocation.run();
+}
+
+// Returns the path of a cached PCH for `include_prologue` under
+// `pch_cache_dir`, building it first if no PCH has been cached yet for this
+// combination of prologue and `clang_args`. Returns `std::nullopt` if the PCH
+// could not be built; callers then fall back to a cold parse.
+std::optional<std::string> GetOrBuildPch(
+    absl::string_view pch_cache_dir, absl::string_view include_prologue,
+    absl::Span<const std::string> clang_args,
+    clang::FileManager& file_manager) {
+  Fingerprint fingerprint;
+  for (const std::string& arg : clang_args) {
+    fingerprint.Update(arg);
+  }
+  fingerprint.Update(include_prologue);
+  std::string digest = std::move(fingerprint).HexDigest();
+
+  llvm::SmallString<128> pch_path(pch_cache_dir);
+  llvm::sys::path::append(pch_path, absl::StrCat(digest, ".pch"));
+  // Clang validates the headers recorded in a PCH when loading it, so a PCH
+  // that became stale (e.g. a header changed under an unchanged include
+  // prologue) makes the main parse fail and the caller re-parse cold.
+  if (llvm::sys::fs::exists(pch_path)) return std::string(pch_path);
+
+  if (llvm::sys::fs::create_directories(pch_cache_dir)) return std::nullopt;
+
+  // Build into a process-unique temporary file and rename it into place so
+  // that concurrent invocations never observe a partially written PCH.
+  llvm::SmallString<128> tmp_path(pch_path);
+  tmp_path += absl::StrCat(".tmp.", llvm::sys::Process::getProcessId());
+  std::vector<std::string> pch_args(clang_args.begin(), clang_args.end());
+  pch_args.push_back("-xc++-header");
+  pch_args.push_back("-o");
+  pch_args.push_back(std::string(tmp_path));
+  if (!RunToolOnCode(std::make_unique<clang::GeneratePCHAction>(),
+                     include_prologue, pch_args, kVirtualPchInputPath,
+                     /*file_contents=*/{}, file_manager)) {
+    llvm::sys::fs::remove(tmp_path);
+    return std::nullopt;
+  }
+  if (llvm::sys::fs::rename(tmp_path, pch_path)) {
+    llvm::sys::fs::remove(tmp_path);
+    return std::nullopt;
+  }
+  return std::string(pch_path);
+}
+
+}  // namespace
 
 absl::StatusOr<IR> IrFromCc(
     const absl::string_view extra_source_code_for_testing,
@@ -39,7 +134,8 @@ absl::StatusOr<IR> IrFromCc(
     absl::flat_hash_map<HeaderName, BazelLabel> headers_to_targets,
     absl::Span<const std::string> extra_rs_srcs,
     absl::Span<const absl::string_view> clang_args,
-    absl::Span<const std::string> extra_instantiations) {
+    absl::Span<const std::string> extra_instantiations,
+    absl::string_view pch_cache_dir) {
   // Caller should verify that the inputs are not empty.
   CHECK(!extra_source_code_for_testing.empty() || !public_headers.empty() ||
         !extra_instantiations.empty());
@@ -63,22 +159,26 @@ absl::StatusOr<IR> IrFromCc(
     headers_to_targets.insert({header_name, current_target});
   }
 
-  std::string virtual_input_file_content;
+  // The `#include` prologue is the stable prefix of the translation unit - it
+  // only changes when the target's headers or dependencies change - while the
+  // instantiation suffix is volatile per invocation. Keeping them separate
+  // lets the prologue be served from a PCH.
+  std::string include_prologue;
   for (const HeaderName& header_name : augmented_public_headers) {
-    absl::SubstituteAndAppend(&virtual_input_file_content, "#include \"$0\"\n",
+    absl::SubstituteAndAppend(&include_prologue, "#include \"$0\"\n",
                               header_name.IncludePath());
   }
+  std::string instantiation_suffix;
   if (!extra_instantiations.empty()) {
-    absl::SubstituteAndAppend(&virtual_input_file_content, "namespace $0 {\n",
+    absl::SubstituteAndAppend(&instantiation_suffix, "namespace $0 {\n",
                               kInstantiationsNamespaceName);
     int counter = 0;
     for (const std::string& extra_instantiation : extra_instantiations) {
-      absl::SubstituteAndAppend(&virtual_input_file_content,
+      absl::SubstituteAndAppend(&instantiation_suffix,
                                 "using __cc_template_instantiation_$0 = $1;\n",
                                 counter++, extra_instantiation);
     }
-    absl::SubstituteAndAppend(&virtual_input_file_content,
-                              "}  // namespace $0\n",
+    absl::SubstituteAndAppend(&instantiation_suffix, "}  // namespace $0\n",
                               kInstantiationsNamespaceName);
   }
   std::vector<std::string> args_as_strings{
@@ -88,34 +188,136 @@ absl::StatusOr<IR> IrFromCc(
   args_as_strings.insert(args_as_strings.end(), clang_args.begin(),
                          clang_args.end());
 
-  Invocation invocation(current_target, augmented_public_headers,
-                        headers_to_targets);
-  if (!clang::tooling::runToolOnCodeWithArgs(
-          std::make_unique<FrontendAction>(invocation),
-          virtual_input_file_content, args_as_strings, kVirtualInputPath,
-          "rs_bindings_from_cc",
-          std::make_shared<clang::PCHContainerOperations>(), file_contents)) {
+  auto run_tool = [&](Invocation& invocation, absl::string_view code,
+                      absl::Span<const std::string> args,
+                      clang::FileManager& file_manager) {
+    // Parse and import in one phase; `Importer::Import` times the import
+    // separately, so parse time is this minus "import".
+    ScopedTimer timer("parse_and_import");
+    return RunToolOnCode(std::make_unique<FrontendAction>(invocation), code,
+                         args, kVirtualInputPath, file_contents, file_manager);
+  };
+
+  // PCH reuse is only attempted for real (on-disk) headers; virtual headers
+  // exist only for the lifetime of a single test invocation.
+  bool use_pch = !pch_cache_dir.empty() &&
+                 extra_source_code_for_testing.empty() &&
+                 virtual_headers_contents_for_testing.empty();
+  std::optional<Invocation> invocation;
+  bool parsed = false;
+  if (use_pch) {
+    // One FileManager for the PCH build and the PCH-based parse: on a cold
+    // cache, every on-disk header in the include closure is stat'd and read
+    // once per action instead of once per parse.
+    llvm::IntrusiveRefCntPtr<clang::FileManager> file_manager(
+        new clang::FileManager(clang::FileSystemOptions()));
+    if (std::optional<std::string> pch_path = GetOrBuildPch(
+            pch_cache_dir, include_prologue, args_as_strings, *file_manager)) {
+      std::vector<std::string> pch_args = args_as_strings;
+      pch_args.push_back("-include-pch");
+      pch_args.push_back(*pch_path);
+      invocation.emplace(current_target, augmented_public_headers,
+                         headers_to_targets);
+      parsed = run_tool(*invocation, instantiation_suffix, pch_args,
+                        *file_manager);
+    }
+  }
+  if (!parsed) {
+    // Cold parse; also the fallback when the PCH was stale or unusable. A
+    // partially imported IR from a failed PCH parse is discarded wholesale,
+    // and so is that parse's FileManager - this one remaps the virtual input
+    // with different contents, which a shared FileManager would mis-size.
+    llvm::IntrusiveRefCntPtr<clang::FileManager> file_manager(
+        new clang::FileManager(clang::FileSystemOptions()));
+    invocation.emplace(current_target, augmented_public_headers,
+                       headers_to_targets);
+    parsed = run_tool(*invocation,
+                      absl::StrCat(include_prologue, instantiation_suffix),
+                      args_as_strings, *file_manager);
+  }
+  if (!parsed) {
     return absl::Status(absl::StatusCode::kInvalidArgument,
                         "Could not compile header contents");
   }
 
-  invocation.ir_.items.reserve(invocation.ir_.items.size() +
-                               extra_rs_srcs.size());
+  invocation->ir_.items.reserve(invocation->ir_.items.size() +
+                                extra_rs_srcs.size());
   int i = 0;
   for (const std::string& extra_source : extra_rs_srcs) {
     // TODO(jeanpierreda): It'd be nice to give these human-readable names, e.g. the
     // name of the file without the `.rs`, but it's also annoying to handle name
     // collisions.
     ItemId id(reinterpret_cast<uintptr_t>(&extra_source));
-    invocation.ir_.items.push_back(UseMod{
+    invocation->ir_.items.push_back(UseMod{
         .path = extra_source,
         .mod_name = Identifier(absl::StrCat("__crubit_mod_", i)),
         .id = id,
     });
-    invocation.ir_.top_level_item_ids.push_back(id);
+    invocation->ir_.top_level_item_ids.push_back(id);
     ++i;
   }
-  return invocation.ir_;
+  return invocation->ir_;
+}
+
+absl::StatusOr<std::vector<IR>> IrsFromCcBatch(
+    absl::Span<const IrFromCcBatchTarget> targets,
+    absl::flat_hash_map<HeaderName, BazelLabel> headers_to_targets,
+    absl::Span<const absl::string_view> clang_args) {
+  CHECK(!targets.empty());
+
+  // Union of the batch's public headers, deduplicated in first-occurrence
+  // order; this is the shared translation unit that gets parsed once.
+  std::vector<HeaderName> union_headers;
+  absl::flat_hash_set<HeaderName> seen_headers;
+  for (const IrFromCcBatchTarget& target : targets) {
+    CHECK(!target.public_headers.empty());
+    for (const HeaderName& header : target.public_headers) {
+      if (seen_headers.insert(header).second) {
+        union_headers.push_back(header);
+      }
+    }
+  }
+
+  std::string virtual_input_file_content;
+  for (const HeaderName& header_name : union_headers) {
+    absl::SubstituteAndAppend(&virtual_input_file_content, "#include \"$0\"\n",
+                              header_name.IncludePath());
+  }
+  std::vector<std::string> args_as_strings{
+      "-std=gnu++17",
+      // Parse non-doc comments that are used as documention
+      "-fparse-all-comments"};
+  args_as_strings.insert(args_as_strings.end(), clang_args.begin(),
+                         clang_args.end());
+
+  std::vector<Invocation> invocations;
+  invocations.reserve(targets.size());
+  std::vector<Invocation*> invocation_ptrs;
+  invocation_ptrs.reserve(targets.size());
+  for (const IrFromCcBatchTarget& target : targets) {
+    invocations.emplace_back(target.target, target.public_headers,
+                             headers_to_targets);
+    // Lifetime annotation handlers are registered on the preprocessor only
+    // once, so all invocations must share one annotation context.
+    invocations.back().lifetime_context_ = invocations.front().lifetime_context_;
+    invocation_ptrs.push_back(&invocations.back());
+  }
+
+  if (!clang::tooling::runToolOnCodeWithArgs(
+          std::make_unique<FrontendAction>(std::move(invocation_ptrs)),
+          virtual_input_file_content, args_as_strings, kVirtualInputPath,
+          "rs_bindings_from_cc",
+          std::make_shared<clang::PCHContainerOperations>())) {
+    return absl::Status(absl::StatusCode::kInvalidArgument,
+                        "Could not compile header contents");
+  }
+
+  std::vector<IR> irs;
+  irs.reserve(invocations.size());
+  for (Invocation& invocation : invocations) {
+    irs.push_back(std::move(invocation.ir_));
+  }
+  return irs;
 }
 
 }  // namespace crubit
@@ -6,6 +6,7 @@
 #define CRUBIT_RS_BINDINGS_FROM_CC_IR_FROM_CC_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
@@ -44,6 +45,12 @@ static constexpr absl::string_view kInstantiationsNamespaceName =
 //   the crate. This is done via `#[path="..."] mod <...>; pub use <...>::*;`.
 // * `extra_instantiations`: names of full C++ class template specializations
 // to instantiate and generate bindings from.
+// * `pch_cache_dir`: if non-empty, a directory in which a precompiled header
+//   for the `#include` prologue of the parsed translation unit is cached,
+//   keyed on `clang_args` and the prologue itself. Repeat invocations with
+//   the same inputs then reuse the PCH instead of re-parsing the headers from
+//   scratch. A stale or unusable PCH silently falls back to a cold parse.
+//   Ignored when virtual headers are injected (i.e. in tests).
 //
 absl::StatusOr<IR> IrFromCc(
     absl::string_view extra_source_code_for_testing,
@@ -54,7 +61,26 @@ absl::StatusOr<IR> IrFromCc(
     absl::flat_hash_map<HeaderName, BazelLabel> headers_to_targets = {},
     absl::Span<const std::string> extra_rs_srcs = {},
     absl::Span<const absl::string_view> clang_args = {},
-    absl::Span<const std::string> extra_instantiations = {});
+    absl::Span<const std::string> extra_instantiations = {},
+    absl::string_view pch_cache_dir = {});
+
+// One target of a batched invocation; see `IrsFromCcBatch`.
+struct IrFromCcBatchTarget {
+  BazelLabel target;
+  std::vector<HeaderName> public_headers;
+};
+
+// Parses the union of the batch's public headers in a single Clang invocation
+// and runs the importer once per target against the shared AST. Returns one
+// `IR` per entry of `targets`, in order. Intended for batches of targets that
+// share most of their header closure, where the parse dominates and the
+// per-target marginal cost shrinks to import only. The testing-only knobs,
+// extra Rust sources and template instantiations of `IrFromCc` are not
+// supported in batch mode.
+absl::StatusOr<std::vector<IR>> IrsFromCcBatch(
+    absl::Span<const IrFromCcBatchTarget> targets,
+    absl::flat_hash_map<HeaderName, BazelLabel> headers_to_targets,
+    absl::Span<const absl::string_view> clang_args);
 
 }  // namespace crubit
 
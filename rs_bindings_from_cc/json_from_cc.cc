@@ -2,16 +2,32 @@
 // Exceptions. See /LICENSE for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "common/ffi_types.h"
+#include "common/fingerprint.h"
 #include "rs_bindings_from_cc/bazel_types.h"
 #include "rs_bindings_from_cc/ir.h"
 #include "rs_bindings_from_cc/ir_from_cc.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 
 namespace crubit {
 
@@ -20,28 +36,105 @@ static constexpr absl::string_view kDependencyTarget = "//test:dependency";
 
 static constexpr absl::string_view kDependencyHeaderName =
     "test/dependency_header.h";
+
+// The `#include` line that `ir_from_cc_dependency` prepends to every test
+// case's header source.
+static constexpr absl::string_view kDependencyInclude =
+    "#include \"test/dependency_header.h\"\n";
 // LINT.ThenChange(//depot/rs_bindings_from_cc/ir_testing.rs)
 
+// Returns the path of a PCH compiled from `dependency_header_source`,
+// building it on first use per distinct source. Test cases within one
+// process that share a dependency header - in particular every `ir_from_cc`
+// case, which passes a fixed placeholder - then reuse the compiled
+// dependency instead of re-parsing it, so the per-case parse covers only the
+// case's own header. Returns `std::nullopt` if the PCH could not be built;
+// callers fall back to a plain parse.
+static std::optional<std::string> GetDependencyPch(
+    absl::string_view dependency_header_source) {
+  static absl::Mutex mutex(absl::kConstInit);
+  // Maps dependency header source to the PCH path; an empty path records a
+  // failed build so it is not retried per case.
+  static auto* cache = new absl::flat_hash_map<std::string, std::string>();
+  absl::MutexLock lock(&mutex);
+  auto [it, inserted] =
+      cache->try_emplace(std::string(dependency_header_source));
+  if (inserted) {
+    Fingerprint fingerprint;
+    fingerprint.Update(dependency_header_source);
+    llvm::SmallString<128> pch_path;
+    llvm::sys::path::system_temp_directory(/*ErasedOnReboot=*/true, pch_path);
+    llvm::sys::path::append(
+        pch_path,
+        absl::StrCat("crubit_test_dependency_",
+                     llvm::sys::Process::getProcessId(), "_",
+                     std::move(fingerprint).HexDigest(), ".pch"));
+    std::vector<std::string> args = {"-std=gnu++17", "-fparse-all-comments",
+                                     "-xc++-header", "-o",
+                                     std::string(pch_path)};
+    clang::tooling::FileContentMappings file_contents = {
+        {std::string(kDependencyHeaderName),
+         std::string(dependency_header_source)}};
+    if (clang::tooling::runToolOnCodeWithArgs(
+            std::make_unique<clang::GeneratePCHAction>(),
+            llvm::StringRef(kDependencyInclude.data(),
+                            kDependencyInclude.size()),
+            args, "dependency_pch_input.h", "json_from_cc",
+            std::make_shared<clang::PCHContainerOperations>(),
+            file_contents)) {
+      it->second = std::string(pch_path);
+    }
+  }
+  if (it->second.empty()) return std::nullopt;
+  return it->second;
+}
+
 // This is intended to be called from Rust tests.
 extern "C" FfiU8SliceBox json_from_cc_dependency(
     FfiU8Slice header_source, FfiU8Slice dependency_header_source) {
-  absl::StatusOr<IR> ir = IrFromCc(
-      StringViewFromFfiU8Slice(header_source),
-      BazelLabel{"//test:testing_target"},
-      /* public_headers= */ {},
-      {{HeaderName(std::string(kDependencyHeaderName)),
-        std::string(StringViewFromFfiU8Slice(dependency_header_source))}},
-      {{HeaderName(std::string(kDependencyHeaderName)),
-        BazelLabel{std::string(kDependencyTarget)}}});
+  absl::string_view header = StringViewFromFfiU8Slice(header_source);
+  absl::string_view dependency =
+      StringViewFromFfiU8Slice(dependency_header_source);
+
+  auto ir_from_cc = [&](absl::string_view source,
+                        absl::Span<const absl::string_view> clang_args) {
+    return IrFromCc(
+        source, BazelLabel{"//test:testing_target"},
+        /* public_headers= */ {},
+        {{HeaderName(std::string(kDependencyHeaderName)),
+          std::string(dependency)}},
+        {{HeaderName(std::string(kDependencyHeaderName)),
+          BazelLabel{std::string(kDependencyTarget)}}},
+        /* extra_rs_srcs= */ {}, clang_args);
+  };
+
+  std::optional<absl::StatusOr<IR>> ir;
+  if (absl::StartsWith(header, kDependencyInclude)) {
+    if (std::optional<std::string> pch_path = GetDependencyPch(dependency)) {
+      // The dependency's declarations come from the PCH, so the `#include`
+      // line is replaced with a blank line - not removed, which would shift
+      // the line numbers that source location assertions rely on.
+      std::string source =
+          absl::StrCat("\n", header.substr(kDependencyInclude.size()));
+      absl::string_view pch_args[] = {"-include-pch", *pch_path};
+      ir = ir_from_cc(source, pch_args);
+      // A stale or unloadable PCH must not fail the test; reparse cold.
+      // Genuine compile errors reparse too and fail just like before.
+      if (!ir->ok()) ir.reset();
+    }
+  }
+  if (!ir.has_value()) {
+    ir = ir_from_cc(header, {});
+  }
   // TODO(forster): For now it is good enough to just exit: We are just using
   // this from tests, which are ok to just fail. Clang has already printed error
   // messages. If we start using this for production, then we should bridge the
   // error code into Rust.
-  if (!ir.ok()) {
+  if (!ir->ok()) {
     llvm::report_fatal_error(llvm::formatv("IrFromCc reported an error: {0}",
-                                           ir.status().message()));
+                                           ir->status().message()));
   }
-  std::string json = llvm::formatv("{0}", ir->ToJson());
+  std::string json = IrToJson(**ir, /*indent=*/0);
   return AllocFfiU8SliceBox(MakeFfiU8Slice(json));
 }
 
@@ -4,51 +4,76 @@
 
 #include "rs_bindings_from_cc/known_types_map.h"
 
-#include "absl/container/flat_hash_map.h"
+#include <algorithm>
+#include <iterator>
+#include <utility>
 
 namespace crubit {
 
+namespace {
+
 // A mapping of C++ standard types to their equivalent Rust types.
 // To produce more idiomatic results, these types receive special handling
 // instead of using the generic type mapping mechanism.
+//
+// The table is a frozen array sorted by C++ name and looked up via binary
+// search: this sits on the type-conversion hot path, where a static hash map
+// would cost a heap allocation at startup and a hash of the qualified name
+// per query. Sortedness is enforced at compile time below.
+constexpr std::pair<absl::string_view, absl::string_view> kWellKnownTypes[] = {
+    {"char16_t", "u16"},
+    {"char32_t", "u32"},
+    {"int16_t", "i16"},
+    {"int32_t", "i32"},
+    {"int64_t", "i64"},
+    {"int8_t", "i8"},
+    {"intptr_t", "isize"},
+    {"ptrdiff_t", "isize"},
+    {"size_t", "usize"},
+    {"std::int16_t", "i16"},
+    {"std::int32_t", "i32"},
+    {"std::int64_t", "i64"},
+    {"std::int8_t", "i8"},
+    {"std::intptr_t", "isize"},
+    {"std::ptrdiff_t", "isize"},
+    {"std::size_t", "usize"},
+    {"std::uint16_t", "u16"},
+    {"std::uint32_t", "u32"},
+    {"std::uint64_t", "u64"},
+    {"std::uint8_t", "u8"},
+    {"std::uintptr_t", "usize"},
+    {"uint16_t", "u16"},
+    {"uint32_t", "u32"},
+    {"uint64_t", "u64"},
+    {"uint8_t", "u8"},
+    {"uintptr_t", "usize"},
+    {"wchar_t", "i32"},
+};
+
+constexpr bool IsSortedByCcName() {
+  for (size_t i = 1; i < std::size(kWellKnownTypes); ++i) {
+    if (kWellKnownTypes[i - 1].first.compare(kWellKnownTypes[i].first) >= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(IsSortedByCcName(),
+              "kWellKnownTypes must be sorted by C++ name (and contain no "
+              "duplicates) for the binary search below");
+
+}  // namespace
+
 std::optional<absl::string_view> MapKnownCcTypeToRsType(
     absl::string_view cc_type) {
-  static const auto* const kWellKnownTypes =
-      new absl::flat_hash_map<absl::string_view, absl::string_view>({
-          {"ptrdiff_t", "isize"},
-          {"intptr_t", "isize"},
-          {"size_t", "usize"},
-          {"uintptr_t", "usize"},
-          {"std::ptrdiff_t", "isize"},
-          {"std::intptr_t", "isize"},
-          {"std::size_t", "usize"},
-          {"std::uintptr_t", "usize"},
-
-          {"int8_t", "i8"},
-          {"int16_t", "i16"},
-          {"int32_t", "i32"},
-          {"int64_t", "i64"},
-          {"std::int8_t", "i8"},
-          {"std::int16_t", "i16"},
-          {"std::int32_t", "i32"},
-          {"std::int64_t", "i64"},
-
-          {"uint8_t", "u8"},
-          {"uint16_t", "u16"},
-          {"uint32_t", "u32"},
-
-          {"uint64_t", "u64"},
-          {"std::uint8_t", "u8"},
-          {"std::uint16_t", "u16"},
-          {"std::uint32_t", "u32"},
-          {"std::uint64_t", "u64"},
-
-          {"char16_t", "u16"},
-          {"char32_t", "u32"},
-          {"wchar_t", "i32"},
-      });
-  auto it = kWellKnownTypes->find(cc_type);
-  if (it == kWellKnownTypes->end()) return std::nullopt;
+  const auto* it = std::lower_bound(
+      std::begin(kWellKnownTypes), std::end(kWellKnownTypes), cc_type,
+      [](const std::pair<absl::string_view, absl::string_view>& entry,
+         absl::string_view name) { return entry.first < name; });
+  if (it == std::end(kWellKnownTypes) || it->first != cc_type) {
+    return std::nullopt;
+  }
   return it->second;
 }
 
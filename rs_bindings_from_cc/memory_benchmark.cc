@@ -0,0 +1,182 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Peak-memory guardrail over the golden corpus: runs
+// `GenerateBindingsAndMetadata` on every header fixture in
+// rs_bindings_from_cc/test/golden (read from the runfiles, so the corpus and
+// the benchmark cannot drift apart), reports the process's peak RSS, the
+// Rust-side allocation statistics from common/rust_allocator_shims.c, and
+// the per-phase allocation deltas from the timing report, and exits
+// non-zero when a configured threshold is exceeded.
+//
+// Run with:
+//   bazel run -c opt //rs_bindings_from_cc:memory_benchmark -- \
+//       --max_peak_rss_mb=N --max_rust_peak_mb=M
+//
+// With the threshold flags at their defaults (0 = unlimited) the binary only
+// reports, which is the mode to use for establishing a baseline; CI runs it
+// with thresholds a comfortable margin above that baseline so that a change
+// that doubles peak memory fails loudly instead of OOM-killing workers.
+
+#include <stddef.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "common/file_io.h"
+#include "common/timing.h"
+#include "rs_bindings_from_cc/cmdline.h"
+#include "rs_bindings_from_cc/generate_bindings_and_metadata.h"
+#include "rs_bindings_from_cc/ir.h"
+
+ABSL_FLAG(int64_t, max_peak_rss_mb, 0,
+          "Fail if the peak RSS after processing the whole corpus exceeds "
+          "this many MiB. 0 means report only.");
+ABSL_FLAG(int64_t, max_rust_peak_mb, 0,
+          "Fail if the peak of live Rust-side allocations exceeds this many "
+          "MiB. 0 means report only.");
+
+// The Rust allocation counters from common/rust_allocator_shims.c; weak so
+// the binary still links (and the numbers read as zero) if the shims are
+// ever dropped from the link.
+extern "C" {
+__attribute__((weak)) size_t crubit_rust_allocated_bytes(void);
+__attribute__((weak)) size_t crubit_rust_peak_bytes(void);
+}
+
+namespace crubit {
+namespace {
+
+constexpr absl::string_view kGoldenDir = "rs_bindings_from_cc/test/golden";
+
+int64_t PeakRssKb() {
+  struct rusage usage = {};
+  CHECK_EQ(getrusage(RUSAGE_SELF, &usage), 0);
+  // ru_maxrss is in KiB on Linux.
+  return usage.ru_maxrss;
+}
+
+int64_t RustAllocatedBytes() {
+  return crubit_rust_allocated_bytes != nullptr
+             ? static_cast<int64_t>(crubit_rust_allocated_bytes())
+             : 0;
+}
+
+int RunMemoryBenchmark() {
+  // Load the whole corpus up front: the fixtures include each other by full
+  // path, so every run gets the complete set as virtual headers.
+  std::vector<std::string> fixture_paths;
+  for (const auto& entry : std::filesystem::directory_iterator(
+           std::string(kGoldenDir))) {
+    if (entry.path().extension() == ".h") {
+      fixture_paths.push_back(entry.path().string());
+    }
+  }
+  CHECK(!fixture_paths.empty())
+      << "no golden headers found under " << kGoldenDir
+      << "; run through bazel so the runfiles are present";
+  std::sort(fixture_paths.begin(), fixture_paths.end());
+
+  absl::flat_hash_map<const HeaderName, const std::string> virtual_headers;
+  std::string targets_and_headers = "[";
+  for (const std::string& path : fixture_paths) {
+    absl::StatusOr<std::string> contents = GetFileContents(path);
+    CHECK_OK(contents);
+    virtual_headers.insert({HeaderName(path), *std::move(contents)});
+    absl::StrAppend(&targets_and_headers,
+                    targets_and_headers.size() > 1 ? ",\n" : "\n",
+                    R"({"t": "//)", kGoldenDir, ":",
+                    std::filesystem::path(path).stem().string(), R"(", "h": [")",
+                    path, R"("]})");
+  }
+  absl::StrAppend(&targets_and_headers, "\n]");
+
+  int failures = 0;
+  for (const std::string& path : fixture_paths) {
+    std::string target =
+        absl::StrCat("//", kGoldenDir, ":",
+                     std::filesystem::path(path).stem().string());
+    // Empty formatter paths select the in-process printers; subprocesses
+    // would not show up in this process's memory statistics anyway.
+    absl::StatusOr<Cmdline> cmdline = Cmdline::CreateForTesting(
+        target, "cc_out", "rs_out", "ir_out", "namespaces_out",
+        "crubit_support_path", /* clang_format_exe_path= */ "",
+        /* rustfmt_exe_path= */ "", /* rustfmt_config_path= */ "",
+        /* do_nothing= */ false,
+        /* public_headers= */ {path}, targets_and_headers,
+        /* extra_rs_sources= */ {},
+        /* srcs_to_scan_for_instantiations= */ {},
+        /* instantiations_out= */ "",
+        /* error_report_out= */ "");
+    CHECK_OK(cmdline);
+
+    int64_t rust_alloc_before = RustAllocatedBytes();
+    absl::StatusOr<BindingsAndMetadata> result = GenerateBindingsAndMetadata(
+        *cmdline, /* clang_args= */ {}, virtual_headers);
+    if (!result.ok()) {
+      ++failures;
+      std::fprintf(stderr, "%-60s FAILED: %s\n", path.c_str(),
+                   result.status().ToString().c_str());
+      continue;
+    }
+    std::fprintf(stderr,
+                 "%-60s items=%5zu peak_rss_kb=%9ld rust_alloc_delta_kb=%9ld\n",
+                 path.c_str(), result->ir.items.size(), PeakRssKb(),
+                 (RustAllocatedBytes() - rust_alloc_before) / 1024);
+  }
+  CHECK_LT(failures, static_cast<int>(fixture_paths.size()))
+      << "every fixture failed; the corpus setup is broken";
+
+  std::string timing_report = TimingReportAsJson();
+  std::fprintf(stderr, "Per-phase breakdown (whole corpus):\n%s\n",
+               timing_report.c_str());
+
+  int64_t peak_rss_mb = PeakRssKb() / 1024;
+  int64_t rust_peak_mb =
+      crubit_rust_peak_bytes != nullptr
+          ? static_cast<int64_t>(crubit_rust_peak_bytes()) / (1024 * 1024)
+          : 0;
+  std::fprintf(stderr,
+               "Corpus summary: fixtures=%zu failures=%d peak_rss_mb=%ld "
+               "rust_peak_mb=%ld\n",
+               fixture_paths.size(), failures, peak_rss_mb, rust_peak_mb);
+
+  int exit_code = 0;
+  int64_t max_peak_rss_mb = absl::GetFlag(FLAGS_max_peak_rss_mb);
+  if (max_peak_rss_mb > 0 && peak_rss_mb > max_peak_rss_mb) {
+    std::fprintf(stderr, "FAIL: peak RSS %ld MiB exceeds --max_peak_rss_mb=%ld\n",
+                 peak_rss_mb, max_peak_rss_mb);
+    exit_code = 1;
+  }
+  int64_t max_rust_peak_mb = absl::GetFlag(FLAGS_max_rust_peak_mb);
+  if (max_rust_peak_mb > 0 && rust_peak_mb > max_rust_peak_mb) {
+    std::fprintf(stderr,
+                 "FAIL: Rust allocation peak %ld MiB exceeds "
+                 "--max_rust_peak_mb=%ld\n",
+                 rust_peak_mb, max_rust_peak_mb);
+    exit_code = 1;
+  }
+  return exit_code;
+}
+
+}  // namespace
+}  // namespace crubit
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  crubit::EnableTimingCollection();
+  return crubit::RunMemoryBenchmark();
+}
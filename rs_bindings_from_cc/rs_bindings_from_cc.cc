@@ -5,37 +5,138 @@
 // Parses C++ headers and generates:
 // * a Rust source file with bindings for the C++ API
 // * a C++ source file with the implementation of the bindings
+//
+// Besides the one-shot mode, the tool can run as a Bazel persistent worker
+// (`--persistent_worker`), serving sequential work requests over the JSON
+// worker protocol on stdin/stdout. This keeps LLVM initialization and any
+// in-process caches warm across targets instead of paying process startup per
+// Bazel action.
 
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/parse.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "common/file_io.h"
+#include "common/fingerprint.h"
 #include "common/status_macros.h"
+#include "common/timing.h"
 #include "rs_bindings_from_cc/cmdline.h"
 #include "rs_bindings_from_cc/collect_namespaces.h"
 #include "rs_bindings_from_cc/generate_bindings_and_metadata.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace crubit {
 
-std::string InstantiationsAsJson(
-    const BindingsAndMetadata& bindings_and_metadata) {
-  llvm::json::Object obj;
-  for (const auto& entry : bindings_and_metadata.instantiations) {
-    obj[entry.first] = entry.second;
+// Computes a manifest digest over everything that determines this
+// invocation's outputs: a format version, the Clang arguments, and the path,
+// owning target and content of every header in `--targets_and_headers` (the
+// transitive closure that Bazel declares for this action). Returns
+// `std::nullopt` if some input cannot be read; the caller then regenerates
+// unconditionally. File contents are read through `GetFileBuffer`, so each
+// header is hashed straight out of a memory-mapped buffer and never copied.
+std::optional<std::string> ComputeInputFingerprint(
+    const Cmdline& cmdline, const std::vector<std::string>& clang_args) {
+  Fingerprint fingerprint;
+  fingerprint.Update("rs_bindings_from_cc_fingerprint_v1");
+  fingerprint.Update(cmdline.current_target().value());
+  for (const std::string& arg : clang_args) {
+    fingerprint.Update(arg);
   }
-  return std::string(llvm::formatv("{0:2}", llvm::json::Value(std::move(obj))));
+
+  std::vector<const HeaderName*> headers;
+  headers.reserve(cmdline.headers_to_targets().size());
+  for (const auto& [header, target] : cmdline.headers_to_targets()) {
+    headers.push_back(&header);
+  }
+  std::sort(headers.begin(), headers.end(),
+            [](const HeaderName* a, const HeaderName* b) {
+              return a->IncludePath() < b->IncludePath();
+            });
+  for (const HeaderName* header : headers) {
+    absl::StatusOr<std::unique_ptr<llvm::MemoryBuffer>> contents =
+        GetFileBuffer(header->IncludePath());
+    if (!contents.ok()) return std::nullopt;
+    fingerprint.Update(header->IncludePath());
+    fingerprint.Update(
+        cmdline.headers_to_targets().find(*header)->second.value());
+    fingerprint.Update(BufferContents(**contents));
+  }
+  return std::move(fingerprint).HexDigest();
 }
 
-absl::Status Main(absl::Span<char* const> args) {
-  CRUBIT_ASSIGN_OR_RETURN(Cmdline cmdline, Cmdline::Create());
+// Returns true if the fingerprint manifest at `cmdline.fingerprint_out()`
+// matches `fingerprint` and every requested output already exists, i.e. the
+// previous run's outputs are up to date for the current inputs.
+bool OutputsAreUpToDate(const Cmdline& cmdline,
+                        const std::string& fingerprint) {
+  absl::StatusOr<std::unique_ptr<llvm::MemoryBuffer>> previous =
+      GetFileBuffer(cmdline.fingerprint_out());
+  if (!previous.ok() || BufferContents(**previous) != fingerprint) return false;
+  for (absl::string_view output :
+       {cmdline.rs_out(), cmdline.cc_out(), cmdline.ir_out(),
+        cmdline.instantiations_out(), cmdline.namespaces_out(),
+        cmdline.error_report_out()}) {
+    if (!output.empty() && !llvm::sys::fs::exists(output)) return false;
+  }
+  return true;
+}
+
+// Serializes the instantiations map into the sorted binary format read by
+// `support/cc_template/cc_template_impl.rs`, which documents the layout: a
+// magic/count header, a fixed-width entry table sorted by key bytes, then a
+// string heap. The sorted table lets the consumer binary-search the raw
+// (e.g. memory-mapped) bytes per lookup instead of parsing the whole map,
+// and makes the output byte-for-byte deterministic for caching.
+std::string InstantiationsAsBinaryMap(
+    const absl::flat_hash_map<std::string, std::string>& instantiations) {
+  std::vector<std::pair<absl::string_view, absl::string_view>> entries;
+  entries.reserve(instantiations.size());
+  for (const auto& entry : instantiations) {
+    entries.push_back({entry.first, entry.second});
+  }
+  std::sort(entries.begin(), entries.end());
+
+  std::string out;
+  auto append_u32 = [&out](uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+  };
+  out.append("CIM1");
+  append_u32(entries.size());
+  uint32_t offset = 8 + 16 * entries.size();
+  for (const auto& [key, value] : entries) {
+    append_u32(offset);
+    append_u32(key.size());
+    offset += key.size();
+    append_u32(offset);
+    append_u32(value.size());
+    offset += value.size();
+  }
+  for (const auto& [key, value] : entries) {
+    out.append(key.data(), key.size());
+    out.append(value.data(), value.size());
+  }
+  return out;
+}
 
+// Runs a single bindings-generation invocation described by `cmdline`.
+absl::Status GenerateBindings(const Cmdline& cmdline,
+                              std::vector<std::string> clang_args) {
   if (cmdline.do_nothing()) {
     CRUBIT_RETURN_IF_ERROR(SetFileContents(
         cmdline.rs_out(),
@@ -44,55 +145,175 @@ absl::Status Main(absl::Span<char* const> args) {
         cmdline.cc_out(),
         "// intentionally left empty because --do_nothing was passed."));
     if (!cmdline.instantiations_out().empty()) {
-      CRUBIT_RETURN_IF_ERROR(
-          SetFileContents(cmdline.instantiations_out(), "[]"));
+      CRUBIT_RETURN_IF_ERROR(SetFileContents(cmdline.instantiations_out(),
+                                             InstantiationsAsBinaryMap({})));
     }
     if (!cmdline.namespaces_out().empty()) {
-      CRUBIT_RETURN_IF_ERROR(SetFileContents(cmdline.namespaces_out(), "[]"));
+      CRUBIT_RETURN_IF_ERROR(SetFileContents(
+          cmdline.namespaces_out(),
+          NamespacesAsBinary(
+              NamespacesHierarchy{cmdline.current_target(), {}})));
     }
     return absl::OkStatus();
   }
 
-  std::vector<std::string> clang_args;
-  clang_args.insert(clang_args.end(), args.begin(), args.end());
+  if (!cmdline.timing_report_out().empty()) {
+    EnableTimingCollection();
+  }
+  if (cmdline.stable_item_ids()) {
+    EnableStableItemIds();
+  }
+  if (cmdline.no_doc_comments()) {
+    DisableDocComments();
+  }
+
+  // Incremental no-op detection: if the inputs fingerprint to the same
+  // manifest as the previous run and all requested outputs exist, there is
+  // nothing to do - in particular, no CompilerInstance is ever constructed.
+  std::optional<std::string> fingerprint;
+  if (!cmdline.fingerprint_out().empty()) {
+    fingerprint = ComputeInputFingerprint(cmdline, clang_args);
+    if (fingerprint.has_value() && OutputsAreUpToDate(cmdline, *fingerprint)) {
+      return absl::OkStatus();
+    }
+  }
 
   CRUBIT_ASSIGN_OR_RETURN(
       BindingsAndMetadata bindings_and_metadata,
       GenerateBindingsAndMetadata(cmdline, std::move(clang_args)));
 
+  // The outputs are independent of one another, so each is queued on a
+  // background thread as soon as its contents exist: the writes overlap the
+  // remaining serializations (and each other) instead of running back to
+  // back at the end. The queued views stay valid because
+  // `bindings_and_metadata` and the serialized strings outlive `Join`.
+  AsyncFileWriter writer;
+
+  std::string ir_json;
   if (!cmdline.ir_out().empty()) {
-    CRUBIT_RETURN_IF_ERROR(
-        SetFileContents(cmdline.ir_out(), IrToJson(bindings_and_metadata.ir)));
+    // The IR artifact travels through the remote cache, so it is compressed
+    // for transport; readers sniff the magic header and accept both forms.
+    ir_json = CompressIrPayload(IrToJson(bindings_and_metadata.ir));
+    writer.Write(cmdline.ir_out(), ir_json);
   }
 
-  CRUBIT_RETURN_IF_ERROR(
-      SetFileContents(cmdline.rs_out(), bindings_and_metadata.rs_api));
-  CRUBIT_RETURN_IF_ERROR(
-      SetFileContents(cmdline.cc_out(), bindings_and_metadata.rs_api_impl));
+  if (cmdline.thin_ir_only()) {
+    // Only the IR is consumed downstream; the source outputs are written as
+    // placeholders so that Bazel still sees all declared outputs.
+    writer.Write(
+        cmdline.rs_out(),
+        "// intentionally left empty because --thin_ir_only was passed.");
+    writer.Write(
+        cmdline.cc_out(),
+        "// intentionally left empty because --thin_ir_only was passed.");
+  } else {
+    writer.Write(cmdline.rs_out(), bindings_and_metadata.rs_api.value());
+    writer.Write(cmdline.cc_out(), bindings_and_metadata.rs_api_impl.value());
+  }
 
+  std::string instantiations_map;
   if (!cmdline.instantiations_out().empty()) {
-    CRUBIT_RETURN_IF_ERROR(
-        SetFileContents(cmdline.instantiations_out(),
-                        InstantiationsAsJson(bindings_and_metadata)));
+    instantiations_map =
+        InstantiationsAsBinaryMap(bindings_and_metadata.instantiations);
+    writer.Write(cmdline.instantiations_out(), instantiations_map);
   }
 
+  std::string namespaces_manifest;
   if (!cmdline.namespaces_out().empty()) {
-    CRUBIT_RETURN_IF_ERROR(SetFileContents(
-        cmdline.namespaces_out(),
-        crubit::NamespacesAsJson(bindings_and_metadata.namespaces)));
+    namespaces_manifest =
+        crubit::NamespacesAsBinary(bindings_and_metadata.namespaces);
+    writer.Write(cmdline.namespaces_out(), namespaces_manifest);
   }
 
   if (!cmdline.error_report_out().empty()) {
-    CRUBIT_RETURN_IF_ERROR(SetFileContents(cmdline.error_report_out(),
-                                           bindings_and_metadata.error_report));
+    writer.Write(cmdline.error_report_out(),
+                 bindings_and_metadata.error_report.value());
+  }
+
+  CRUBIT_RETURN_IF_ERROR(writer.Join());
+
+  // Written last, so a partially failed run never claims to be up to date.
+  if (fingerprint.has_value()) {
+    CRUBIT_RETURN_IF_ERROR(
+        SetFileContents(cmdline.fingerprint_out(), *fingerprint));
+  }
+
+  if (!cmdline.timing_report_out().empty()) {
+    RecordTimingCount("ir_items", bindings_and_metadata.ir.items.size());
+    CRUBIT_RETURN_IF_ERROR(
+        SetFileContents(cmdline.timing_report_out(), TimingReportAsJson()));
   }
 
   return absl::OkStatus();
 }
 
+absl::Status Main(absl::Span<char* const> args) {
+  CRUBIT_ASSIGN_OR_RETURN(Cmdline cmdline, Cmdline::Create());
+  std::vector<std::string> clang_args(args.begin(), args.end());
+  return GenerateBindings(cmdline, std::move(clang_args));
+}
+
+// Serves work requests over Bazel's JSON persistent worker protocol: one JSON
+// object per line on stdin ({"arguments": [...], "requestId": n}), one JSON
+// response per line on stdout. See
+// https://bazel.build/remote/persistent#json-protocol. Returns the process
+// exit code (non-zero only if the protocol stream itself is broken; per
+// request failures are reported via the response's `exitCode`).
+int RunPersistentWorker() {
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    int64_t request_id = 0;
+    int exit_code = 0;
+    std::string output;
+
+    llvm::Expected<llvm::json::Value> request = llvm::json::parse(line);
+    const llvm::json::Object* request_obj =
+        request ? request->getAsObject() : nullptr;
+    if (request_obj == nullptr) {
+      exit_code = 1;
+      output = request ? "malformed work request: expected a JSON object"
+                       : llvm::toString(request.takeError());
+    } else {
+      request_id = request_obj->getInteger("requestId").value_or(0);
+      std::vector<std::string> args;
+      if (const llvm::json::Array* arguments =
+              request_obj->getArray("arguments")) {
+        for (const llvm::json::Value& argument : *arguments) {
+          args.push_back(std::string(argument.getAsString().value_or("")));
+        }
+      }
+      std::vector<std::string> clang_args;
+      absl::StatusOr<Cmdline> cmdline =
+          Cmdline::CreateFromWorkerArgs(std::move(args), clang_args);
+      absl::Status status =
+          cmdline.ok() ? GenerateBindings(*cmdline, std::move(clang_args))
+                       : cmdline.status();
+      if (!status.ok()) {
+        exit_code = 1;
+        output = std::string(status.message());
+      }
+    }
+
+    llvm::json::Object response{{"exitCode", exit_code},
+                                {"requestId", request_id},
+                                {"output", output}};
+    llvm::outs() << llvm::json::Value(std::move(response)) << "\n";
+    llvm::outs().flush();
+  }
+  return 0;
+}
+
 }  // namespace crubit
 
 int main(int argc, char* argv[]) {
+  // Bazel appends `--persistent_worker` when it launches the tool as a
+  // persistent worker; detect it before flag parsing since it is not an absl
+  // flag.
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i] == absl::string_view("--persistent_worker")) {
+      return crubit::RunPersistentWorker();
+    }
+  }
   auto args = absl::ParseCommandLine(argc, argv);
   absl::Status status = crubit::Main(args);
   if (!status.ok()) {
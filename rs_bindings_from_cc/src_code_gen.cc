@@ -7,10 +7,7 @@
 #include <string>
 
 #include "common/ffi_types.h"
-#include "common/status_macros.h"
 #include "rs_bindings_from_cc/ir.h"
-#include "llvm/Support/FormatVariadic.h"
-#include "llvm/Support/JSON.h"
 
 namespace crubit {
 
@@ -22,49 +19,35 @@ struct FfiBindings {
 };
 
 // This function is implemented in Rust.
-extern "C" FfiBindings GenerateBindingsImpl(FfiU8Slice json,
+extern "C" FfiBindings GenerateBindingsImpl(FfiU8Slice ir,
                                             FfiU8Slice crubit_support_path,
                                             FfiU8Slice clang_format_exe_path,
                                             FfiU8Slice rustfmt_exe_path,
                                             FfiU8Slice rustfmt_config_path,
                                             bool generate_error_report);
 
-// Creates `Bindings` instance from copied data from `ffi_bindings`.
-static absl::StatusOr<Bindings> MakeBindingsFromFfiBindings(
-    const FfiBindings& ffi_bindings) {
+// Creates a `Bindings` instance that adopts the Rust-allocated buffers in
+// `ffi_bindings` without copying them.  The buffers are freed via the Rust
+// deallocator when the returned `Bindings` is destroyed.
+static Bindings MakeBindingsFromFfiBindings(FfiBindings ffi_bindings) {
   Bindings bindings;
-
-  const FfiU8SliceBox& rs_api = ffi_bindings.rs_api;
-  const FfiU8SliceBox& rs_api_impl = ffi_bindings.rs_api_impl;
-  const FfiU8SliceBox& error_report = ffi_bindings.error_report;
-
-  bindings.rs_api = std::string(rs_api.ptr, rs_api.size);
-  bindings.rs_api_impl = std::string(rs_api_impl.ptr, rs_api_impl.size);
-  bindings.error_report = std::string(error_report.ptr, error_report.size);
+  bindings.rs_api = ScopedFfiU8SliceBox(ffi_bindings.rs_api);
+  bindings.rs_api_impl = ScopedFfiU8SliceBox(ffi_bindings.rs_api_impl);
+  bindings.error_report = ScopedFfiU8SliceBox(ffi_bindings.error_report);
   return bindings;
 }
 
-// Deallocates given `ffi_bindings` instance that was created in Rust.
-static void FreeFfiBindings(FfiBindings ffi_bindings) {
-  FreeFfiU8SliceBox(ffi_bindings.rs_api);
-  FreeFfiU8SliceBox(ffi_bindings.rs_api_impl);
-  FreeFfiU8SliceBox(ffi_bindings.error_report);
-}
-
 absl::StatusOr<Bindings> GenerateBindings(
     const IR& ir, absl::string_view crubit_support_path,
     absl::string_view clang_format_exe_path, absl::string_view rustfmt_exe_path,
     absl::string_view rustfmt_config_path, bool generate_error_report) {
-  std::string json = llvm::formatv("{0}", ir.ToJson());
+  std::string serialized_ir = IrToBinary(ir);
 
   FfiBindings ffi_bindings = GenerateBindingsImpl(
-      MakeFfiU8Slice(json), MakeFfiU8Slice(crubit_support_path),
+      MakeFfiU8Slice(serialized_ir), MakeFfiU8Slice(crubit_support_path),
       MakeFfiU8Slice(clang_format_exe_path), MakeFfiU8Slice(rustfmt_exe_path),
       MakeFfiU8Slice(rustfmt_config_path), generate_error_report);
-  CRUBIT_ASSIGN_OR_RETURN(Bindings bindings,
-                          MakeBindingsFromFfiBindings(ffi_bindings));
-  FreeFfiBindings(ffi_bindings);
-  return bindings;
+  return MakeBindingsFromFfiBindings(ffi_bindings);
 }
 
 }  // namespace crubit
@@ -5,22 +5,22 @@
 #ifndef CRUBIT_RS_BINDINGS_FROM_CC_SRC_CODE_GEN_H_
 #define CRUBIT_RS_BINDINGS_FROM_CC_SRC_CODE_GEN_H_
 
-#include <string>
-
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "common/ffi_types.h"
 #include "rs_bindings_from_cc/ir.h"
 
 namespace crubit {
 
-// Source code for generated bindings.
+// Source code for generated bindings.  The buffers were allocated in Rust and
+// are adopted here without copying.
 struct Bindings {
   // Rust source code.
-  std::string rs_api;
+  ScopedFfiU8SliceBox rs_api;
   // C++ source code.
-  std::string rs_api_impl;
+  ScopedFfiU8SliceBox rs_api_impl;
   // Optional JSON error report.
-  std::string error_report;
+  ScopedFfiU8SliceBox error_report;
 };
 
 // Generates bindings from the given `IR`.
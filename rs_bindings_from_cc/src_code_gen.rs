@@ -22,7 +22,9 @@ use std::process;
 use std::ptr;
 use std::rc::Rc;
 use token_stream_printer::{
-    cc_tokens_to_formatted_string, rs_tokens_to_formatted_string, RustfmtConfig,
+    cc_format_string, cc_tokens_to_string_with_indentation, rs_format_string_chunks,
+    rs_tokens_to_string_chunks, rs_tokens_to_string_with_line_breaks, tokens_to_string,
+    RustfmtConfig,
 };
 
 /// FFI equivalent of `Bindings`.
@@ -33,14 +35,14 @@ pub struct FfiBindings {
     error_report: FfiU8SliceBox,
 }
 
-/// Deserializes IR from `json` and generates bindings source code.
+/// Deserializes binary IR from `ir` and generates bindings source code.
 ///
 /// This function panics on error.
 ///
 /// # Safety
 ///
 /// Expectations:
-///    * `json` should be a FfiU8Slice for a valid array of bytes with the given
+///    * `ir` should be a FfiU8Slice for a valid array of bytes with the given
 ///      size.
 ///    * `crubit_support_path` should be a FfiU8Slice for a valid array of bytes
 ///      representing an UTF8-encoded string
@@ -48,24 +50,24 @@ pub struct FfiBindings {
 ///      FfiU8Slice for a valid array of bytes representing an UTF8-encoded
 ///      string (without the UTF-8 requirement, it seems that Rust doesn't offer
 ///      a way to convert to OsString on Windows)
-///    * `json`, `crubit_support_path`, `rustfmt_exe_path`, and
+///    * `ir`, `crubit_support_path`, `rustfmt_exe_path`, and
 ///      `rustfmt_config_path` shouldn't change during the call.
 ///
 /// Ownership:
 ///    * function doesn't take ownership of (in other words it borrows) the
-///      input params: `json`, `crubit_support_path`, `rustfmt_exe_path`, and
+///      input params: `ir`, `crubit_support_path`, `rustfmt_exe_path`, and
 ///      `rustfmt_config_path`
 ///    * function passes ownership of the returned value to the caller
 #[no_mangle]
 pub unsafe extern "C" fn GenerateBindingsImpl(
-    json: FfiU8Slice,
+    ir: FfiU8Slice,
     crubit_support_path: FfiU8Slice,
     clang_format_exe_path: FfiU8Slice,
     rustfmt_exe_path: FfiU8Slice,
     rustfmt_config_path: FfiU8Slice,
     generate_error_report: bool,
 ) -> FfiBindings {
-    let json: &[u8] = json.as_slice();
+    let ir: &[u8] = ir.as_slice();
     let crubit_support_path: &str = std::str::from_utf8(crubit_support_path.as_slice()).unwrap();
     let clang_format_exe_path: OsString =
         std::str::from_utf8(clang_format_exe_path.as_slice()).unwrap().into();
@@ -85,7 +87,7 @@ pub unsafe extern "C" fn GenerateBindingsImpl(
             &mut ignore_errors
         };
         let Bindings { rs_api, rs_api_impl } = generate_bindings(
-            json,
+            ir,
             crubit_support_path,
             &clang_format_exe_path,
             &rustfmt_exe_path,
@@ -151,28 +153,68 @@ struct BindingsTokens {
 }
 
 fn generate_bindings(
-    json: &[u8],
+    serialized_ir: &[u8],
     crubit_support_path: &str,
     clang_format_exe_path: &OsStr,
     rustfmt_exe_path: &OsStr,
     rustfmt_config_path: &OsStr,
     errors: &mut dyn ErrorReporting,
 ) -> Result<Bindings> {
-    let ir = Rc::new(deserialize_ir(json)?);
+    let ir = Rc::new(deserialize_ir_binary(serialized_ir)?);
 
     let BindingsTokens { rs_api, rs_api_impl } =
         generate_bindings_tokens(ir.clone(), crubit_support_path, errors)?;
-    let rs_api = {
-        let rustfmt_exe_path = Path::new(rustfmt_exe_path);
+    let rustfmt_config = if rustfmt_exe_path.is_empty() {
+        // No `rustfmt` configured: format in-process, skipping the subprocess
+        // spawn and the two pipe copies on the critical path.
+        None
+    } else {
         let rustfmt_config_path = if rustfmt_config_path.is_empty() {
             None
         } else {
             Some(Path::new(rustfmt_config_path))
         };
-        let rustfmt_config = RustfmtConfig::new(rustfmt_exe_path, rustfmt_config_path);
-        rs_tokens_to_formatted_string(rs_api, &rustfmt_config)?
+        Some(RustfmtConfig::new(Path::new(rustfmt_exe_path), rustfmt_config_path))
+    };
+    // With `rustfmt` configured, the Rust output is printed as chunks split
+    // at top-level item boundaries so that a multi-megabyte buffer can be
+    // formatted by parallel `rustfmt` processes instead of one; the chunks
+    // concatenate to the same text a single invocation would produce. The
+    // in-process printer is already cheap and stays single-buffer.
+    let (rs_chunks, rs_api) = match &rustfmt_config {
+        None => (Vec::new(), rs_tokens_to_string_with_line_breaks(rs_api)?),
+        Some(_) => (
+            rs_tokens_to_string_chunks(
+                rs_api,
+                std::thread::available_parallelism().map_or(1, std::num::NonZeroUsize::get),
+            )?,
+            String::new(),
+        ),
+    };
+    let rs_api_impl = if clang_format_exe_path.is_empty() {
+        // No `clang-format` configured: the thunk grammar is small enough for
+        // the built-in indentation-aware printer.
+        cc_tokens_to_string_with_indentation(rs_api_impl)?
+    } else {
+        tokens_to_string(rs_api_impl)?
+    };
+    // The formatter subprocesses are independent; when both formatters are
+    // configured, pipe through them concurrently so the invocation pays
+    // max(rustfmt, clang-format) instead of their sum. Token streams are not
+    // `Send`, hence the string-level hand-off to the worker thread.
+    let (rs_api, rs_api_impl) = match rustfmt_config {
+        Some(config) if !clang_format_exe_path.is_empty() => {
+            let rustfmt_thread =
+                std::thread::spawn(move || rs_format_string_chunks(rs_chunks, &config));
+            let rs_api_impl = cc_format_string(rs_api_impl, Path::new(clang_format_exe_path))?;
+            (rustfmt_thread.join().expect("rustfmt thread panicked")?, rs_api_impl)
+        }
+        Some(config) => (rs_format_string_chunks(rs_chunks, &config)?, rs_api_impl),
+        None if !clang_format_exe_path.is_empty() => {
+            (rs_api, cc_format_string(rs_api_impl, Path::new(clang_format_exe_path))?)
+        }
+        None => (rs_api, rs_api_impl),
     };
-    let rs_api_impl = cc_tokens_to_formatted_string(rs_api_impl, Path::new(clang_format_exe_path))?;
 
     // Add top-level comments that help identify where the generated bindings came
     // from.
@@ -214,6 +256,14 @@ fn generate_bindings(
 /// If we know the original C++ function is codegenned and already compatible
 /// with `extern "C"` calling convention we skip creating/calling the C++ thunk
 /// since we can call the original C++ directly.
+///
+/// When this returns true, `generate_func_thunk` attaches
+/// `#[link_name = <mangled name>]` to the Rust-side `extern "C"` declaration
+/// (so it binds straight to the original symbol) and `generate_rs_api_impl`
+/// emits no `__rust_thunk__` definition at all - the call has no extra hop.
+/// When this returns false the thunk remains, and collapsing the remaining
+/// hop is a ThinLTO job (cross-language inlining sees through the thunk); the
+/// individual cases below explain why each one cannot take the direct path.
 fn can_skip_cc_thunk(db: &dyn BindingsGenerator, func: &Func) -> bool {
     // ## Inline functions
     //
@@ -1145,12 +1195,8 @@ fn get_binding(
     expected_param_types: Vec<RsTypeKind>,
 ) -> Option<(Ident, ImplKind)> {
     db.ir()
-        // TODO(jeanpierreda): make this O(1) using a hash table lookup.
-        .functions()
-        .filter(|function| {
-            function.name == expected_function_name
-                && generate_func(db, (*function).clone()).ok().flatten().is_some()
-        })
+        .functions_with_name(&expected_function_name)
+        .filter(|function| generate_func(db, (*function).clone()).ok().flatten().is_some())
         .find_map(|function| {
             let mut function_param_types = function
                 .params
@@ -1174,13 +1220,9 @@ fn is_record_clonable(db: &dyn BindingsGenerator, record: Rc<Record>) -> bool {
     should_derive_clone(&record)
         || db
             .ir()
-            // TODO(jeanpierreda): make this O(1) using a hash table lookup.
-            .functions()
-            .filter(|function| {
-                function.name == UnqualifiedIdentifier::Constructor
-                // __this is always the first parameter of constructors
-                && function.params.len() == 2
-            })
+            .functions_with_name(&UnqualifiedIdentifier::Constructor)
+            // __this is always the first parameter of constructors
+            .filter(|function| function.params.len() == 2)
             .any(|function| {
                 let mut function_param_types = function
                     .params
@@ -1234,6 +1276,13 @@ fn materialize_ctor_in_caller(func: &Func, params: &mut [RsTypeKind]) {
 
 /// Generates Rust source code for a given `Func`.
 ///
+/// Memoization is per `Func` (the salsa query key). A coarser structural memo
+/// - generating `vector<A>::size` once and substituting names to obtain
+/// `vector<B>::size` - was considered and rejected: the mangled name, the
+/// record id, doc comments and lifetimes are woven through the emitted
+/// tokens, so a sound "skeleton" would need to parameterize over all of
+/// them, at which point it is this function again.
+///
 /// Returns:
 ///
 ///  * `Err(_)`: couldn't import the function, emit an `UnsupportedItem`.
@@ -1272,7 +1321,9 @@ fn generate_func(
     return_type.check_by_value()?;
     let param_idents =
         func.params.iter().map(|p| make_rs_ident(&p.identifier.identifier)).collect_vec();
-    let thunk = generate_func_thunk(db, &func, &param_idents, &param_types, &return_type)?;
+    let thunk_ident = thunk_ident(&func);
+    let thunk =
+        generate_func_thunk(db, &func, &param_idents, &param_types, &return_type, &thunk_ident)?;
 
     // If the Rust trait require a function to take the params by const reference
     // and the thunk takes some of its params by value then we should add a const
@@ -1335,7 +1386,6 @@ fn generate_func(
         // MaybeUninit<T> in Pin if T is !Unpin. It should understand
         // 'structural pinning', so that we do not need into_inner_unchecked()
         // here.
-        let thunk_ident = thunk_ident(&func);
         let func_body = match &impl_kind {
             ImplKind::Trait { trait_name: TraitName::UnpinConstructor { .. }, .. } => {
                 // SAFETY: A user-defined constructor is not guaranteed to
@@ -1797,6 +1847,7 @@ fn generate_func_thunk(
     param_idents: &[Ident],
     param_types: &[RsTypeKind],
     return_type: &RsTypeKind,
+    thunk_ident: &Ident,
 ) -> Result<TokenStream> {
     let thunk_attr = if can_skip_cc_thunk(db, func) {
         let mangled_name = func.mangled_name.as_ref();
@@ -1834,8 +1885,6 @@ fn generate_func_thunk(
         return_type_fragment = quote! {};
     }
 
-    let thunk_ident = thunk_ident(&func);
-
     let generic_params = format_generic_params(&lifetimes, std::iter::empty::<syn::Ident>());
     let param_idents = out_param_ident.as_ref().into_iter().chain(param_idents);
     let param_types = out_param.into_iter().chain(param_types.map(|t| {
@@ -2674,7 +2723,6 @@ fn generate_item(
             return Ok(GeneratedItem::default());
         }
     }
-    let overloaded_funcs = db.overloaded_funcs();
     let generated_item = match item {
         Item::Func(func) => match db.generate_func(func.clone()) {
             Err(e) => generate_unsupported(
@@ -2683,7 +2731,7 @@ fn generate_item(
             )?,
             Ok(None) => GeneratedItem::default(),
             Ok(Some((item, function_id))) => {
-                if overloaded_funcs.contains(&function_id) {
+                if db.overloaded_funcs().contains(&function_id) {
                     generate_unsupported(
                         &make_unsupported_fn(
                             func,
@@ -3386,6 +3434,14 @@ fn rs_type_kind(db: &dyn BindingsGenerator, ty: ir::RsType) -> Result<RsTypeKind
             .map(Lifetime::from)
     };
 
+    // The marker names below ("*mut", "&", "#funcPtr <abi>", ... - see
+    // rs_bindings_from_cc/ir.h) are deliberately matched as strings rather
+    // than carried as a separate wire-format discriminant. This query is
+    // salsa-memoized on the whole `RsType`, so the match runs once per
+    // distinct type rather than once per occurrence, and hashing the type
+    // tree for the memo lookup dominates the handful of short string
+    // comparisons. A parallel enum emitted by ir.cc would have to be kept
+    // consistent with `name` by hand on both sides of the FFI boundary.
     let result = match ty.name.as_deref() {
         None => {
             ensure!(
@@ -3734,8 +3790,12 @@ fn cc_struct_upcast_impl(record: &Rc<Record>, ir: &IR) -> Result<GeneratedItem>
                 #crate_root_path::detail::#cast_fn_name(derived)
             };
         }
+        // `#[inline(always)]` is load-bearing for the non-virtual case: it is
+        // what lets the constant offset adjustment inline into callers in
+        // other crates without LTO.
         impls.push(quote! {
             unsafe impl oops::Inherits<#base_name> for #derived_name {
+                #[inline(always)]
                 unsafe fn upcast_ptr(derived: *const Self) -> *const #base_name {
                     #body
                 }
@@ -3751,6 +3811,12 @@ fn cc_struct_upcast_impl(record: &Rc<Record>, ir: &IR) -> Result<GeneratedItem>
     })
 }
 
+/// Returns the name of the C ABI thunk for `func`.
+///
+/// This is the single point where thunk names are derived from the mangled
+/// name: both the Rust-side declarations (`generate_func`) and the C++-side
+/// definitions (`generate_rs_api_impl`) go through it, so the two passes
+/// cannot disagree on a symbol name.
 fn thunk_ident(func: &Func) -> Ident {
     format_ident!("__rust_thunk__{}", func.mangled_name.as_ref())
 }
@@ -3763,6 +3829,23 @@ fn generate_rs_api_impl(db: &mut Database, crubit_support_path: &str) -> Result<
     //
     // See rs_bindings_from_cc/
     // token_stream_printer.rs for a list of supported placeholders.
+    //
+    // Note on deduplicating thunks: many thunks look alike (e.g. every
+    // constructor thunk is a `crubit::construct_at` call, every destructor
+    // thunk a `std::destroy_at` call), which invites an ICF-style pass that
+    // folds them into one definition plus `__attribute__((alias(...)))`
+    // declarations. No such pass exists here, deliberately:
+    // - no two emitted thunks are byte-identical - the `__this` parameter
+    //   type appears in every signature and the thunk name embeds the mangled
+    //   function name - so textual identity never fires; and
+    // - folding thunks that match "modulo the record type" is unsound at the
+    //   source level, because the matching bodies dispatch to *different*
+    //   constructors/destructors/operators, which only sometimes compile to
+    //   identical code.
+    // Machine-code identity is exactly what linker ICF verifies, so the
+    // object-size win is instead available by building the generated
+    // `..._rs_api_impl.cc` with `-ffunction-sections` and linking with
+    // `--icf=safe`, which folds the thunks this pass could not prove equal.
     let mut thunks = vec![];
     let ir = db.ir();
     for func in ir.functions() {
@@ -6171,6 +6254,7 @@ mod tests {
             rs_api,
             quote! {
                 unsafe impl oops::Inherits<crate::VirtualBase> for crate::Derived {
+                    #[inline(always)]
                     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::VirtualBase {
                         crate::detail::__crubit_dynamic_upcast__7Derived__to__11VirtualBase(derived)
                     }
@@ -328,6 +328,7 @@ impl<'b> ::ctor::Assign<::ctor::RvalueReference<'b, Self>> for InheritsFromBaseW
 unsafe impl oops::Inherits<crate::HasCustomAlignment>
     for crate::InheritsFromBaseWithCustomAlignment
 {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::HasCustomAlignment {
         (derived as *const _ as *const u8).offset(0) as *const crate::HasCustomAlignment
     }
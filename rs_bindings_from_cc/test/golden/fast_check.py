@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+# Part of the Crubit project, under the Apache License v2.0 with LLVM
+# Exceptions. See /LICENSE for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Fast local runner for the golden-file tests.
+
+The Bazel suite spawns one generator action per fixture, so the edit-test
+loop on a codegen change is dominated by process startup and re-parsing.
+This driver builds the generator once, starts a pool of persistent worker
+processes (`--persistent_worker`, the same JSON protocol Bazel uses), pushes
+one work request per fixture through the pool, and diffs each output against
+the checked-in golden as soon as it arrives. Warm workers keep LLVM
+initialization and in-process caches across fixtures.
+
+Usage (from the workspace root):
+
+    rs_bindings_from_cc/test/golden/fast_check.py [fixture ...] [-- clang-args]
+
+With no fixture arguments, all fixtures are checked. Extra arguments after
+`--` are forwarded to Clang (e.g. sysroot flags for unusual local setups).
+This is a development tool; the Bazel suite remains the source of truth.
+"""
+
+import difflib
+import json
+import os
+import queue
+import subprocess
+import sys
+import tempfile
+import threading
+
+PKG = "rs_bindings_from_cc/test/golden"
+GENERATOR = "//rs_bindings_from_cc:rs_bindings_from_cc"
+# The namespaces_json fixture inspects the namespace manifest, not the generated
+# sources; it is excluded here just like in update.sh.
+SKIPPED_HEADERS = ("namespaces_json.h",)
+# Diff filters mirroring the `diff -I` patterns in test.sh.
+VOLATILE_LINE_PREFIXES = ("// Generated from: ", "// Expanded at: ")
+
+
+def workspace_root():
+    return os.path.dirname(
+        os.path.dirname(os.path.dirname(os.path.dirname(
+            os.path.abspath(__file__)))))
+
+
+def targets_and_headers(fixtures):
+    entries = [{
+        "t": "//%s:%s_cc" % (PKG, name),
+        "h": ["%s/%s.h" % (PKG, name)],
+    } for name in fixtures]
+    # The only cross-package dependency of the suite (see DEPS in BUILD).
+    entries.append({
+        "t": "//support/rs_std:rs_char",
+        "h": ["support/rs_std/rs_char.h"],
+    })
+    return json.dumps(entries)
+
+
+def filtered_lines(text):
+    return [
+        line for line in text.splitlines(keepends=True)
+        if not line.lstrip().startswith(VOLATILE_LINE_PREFIXES)
+    ]
+
+
+def diff_output(root, golden_path, generated_path):
+    """Returns a unified diff string, empty if the files match."""
+    with open(os.path.join(root, PKG, "LICENSE_HEADER")) as f:
+        license_header = f.read()
+    with open(golden_path) as f:
+        golden = f.read()
+    with open(generated_path) as f:
+        generated = license_header + f.read()
+    return "".join(
+        difflib.unified_diff(
+            filtered_lines(golden), filtered_lines(generated),
+            fromfile=os.path.relpath(golden_path, root),
+            tofile="generated"))
+
+
+def worker_loop(generator, root, requests, results):
+    """Feeds requests from the shared queue through one worker process."""
+    process = subprocess.Popen(
+        [generator, "--persistent_worker"],
+        stdin=subprocess.PIPE,
+        stdout=subprocess.PIPE,
+        cwd=root,
+        text=True)
+    try:
+        while True:
+            try:
+                name, args = requests.get_nowait()
+            except queue.Empty:
+                return
+            process.stdin.write(
+                json.dumps({"arguments": args, "requestId": 0}) + "\n")
+            process.stdin.flush()
+            line = process.stdout.readline()
+            if not line:
+                results.put((name, "worker process died"))
+                return
+            response = json.loads(line)
+            if response.get("exitCode", 1) != 0:
+                results.put((name, response.get("output", "unknown error")))
+            else:
+                results.put((name, None))
+    finally:
+        process.stdin.close()
+        process.wait()
+
+
+def main(argv):
+    if "--" in argv:
+        split = argv.index("--")
+        argv, clang_args = argv[:split], argv[split + 1:]
+    else:
+        clang_args = []
+
+    root = workspace_root()
+    golden_dir = os.path.join(root, PKG)
+    all_fixtures = sorted(
+        name[:-2] for name in os.listdir(golden_dir)
+        if name.endswith(".h") and name not in SKIPPED_HEADERS)
+    fixtures = argv or all_fixtures
+    unknown = set(fixtures) - set(all_fixtures)
+    if unknown:
+        sys.exit("unknown fixtures: %s" % ", ".join(sorted(unknown)))
+
+    generator = os.environ.get("CRUBIT_GENERATOR")
+    if not generator:
+        subprocess.run(["bazel", "build", GENERATOR], cwd=root, check=True)
+        bazel_bin = subprocess.run(["bazel", "info", "bazel-bin"],
+                                   cwd=root,
+                                   check=True,
+                                   capture_output=True,
+                                   text=True).stdout.strip()
+        generator = os.path.join(bazel_bin,
+                                 "rs_bindings_from_cc/rs_bindings_from_cc")
+
+    # The full header-to-target index is shared by every request, so warm
+    # workers parse it once (the generator caches it by value).
+    headers_json = targets_and_headers(all_fixtures)
+    out_dir = tempfile.mkdtemp(prefix="golden_fast_check_")
+    requests = queue.Queue()
+    for name in fixtures:
+        requests.put((name, [
+            "--target=//%s:%s_cc" % (PKG, name),
+            "--public_headers=%s/%s.h" % (PKG, name),
+            "--targets_and_headers=%s" % headers_json,
+            "--rs_out=%s/%s.rs" % (out_dir, name),
+            "--cc_out=%s/%s.cc" % (out_dir, name),
+            "--crubit_support_path=support",
+            "-I.",
+            "-Wno-google3-inline-namespace",
+        ] + clang_args))
+
+    results = queue.Queue()
+    threads = [
+        threading.Thread(
+            target=worker_loop, args=(generator, root, requests, results))
+        for _ in range(min(os.cpu_count() or 1, len(fixtures)))
+    ]
+    for thread in threads:
+        thread.start()
+
+    failures = []
+    for _ in fixtures:
+        name, error = results.get()
+        if error is None:
+            for kind, golden_suffix in (("rs", "_rs_api.rs"),
+                                        ("cc", "_rs_api_impl.cc")):
+                diff = diff_output(
+                    root, os.path.join(golden_dir, name + golden_suffix),
+                    os.path.join(out_dir, "%s.%s" % (name, kind)))
+                if diff:
+                    error = diff if error is None else error + diff
+        if error is not None:
+            failures.append(name)
+            print("FAIL %s\n%s" % (name, error))
+        else:
+            print("PASS %s" % name)
+    for thread in threads:
+        thread.join()
+
+    if failures:
+        sys.exit("%d of %d fixtures failed: %s" %
+                 (len(failures), len(fixtures), ", ".join(sorted(failures))))
+    print("all %d fixtures match" % len(fixtures))
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -375,16 +375,19 @@ impl<'b> ::ctor::UnpinAssign<::ctor::RvalueReference<'b, Self>> for Derived {
 }
 
 unsafe impl oops::Inherits<crate::Base0> for crate::Derived {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::Base0 {
         (derived as *const _ as *const u8).offset(0) as *const crate::Base0
     }
 }
 unsafe impl oops::Inherits<crate::Base1> for crate::Derived {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::Base1 {
         (derived as *const _ as *const u8).offset(0) as *const crate::Base1
     }
 }
 unsafe impl oops::Inherits<crate::Base2> for crate::Derived {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::Base2 {
         (derived as *const _ as *const u8).offset(10) as *const crate::Base2
     }
@@ -488,6 +491,7 @@ impl<'b> ::ctor::Assign<::ctor::RvalueReference<'b, Self>> for VirtualBase1 {
 }
 
 unsafe impl oops::Inherits<crate::Base1> for crate::VirtualBase1 {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::Base1 {
         crate::detail::__crubit_dynamic_upcast__12VirtualBase1__to__5Base1(derived)
     }
@@ -591,6 +595,7 @@ impl<'b> ::ctor::Assign<::ctor::RvalueReference<'b, Self>> for VirtualBase2 {
 }
 
 unsafe impl oops::Inherits<crate::Base1> for crate::VirtualBase2 {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::Base1 {
         crate::detail::__crubit_dynamic_upcast__12VirtualBase2__to__5Base1(derived)
     }
@@ -694,16 +699,19 @@ impl<'b> ::ctor::Assign<::ctor::RvalueReference<'b, Self>> for VirtualDerived {
 }
 
 unsafe impl oops::Inherits<crate::VirtualBase1> for crate::VirtualDerived {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::VirtualBase1 {
         crate::detail::__crubit_dynamic_upcast__14VirtualDerived__to__12VirtualBase1(derived)
     }
 }
 unsafe impl oops::Inherits<crate::Base1> for crate::VirtualDerived {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::Base1 {
         crate::detail::__crubit_dynamic_upcast__14VirtualDerived__to__5Base1(derived)
     }
 }
 unsafe impl oops::Inherits<crate::VirtualBase2> for crate::VirtualDerived {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::VirtualBase2 {
         crate::detail::__crubit_dynamic_upcast__14VirtualDerived__to__12VirtualBase2(derived)
     }
@@ -1027,11 +1035,13 @@ impl<'b> ::ctor::UnpinAssign<::ctor::RvalueReference<'b, Self>> for MethodDerive
 }
 
 unsafe impl oops::Inherits<crate::MethodBase1> for crate::MethodDerived {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::MethodBase1 {
         (derived as *const _ as *const u8).offset(0) as *const crate::MethodBase1
     }
 }
 unsafe impl oops::Inherits<crate::MethodBase2> for crate::MethodDerived {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const crate::MethodBase2 {
         (derived as *const _ as *const u8).offset(0) as *const crate::MethodBase2
     }
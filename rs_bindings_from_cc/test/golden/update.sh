@@ -18,8 +18,9 @@ cd "${G3}/${PKG}"
 
 TARGETS=()
 HEADERS_TO_SKIP=(
-  # The namespaces_json.h header is used to inspect the generated .json file.
-  # Updates to namespaces_json.json, if needed, shall be performed manually.
+  # The namespaces_json.h header is used to inspect the generated namespace
+  # manifest.
+  # Updates to namespaces_json.bin, if needed, shall be performed manually.
   "namespaces_json.h"
 )
 
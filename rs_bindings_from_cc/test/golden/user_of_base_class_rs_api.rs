@@ -122,16 +122,19 @@ impl<'b> ::ctor::Assign<::ctor::RvalueReference<'b, Self>> for Derived2 {
 }
 
 unsafe impl oops::Inherits<inheritance_cc::Base0> for crate::Derived2 {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const inheritance_cc::Base0 {
         crate::detail::__crubit_dynamic_upcast__8Derived2__to__5Base0(derived)
     }
 }
 unsafe impl oops::Inherits<inheritance_cc::Base1> for crate::Derived2 {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const inheritance_cc::Base1 {
         (derived as *const _ as *const u8).offset(8) as *const inheritance_cc::Base1
     }
 }
 unsafe impl oops::Inherits<inheritance_cc::Base2> for crate::Derived2 {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const inheritance_cc::Base2 {
         (derived as *const _ as *const u8).offset(18) as *const inheritance_cc::Base2
     }
@@ -238,16 +241,19 @@ impl<'b> ::ctor::Assign<::ctor::RvalueReference<'b, Self>> for VirtualDerived2 {
 }
 
 unsafe impl oops::Inherits<inheritance_cc::VirtualBase1> for crate::VirtualDerived2 {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const inheritance_cc::VirtualBase1 {
         crate::detail::__crubit_dynamic_upcast__15VirtualDerived2__to__12VirtualBase1(derived)
     }
 }
 unsafe impl oops::Inherits<inheritance_cc::Base1> for crate::VirtualDerived2 {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const inheritance_cc::Base1 {
         crate::detail::__crubit_dynamic_upcast__15VirtualDerived2__to__5Base1(derived)
     }
 }
 unsafe impl oops::Inherits<inheritance_cc::VirtualBase2> for crate::VirtualDerived2 {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const inheritance_cc::VirtualBase2 {
         crate::detail::__crubit_dynamic_upcast__15VirtualDerived2__to__12VirtualBase2(derived)
     }
@@ -3,7 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 use import_internal::{ImportMacroInput, Mode};
-use merged_namespaces::{JsonNamespaceHierarchy, MergedNamespaceHierarchy};
+use merged_namespaces::{MergedNamespaceHierarchy, NamespaceHierarchy};
 use proc_macro2::TokenStream;
 use quote::ToTokens;
 use syn::parse::{Parse, ParseStream};
@@ -29,20 +29,19 @@ impl CcImportMacroInput {
 }
 
 fn get_namespace_hierarchy() -> MergedNamespaceHierarchy {
-    let namespace_json_files = std::env::var("CC_IMPORT_NAMESPACES")
+    let namespace_manifest_files = std::env::var("CC_IMPORT_NAMESPACES")
         .expect("Missing CC_IMPORT_NAMESPACES environment variable");
-    let files: Vec<String> = serde_json::from_str(&namespace_json_files)
+    let files: Vec<String> = serde_json::from_str(&namespace_manifest_files)
         .expect("Could not parse CC_IMPORT_NAMESPACES environment variable");
 
     let merged_hierarchy = files
         .iter()
         .map(|file_path| {
-            let json_file_content = std::fs::read_to_string(file_path)
+            let manifest_bytes = std::fs::read(file_path)
                 .unwrap_or_else(|_| panic!("Couldn't read file {}", &file_path));
-            let json_namespace_hierarchy: JsonNamespaceHierarchy =
-                serde_json::from_str(&json_file_content)
-                    .expect("Did not parse JSON content successfully");
-            MergedNamespaceHierarchy::from_json_namespace_hierarchy(&json_namespace_hierarchy)
+            let namespace_hierarchy = NamespaceHierarchy::from_binary(&manifest_bytes)
+                .unwrap_or_else(|err| panic!("Couldn't parse file {}: {}", &file_path, err));
+            MergedNamespaceHierarchy::from_namespace_hierarchy(&namespace_hierarchy)
         })
         .reduce(|mut merged, next| {
             merged.merge(next);
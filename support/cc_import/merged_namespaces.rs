@@ -5,27 +5,116 @@
 use import_internal::{AbsoluteLabel, Mode};
 use proc_macro2::{Span, TokenStream};
 use quote::{quote, ToTokens, TokenStreamExt};
-use serde::Deserialize;
 use std::collections::BTreeMap;
 use std::collections::BTreeSet;
 use std::rc::Rc;
 use syn::Ident;
 
-/// Representation of a target's namespace hierarchy, as encoded in the
-/// *_namespace.json file.
-#[derive(Clone, Debug, Deserialize)]
-pub struct JsonNamespaceHierarchy {
+/// Binary namespace manifest layout, produced by `NamespacesAsBinary` in
+/// `rs_bindings_from_cc/collect_namespaces.cc` (all integers are
+/// little-endian u32):
+///
+///   bytes 0..4     magic `b"CNH1"`
+///   bytes 4..8     node count `n`, including the synthetic root at index 0
+///   bytes 8..12    label offset
+///   bytes 12..16   label length
+///   bytes 16..16+16*n  node table in breadth-first order; each node is
+///                  (name_offset, name_len, children_begin, children_count).
+///                  The children of a node are the contiguous index range
+///                  [children_begin, children_begin + children_count),
+///                  sorted by name bytes. Node 0 is a synthetic root with an
+///                  empty name whose children are the top-level namespaces.
+///   rest           string heap; all offsets are relative to the start of
+///                  the manifest
+///
+/// The fixed-width table is decoded straight from the raw (e.g. memory-
+/// mapped) bytes, with no textual parsing.
+const NAMESPACES_MAGIC: &[u8; 4] = b"CNH1";
+const NAMESPACES_HEADER_LEN: usize = 16;
+const NAMESPACES_NODE_LEN: usize = 16;
+
+/// One target's namespace hierarchy, decoded from its binary manifest.
+#[derive(Clone, Debug)]
+pub struct NamespaceHierarchy {
     pub label: Rc<str>,
-    #[serde(default)]
-    pub namespaces: Vec<JsonNamespace>,
+    pub namespaces: Vec<NamespaceEntry>,
 }
 
-/// Single C++ namespace, as encoded in the *_namespace.json file.
-#[derive(Clone, Debug, Deserialize)]
-pub struct JsonNamespace {
+/// A single C++ namespace of one target's manifest.
+#[derive(Clone, Debug)]
+pub struct NamespaceEntry {
     pub name: Rc<str>,
-    #[serde(default)]
-    pub children: Vec<JsonNamespace>,
+    pub children: Vec<NamespaceEntry>,
+}
+
+fn read_u32(bytes: &[u8], offset: usize) -> Option<usize> {
+    let slice = bytes.get(offset..offset.checked_add(4)?)?;
+    Some(u32::from_le_bytes(slice.try_into().unwrap()) as usize)
+}
+
+fn read_str(bytes: &[u8], offset: usize, len: usize) -> Result<&str, String> {
+    let slice = bytes
+        .get(offset..offset.checked_add(len).ok_or("Malformed namespace manifest: bad offset")?)
+        .ok_or("Malformed namespace manifest: string out of bounds")?;
+    std::str::from_utf8(slice).map_err(|_| "Malformed namespace manifest: non-UTF-8 string".into())
+}
+
+impl NamespaceHierarchy {
+    /// Decodes the binary manifest in `bytes`.
+    pub fn from_binary(bytes: &[u8]) -> Result<NamespaceHierarchy, String> {
+        if bytes.len() < NAMESPACES_HEADER_LEN || &bytes[0..4] != NAMESPACES_MAGIC {
+            return Err("Malformed namespace manifest: bad header".to_string());
+        }
+        let node_count = read_u32(bytes, 4).unwrap();
+        let label_offset = read_u32(bytes, 8).unwrap();
+        let label_len = read_u32(bytes, 12).unwrap();
+        let label: Rc<str> = read_str(bytes, label_offset, label_len)?.into();
+        if node_count == 0 {
+            return Err("Malformed namespace manifest: missing root node".to_string());
+        }
+        let (_, _, children_begin, children_count) = node_fields(bytes, 0)?;
+        let namespaces = read_child_range(bytes, node_count, 0, children_begin, children_count)?;
+        Ok(NamespaceHierarchy { label, namespaces })
+    }
+}
+
+/// Returns the (name_offset, name_len, children_begin, children_count) fields
+/// of the `index`-th node.
+fn node_fields(bytes: &[u8], index: usize) -> Result<(usize, usize, usize, usize), String> {
+    let node = NAMESPACES_HEADER_LEN + NAMESPACES_NODE_LEN * index;
+    let out_of_bounds = || "Malformed namespace manifest: node out of bounds".to_string();
+    Ok((
+        read_u32(bytes, node).ok_or_else(out_of_bounds)?,
+        read_u32(bytes, node + 4).ok_or_else(out_of_bounds)?,
+        read_u32(bytes, node + 8).ok_or_else(out_of_bounds)?,
+        read_u32(bytes, node + 12).ok_or_else(out_of_bounds)?,
+    ))
+}
+
+fn read_entry(bytes: &[u8], node_count: usize, index: usize) -> Result<NamespaceEntry, String> {
+    let (name_offset, name_len, children_begin, children_count) = node_fields(bytes, index)?;
+    let name: Rc<str> = read_str(bytes, name_offset, name_len)?.into();
+    let children = read_child_range(bytes, node_count, index, children_begin, children_count)?;
+    Ok(NamespaceEntry { name, children })
+}
+
+fn read_child_range(
+    bytes: &[u8],
+    node_count: usize,
+    parent: usize,
+    begin: usize,
+    count: usize,
+) -> Result<Vec<NamespaceEntry>, String> {
+    if count == 0 {
+        return Ok(Vec::new());
+    }
+    let end = begin.checked_add(count).ok_or("Malformed namespace manifest: bad child range")?;
+    // The breadth-first layout places children strictly after their parent;
+    // enforcing it also rules out cycles in malformed input.
+    if begin <= parent || end > node_count {
+        return Err("Malformed namespace manifest: child range out of bounds".to_string());
+    }
+    (begin..end).map(|index| read_entry(bytes, node_count, index)).collect()
 }
 
 /// A trie-like data structure that represents the merged namespace hierarchy
@@ -49,17 +138,17 @@ pub struct MergedNamespace {
 }
 
 impl MergedNamespace {
-    /// Creates a MergedNamespace from JsonNamespace.
-    pub fn from_json_namespace(label: Rc<str>, json_namespace: &JsonNamespace) -> MergedNamespace {
+    /// Creates a MergedNamespace from a single target's NamespaceEntry.
+    pub fn from_namespace_entry(label: Rc<str>, entry: &NamespaceEntry) -> MergedNamespace {
         let mut merged_children = BTreeMap::new();
-        for child in json_namespace.children.iter() {
+        for child in entry.children.iter() {
             merged_children.insert(
                 child.name.clone(),
-                MergedNamespace::from_json_namespace(label.clone(), child),
+                MergedNamespace::from_namespace_entry(label.clone(), child),
             );
         }
         MergedNamespace {
-            name: json_namespace.name.clone(),
+            name: entry.name.clone(),
             children: merged_children,
             labels: BTreeSet::from([label]),
         }
@@ -97,13 +186,16 @@ impl MergedNamespace {
 }
 
 impl MergedNamespaceHierarchy {
-    /// Creates a MergedNamespaceHierarchy from JsonNamespaceHierarchy.
-    pub fn from_json_namespace_hierarchy(jnh: &JsonNamespaceHierarchy) -> MergedNamespaceHierarchy {
+    /// Creates a MergedNamespaceHierarchy from a single target's hierarchy.
+    pub fn from_namespace_hierarchy(hierarchy: &NamespaceHierarchy) -> MergedNamespaceHierarchy {
         let mut merged_namespaces = BTreeMap::new();
-        for top_level_namespace in jnh.namespaces.iter() {
+        for top_level_namespace in hierarchy.namespaces.iter() {
             merged_namespaces.insert(
                 top_level_namespace.name.clone(),
-                MergedNamespace::from_json_namespace(jnh.label.clone(), top_level_namespace),
+                MergedNamespace::from_namespace_entry(
+                    hierarchy.label.clone(),
+                    top_level_namespace,
+                ),
             );
         }
         MergedNamespaceHierarchy { top_level_namespaces: merged_namespaces }
@@ -168,60 +260,129 @@ mod tests {
     use super::*;
     use std::ops::Deref;
 
+    fn ns(name: &str, children: Vec<NamespaceEntry>) -> NamespaceEntry {
+        NamespaceEntry { name: name.into(), children }
+    }
+
+    fn hierarchy(label: &str, namespaces: Vec<NamespaceEntry>) -> NamespaceHierarchy {
+        NamespaceHierarchy { label: label.into(), namespaces }
+    }
+
+    /// Test encoder mirroring `NamespacesAsBinary` in collect_namespaces.cc:
+    /// breadth-first node table with a synthetic root, children sorted by
+    /// name, then the string heap.
+    fn encode(hierarchy: &NamespaceHierarchy) -> Vec<u8> {
+        let mut nodes: Vec<Option<&NamespaceEntry>> = vec![None];
+        let mut child_ranges: Vec<(u32, u32)> = vec![(0, 0)];
+        let mut index = 0;
+        while index < nodes.len() {
+            let mut children: Vec<&NamespaceEntry> = match nodes[index] {
+                None => hierarchy.namespaces.iter().collect(),
+                Some(entry) => entry.children.iter().collect(),
+            };
+            children.sort_by(|a, b| a.name.as_bytes().cmp(b.name.as_bytes()));
+            child_ranges[index] = (nodes.len() as u32, children.len() as u32);
+            for child in children {
+                nodes.push(Some(child));
+                child_ranges.push((0, 0));
+            }
+            index += 1;
+        }
+
+        let heap_base = (NAMESPACES_HEADER_LEN + NAMESPACES_NODE_LEN * nodes.len()) as u32;
+        let mut heap: Vec<u8> = Vec::new();
+        let intern = |s: &str, heap: &mut Vec<u8>| -> (u32, u32) {
+            if s.is_empty() {
+                return (0, 0);
+            }
+            let offset = heap_base + heap.len() as u32;
+            heap.extend_from_slice(s.as_bytes());
+            (offset, s.len() as u32)
+        };
+
+        let mut out = Vec::new();
+        out.extend_from_slice(NAMESPACES_MAGIC);
+        out.extend_from_slice(&(nodes.len() as u32).to_le_bytes());
+        let (label_offset, label_len) = intern(&hierarchy.label, &mut heap);
+        out.extend_from_slice(&label_offset.to_le_bytes());
+        out.extend_from_slice(&label_len.to_le_bytes());
+        for (node, (children_begin, children_count)) in nodes.iter().zip(child_ranges.iter()) {
+            let (name_offset, name_len) = match node {
+                None => (0, 0),
+                Some(entry) => intern(&entry.name, &mut heap),
+            };
+            out.extend_from_slice(&name_offset.to_le_bytes());
+            out.extend_from_slice(&name_len.to_le_bytes());
+            out.extend_from_slice(&children_begin.to_le_bytes());
+            out.extend_from_slice(&children_count.to_le_bytes());
+        }
+        out.extend_from_slice(&heap);
+        out
+    }
+
     #[test]
-    fn from_json() {
-        let json = r#"{
-            "label": "//foo/bar:baz",
-            "namespaces": [
-                {
-                    "name": "top_level",
-                    "children": []
-                }
-            ]
-        }"#;
+    fn from_binary_roundtrip() {
+        let encoded = encode(&hierarchy(
+            "//foo/bar:baz",
+            vec![ns("top_level", vec![ns("inner", vec![])]), ns("other", vec![])],
+        ));
+
+        let decoded = NamespaceHierarchy::from_binary(&encoded).unwrap();
+        assert_eq!(&*decoded.label, "//foo/bar:baz");
+        // Children are stored sorted by name.
+        assert_eq!(decoded.namespaces.len(), 2);
+        assert_eq!(&*decoded.namespaces[0].name, "other");
+        assert_eq!(&*decoded.namespaces[1].name, "top_level");
+        assert_eq!(decoded.namespaces[1].children.len(), 1);
+        assert_eq!(&*decoded.namespaces[1].children[0].name, "inner");
+    }
+
+    #[test]
+    fn from_binary_empty_hierarchy() {
+        let encoded = encode(&hierarchy("//foo/bar:baz", vec![]));
+        let decoded = NamespaceHierarchy::from_binary(&encoded).unwrap();
+        assert_eq!(&*decoded.label, "//foo/bar:baz");
+        assert!(decoded.namespaces.is_empty());
+    }
+
+    #[test]
+    fn from_binary_rejects_bad_magic() {
+        let mut encoded = encode(&hierarchy("//foo/bar:baz", vec![]));
+        encoded[0] = b'X';
+        assert!(NamespaceHierarchy::from_binary(&encoded).unwrap_err().contains("bad header"));
+    }
 
-        let ns: JsonNamespaceHierarchy = serde_json::from_str(json).unwrap();
-        assert_eq!(&*ns.label, "//foo/bar:baz");
-        assert_eq!(ns.namespaces.len(), 1);
-        assert_eq!(&*ns.namespaces[0].name, "top_level");
+    #[test]
+    fn from_binary_rejects_truncated_table() {
+        let encoded = encode(&hierarchy("//foo/bar:baz", vec![ns("a", vec![])]));
+        assert!(NamespaceHierarchy::from_binary(&encoded[..NAMESPACES_HEADER_LEN + 4]).is_err());
+    }
+
+    #[test]
+    fn from_binary_rejects_child_range_cycle() {
+        // A root whose child range points back at the root itself must be
+        // rejected instead of recursing forever.
+        let mut encoded = encode(&hierarchy("//foo/bar:baz", vec![]));
+        let root = NAMESPACES_HEADER_LEN;
+        encoded[root + 8..root + 12].copy_from_slice(&0u32.to_le_bytes());
+        encoded[root + 12..root + 16].copy_from_slice(&1u32.to_le_bytes());
+        assert!(NamespaceHierarchy::from_binary(&encoded)
+            .unwrap_err()
+            .contains("child range out of bounds"));
     }
 
     #[test]
     fn test_merge_namespace_hierarchies() {
-        let hierarchy_one: JsonNamespaceHierarchy = serde_json::from_str(
-            r#"{
-            "label": "//foo/bar:baz",
-            "namespaces": [
-                {
-                    "name": "top_level_1",
-                    "children": []
-                }
-            ]
-        }"#,
-        )
-        .unwrap();
-
-        let hierarchy_two: JsonNamespaceHierarchy = serde_json::from_str(
-            r#"{
-            "label": "//foo/bar:xyz",
-            "namespaces": [
-                {
-                    "name": "top_level_1",
-                    "children": []
-                },
-                {
-                    "name": "top_level_2",
-                    "children": []
-                }
-            ]
-        }"#,
-        )
-        .unwrap();
+        let hierarchy_one = hierarchy("//foo/bar:baz", vec![ns("top_level_1", vec![])]);
+        let hierarchy_two = hierarchy(
+            "//foo/bar:xyz",
+            vec![ns("top_level_1", vec![]), ns("top_level_2", vec![])],
+        );
 
         let mut merged_hierarchy =
-            MergedNamespaceHierarchy::from_json_namespace_hierarchy(&hierarchy_one);
+            MergedNamespaceHierarchy::from_namespace_hierarchy(&hierarchy_one);
         let merged_hierarchy_two =
-            MergedNamespaceHierarchy::from_json_namespace_hierarchy(&hierarchy_two);
+            MergedNamespaceHierarchy::from_namespace_hierarchy(&hierarchy_two);
 
         merged_hierarchy.merge(merged_hierarchy_two);
         let MergedNamespaceHierarchy { top_level_namespaces } = merged_hierarchy;
@@ -247,76 +408,24 @@ mod tests {
     #[test]
     #[should_panic(expected = "Cannot merge namespaces with different names, got 'a' and 'b'")]
     fn test_merge_different_namespaces() {
-        let mut namespace_one = MergedNamespace::from_json_namespace(
-            "//label1".into(),
-            &serde_json::from_str(
-                r#"{
-            "name": "a",
-            "children": []
-        }"#,
-            )
-            .unwrap(),
-        );
+        let mut namespace_one =
+            MergedNamespace::from_namespace_entry("//label1".into(), &ns("a", vec![]));
 
-        let namespace_two = MergedNamespace::from_json_namespace(
-            "//label2".into(),
-            &serde_json::from_str(
-                r#"{
-            "name": "b",
-            "children": []
-        }"#,
-            )
-            .unwrap(),
-        );
+        let namespace_two =
+            MergedNamespace::from_namespace_entry("//label2".into(), &ns("b", vec![]));
 
         namespace_one.merge(namespace_two);
     }
 
     #[test]
     fn test_merge_namespaces() {
-        let json_namespace_one: JsonNamespace = serde_json::from_str(
-            r#"{
-            "name": "a",
-            "children": [
-                {
-                    "name": "b",
-                    "children": []
-                },
-                {
-                    "name": "c",
-                    "children": []
-                }
-            ]
-        }"#,
-        )
-        .unwrap();
-
-        let json_namespace_two: JsonNamespace = serde_json::from_str(
-            r#"{
-            "name": "a",
-            "children": [
-                {
-                    "name": "c",
-                    "children": [
-                        {
-                            "name": "d",
-                            "children": []
-                        }
-                    ]
-                },
-                {
-                    "name": "d",
-                    "children": []
-                }
-            ]
-        }"#,
-        )
-        .unwrap();
+        let namespace_one = ns("a", vec![ns("b", vec![]), ns("c", vec![])]);
+        let namespace_two = ns("a", vec![ns("c", vec![ns("d", vec![])]), ns("d", vec![])]);
 
         let mut merged_namespace =
-            MergedNamespace::from_json_namespace("//:label1".into(), &json_namespace_one);
+            MergedNamespace::from_namespace_entry("//:label1".into(), &namespace_one);
         let merged_namespace_two =
-            MergedNamespace::from_json_namespace("//:label2".into(), &json_namespace_two);
+            MergedNamespace::from_namespace_entry("//:label2".into(), &namespace_two);
 
         merged_namespace.merge(merged_namespace_two);
         let MergedNamespace { name, children, labels } = merged_namespace;
@@ -348,59 +457,23 @@ mod tests {
 
     #[test]
     fn test_to_tokens() {
-        let hierarchy_one: JsonNamespaceHierarchy = serde_json::from_str(
-            r#"{
-            "label": "//foo/bar:baz",
-            "namespaces": [
-                {
-                    "name": "top_level_1",
-                    "children": [
-                        {
-                            "name": "reopened",
-                            "children": [
-                                {
-                                    "name": "baz_specific",
-                                    "children": []
-                                }
-                            ]
-                        }
-                    ]
-                }
-            ]
-        }"#,
-        )
-        .unwrap();
-
-        let hierarchy_two: JsonNamespaceHierarchy = serde_json::from_str(
-            r#"{
-            "label": "//foo/bar:xyz",
-            "namespaces": [
-                {
-                    "name": "top_level_1",
-                    "children": [
-                        {
-                            "name": "xyz_specific",
-                            "children": []
-                        },
-                        {
-                            "name": "reopened",
-                            "children": []
-                        }
-                    ]
-                },
-                {
-                    "name": "top_level_2",
-                    "children": []
-                }
-            ]
-        }"#,
-        )
-        .unwrap();
+        let hierarchy_one = hierarchy(
+            "//foo/bar:baz",
+            vec![ns("top_level_1", vec![ns("reopened", vec![ns("baz_specific", vec![])])])],
+        );
+
+        let hierarchy_two = hierarchy(
+            "//foo/bar:xyz",
+            vec![
+                ns("top_level_1", vec![ns("xyz_specific", vec![]), ns("reopened", vec![])]),
+                ns("top_level_2", vec![]),
+            ],
+        );
 
         let mut merged_hierarchy =
-            MergedNamespaceHierarchy::from_json_namespace_hierarchy(&hierarchy_one);
+            MergedNamespaceHierarchy::from_namespace_hierarchy(&hierarchy_one);
         let merged_hierarchy_two =
-            MergedNamespaceHierarchy::from_json_namespace_hierarchy(&hierarchy_two);
+            MergedNamespaceHierarchy::from_namespace_hierarchy(&hierarchy_two);
 
         merged_hierarchy.merge(merged_hierarchy_two);
 
@@ -50,6 +50,35 @@ impl TryFrom<string_view> for &'static str {
     }
 }
 
+/// Borrows the bytes viewed by a C++ `string_view` for a caller-chosen
+/// lifetime `'a` - typically the lifetime of the C++ object that owns the
+/// character data. This is the zero-copy alternative to copying C++ return
+/// values into owned Rust types, and unlike the `From<string_view> for
+/// &'static [u8]` impl above it doesn't pretend the data lives forever.
+///
+/// # Safety
+///
+/// The caller must guarantee that the data viewed by `sv` lives for at least
+/// `'a` and is not mutated nor deallocated for the duration of `'a`.
+// TODO(b/246425449): Replace with a safe conversion once string_view has
+// lifetime annotations.
+pub unsafe fn borrow_bytes<'a>(sv: string_view) -> &'a [u8] {
+    let raw_slice: *const [u8] = sv.into();
+    &*raw_slice
+}
+
+/// Borrows the bytes viewed by a C++ `string_view` as a `&'a str`, failing if
+/// the data is not UTF8.  See `borrow_bytes` for the lifetime rationale.
+///
+/// # Safety
+///
+/// Same requirements as `borrow_bytes`.
+// TODO(b/246425449): Replace with a safe conversion once string_view has
+// lifetime annotations.
+pub unsafe fn borrow_utf8<'a>(sv: string_view) -> Result<&'a str, std::str::Utf8Error> {
+    std::str::from_utf8(borrow_bytes(sv))
+}
+
 /// Currently only implementing conversion from &'static str, because
 /// string_view isn't yet annotated with lifetimes, and so is unsafe to use
 /// with non-static lifetimes.
@@ -2,17 +2,18 @@
 // Exceptions. See /LICENSE for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+use once_cell::sync::Lazy;
 use proc_macro2::{Span, TokenStream};
 use quote::quote;
 use std::collections::HashMap;
 use std::env;
-use std::fs::File;
-use std::io::BufReader;
+use std::fs;
+use std::sync::{Arc, Mutex};
 
 pub fn to_private_struct_path(input: TokenStream) -> Result<TokenStream, syn::Error> {
     validate_user_input(&input)?;
-    let instantiations = read_instantiations_map()?;
-    get_instantiation_struct_name(input, instantiations)
+    let instantiations = get_instantiations_index()?;
+    get_instantiation_struct_name(input, &instantiations)
 }
 
 fn validate_user_input(_input: &TokenStream) -> Result<(), syn::Error> {
@@ -21,21 +22,89 @@ fn validate_user_input(_input: &TokenStream) -> Result<(), syn::Error> {
     Ok(())
 }
 
-fn read_instantiations_map() -> Result<HashMap<String, String>, syn::Error> {
+/// Binary instantiations map layout, produced by `InstantiationsAsBinaryMap`
+/// in `rs_bindings_from_cc/rs_bindings_from_cc.cc` (all integers are
+/// little-endian u32):
+///
+///   bytes 0..4    magic `b"CIM1"`
+///   bytes 4..8    entry count `n`
+///   bytes 8..8+16*n  entry table, sorted by key bytes; each entry is
+///                 (key_offset, key_len, value_offset, value_len), with
+///                 offsets relative to the start of the map
+///   rest          string heap
+///
+/// The fixed-width entry table makes the one-time indexing pass below a
+/// simple linear walk over the raw bytes, with no textual parsing.
+const INSTANTIATIONS_MAGIC: &[u8; 4] = b"CIM1";
+const INSTANTIATIONS_HEADER_LEN: usize = 8;
+const INSTANTIATIONS_ENTRY_LEN: usize = 16;
+
+/// Per-process cache of indexed instantiation maps, keyed by manifest path.
+///
+/// A crate with hundreds of `cc_template!` uses re-enters the proc macro once
+/// per use, but every invocation within one `rustc` process consults the same
+/// manifest - so it is read and indexed only once, and each expansion is a
+/// single hashed lookup.  Failed reads are not cached; they abort the
+/// compilation anyway.
+static INSTANTIATIONS_CACHE: Lazy<Mutex<HashMap<String, Arc<HashMap<String, String>>>>> =
+    Lazy::new(|| Mutex::new(HashMap::new()));
+
+fn get_instantiations_index() -> Result<Arc<HashMap<String, String>>, syn::Error> {
     let path = env::var("CRUBIT_INSTANTIATIONS_FILE").map_err(|err| {
         make_syn_error(format!("Couldn't read 'CRUBIT_INSTANTIATIONS_FILE': {}.", err))
     })?;
-    let file = File::open(&path).map_err(|err| {
+    let mut cache = INSTANTIATIONS_CACHE.lock().unwrap();
+    if let Some(index) = cache.get(&path) {
+        return Ok(Arc::clone(index));
+    }
+    let bytes = fs::read(&path).map_err(|err| {
         make_syn_error(format!("Couldn't read C++ instantiations from '{}': {}", path, err))
     })?;
-    let reader = BufReader::new(file);
-    serde_json::from_reader(reader)
-        .map_err(|err| make_syn_error(format!("Couldn't deserialize JSON from {}: {}", path, err)))
+    let index = Arc::new(parse_instantiations_map(&bytes)?);
+    cache.insert(path, Arc::clone(&index));
+    Ok(index)
+}
+
+fn read_u32(bytes: &[u8], offset: usize) -> Option<usize> {
+    let slice = bytes.get(offset..offset.checked_add(4)?)?;
+    Some(u32::from_le_bytes(slice.try_into().unwrap()) as usize)
+}
+
+/// Returns the (key, value) byte slices of the `index`-th entry, or `None`
+/// if any offset points outside of `bytes`.
+fn entry_slices(bytes: &[u8], index: usize) -> Option<(&[u8], &[u8])> {
+    let entry = INSTANTIATIONS_HEADER_LEN + INSTANTIATIONS_ENTRY_LEN * index;
+    let key_offset = read_u32(bytes, entry)?;
+    let key_len = read_u32(bytes, entry + 4)?;
+    let value_offset = read_u32(bytes, entry + 8)?;
+    let value_len = read_u32(bytes, entry + 12)?;
+    let key = bytes.get(key_offset..key_offset.checked_add(key_len)?)?;
+    let value = bytes.get(value_offset..value_offset.checked_add(value_len)?)?;
+    Some((key, value))
+}
+
+fn parse_instantiations_map(bytes: &[u8]) -> Result<HashMap<String, String>, syn::Error> {
+    if bytes.len() < INSTANTIATIONS_HEADER_LEN || &bytes[0..4] != INSTANTIATIONS_MAGIC {
+        return Err(make_syn_error("Malformed instantiations map: bad header"));
+    }
+    let count = read_u32(bytes, 4).unwrap();
+    let mut map = HashMap::with_capacity(count);
+    for index in 0..count {
+        let (key, value) = entry_slices(bytes, index).ok_or_else(|| {
+            make_syn_error("Malformed instantiations map: entry out of bounds")
+        })?;
+        let key = std::str::from_utf8(key)
+            .map_err(|_| make_syn_error("Malformed instantiations map: non-UTF-8 key"))?;
+        let value = std::str::from_utf8(value)
+            .map_err(|_| make_syn_error("Malformed instantiations map: non-UTF-8 value"))?;
+        map.insert(key.to_string(), value.to_string());
+    }
+    Ok(map)
 }
 
 fn get_instantiation_struct_name(
     input: TokenStream,
-    instantiations: HashMap<String, String>,
+    instantiations: &HashMap<String, String>,
 ) -> Result<TokenStream, syn::Error> {
     // In theory `TokenStream` -> `instantiation_name` translation could go through
     // `token_stream_printer::tokens_to_string`.  This route is not used because:
@@ -59,8 +128,8 @@ fn get_instantiation_struct_name(
             Ok(quote! { __cc_template_instantiations_rs_api :: #ident })
         }
         None => Err(make_syn_error(format!(
-            "Couldn't find '{}' in the instantiations map {:?}",
-            instantiation_name, instantiations
+            "Couldn't find '{}' in the instantiations map",
+            instantiation_name
         ))),
     }
 }
@@ -73,16 +142,44 @@ fn make_syn_error<T: Into<String>>(message: T) -> syn::Error {
 mod tests {
     use super::*;
     use maplit::hashmap;
+    use std::collections::HashMap;
     use std::path::Path;
 
-    fn get_error_from_read_instantiations_map(no_error_happened_msg: &str) -> String {
-        read_instantiations_map().expect_err(no_error_happened_msg).to_string()
+    /// Test-side encoder for the format documented above; mirrors
+    /// `InstantiationsAsBinaryMap` in rs_bindings_from_cc.cc.
+    fn encode_instantiations_map(entries: &HashMap<&str, &str>) -> Vec<u8> {
+        let mut sorted: Vec<(&str, &str)> = entries.iter().map(|(k, v)| (*k, *v)).collect();
+        sorted.sort();
+        let mut out = Vec::new();
+        out.extend_from_slice(INSTANTIATIONS_MAGIC);
+        out.extend_from_slice(&(sorted.len() as u32).to_le_bytes());
+        let mut offset =
+            (INSTANTIATIONS_HEADER_LEN + INSTANTIATIONS_ENTRY_LEN * sorted.len()) as u32;
+        for (key, value) in &sorted {
+            out.extend_from_slice(&offset.to_le_bytes());
+            out.extend_from_slice(&(key.len() as u32).to_le_bytes());
+            offset += key.len() as u32;
+            out.extend_from_slice(&offset.to_le_bytes());
+            out.extend_from_slice(&(value.len() as u32).to_le_bytes());
+            offset += value.len() as u32;
+        }
+        for (key, value) in &sorted {
+            out.extend_from_slice(key.as_bytes());
+            out.extend_from_slice(value.as_bytes());
+        }
+        out
+    }
+
+    fn get_error_from_instantiations_index(no_error_happened_msg: &str) -> String {
+        get_instantiations_index().expect_err(no_error_happened_msg).to_string()
     }
 
     #[test]
     fn test_env_var_not_set() {
+        env::remove_var("CRUBIT_INSTANTIATIONS_FILE");
+
         let err_message =
-            get_error_from_read_instantiations_map("The env var was unexpectedly set.");
+            get_error_from_instantiations_index("The env var was unexpectedly set.");
 
         assert_eq!(
             err_message,
@@ -95,7 +192,7 @@ mod tests {
         env::set_var("CRUBIT_INSTANTIATIONS_FILE", "path/does/not/exist");
 
         let err_message =
-            get_error_from_read_instantiations_map("The file was unexpectedly found.");
+            get_error_from_instantiations_index("The file was unexpectedly found.");
 
         assert_eq!(
             err_message,
@@ -104,47 +201,75 @@ mod tests {
     }
 
     #[test]
-    fn test_instantiations_file_deserialization_error() {
-        let path = Path::join(Path::new(&env::var("TEST_TMPDIR").unwrap()), "my_file.not_json");
-        std::fs::write(&path, "definitely not json").unwrap();
-        env::set_var("CRUBIT_INSTANTIATIONS_FILE", &path);
+    fn test_instantiations_index_is_cached() {
+        let path = env::temp_dir().join("cc_template_cached_instantiations.map");
+        fs::write(
+            &path,
+            encode_instantiations_map(&hashmap! { "vector < int >" => "__vector_int__" }),
+        )
+        .unwrap();
+        env::set_var("CRUBIT_INSTANTIATIONS_FILE", Path::new(&path));
 
-        let err_message = get_error_from_read_instantiations_map(
-            "The file was unexpectedly deserialized successfully.",
-        );
+        let index = get_instantiations_index().unwrap();
+        assert_eq!(index.get("vector < int >").map(String::as_str), Some("__vector_int__"));
 
-        assert_eq!(
-            err_message,
-            format!(
-                "Couldn't deserialize JSON from {}: expected value at line 1 column 1",
-                path.to_str().unwrap()
-            )
-        );
+        // Later invocations are served from the per-process cache - even
+        // clobbering the file on disk does not invalidate the index.
+        fs::write(&path, b"definitely not the binary map").unwrap();
+        let index = get_instantiations_index().unwrap();
+        assert_eq!(index.get("vector < int >").map(String::as_str), Some("__vector_int__"));
+    }
+
+    #[test]
+    fn test_instantiations_map_bad_header() {
+        let err = parse_instantiations_map(b"definitely not the binary map")
+            .expect_err("The map was unexpectedly read successfully.");
+
+        assert_eq!(err.to_string(), "Malformed instantiations map: bad header");
     }
 
     #[test]
-    fn test_instantiations_deserialization_success() {
-        let path = Path::join(Path::new(&env::var("TEST_TMPDIR").unwrap()), "instantiations.json");
-        let key = "std::string<bool>";
-        let value = "__CcTemplateInst_std_string_bool";
-        std::fs::write(&path, serde_json::to_string(&hashmap! {key => value}).unwrap()).unwrap();
-        env::set_var("CRUBIT_INSTANTIATIONS_FILE", &path);
+    fn test_instantiations_map_entry_out_of_bounds() {
+        // A header claiming one entry but providing no entry table.
+        let mut map = Vec::new();
+        map.extend_from_slice(INSTANTIATIONS_MAGIC);
+        map.extend_from_slice(&1u32.to_le_bytes());
+
+        let err = parse_instantiations_map(&map)
+            .expect_err("The map was unexpectedly read successfully.");
+
+        assert_eq!(err.to_string(), "Malformed instantiations map: entry out of bounds");
+    }
 
-        let deserialized_map =
-            read_instantiations_map().expect("Expected successful deserialization.");
+    #[test]
+    fn test_instantiations_map_roundtrip() {
+        let map = parse_instantiations_map(&encode_instantiations_map(&hashmap! {
+            "std :: vector < bool >" => "__CcTemplateInst_std_vector_bool",
+            "std :: vector < int >" => "__CcTemplateInst_std_vector_int",
+            "MyTemplate < 42 >" => "__CcTemplateInst_MyTemplate_42",
+        }))
+        .unwrap();
 
-        assert_eq!(deserialized_map, hashmap! { key.to_string() => value.to_string() });
+        for (key, value) in [
+            ("std :: vector < bool >", "__CcTemplateInst_std_vector_bool"),
+            ("std :: vector < int >", "__CcTemplateInst_std_vector_int"),
+            ("MyTemplate < 42 >", "__CcTemplateInst_MyTemplate_42"),
+        ] {
+            assert_eq!(map.get(key).map(String::as_str), Some(value));
+        }
+        assert_eq!(map.get("absent"), None);
+        assert!(parse_instantiations_map(&encode_instantiations_map(&hashmap! {}))
+            .unwrap()
+            .is_empty());
     }
 
     #[test]
     fn test_successful_expansion() {
-        let expanded = get_instantiation_struct_name(
-            quote!{ std::vector<bool> },
-            hashmap! {
-                quote!{ std::vector<bool> }.to_string() => "__std_vector__bool__".to_string(),
-            },
-        )
+        let map = parse_instantiations_map(&encode_instantiations_map(&hashmap! {
+            &*quote! { std::vector<bool> }.to_string() => "__std_vector__bool__",
+        }))
         .unwrap();
+        let expanded = get_instantiation_struct_name(quote! { std::vector<bool> }, &map).unwrap();
         assert_eq!(
             expanded.to_string(),
             quote! {__cc_template_instantiations_rs_api::__std_vector__bool__}.to_string()
@@ -7,7 +7,7 @@
 use cc_template::cc_template;
 
 /// Test the `cc_template!` macro with:
-/// * the JSON file `__cc_template_instantiations.json` (the environment
+/// * the binary map `__cc_template_instantiations.map` (the environment
 ///   variable is configured in the BUILD file)
 /// * `__cc_template_instantiations_rs_api.rs` as the "generated" Rust bindings
 ///   file
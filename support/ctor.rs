@@ -373,6 +373,68 @@ impl<T> Ctor for RustMoveCtor<T> {
     }
 }
 
+/// Type-erases a `Ctor`, so that cold construction sites don't pay for full
+/// monomorphization.
+///
+/// A chain of combinators (`ctor_then`, `FnCtor`, emplacement helpers) is
+/// re-instantiated for every concrete ctor type that flows through it. For
+/// construction sites that are not hot, `erased_ctor` cuts the chain: the
+/// concrete ctor is boxed once, and everything downstream is instantiated
+/// only per *output* type (`ErasedCtor<Output>`), not per ctor type. The
+/// price is one allocation and one indirect call per construction - a good
+/// trade everywhere except hot paths, which should keep using the concrete
+/// `Ctor` directly.
+pub fn erased_ctor<'a, C: Ctor + 'a>(c: C) -> ErasedCtor<'a, C::Output> {
+    ErasedCtor(Box::new(move |dest| unsafe { c.ctor(dest) }))
+}
+
+#[must_use = must_use_ctor!()]
+pub struct ErasedCtor<'a, Output>(Box<dyn FnOnce(Pin<&mut MaybeUninit<Output>>) + 'a>);
+impl<'a, Output> !Unpin for ErasedCtor<'a, Output> {}
+impl<'a, Output> Ctor for ErasedCtor<'a, Output> {
+    type Output = Output;
+    unsafe fn ctor(self, dest: Pin<&mut MaybeUninit<Output>>) {
+        (self.0)(dest)
+    }
+}
+
+/// Marker for types whose C++ default construction is equivalent to writing
+/// the all-zero bit pattern into place.
+///
+/// The bindings generator can implement this for eligible `Record`s (trivially
+/// default constructible, with no members that require a nonzero
+/// representation), letting hot construction paths use [`zeroed_ctor`] - a
+/// direct `write_bytes` with no closure indirection - instead of funneling
+/// through `FnCtor` and a C++ constructor thunk.
+///
+/// # Safety
+///
+/// Implementors guarantee that the all-zero bit pattern is a valid, fully
+/// constructed value of `Self`, indistinguishable (as far as program behavior
+/// is concerned) from one produced by the C++ default constructor.
+pub unsafe trait TrivialCtor: Sized {}
+
+/// Constructs a `T: TrivialCtor` in place by zero-filling it.
+///
+/// Unlike a `FnCtor`-based construction there is no closure to outline: the
+/// returned `Ctor` lowers to a plain `write_bytes` (a memset the compiler can
+/// see through and merge with surrounding stores).
+pub fn zeroed_ctor<T: TrivialCtor>() -> ZeroedCtor<T> {
+    ZeroedCtor(PhantomData)
+}
+
+#[must_use = must_use_ctor!()]
+pub struct ZeroedCtor<T: TrivialCtor>(PhantomData<fn(T)>);
+impl<T: TrivialCtor> !Unpin for ZeroedCtor<T> {}
+impl<T: TrivialCtor> Ctor for ZeroedCtor<T> {
+    type Output = T;
+    unsafe fn ctor(self, dest: Pin<&mut MaybeUninit<T>>) {
+        // SAFETY: `TrivialCtor` guarantees that all-zero bytes are a valid,
+        // fully constructed `T`.
+        Pin::into_inner_unchecked(dest).as_mut_ptr().write_bytes(0u8, 1);
+    }
+}
+
 /// All Rust types are C++-default-constructible if safe (i.e. Unpin + Default).
 impl<T: Unpin + Default + Sized> CtorNew<()> for T {
     type CtorType = RustMoveCtor<Self>;
@@ -1200,6 +1262,31 @@ mod test {
         assert_eq!(*x, 0);
     }
 
+    #[test]
+    fn test_erased_ctor() {
+        emplace! {let x = erased_ctor(42_u32);}
+        assert_eq!(*x, 42);
+
+        // Combinators still work on the erased form.
+        emplace! {let y = erased_ctor(1_u32).ctor_then(|mut inited| *inited += 1);}
+        assert_eq!(*y, 2);
+    }
+
+    #[test]
+    fn test_zeroed_ctor() {
+        #[derive(Debug, PartialEq)]
+        struct Trivial {
+            x: u32,
+            y: f32,
+        }
+        // SAFETY: all-zero bytes are a valid `Trivial` (matching what a
+        // trivial C++ default constructor would be refined to).
+        unsafe impl TrivialCtor for Trivial {}
+
+        emplace! {let trivial = zeroed_ctor::<Trivial>();}
+        assert_eq!(*trivial, Trivial { x: 0, y: 0.0 });
+    }
+
     #[test]
     fn test_copy_rust_type() {
         let x: u32 = 42;
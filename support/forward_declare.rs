@@ -214,14 +214,21 @@ pub mod internal {
     /// `Symbol` type, equivalent to const &'static str values, but usable in
     /// generics in stable Rust.
     ///
-    /// Every symbol is a tuple of `C`: for example, `symbol!("xy")` is
-    /// `Symbol((C<'x'>, C<'y'>))`
+    /// To keep type unification and symbol mangling cheap even for long
+    /// fully-qualified C++ names, the string is packed into `u128` "limbs"
+    /// instead of being spelled out one character per type parameter:
+    /// `symbol!("xy")` is `Symbol<(C<2>, C<0x7879 << 112>)>`.  The first limb
+    /// is the byte length of the string, and each following limb holds up to
+    /// 16 UTF-8 bytes (big-endian, zero-padded at the end).  The length limb
+    /// makes the packing bijective, so two `symbol!` invocations expand to
+    /// the same type exactly when their strings are equal, and the compiler
+    /// resolves symbol identity with a handful of integer comparisons.
     #[repr(C)]
     pub struct Symbol<T>(std::marker::PhantomData<T>);
 
-    /// A character in a symbol string.
+    /// A limb of a packed symbol string.
     #[repr(C)]
-    pub struct C<const CHAR: char>;
+    pub struct C<const LIMB: u128>;
 
     /// Types that implement the `CcType` trait with the same `Name` can be
     /// safely transmuted between each other, because they either provide
@@ -7,14 +7,18 @@ mod std {}
 mod forward_declare {}
 
 mod test_is_same_0 {
-    type _Expected = ::forward_declare::internal::Symbol<()>;
+    type _Expected =
+        ::forward_declare::internal::Symbol<(::forward_declare::internal::C<0u128>,)>;
     fn _is_same(x: _Expected) -> ::forward_declare::symbol!("") {
         x
     }
 }
 
 mod test_is_same_1 {
-    type _Expected = ::forward_declare::internal::Symbol<(::forward_declare::internal::C<'x'>,)>;
+    type _Expected = ::forward_declare::internal::Symbol<(
+        ::forward_declare::internal::C<1u128>,
+        ::forward_declare::internal::C<0x78000000000000000000000000000000u128>,
+    )>;
     fn _is_same(x: _Expected) -> ::forward_declare::symbol!("x") {
         x
     }
@@ -22,15 +26,26 @@ mod test_is_same_1 {
 
 mod test_is_same_3 {
     type _Expected = ::forward_declare::internal::Symbol<(
-        ::forward_declare::internal::C<'f'>,
-        ::forward_declare::internal::C<'o'>,
-        ::forward_declare::internal::C<'o'>,
+        ::forward_declare::internal::C<3u128>,
+        ::forward_declare::internal::C<0x666f6f00000000000000000000000000u128>,
     )>;
     fn _is_same(x: _Expected) -> ::forward_declare::symbol!("foo") {
         x
     }
 }
 
+mod test_is_same_17 {
+    // 17 bytes - long enough to need a second limb.
+    type _Expected = ::forward_declare::internal::Symbol<(
+        ::forward_declare::internal::C<17u128>,
+        ::forward_declare::internal::C<0x30313233343536373839616263646566u128>,
+        ::forward_declare::internal::C<0x67000000000000000000000000000000u128>,
+    )>;
+    fn _is_same(x: _Expected) -> ::forward_declare::symbol!("0123456789abcdefg") {
+        x
+    }
+}
+
 #[test]
 fn test_conversions() {
     use ::forward_declare::CcCast as _; // test becomes too verbose otherwise.
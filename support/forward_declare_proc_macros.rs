@@ -9,16 +9,29 @@ use quote::quote;
 pub fn symbol(input: TokenStream) -> TokenStream {
     let input = syn::parse_macro_input!(input as syn::LitStr);
     let string = input.value();
-    let parts = string.chars().map(|c| {
-        let c = syn::LitChar::new(c, input.span());
+    let bytes = string.as_bytes();
+    // The first limb is the byte length of the string; each following limb
+    // packs up to 16 UTF-8 bytes (big-endian, zero-padded at the end).  The
+    // length limb makes the packing bijective - without it, strings differing
+    // only in trailing NUL bytes would collide.  See the doc comment of
+    // `Symbol` in `forward_declare.rs`.
+    let len = syn::LitInt::new(&format!("{}u128", bytes.len()), input.span());
+    let limbs = bytes.chunks(16).map(|chunk| {
+        let mut limb: u128 = 0;
+        for &byte in chunk {
+            limb = (limb << 8) | u128::from(byte);
+        }
+        limb <<= 8 * (16 - chunk.len());
+        let limb = syn::LitInt::new(&format!("{limb:#034x}u128"), input.span());
         quote! {
-          ::forward_declare::internal::C<#c>
+          ::forward_declare::internal::C<#limb>
         }
     });
 
     TokenStream::from(quote! {
       ::forward_declare::internal::Symbol<(
-          #(#parts,)*
+          ::forward_declare::internal::C<#len>,
+          #(#limbs,)*
       )>
     })
 }
@@ -59,8 +59,26 @@ struct OffsetOfHelper<void(T)> {
 // the type name in an extra parens is not sufficient for the standard
 // `offsetof` macro.
 //
+// CRUBIT_OFFSET_OF also supports non-standard-layout types (e.g. types with a
+// vtable, or with mixed-access fields).  `offsetof` is only "conditionally
+// supported" for such types [1], and while Clang and GCC both implement it,
+// they diagnose it under `-Winvalid-offsetof`.  The layout assertions that
+// `rs_bindings_from_cc` emits into `..._rs_api_impl.cc` intentionally verify
+// such types too (the Rust side hardcodes their field offsets all the same),
+// so the macro evaluates `offsetof` inside an immediately-invoked `constexpr`
+// lambda, where the diagnostic can be locally suppressed.  The result is
+// still a constant expression - usable in `static_assert` - and no code is
+// emitted at runtime.
+//
 // [1] https://en.cppreference.com/w/cpp/types/offsetof
-#define CRUBIT_OFFSET_OF(member, T...) \
-  offsetof(::crubit::details::OffsetOfHelper<void(T)>::Type, member)
+#define CRUBIT_OFFSET_OF(member, T...)                              \
+  []() constexpr {                                                  \
+    _Pragma("GCC diagnostic push")                                  \
+    _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"")        \
+    constexpr ::std::size_t offset = offsetof(                      \
+        ::crubit::details::OffsetOfHelper<void(T)>::Type, member);  \
+    _Pragma("GCC diagnostic pop")                                   \
+    return offset;                                                  \
+  }()
 
 #endif  // CRUBIT_RS_BINDINGS_FROM_CC_SUPPORT_OFFSETOF_H_
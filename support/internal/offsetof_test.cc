@@ -27,4 +27,17 @@ static_assert(CRUBIT_OFFSET_OF(t1, TemplateWithTwoArgs<int64_t, int32_t>) == 0,
 static_assert(CRUBIT_OFFSET_OF(t2, TemplateWithTwoArgs<int64_t, int32_t>) == 8,
               "");
 
+// `offsetof` is only "conditionally supported" for non-standard-layout types,
+// but CRUBIT_OFFSET_OF is expected to handle them (without tripping
+// `-Winvalid-offsetof`) - the bindings generator emits layout assertions for
+// such types too.
+struct NonStandardLayoutStruct {
+  virtual ~NonStandardLayoutStruct() = default;
+  int64_t field;
+};
+
+static_assert(CRUBIT_OFFSET_OF(field, NonStandardLayoutStruct) ==
+                  sizeof(void*),
+              "");
+
 }  // namespace crubit
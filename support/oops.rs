@@ -55,6 +55,7 @@ impl<'a, Derived, Base> Upcast<&'a Base> for &'a Derived
 where
     Derived: Inherits<Base>,
 {
+    #[inline(always)]
     fn upcast(self: &'a Derived) -> &'a Base {
         unsafe { &*Derived::upcast_ptr(self as *const Derived) }
     }
@@ -65,6 +66,7 @@ impl<'a, Derived, Base> Upcast<Pin<&'a mut Base>> for Pin<&'a mut Derived>
 where
     Derived: Inherits<Base>,
 {
+    #[inline(always)]
     fn upcast(self: Pin<&'a mut Derived>) -> Pin<&'a mut Base> {
         unsafe {
             let inner = Pin::into_inner_unchecked(self) as *mut Derived;
@@ -82,6 +84,7 @@ where
     Pin<&'a mut Derived>: Upcast<Pin<&'a mut Base>>,
     Derived: Unpin,
 {
+    #[inline(always)]
     fn upcast(self: &'a mut Derived) -> Pin<&'a mut Base> {
         Pin::new(self).upcast()
     }
@@ -97,6 +100,7 @@ where
     Derived: Unpin,
     Base: Unpin,
 {
+    #[inline(always)]
     fn upcast(self: &'a mut Derived) -> &'a mut Base {
         Pin::into_inner(Pin::new(self).upcast())
     }
@@ -157,6 +161,7 @@ pub unsafe trait Inherits<Base> {
     ///
     /// Otherwise, if `derived` is non-dereferencable and `Base` is a virtual
     /// base class, the behavior is undefined.
+    #[inline(always)]
     unsafe fn upcast_ptr_mut(derived: *mut Self) -> *mut Base {
         Self::upcast_ptr(derived) as *mut _
     }
@@ -164,6 +169,7 @@ pub unsafe trait Inherits<Base> {
 
 /// All classes are their own improper base.
 unsafe impl<T> Inherits<T> for T {
+    #[inline(always)]
     unsafe fn upcast_ptr(derived: *const Self) -> *const Self {
         derived
     }
@@ -5,10 +5,12 @@
 #ifndef CRUBIT_SUPPORT_RS_STD_CHAR_H_
 #define CRUBIT_SUPPORT_RS_STD_CHAR_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 
 #include "absl/base/optimization.h"
+#include "absl/types/span.h"
 
 namespace rs_std {
 
@@ -37,20 +39,49 @@ class rs_char final {
   // This function mimics Rust's `char::from_u32`:
   // https://doc.rust-lang.org/std/primitive.char.html#method.from_u32
   static constexpr std::optional<rs_char> from_u32(char32_t c) {
-    // TODO(lukasza): Consider using slightly more efficient checks similarly
-    // to how `char_try_from_u32` is implemented in Rust standard library.
-    if (ABSL_PREDICT_FALSE(c > 0x10ffff)) {
-      // Value greater than Rust's `char::MAX`:
-      // https://doc.rust-lang.org/std/primitive.char.html#associatedconstant.MAX
+    if (ABSL_PREDICT_FALSE(!is_valid(c))) {
       return std::nullopt;
     }
+    return from_u32_unchecked(c);
+  }
 
-    if (ABSL_PREDICT_FALSE(c >= 0xd800 && c <= 0xdfff)) {
-      // Surrogate characters.
-      return std::nullopt;
+  // Validates and converts a buffer of `char32_t` values into `rs_char`s.
+  //
+  // Converts `min(source.size(), destination.size())` characters and returns
+  // the number of characters converted - the full count if all source values
+  // were valid, or the index of the first invalid value (at which point the
+  // conversion stops; `destination` elements at and past the returned index
+  // are left unmodified).
+  //
+  // This is the preferred API for bridging bulk character data across the
+  // FFI boundary: the all-valid scan below is a branch-free bitwise
+  // reduction that compilers can vectorize, instead of `from_u32`'s
+  // per-character branching.
+  static constexpr std::size_t from_u32_bulk(
+      absl::Span<const char32_t> source, absl::Span<rs_char> destination) {
+    std::size_t count = source.size() < destination.size()
+                            ? source.size()
+                            : destination.size();
+
+    bool all_valid = true;
+    for (std::size_t i = 0; i < count; ++i) {
+      all_valid &= is_valid(source[i]);
+    }
+    if (ABSL_PREDICT_TRUE(all_valid)) {
+      for (std::size_t i = 0; i < count; ++i) {
+        destination[i] = from_u32_unchecked(source[i]);
+      }
+      return count;
     }
 
-    return from_u32_unchecked(c);
+    // Slow path: stop at the first invalid value.
+    for (std::size_t i = 0; i < count; ++i) {
+      if (!is_valid(source[i])) {
+        return i;
+      }
+      destination[i] = from_u32_unchecked(source[i]);
+    }
+    return count;
   }
 
   constexpr rs_char(const rs_char&) = default;
@@ -87,6 +118,16 @@ class rs_char final {
   static const rs_char MAX;
 
  private:
+  // Returns whether `c` is a valid Rust `char` value - i.e. neither a
+  // surrogate nor above `char::MAX`.  The expression below is the branch-free
+  // check used by `char_try_from_u32` in the Rust standard library: XOR-ing
+  // with 0xd800 relocates the surrogate range to [0, 0x800), so a single
+  // subtract-and-compare rejects both invalid ranges.
+  static constexpr bool is_valid(char32_t c) {
+    return (static_cast<std::uint32_t>(c) ^ 0xd800u) - 0x800u <
+           (0x110000u - 0x800u);
+  }
+
   // This function mimics Rust's `char::from_u32_unchecked`:
   // https://doc.rust-lang.org/std/primitive.char.html#method.from_u32_unchecked
   //
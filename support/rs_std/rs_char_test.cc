@@ -127,6 +127,24 @@ TEST(RsCharTest, FromU32ValidityChecks) {
   EXPECT_EQ(0xe000, uint32_t{*maybe_c});
 }
 
+TEST(RsCharTest, FromU32Bulk) {
+  constexpr char32_t kValidInput[] = {U'f', U'o', U'ó', U'😊'};
+  rs_std::rs_char converted[4];
+  EXPECT_EQ(4, rs_std::rs_char::from_u32_bulk(kValidInput, converted));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(uint32_t{kValidInput[i]}, uint32_t{converted[i]});
+  }
+
+  // Conversion stops at the first invalid value and reports its index.
+  const char32_t invalid_input[] = {U'f', 0xd800, U'o'};
+  EXPECT_EQ(1, rs_std::rs_char::from_u32_bulk(invalid_input, converted));
+  EXPECT_EQ(uint32_t{U'f'}, uint32_t{converted[0]});
+
+  // No more characters are converted than there is room for.
+  rs_std::rs_char short_destination[2];
+  EXPECT_EQ(2, rs_std::rs_char::from_u32_bulk(kValidInput, short_destination));
+}
+
 // Test that `rs_std::rs_char` values can be compared with other
 // `rs_std::rs_char` values.
 TEST(RsCharTest, ComparisonWithAnotherRsChar) {